@@ -50,6 +50,7 @@ typedef struct StygianAPConfig {
   StygianWindow *window;       // Required: window for context creation
   uint32_t max_elements;       // Max elements in SSBO/UBO
   uint32_t max_textures;       // Max texture slots
+  uint32_t max_clips;          // Clip rect capacity (0 = STYGIAN_MAX_CLIPS)
   const char *shader_dir;      // Path to shader files (for hot reload)
   StygianAllocator *allocator; // Optional: defaults to CRT allocator
 } StygianAPConfig;
@@ -123,16 +124,40 @@ void stygian_ap_submit_soa(StygianAP *ap, const StygianSoAHot *hot,
                            const StygianBufferChunk *chunks,
                            uint32_t chunk_count, uint32_t chunk_size);
 
-// Issue draw call for the most recently submitted batch
+// Queue draws for the most recently submitted batch. Ranges are collected
+// (adjacent ones merge) and submitted together, as one multi-draw where the
+// backend supports it, at end_frame, timer_end or the next timer phase mark.
 void stygian_ap_draw(StygianAP *ap);
 void stygian_ap_draw_range(StygianAP *ap, uint32_t first_instance,
                            uint32_t instance_count);
+// GPU draw commands issued by the last finished frame (a multi-draw is one).
+uint32_t stygian_ap_get_last_draw_calls(const StygianAP *ap);
+
+// Limit this frame to the given screen rects (x, y, w, h floats per rect,
+// pixels, top-left origin): the frame clears and draws only inside them and
+// presents them as damage hints where the platform takes hints. rects NULL
+// repaints the whole target; a count of 0 repaints nothing. Call between
+// begin_frame and the first draw. Backends that cannot keep the previous
+// frame's pixels (new or resized targets, no retained image) repaint fully.
+void stygian_ap_set_damage(StygianAP *ap, const float *rects, uint32_t count);
 
 // Optional GPU timing (backend-dependent).
 // If unsupported, begin/end are no-ops and last_gpu_ms returns 0.
 void stygian_ap_gpu_timer_begin(StygianAP *ap);
 void stygian_ap_gpu_timer_end(StygianAP *ap);
 
+// Per-phase GPU timing between timer_begin and timer_end. Phase 0 is the
+// main pass and 1 + i is layer i; each mark starts a phase that runs until
+// the next mark or timer_end, and repeated phases accumulate. Results lag
+// the frame by the backend's frames in flight. Backends without phase
+// timing ignore marks and report 0 phases.
+#define STYGIAN_AP_GPU_PHASES 33 // Main pass + StygianContext.layers[32]
+void stygian_ap_gpu_timer_phase(StygianAP *ap, uint32_t phase);
+// Copies up to max_phases per-phase times (ms) of the newest timed frame and
+// returns how many phases it had.
+uint32_t stygian_ap_get_last_gpu_phases(const StygianAP *ap, float *out_ms,
+                                        uint32_t max_phases);
+
 // End frame - finalize frame (no draw for GL; ends command buffer for VK)
 void stygian_ap_end_frame(StygianAP *ap);
 
@@ -191,12 +216,22 @@ void stygian_ap_set_output_color_transform(
     StygianAP *ap, bool enabled, const float *rgb3x3, bool src_srgb_transfer,
     float src_gamma, bool dst_srgb_transfer, float dst_gamma);
 
+// Sampled output transform: size^3 RGBA16 UNORM texels (red fastest) from
+// stygian_color_transform_lut3d. When set it replaces the analytic transform
+// above; NULL clears it. Backends without 3D LUT support keep the analytic
+// path.
+void stygian_ap_set_output_color_lut(StygianAP *ap, const uint16_t *rgba16,
+                                     uint32_t size);
+
 // ============================================================================
 // Clip Regions
 // ============================================================================
 
-// Update clip regions array (up to 256)
-void stygian_ap_set_clips(StygianAP *ap, const float *clips, uint32_t count);
+// Clip table for the frame: count rects (x, y, w, h), at most max_clips.
+// Entries below first_changed match the previous call, so a backend keeping
+// one copy per frame in flight only writes the entries each copy lacks.
+void stygian_ap_set_clips(StygianAP *ap, const float *clips, uint32_t count,
+                          uint32_t first_changed);
 
 #ifdef __cplusplus
 }
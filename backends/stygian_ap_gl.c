@@ -34,6 +34,8 @@ typedef ptrdiff_t GLsizeiptr;
 typedef char GLchar;
 typedef unsigned char GLboolean;
 typedef float GLfloat;
+typedef unsigned int GLbitfield;
+typedef struct __GLsync *GLsync;
 
 // Use ifndef guards to avoid conflicts with system gl.h
 #ifndef GL_FALSE
@@ -117,6 +119,78 @@ typedef float GLfloat;
 #ifndef GL_QUERY_RESULT_AVAILABLE
 #define GL_QUERY_RESULT_AVAILABLE 0x8867
 #endif
+#ifndef GL_TEXTURE_3D
+#define GL_TEXTURE_3D 0x806F
+#endif
+#ifndef GL_TEXTURE_WRAP_R
+#define GL_TEXTURE_WRAP_R 0x8072
+#endif
+#ifndef GL_RGBA16
+#define GL_RGBA16 0x805B
+#endif
+#ifndef GL_UNSIGNED_SHORT
+#define GL_UNSIGNED_SHORT 0x1403
+#endif
+#ifndef GL_UNSIGNED_INT
+#define GL_UNSIGNED_INT 0x1405
+#endif
+#ifndef GL_STREAM_DRAW
+#define GL_STREAM_DRAW 0x88E0
+#endif
+#ifndef GL_DRAW_INDIRECT_BUFFER
+#define GL_DRAW_INDIRECT_BUFFER 0x8F3F
+#endif
+#ifndef GL_NUM_EXTENSIONS
+#define GL_NUM_EXTENSIONS 0x821D
+#endif
+#ifndef GL_SHADER_STORAGE_BUFFER_OFFSET_ALIGNMENT
+#define GL_SHADER_STORAGE_BUFFER_OFFSET_ALIGNMENT 0x90DF
+#endif
+#ifndef GL_MAP_WRITE_BIT
+#define GL_MAP_WRITE_BIT 0x0002
+#endif
+#ifndef GL_MAP_PERSISTENT_BIT
+#define GL_MAP_PERSISTENT_BIT 0x0040
+#endif
+#ifndef GL_MAP_COHERENT_BIT
+#define GL_MAP_COHERENT_BIT 0x0080
+#endif
+#ifndef GL_SYNC_GPU_COMMANDS_COMPLETE
+#define GL_SYNC_GPU_COMMANDS_COMPLETE 0x9117
+#endif
+#ifndef GL_SYNC_FLUSH_COMMANDS_BIT
+#define GL_SYNC_FLUSH_COMMANDS_BIT 0x00000001
+#endif
+#ifndef GL_TIMEOUT_EXPIRED
+#define GL_TIMEOUT_EXPIRED 0x911B
+#endif
+#ifndef GL_WAIT_FAILED
+#define GL_WAIT_FAILED 0x911D
+#endif
+#ifndef GL_SCISSOR_TEST
+#define GL_SCISSOR_TEST 0x0C11
+#endif
+#ifndef GL_NEAREST
+#define GL_NEAREST 0x2600
+#endif
+#ifndef GL_RGBA8
+#define GL_RGBA8 0x8058
+#endif
+#ifndef GL_FRAMEBUFFER
+#define GL_FRAMEBUFFER 0x8D40
+#endif
+#ifndef GL_READ_FRAMEBUFFER
+#define GL_READ_FRAMEBUFFER 0x8CA8
+#endif
+#ifndef GL_DRAW_FRAMEBUFFER
+#define GL_DRAW_FRAMEBUFFER 0x8CA9
+#endif
+#ifndef GL_COLOR_ATTACHMENT0
+#define GL_COLOR_ATTACHMENT0 0x8CE0
+#endif
+#ifndef GL_FRAMEBUFFER_COMPLETE
+#define GL_FRAMEBUFFER_COMPLETE 0x8CD5
+#endif
 
 // ============================================================================
 // OpenGL Function Pointers
@@ -210,6 +284,54 @@ static PFNGLBEGINQUERYPROC glBeginQuery;
 static PFNGLENDQUERYPROC glEndQuery;
 static PFNGLGETQUERYOBJECTIVPROC glGetQueryObjectiv;
 static PFNGLGETQUERYOBJECTUI64VPROC glGetQueryObjectui64v;
+typedef void (*PFNGLTEXIMAGE3DPROC)(GLenum, GLint, GLint, GLsizei, GLsizei,
+                                    GLsizei, GLint, GLenum, GLenum,
+                                    const void *);
+static PFNGLTEXIMAGE3DPROC glTexImage3D;
+typedef void (*PFNGLVERTEXATTRIBIPOINTERPROC)(GLuint, GLint, GLenum, GLsizei,
+                                              const void *);
+typedef void (*PFNGLVERTEXATTRIBDIVISORPROC)(GLuint, GLuint);
+typedef void (*PFNGLMULTIDRAWARRAYSINDIRECTPROC)(GLenum, const void *, GLsizei,
+                                                 GLsizei);
+static PFNGLVERTEXATTRIBIPOINTERPROC glVertexAttribIPointer;
+static PFNGLVERTEXATTRIBDIVISORPROC glVertexAttribDivisor;
+static PFNGLMULTIDRAWARRAYSINDIRECTPROC glMultiDrawArraysIndirect;
+
+// Persistent-mapped uploads (GL 4.4 / ARB_buffer_storage)
+typedef const unsigned char *(*PFNGLGETSTRINGIPROC)(GLenum, GLuint);
+typedef void (*PFNGLBUFFERSTORAGEPROC)(GLenum, GLsizeiptr, const void *,
+                                       GLbitfield);
+typedef void *(*PFNGLMAPBUFFERRANGEPROC)(GLenum, GLsizeiptr, GLsizeiptr,
+                                         GLbitfield);
+typedef void (*PFNGLBINDBUFFERRANGEPROC)(GLenum, GLuint, GLuint, GLsizeiptr,
+                                         GLsizeiptr);
+typedef GLsync (*PFNGLFENCESYNCPROC)(GLenum, GLbitfield);
+typedef GLenum (*PFNGLCLIENTWAITSYNCPROC)(GLsync, GLbitfield, uint64_t);
+typedef void (*PFNGLDELETESYNCPROC)(GLsync);
+static PFNGLGETSTRINGIPROC glGetStringi;
+static PFNGLBUFFERSTORAGEPROC glBufferStorage;
+static PFNGLMAPBUFFERRANGEPROC glMapBufferRange;
+static PFNGLBINDBUFFERRANGEPROC glBindBufferRange;
+static PFNGLFENCESYNCPROC glFenceSync;
+static PFNGLCLIENTWAITSYNCPROC glClientWaitSync;
+static PFNGLDELETESYNCPROC glDeleteSync;
+
+// Retained frame target (GL 3.0 framebuffer objects)
+typedef void (*PFNGLGENFRAMEBUFFERSPROC)(GLsizei, GLuint *);
+typedef void (*PFNGLDELETEFRAMEBUFFERSPROC)(GLsizei, const GLuint *);
+typedef void (*PFNGLBINDFRAMEBUFFERPROC)(GLenum, GLuint);
+typedef void (*PFNGLFRAMEBUFFERTEXTURE2DPROC)(GLenum, GLenum, GLenum, GLuint,
+                                              GLint);
+typedef GLenum (*PFNGLCHECKFRAMEBUFFERSTATUSPROC)(GLenum);
+typedef void (*PFNGLBLITFRAMEBUFFERPROC)(GLint, GLint, GLint, GLint, GLint,
+                                         GLint, GLint, GLint, GLbitfield,
+                                         GLenum);
+static PFNGLGENFRAMEBUFFERSPROC glGenFramebuffers;
+static PFNGLDELETEFRAMEBUFFERSPROC glDeleteFramebuffers;
+static PFNGLBINDFRAMEBUFFERPROC glBindFramebuffer;
+static PFNGLFRAMEBUFFERTEXTURE2DPROC glFramebufferTexture2D;
+static PFNGLCHECKFRAMEBUFFERSTATUSPROC glCheckFramebufferStatus;
+static PFNGLBLITFRAMEBUFFERPROC glBlitFramebuffer;
 
 static void load_gl(void **ptr, const char *name) {
   *ptr = stygian_window_gl_get_proc_address(name);
@@ -220,9 +342,36 @@ static void load_gl(void **ptr, const char *name) {
 // Access Point Structure
 // ============================================================================
 
+// Persistent upload path: every SSBO holds one region per frame in flight.
+// A frame writes and draws from its own region, and begin_frame waits on the
+// fence placed after that region's last draws before writing it again.
+#define STYGIAN_GL_UPLOAD_REGIONS 3
+#define STYGIAN_GL_SOA_BUFFERS 3 // hot, appearance, effects
+
+// Draw ranges queued per frame before a flush; layers cap real frames at 65.
+#define STYGIAN_GL_MAX_DRAW_BATCH 128
+
+// Damage rects honoured per frame; more repaint the whole frame.
+#define STYGIAN_GL_MAX_DAMAGE_RECTS 16
+
+// DrawArraysIndirectCommand layout.
+typedef struct StygianGLDrawCommand {
+  GLuint count;
+  GLuint instance_count;
+  GLuint first;
+  GLuint base_instance;
+} StygianGLDrawCommand;
+
+// Dirty element range still owed to one region (min > max = nothing pending).
+typedef struct StygianGLDirtyRange {
+  uint32_t min;
+  uint32_t max;
+} StygianGLDirtyRange;
+
 struct StygianAP {
   StygianWindow *window;
   uint32_t max_elements;
+  uint32_t max_clips;
   StygianAllocator *allocator;
 
   void *gl_context;
@@ -231,6 +380,8 @@ struct StygianAP {
   GLuint clip_ssbo;
   GLuint vao;
   GLuint vbo;
+  GLuint element_index_vbo; // Per-instance element index (attribute 1)
+  GLuint indirect_buffer;
   GLuint program;
 
   // Uniform locations
@@ -245,6 +396,8 @@ struct StygianAP {
   GLint loc_output_src_gamma;
   GLint loc_output_dst_srgb;
   GLint loc_output_dst_gamma;
+  GLint loc_output_lut;
+  GLint loc_output_lut_size;
 
   // State
   uint32_t element_count;
@@ -256,6 +409,8 @@ struct StygianAP {
   float output_src_gamma;
   bool output_dst_srgb_transfer;
   float output_dst_gamma;
+  GLuint output_lut_tex; // 3D RGBA16 sampled output transform
+  uint32_t output_lut_size; // 0 = analytic transform
 
   // Shader paths for hot reload
   char shader_dir[256];
@@ -284,10 +439,48 @@ struct StygianAP {
 
   // Remapped hot stream submitted to GPU (texture handles -> sampler slots).
   StygianSoAHot *submit_hot;
+
+  // Persistent-mapped uploads; false = glBufferSubData path.
+  bool persistent_upload;
+  uint32_t upload_region; // Region the current frame writes and draws from
+  GLsync region_fence[STYGIAN_GL_UPLOAD_REGIONS];
+  size_t soa_region_stride[STYGIAN_GL_SOA_BUFFERS]; // Bytes, SSBO-aligned
+  unsigned char *soa_mapped[STYGIAN_GL_SOA_BUFFERS];
+  // Per region, per chunk: changes made since that region was last written
+  StygianGLDirtyRange *soa_pending[STYGIAN_GL_UPLOAD_REGIONS]
+                                  [STYGIAN_GL_SOA_BUFFERS];
+  size_t clip_region_stride;
+  unsigned char *clip_mapped;
+  // Leading clip entries each region holds (region 0 on the fallback path)
+  uint32_t clip_valid[STYGIAN_GL_UPLOAD_REGIONS];
+
+  // Draw ranges queued since the last flush
+  StygianGLDrawCommand draw_batch[STYGIAN_GL_MAX_DRAW_BATCH];
+  uint32_t draw_batch_count;
+  uint32_t frame_draw_calls;
+  uint32_t last_draw_calls;
+
+  // Retained target: frames draw into it and end_frame blits it to the
+  // window, so a damaged frame only repaints inside its damage rects.
+  bool retained_enabled;
+  GLuint retained_fbo;
+  GLuint retained_tex;
+  int retained_w, retained_h;
+  bool retained_valid;  // Holds the previous frame's pixels
+  bool frame_retained;  // This frame draws into the retained target
+  bool frame_prepared;  // This frame's clear went out
+  int frame_w, frame_h;
+  bool damage_partial;  // Clear and draw only inside damage_boxes
+  uint32_t damage_count;
+  GLint damage_boxes[STYGIAN_GL_MAX_DAMAGE_RECTS][4]; // Scissor x, y, w, h
 };
 
+static void gl_flush_draws(StygianAP *ap);
+
 #define STYGIAN_GL_IMAGE_SAMPLERS 16
 #define STYGIAN_GL_IMAGE_UNIT_BASE 2 // units 0,1 reserved for font atlas etc.
+#define STYGIAN_GL_OUTPUT_LUT_UNIT                                             \
+  (STYGIAN_GL_IMAGE_UNIT_BASE + STYGIAN_GL_IMAGE_SAMPLERS)
 
 // Safe string copy: deterministic, no printf overhead, always NUL-terminates.
 // copy_cstr removed — use stygian_cpystr from stygian_internal.h
@@ -473,7 +666,8 @@ static GLuint compile_program_internal(
     GLint *out_loc_px_range, GLint *out_loc_output_transform_enabled,
     GLint *out_loc_output_matrix, GLint *out_loc_output_src_srgb,
     GLint *out_loc_output_src_gamma, GLint *out_loc_output_dst_srgb,
-    GLint *out_loc_output_dst_gamma) {
+    GLint *out_loc_output_dst_gamma, GLint *out_loc_output_lut,
+    GLint *out_loc_output_lut_size) {
   char *vert_src = load_shader_file(ap, "stygian.vert");
   if (!vert_src)
     return 0;
@@ -556,6 +750,11 @@ static GLuint compile_program_internal(
   if (out_loc_output_dst_gamma)
     *out_loc_output_dst_gamma =
         glGetUniformLocation(program, "uOutputDstGamma");
+  if (out_loc_output_lut)
+    *out_loc_output_lut = glGetUniformLocation(program, "uOutputLut");
+  if (out_loc_output_lut_size)
+    *out_loc_output_lut_size =
+        glGetUniformLocation(program, "uOutputLutSize");
 
   return program;
 }
@@ -566,7 +765,8 @@ static bool create_program(StygianAP *ap) {
       &ap->loc_atlas_size, &ap->loc_px_range, &ap->loc_output_transform_enabled,
       &ap->loc_output_matrix, &ap->loc_output_src_srgb,
       &ap->loc_output_src_gamma, &ap->loc_output_dst_srgb,
-      &ap->loc_output_dst_gamma);
+      &ap->loc_output_dst_gamma, &ap->loc_output_lut,
+      &ap->loc_output_lut_size);
 
   if (!program)
     return false;
@@ -600,6 +800,330 @@ static void upload_output_color_transform_uniforms(StygianAP *ap) {
   if (ap->loc_output_dst_gamma >= 0) {
     glUniform1f(ap->loc_output_dst_gamma, ap->output_dst_gamma);
   }
+  if (ap->loc_output_lut >= 0) {
+    glUniform1i(ap->loc_output_lut, STYGIAN_GL_OUTPUT_LUT_UNIT);
+  }
+  if (ap->loc_output_lut_size >= 0) {
+    glUniform1f(ap->loc_output_lut_size, (float)ap->output_lut_size);
+  }
+}
+
+// ============================================================================
+// Persistent-Mapped Uploads
+// ============================================================================
+
+static bool gl_has_extension(const char *name) {
+  GLint count = 0;
+  if (!glGetStringi)
+    return false;
+  glGetIntegerv(GL_NUM_EXTENSIONS, &count);
+  for (GLint i = 0; i < count; i++) {
+    const char *ext = (const char *)glGetStringi(GL_EXTENSIONS, (GLuint)i);
+    if (ext && strcmp(ext, name) == 0)
+      return true;
+  }
+  return false;
+}
+
+static size_t gl_align_up(size_t value, size_t alignment) {
+  return (value + alignment - 1u) / alignment * alignment;
+}
+
+// Create one immutable, persistently mapped SSBO of `regions` x `stride`.
+static bool gl_create_mapped_ssbo(GLuint *buffer, size_t stride,
+                                  unsigned char **mapped) {
+  const GLbitfield flags =
+      GL_MAP_WRITE_BIT | GL_MAP_PERSISTENT_BIT | GL_MAP_COHERENT_BIT;
+  GLsizeiptr size = (GLsizeiptr)(stride * STYGIAN_GL_UPLOAD_REGIONS);
+  glGenBuffers(1, buffer);
+  glBindBuffer(GL_SHADER_STORAGE_BUFFER, *buffer);
+  glBufferStorage(GL_SHADER_STORAGE_BUFFER, size, NULL, flags);
+  *mapped = (unsigned char *)glMapBufferRange(GL_SHADER_STORAGE_BUFFER, 0, size,
+                                              flags);
+  return *mapped != NULL;
+}
+
+static void gl_destroy_persistent_upload(StygianAP *ap) {
+  for (uint32_t r = 0; r < STYGIAN_GL_UPLOAD_REGIONS; r++) {
+    if (ap->region_fence[r]) {
+      glDeleteSync(ap->region_fence[r]);
+      ap->region_fence[r] = NULL;
+    }
+    for (uint32_t b = 0; b < STYGIAN_GL_SOA_BUFFERS; b++) {
+      ap_free(ap, ap->soa_pending[r][b]);
+      ap->soa_pending[r][b] = NULL;
+    }
+  }
+  // Deleting a buffer unmaps it.
+  memset(ap->soa_mapped, 0, sizeof(ap->soa_mapped));
+  ap->clip_mapped = NULL;
+  ap->persistent_upload = false;
+}
+
+// Buffers for the persistent path; on failure everything created here is
+// released and the caller falls back to glBufferData/glBufferSubData.
+static bool gl_create_persistent_upload(StygianAP *ap) {
+  const size_t strides[STYGIAN_GL_SOA_BUFFERS] = {
+      sizeof(StygianSoAHot), sizeof(StygianSoAAppearance),
+      sizeof(StygianSoAEffects)};
+  GLuint *buffers[STYGIAN_GL_SOA_BUFFERS] = {
+      &ap->soa_ssbo_hot, &ap->soa_ssbo_appearance, &ap->soa_ssbo_effects};
+  GLint align = 0;
+  bool ok;
+
+  glGetIntegerv(GL_SHADER_STORAGE_BUFFER_OFFSET_ALIGNMENT, &align);
+  if (align < 1)
+    align = 256;
+
+  ap->clip_region_stride = gl_align_up(
+      (size_t)ap->max_clips * sizeof(float) * 4, (size_t)align);
+  ok = gl_create_mapped_ssbo(&ap->clip_ssbo, ap->clip_region_stride,
+                             &ap->clip_mapped);
+  for (uint32_t b = 0; ok && b < STYGIAN_GL_SOA_BUFFERS; b++) {
+    ap->soa_region_stride[b] =
+        gl_align_up((size_t)ap->max_elements * strides[b], (size_t)align);
+    ok = gl_create_mapped_ssbo(buffers[b], ap->soa_region_stride[b],
+                               &ap->soa_mapped[b]);
+  }
+  for (uint32_t r = 0; ok && r < STYGIAN_GL_UPLOAD_REGIONS; r++) {
+    for (uint32_t b = 0; ok && b < STYGIAN_GL_SOA_BUFFERS; b++) {
+      StygianGLDirtyRange *pending = (StygianGLDirtyRange *)ap_alloc(
+          ap, ap->soa_chunk_count * sizeof(StygianGLDirtyRange),
+          _Alignof(StygianGLDirtyRange));
+      ap->soa_pending[r][b] = pending;
+      if (!pending) {
+        ok = false;
+        break;
+      }
+      for (uint32_t ci = 0; ci < ap->soa_chunk_count; ci++) {
+        pending[ci].min = UINT32_MAX;
+        pending[ci].max = 0u;
+      }
+    }
+  }
+
+  if (!ok) {
+    gl_destroy_persistent_upload(ap);
+    if (ap->clip_ssbo)
+      glDeleteBuffers(1, &ap->clip_ssbo);
+    for (uint32_t b = 0; b < STYGIAN_GL_SOA_BUFFERS; b++) {
+      if (*buffers[b])
+        glDeleteBuffers(1, buffers[b]);
+      *buffers[b] = 0u;
+    }
+    ap->clip_ssbo = 0u;
+    return false;
+  }
+  ap->persistent_upload = true;
+  ap->upload_region = 0u;
+  return true;
+}
+
+// Point bindings 3..6 at the current region.
+static void gl_bind_upload_region(StygianAP *ap) {
+  const GLuint buffers[STYGIAN_GL_SOA_BUFFERS] = {
+      ap->soa_ssbo_hot, ap->soa_ssbo_appearance, ap->soa_ssbo_effects};
+  uint32_t r = ap->upload_region;
+  glBindBufferRange(GL_SHADER_STORAGE_BUFFER, 3, ap->clip_ssbo,
+                    (GLsizeiptr)(r * ap->clip_region_stride),
+                    (GLsizeiptr)ap->clip_region_stride);
+  for (uint32_t b = 0; b < STYGIAN_GL_SOA_BUFFERS; b++) {
+    glBindBufferRange(GL_SHADER_STORAGE_BUFFER, 4 + b, buffers[b],
+                      (GLsizeiptr)(r * ap->soa_region_stride[b]),
+                      (GLsizeiptr)ap->soa_region_stride[b]);
+  }
+}
+
+// Move to the next region and wait until the GPU is done reading it. With
+// three regions this only blocks when the CPU runs two frames ahead.
+static void gl_advance_upload_region(StygianAP *ap) {
+  uint32_t r = (ap->upload_region + 1u) % STYGIAN_GL_UPLOAD_REGIONS;
+  GLsync fence = ap->region_fence[r];
+  ap->upload_region = r;
+  if (fence) {
+    GLenum status;
+    do {
+      status = glClientWaitSync(fence, GL_SYNC_FLUSH_COMMANDS_BIT,
+                                1000000000ull);
+    } while (status == GL_TIMEOUT_EXPIRED);
+    if (status == GL_WAIT_FAILED)
+      printf("[Stygian AP] Upload fence wait failed\n");
+    glDeleteSync(fence);
+    ap->region_fence[r] = NULL;
+  }
+  gl_bind_upload_region(ap);
+}
+
+// Widen one region's pending range for a chunk by [lo, hi].
+static void gl_pending_add(StygianGLDirtyRange *r, uint32_t lo, uint32_t hi) {
+  if (lo < r->min)
+    r->min = lo;
+  if (hi > r->max)
+    r->max = hi;
+}
+
+// Same versioned chunk walk as the glBufferSubData path, but a new version
+// is owed to every region; the current region is then brought up to date
+// with plain memcpy into the mapping.
+static void gl_submit_soa_persistent(StygianAP *ap, const StygianSoAHot *hot,
+                                     const StygianSoAAppearance *appearance,
+                                     const StygianSoAEffects *effects,
+                                     uint32_t element_count,
+                                     const StygianBufferChunk *chunks,
+                                     uint32_t chunk_count,
+                                     uint32_t chunk_size) {
+  const void *sources[STYGIAN_GL_SOA_BUFFERS] = {hot, appearance, effects};
+  const size_t strides[STYGIAN_GL_SOA_BUFFERS] = {
+      sizeof(StygianSoAHot), sizeof(StygianSoAAppearance),
+      sizeof(StygianSoAEffects)};
+  uint32_t *seen[STYGIAN_GL_SOA_BUFFERS] = {ap->gpu_hot_versions,
+                                            ap->gpu_appearance_versions,
+                                            ap->gpu_effects_versions};
+  uint32_t r = ap->upload_region;
+
+  for (uint32_t ci = 0; ci < chunk_count; ci++) {
+    const StygianBufferChunk *c = &chunks[ci];
+    const uint32_t versions[STYGIAN_GL_SOA_BUFFERS] = {
+        c->hot_version, c->appearance_version, c->effects_version};
+    const uint32_t dirty_min[STYGIAN_GL_SOA_BUFFERS] = {
+        c->hot_dirty_min, c->appearance_dirty_min, c->effects_dirty_min};
+    const uint32_t dirty_max[STYGIAN_GL_SOA_BUFFERS] = {
+        c->hot_dirty_max, c->appearance_dirty_max, c->effects_dirty_max};
+    uint32_t base = ci * chunk_size;
+
+    for (uint32_t b = 0; b < STYGIAN_GL_SOA_BUFFERS; b++) {
+      StygianGLDirtyRange *pending = &ap->soa_pending[r][b][ci];
+      if (seen[b] && versions[b] != seen[b][ci]) {
+        if (dirty_min[b] <= dirty_max[b]) {
+          for (uint32_t f = 0; f < STYGIAN_GL_UPLOAD_REGIONS; f++)
+            gl_pending_add(&ap->soa_pending[f][b][ci], dirty_min[b],
+                           dirty_max[b]);
+        }
+        seen[b][ci] = versions[b];
+      }
+      if (pending->min > pending->max)
+        continue;
+      uint32_t abs_min = base + pending->min;
+      uint32_t abs_max = base + pending->max;
+      if (abs_max >= element_count)
+        abs_max = element_count - 1;
+      if (abs_min < element_count) {
+        uint32_t range_count = abs_max - abs_min + 1;
+        size_t offset = (size_t)abs_min * strides[b];
+        size_t bytes = (size_t)range_count * strides[b];
+        memcpy(ap->soa_mapped[b] + r * ap->soa_region_stride[b] + offset,
+               (const char *)sources[b] + offset, bytes);
+        ap->last_upload_bytes += (uint32_t)bytes;
+        ap->last_upload_ranges++;
+      }
+      pending->min = UINT32_MAX;
+      pending->max = 0u;
+    }
+  }
+}
+
+// ============================================================================
+// Retained Frame
+// ============================================================================
+
+static void gl_destroy_retained_target(StygianAP *ap) {
+  if (ap->retained_fbo)
+    glDeleteFramebuffers(1, &ap->retained_fbo);
+  if (ap->retained_tex)
+    glDeleteTextures(1, &ap->retained_tex);
+  ap->retained_fbo = 0;
+  ap->retained_tex = 0;
+  ap->retained_w = 0;
+  ap->retained_h = 0;
+  ap->retained_valid = false;
+}
+
+// (Re)size the retained target to the frame. A new target holds nothing
+// until a whole frame has been drawn into it.
+static bool gl_ensure_retained_target(StygianAP *ap, int width, int height) {
+  if (ap->retained_fbo && ap->retained_w == width &&
+      ap->retained_h == height)
+    return true;
+  ap->retained_valid = false;
+  if (!ap->retained_tex)
+    glGenTextures(1, &ap->retained_tex);
+  if (!ap->retained_fbo)
+    glGenFramebuffers(1, &ap->retained_fbo);
+  glActiveTexture(GL_TEXTURE0);
+  glBindTexture(GL_TEXTURE_2D, ap->retained_tex);
+  glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+  glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+  glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA8, width, height, 0, GL_RGBA,
+               GL_UNSIGNED_BYTE, NULL);
+  glBindFramebuffer(GL_FRAMEBUFFER, ap->retained_fbo);
+  glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D,
+                         ap->retained_tex, 0);
+  if (glCheckFramebufferStatus(GL_FRAMEBUFFER) != GL_FRAMEBUFFER_COMPLETE) {
+    printf("[Stygian AP GL] Retained frame target incomplete; drawing to "
+           "the window directly\n");
+    glBindFramebuffer(GL_FRAMEBUFFER, 0);
+    gl_destroy_retained_target(ap);
+    ap->retained_enabled = false;
+    return false;
+  }
+  ap->retained_w = width;
+  ap->retained_h = height;
+  return true;
+}
+
+// Clear the frame once, before its first draw: all of it, or only the
+// damage boxes when the retained target still holds the previous frame.
+static void gl_prepare_frame(StygianAP *ap) {
+  if (ap->frame_prepared)
+    return;
+  ap->frame_prepared = true;
+  glClearColor(0.235f, 0.259f, 0.294f, 1.0f);
+  if (!ap->damage_partial) {
+    glDisable(GL_SCISSOR_TEST);
+    glClear(GL_COLOR_BUFFER_BIT);
+    return;
+  }
+  glEnable(GL_SCISSOR_TEST);
+  for (uint32_t i = 0; i < ap->damage_count; i++) {
+    const GLint *box = ap->damage_boxes[i];
+    glScissor(box[0], box[1], box[2], box[3]);
+    glClear(GL_COLOR_BUFFER_BIT);
+  }
+}
+
+void stygian_ap_set_damage(StygianAP *ap, const float *rects, uint32_t count) {
+  if (!ap || ap->frame_prepared)
+    return; // Already cleared in full
+  ap->damage_partial = false;
+  ap->damage_count = 0u;
+  if (rects && ap->frame_retained && ap->retained_valid &&
+      count <= STYGIAN_GL_MAX_DAMAGE_RECTS) {
+    for (uint32_t i = 0; i < count; i++) {
+      const float *r = &rects[i * 4u];
+      float fx1 = r[0] + r[2], fy1 = r[1] + r[3];
+      int x0, y0, x1, y1;
+      if (!(r[2] > 0.0f && r[3] > 0.0f))
+        continue;
+      x0 = r[0] > 0.0f ? (int)r[0] : 0;
+      y0 = r[1] > 0.0f ? (int)r[1] : 0;
+      x1 = fx1 < (float)ap->frame_w ? (int)fx1 : ap->frame_w;
+      y1 = fy1 < (float)ap->frame_h ? (int)fy1 : ap->frame_h;
+      if ((float)x1 < fx1 && x1 < ap->frame_w)
+        x1++;
+      if ((float)y1 < fy1 && y1 < ap->frame_h)
+        y1++;
+      if (x1 <= x0 || y1 <= y0)
+        continue;
+      // Scissor boxes are bottom-left based.
+      ap->damage_boxes[ap->damage_count][0] = x0;
+      ap->damage_boxes[ap->damage_count][1] = ap->frame_h - y1;
+      ap->damage_boxes[ap->damage_count][2] = x1 - x0;
+      ap->damage_boxes[ap->damage_count][3] = y1 - y0;
+      ap->damage_count++;
+    }
+    ap->damage_partial = true;
+  }
+  gl_prepare_frame(ap);
 }
 
 // ============================================================================
@@ -622,6 +1146,8 @@ StygianAP *stygian_ap_create(const StygianAPConfig *config) {
 
   ap->window = config->window;
   ap->max_elements = config->max_elements > 0 ? config->max_elements : 16384;
+  ap->max_clips =
+      config->max_clips > 0 ? config->max_clips : STYGIAN_MAX_CLIPS;
   ap->output_color_transform_enabled = false;
   ap->output_src_srgb_transfer = true;
   ap->output_dst_srgb_transfer = true;
@@ -701,8 +1227,26 @@ StygianAP *stygian_ap_create(const StygianAPConfig *config) {
   LOAD_GL(glEndQuery);
   LOAD_GL(glGetQueryObjectiv);
   LOAD_GL(glGetQueryObjectui64v);
+  LOAD_GL(glTexImage3D);
+  LOAD_GL(glGetStringi);
+  LOAD_GL(glBufferStorage);
+  LOAD_GL(glMapBufferRange);
+  LOAD_GL(glBindBufferRange);
+  LOAD_GL(glFenceSync);
+  LOAD_GL(glClientWaitSync);
+  LOAD_GL(glDeleteSync);
+  LOAD_GL(glVertexAttribIPointer);
+  LOAD_GL(glVertexAttribDivisor);
+  LOAD_GL(glMultiDrawArraysIndirect);
+  LOAD_GL(glGenFramebuffers);
+  LOAD_GL(glDeleteFramebuffers);
+  LOAD_GL(glBindFramebuffer);
+  LOAD_GL(glFramebufferTexture2D);
+  LOAD_GL(glCheckFramebufferStatus);
+  LOAD_GL(glBlitFramebuffer);
 
   // Check GL version
+  bool buffer_storage = false;
   const char *version = (const char *)glGetString(GL_VERSION);
   const char *renderer = (const char *)glGetString(GL_RENDERER);
   ap->adapter_class = classify_renderer(renderer);
@@ -716,6 +1260,7 @@ StygianAP *stygian_ap_create(const StygianAPConfig *config) {
     if (major < 4 || (major == 4 && minor < 3)) {
       printf("[Stygian AP] Warning: OpenGL 4.3+ required for SSBO\n");
     }
+    buffer_storage = major > 4 || (major == 4 && minor >= 4);
   } else {
     printf("[Stygian AP] Warning: Could not get GL version\n");
   }
@@ -726,49 +1271,6 @@ StygianAP *stygian_ap_create(const StygianAPConfig *config) {
     return NULL;
   }
 
-  // Create SSBO for clip rects (binding 3)
-  glGenBuffers(1, &ap->clip_ssbo);
-  glBindBuffer(GL_SHADER_STORAGE_BUFFER, ap->clip_ssbo);
-  glBufferData(GL_SHADER_STORAGE_BUFFER, STYGIAN_MAX_CLIPS * sizeof(float) * 4,
-               NULL, GL_DYNAMIC_DRAW);
-  glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 3, ap->clip_ssbo);
-
-  // Create SoA SSBOs (bindings 4, 5, 6)
-  glGenBuffers(1, &ap->soa_ssbo_hot);
-  glBindBuffer(GL_SHADER_STORAGE_BUFFER, ap->soa_ssbo_hot);
-  glBufferData(GL_SHADER_STORAGE_BUFFER,
-               ap->max_elements * sizeof(StygianSoAHot), NULL, GL_DYNAMIC_DRAW);
-  glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 4, ap->soa_ssbo_hot);
-
-  glGenBuffers(1, &ap->soa_ssbo_appearance);
-  glBindBuffer(GL_SHADER_STORAGE_BUFFER, ap->soa_ssbo_appearance);
-  glBufferData(GL_SHADER_STORAGE_BUFFER,
-               ap->max_elements * sizeof(StygianSoAAppearance), NULL,
-               GL_DYNAMIC_DRAW);
-  glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 5, ap->soa_ssbo_appearance);
-
-  glGenBuffers(1, &ap->soa_ssbo_effects);
-  glBindBuffer(GL_SHADER_STORAGE_BUFFER, ap->soa_ssbo_effects);
-  glBufferData(GL_SHADER_STORAGE_BUFFER,
-               ap->max_elements * sizeof(StygianSoAEffects), NULL,
-               GL_DYNAMIC_DRAW);
-  glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 6, ap->soa_ssbo_effects);
-
-  // Optional GPU timing queries (GL_TIME_ELAPSED).
-  ap->gpu_query_initialized =
-      (glGenQueries && glDeleteQueries && glBeginQuery && glEndQuery &&
-       glGetQueryObjectiv && glGetQueryObjectui64v);
-  ap->gpu_query_in_flight = false;
-  ap->gpu_query_index = 0u;
-  ap->last_gpu_ms = 0.0f;
-  ap->gpu_queries[0] = 0u;
-  ap->gpu_queries[1] = 0u;
-  ap->gpu_query_pending[0] = false;
-  ap->gpu_query_pending[1] = false;
-  if (ap->gpu_query_initialized) {
-    glGenQueries(2, ap->gpu_queries);
-  }
-
   // Allocate GPU-side version tracking for SoA chunk upload
   // Default chunk_size 256 → chunk_count = ceil(max_elements / 256)
   {
@@ -789,6 +1291,70 @@ StygianAP *stygian_ap_create(const StygianAPConfig *config) {
       memset(ap->gpu_effects_versions, 0, cc * sizeof(uint32_t));
   }
 
+  // Persistent-mapped upload regions when the context has buffer storage;
+  // STYGIAN_GL_PERSISTENT_UPLOAD=0 forces the glBufferSubData path.
+  if (!buffer_storage)
+    buffer_storage = gl_has_extension("GL_ARB_buffer_storage");
+  {
+    const char *persistent_env = getenv("STYGIAN_GL_PERSISTENT_UPLOAD");
+    if (persistent_env && persistent_env[0] &&
+        strtol(persistent_env, NULL, 10) == 0)
+      buffer_storage = false;
+  }
+  if (buffer_storage && glBufferStorage && glMapBufferRange &&
+      glBindBufferRange && glFenceSync && glClientWaitSync && glDeleteSync &&
+      ap->gpu_hot_versions && ap->gpu_appearance_versions &&
+      ap->gpu_effects_versions && gl_create_persistent_upload(ap)) {
+    gl_bind_upload_region(ap);
+    printf("[Stygian AP] Persistent-mapped uploads (%u regions)\n",
+           STYGIAN_GL_UPLOAD_REGIONS);
+  } else {
+    // Create SSBO for clip rects (binding 3)
+    glGenBuffers(1, &ap->clip_ssbo);
+    glBindBuffer(GL_SHADER_STORAGE_BUFFER, ap->clip_ssbo);
+    glBufferData(GL_SHADER_STORAGE_BUFFER,
+                 (GLsizeiptr)ap->max_clips * sizeof(float) * 4, NULL,
+                 GL_DYNAMIC_DRAW);
+    glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 3, ap->clip_ssbo);
+
+    // Create SoA SSBOs (bindings 4, 5, 6)
+    glGenBuffers(1, &ap->soa_ssbo_hot);
+    glBindBuffer(GL_SHADER_STORAGE_BUFFER, ap->soa_ssbo_hot);
+    glBufferData(GL_SHADER_STORAGE_BUFFER,
+                 ap->max_elements * sizeof(StygianSoAHot), NULL,
+                 GL_DYNAMIC_DRAW);
+    glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 4, ap->soa_ssbo_hot);
+
+    glGenBuffers(1, &ap->soa_ssbo_appearance);
+    glBindBuffer(GL_SHADER_STORAGE_BUFFER, ap->soa_ssbo_appearance);
+    glBufferData(GL_SHADER_STORAGE_BUFFER,
+                 ap->max_elements * sizeof(StygianSoAAppearance), NULL,
+                 GL_DYNAMIC_DRAW);
+    glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 5, ap->soa_ssbo_appearance);
+
+    glGenBuffers(1, &ap->soa_ssbo_effects);
+    glBindBuffer(GL_SHADER_STORAGE_BUFFER, ap->soa_ssbo_effects);
+    glBufferData(GL_SHADER_STORAGE_BUFFER,
+                 ap->max_elements * sizeof(StygianSoAEffects), NULL,
+                 GL_DYNAMIC_DRAW);
+    glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 6, ap->soa_ssbo_effects);
+  }
+
+  // Optional GPU timing queries (GL_TIME_ELAPSED).
+  ap->gpu_query_initialized =
+      (glGenQueries && glDeleteQueries && glBeginQuery && glEndQuery &&
+       glGetQueryObjectiv && glGetQueryObjectui64v);
+  ap->gpu_query_in_flight = false;
+  ap->gpu_query_index = 0u;
+  ap->last_gpu_ms = 0.0f;
+  ap->gpu_queries[0] = 0u;
+  ap->gpu_queries[1] = 0u;
+  ap->gpu_query_pending[0] = false;
+  ap->gpu_query_pending[1] = false;
+  if (ap->gpu_query_initialized) {
+    glGenQueries(2, ap->gpu_queries);
+  }
+
   ap->submit_hot = (StygianSoAHot *)ap_alloc(
       ap, (size_t)ap->max_elements * sizeof(StygianSoAHot),
       _Alignof(StygianSoAHot));
@@ -811,6 +1377,43 @@ StygianAP *stygian_ap_create(const StygianAPConfig *config) {
   glEnableVertexAttribArray(0);
   glVertexAttribPointer(0, 2, GL_FLOAT, GL_FALSE, 0, 0);
 
+  // gl_InstanceID ignores the base instance, so element indices come from an
+  // instanced attribute, which does honour it (draw ranges, indirect draws).
+  {
+    uint32_t *indices = (uint32_t *)ap_alloc(
+        ap, (size_t)ap->max_elements * sizeof(uint32_t), _Alignof(uint32_t));
+    if (!indices) {
+      printf("[Stygian AP] Failed to allocate element index buffer\n");
+      stygian_ap_destroy(ap);
+      return NULL;
+    }
+    for (uint32_t i = 0; i < ap->max_elements; i++)
+      indices[i] = i;
+    glGenBuffers(1, &ap->element_index_vbo);
+    glBindBuffer(GL_ARRAY_BUFFER, ap->element_index_vbo);
+    glBufferData(GL_ARRAY_BUFFER,
+                 (GLsizeiptr)ap->max_elements * (GLsizeiptr)sizeof(uint32_t),
+                 indices, GL_STATIC_DRAW);
+    ap_free(ap, indices);
+    glEnableVertexAttribArray(1);
+    glVertexAttribIPointer(1, 1, GL_UNSIGNED_INT, 0, 0);
+    glVertexAttribDivisor(1, 1);
+  }
+  if (glMultiDrawArraysIndirect)
+    glGenBuffers(1, &ap->indirect_buffer);
+
+  // Frames draw into a retained target so damaged frames can repaint only
+  // their damage; STYGIAN_GL_RETAINED_FRAME=0 draws to the window directly.
+  ap->retained_enabled = glGenFramebuffers && glDeleteFramebuffers &&
+                         glBindFramebuffer && glFramebufferTexture2D &&
+                         glCheckFramebufferStatus && glBlitFramebuffer;
+  {
+    const char *retained_env = getenv("STYGIAN_GL_RETAINED_FRAME");
+    if (retained_env && retained_env[0] &&
+        strtol(retained_env, NULL, 10) == 0)
+      ap->retained_enabled = false;
+  }
+
   ap->initialized = true;
   return ap;
 }
@@ -819,6 +1422,9 @@ void stygian_ap_destroy(StygianAP *ap) {
   if (!ap)
     return;
 
+  if (ap->persistent_upload)
+    gl_destroy_persistent_upload(ap);
+
   if (ap->clip_ssbo)
     glDeleteBuffers(1, &ap->clip_ssbo);
   if (ap->soa_ssbo_hot)
@@ -838,6 +1444,13 @@ void stygian_ap_destroy(StygianAP *ap) {
   }
   if (ap->vbo)
     glDeleteBuffers(1, &ap->vbo);
+  if (ap->element_index_vbo)
+    glDeleteBuffers(1, &ap->element_index_vbo);
+  if (ap->indirect_buffer)
+    glDeleteBuffers(1, &ap->indirect_buffer);
+  if (ap->output_lut_tex)
+    glDeleteTextures(1, &ap->output_lut_tex);
+  gl_destroy_retained_target(ap);
   if (ap->program)
     glDeleteProgram(ap->program);
   ap_free(ap, ap->gpu_hot_versions);
@@ -901,6 +1514,7 @@ void stygian_ap_gpu_timer_end(StygianAP *ap) {
     return;
   if (!ap->gpu_query_in_flight)
     return;
+  gl_flush_draws(ap); // Queued draws belong inside the query
   glEndQuery(GL_TIME_ELAPSED);
   ap->gpu_query_in_flight = false;
 
@@ -921,6 +1535,20 @@ void stygian_ap_gpu_timer_end(StygianAP *ap) {
   }
 }
 
+// GL_TIME_ELAPSED queries cannot nest, so the GL path times whole frames only.
+void stygian_ap_gpu_timer_phase(StygianAP *ap, uint32_t phase) {
+  (void)ap;
+  (void)phase;
+}
+
+uint32_t stygian_ap_get_last_gpu_phases(const StygianAP *ap, float *out_ms,
+                                        uint32_t max_phases) {
+  (void)ap;
+  (void)out_ms;
+  (void)max_phases;
+  return 0u;
+}
+
 // ============================================================================
 // Shader Hot Reload
 // ============================================================================
@@ -933,13 +1561,15 @@ bool stygian_ap_reload_shaders(StygianAP *ap) {
   GLint new_loc_screen_size, new_loc_font_tex, new_loc_image_tex,
       new_loc_atlas_size, new_loc_px_range, new_loc_output_transform_enabled,
       new_loc_output_matrix, new_loc_output_src_srgb, new_loc_output_src_gamma,
-      new_loc_output_dst_srgb, new_loc_output_dst_gamma;
+      new_loc_output_dst_srgb, new_loc_output_dst_gamma, new_loc_output_lut,
+      new_loc_output_lut_size;
   GLuint new_program = compile_program_internal(
       ap, &new_loc_screen_size, &new_loc_font_tex, &new_loc_image_tex,
       &new_loc_atlas_size, &new_loc_px_range, &new_loc_output_transform_enabled,
       &new_loc_output_matrix, &new_loc_output_src_srgb,
       &new_loc_output_src_gamma, &new_loc_output_dst_srgb,
-      &new_loc_output_dst_gamma);
+      &new_loc_output_dst_gamma, &new_loc_output_lut,
+      &new_loc_output_lut_size);
 
   if (!new_program) {
     // Compilation failed - keep old shader, no black screen!
@@ -965,6 +1595,8 @@ bool stygian_ap_reload_shaders(StygianAP *ap) {
   ap->loc_output_src_gamma = new_loc_output_src_gamma;
   ap->loc_output_dst_srgb = new_loc_output_dst_srgb;
   ap->loc_output_dst_gamma = new_loc_output_dst_gamma;
+  ap->loc_output_lut = new_loc_output_lut;
+  ap->loc_output_lut_size = new_loc_output_lut_size;
 
   // Update load timestamp for hot-reload tracking
   ap->shader_load_time = get_shader_newest_mod_time(ap->shader_dir);
@@ -995,9 +1627,20 @@ void stygian_ap_begin_frame(StygianAP *ap, int width, int height) {
   // Ensure the correct GL context is current for this frame.
   stygian_ap_make_current(ap);
 
+  // The clear waits for set_damage (or the first draw) to know its extent.
+  ap->frame_w = width;
+  ap->frame_h = height;
+  ap->frame_prepared = false;
+  ap->damage_partial = false;
+  ap->damage_count = 0u;
+  ap->frame_retained = ap->retained_enabled && width > 0 && height > 0 &&
+                       gl_ensure_retained_target(ap, width, height);
+  if (ap->frame_retained)
+    glBindFramebuffer(GL_FRAMEBUFFER, ap->retained_fbo);
+  else if (glBindFramebuffer)
+    glBindFramebuffer(GL_FRAMEBUFFER, 0);
+
   glViewport(0, 0, width, height);
-  glClearColor(0.235f, 0.259f, 0.294f, 1.0f);
-  glClear(GL_COLOR_BUFFER_BIT);
   glEnable(GL_BLEND);
   glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
 
@@ -1014,7 +1657,12 @@ void stygian_ap_begin_frame(StygianAP *ap, int width, int height) {
   upload_output_color_transform_uniforms(ap);
 
   glBindVertexArray(ap->vao);
-  glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 3, ap->clip_ssbo);
+  ap->draw_batch_count = 0u;
+  ap->frame_draw_calls = 0u;
+  if (ap->persistent_upload)
+    gl_advance_upload_region(ap);
+  else
+    glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 3, ap->clip_ssbo);
 }
 
 void stygian_ap_submit(StygianAP *ap, const StygianSoAHot *soa_hot,
@@ -1095,6 +1743,12 @@ void stygian_ap_submit_soa(StygianAP *ap, const StygianSoAHot *hot,
     chunk_count = ap->soa_chunk_count;
   }
 
+  if (ap->persistent_upload) {
+    gl_submit_soa_persistent(ap, hot_src, appearance, effects, element_count,
+                             chunks, chunk_count, chunk_size);
+    return;
+  }
+
   for (uint32_t ci = 0; ci < chunk_count; ci++) {
     const StygianBufferChunk *c = &chunks[ci];
     uint32_t base = ci * chunk_size;
@@ -1178,16 +1832,8 @@ void stygian_ap_submit_soa(StygianAP *ap, const StygianSoAHot *hot,
   }
 }
 
-void stygian_ap_draw(StygianAP *ap) {
-  if (!ap || ap->element_count == 0)
-    return;
-  stygian_ap_draw_range(ap, 0u, ap->element_count);
-}
-
-void stygian_ap_draw_range(StygianAP *ap, uint32_t first_instance,
-                           uint32_t instance_count) {
-  if (!ap || instance_count == 0)
-    return;
+static void gl_draw_range_now(StygianAP *ap, uint32_t first_instance,
+                              uint32_t instance_count) {
   if (glDrawArraysInstancedBaseInstance) {
     glDrawArraysInstancedBaseInstance(GL_TRIANGLES, 0, 6, instance_count,
                                       first_instance);
@@ -1202,20 +1848,128 @@ void stygian_ap_draw_range(StygianAP *ap, uint32_t first_instance,
   glDrawArraysInstanced(GL_TRIANGLES, 0, 6, instance_count);
 }
 
+// Submit queued ranges: one glMultiDrawArraysIndirect when there are several
+// (GL 4.3), else one instanced draw per range.
+static void gl_flush_draws(StygianAP *ap) {
+  uint32_t n = ap->draw_batch_count;
+  // A damaged frame replays the batch once per damage box.
+  uint32_t passes = ap->damage_partial ? ap->damage_count : 1u;
+  if (n == 0u)
+    return;
+  ap->draw_batch_count = 0u;
+  gl_prepare_frame(ap);
+  if (n > 1u && ap->indirect_buffer) {
+    glBindBuffer(GL_DRAW_INDIRECT_BUFFER, ap->indirect_buffer);
+    // Orphan each time: the previous commands may still be in flight.
+    glBufferData(GL_DRAW_INDIRECT_BUFFER,
+                 (GLsizeiptr)(n * sizeof(StygianGLDrawCommand)),
+                 ap->draw_batch, GL_STREAM_DRAW);
+    for (uint32_t p = 0; p < passes; p++) {
+      if (ap->damage_partial)
+        glScissor(ap->damage_boxes[p][0], ap->damage_boxes[p][1],
+                  ap->damage_boxes[p][2], ap->damage_boxes[p][3]);
+      glMultiDrawArraysIndirect(GL_TRIANGLES, NULL, (GLsizei)n, 0);
+    }
+    ap->frame_draw_calls += passes;
+    return;
+  }
+  for (uint32_t p = 0; p < passes; p++) {
+    if (ap->damage_partial)
+      glScissor(ap->damage_boxes[p][0], ap->damage_boxes[p][1],
+                ap->damage_boxes[p][2], ap->damage_boxes[p][3]);
+    for (uint32_t i = 0; i < n; i++) {
+      gl_draw_range_now(ap, ap->draw_batch[i].base_instance,
+                        ap->draw_batch[i].instance_count);
+    }
+  }
+  ap->frame_draw_calls += n * passes;
+}
+
+void stygian_ap_draw(StygianAP *ap) {
+  if (!ap || ap->element_count == 0)
+    return;
+  stygian_ap_draw_range(ap, 0u, ap->element_count);
+}
+
+void stygian_ap_draw_range(StygianAP *ap, uint32_t first_instance,
+                           uint32_t instance_count) {
+  StygianGLDrawCommand *last;
+  if (!ap || instance_count == 0)
+    return;
+  last = ap->draw_batch_count > 0u ? &ap->draw_batch[ap->draw_batch_count - 1u]
+                                   : NULL;
+  if (last && last->base_instance + last->instance_count == first_instance) {
+    last->instance_count += instance_count;
+    return;
+  }
+  if (ap->draw_batch_count == STYGIAN_GL_MAX_DRAW_BATCH)
+    gl_flush_draws(ap);
+  last = &ap->draw_batch[ap->draw_batch_count++];
+  last->count = 6u;
+  last->instance_count = instance_count;
+  last->first = 0u;
+  last->base_instance = first_instance;
+}
+
+uint32_t stygian_ap_get_last_draw_calls(const StygianAP *ap) {
+  return ap ? ap->last_draw_calls : 0u;
+}
+
 void stygian_ap_end_frame(StygianAP *ap) {
   if (!ap)
     return;
+  gl_prepare_frame(ap);
+  gl_flush_draws(ap);
+  ap->last_draw_calls = ap->frame_draw_calls;
+  glDisable(GL_SCISSOR_TEST);
+  if (ap->frame_retained) {
+    // The window gets the whole image; only the damage was redrawn.
+    glBindFramebuffer(GL_READ_FRAMEBUFFER, ap->retained_fbo);
+    glBindFramebuffer(GL_DRAW_FRAMEBUFFER, 0);
+    glBlitFramebuffer(0, 0, ap->frame_w, ap->frame_h, 0, 0, ap->frame_w,
+                      ap->frame_h, GL_COLOR_BUFFER_BIT, GL_NEAREST);
+    glBindFramebuffer(GL_FRAMEBUFFER, 0);
+    ap->retained_valid = true;
+    ap->frame_retained = false;
+  }
+  if (ap->persistent_upload) {
+    // Fence the region's draws; a later fence (surface draws) supersedes it.
+    GLsync *fence = &ap->region_fence[ap->upload_region];
+    if (*fence)
+      glDeleteSync(*fence);
+    *fence = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+  }
 }
 
-void stygian_ap_set_clips(StygianAP *ap, const float *clips, uint32_t count) {
+void stygian_ap_set_clips(StygianAP *ap, const float *clips, uint32_t count,
+                          uint32_t first_changed) {
+  const size_t rect = sizeof(float) * 4;
+  uint32_t *valid;
   if (!ap || !ap->clip_ssbo || !clips || count == 0)
     return;
-  if (count > STYGIAN_MAX_CLIPS)
-    count = STYGIAN_MAX_CLIPS;
+  if (count > ap->max_clips)
+    count = ap->max_clips;
+
+  // Every region loses what changed; this one then copies what it lacks.
+  for (uint32_t r = 0; r < STYGIAN_GL_UPLOAD_REGIONS; r++) {
+    if (ap->clip_valid[r] > first_changed)
+      ap->clip_valid[r] = first_changed;
+  }
+  valid = &ap->clip_valid[ap->upload_region];
+  if (*valid >= count)
+    return;
 
-  glBindBuffer(GL_SHADER_STORAGE_BUFFER, ap->clip_ssbo);
-  glBufferSubData(GL_SHADER_STORAGE_BUFFER, 0, count * sizeof(float) * 4,
-                  clips);
+  if (ap->persistent_upload) {
+    memcpy(ap->clip_mapped + ap->upload_region * ap->clip_region_stride +
+               *valid * rect,
+           clips + (size_t)*valid * 4u, (count - *valid) * rect);
+  } else {
+    glBindBuffer(GL_SHADER_STORAGE_BUFFER, ap->clip_ssbo);
+    glBufferSubData(GL_SHADER_STORAGE_BUFFER, (intptr_t)(*valid * rect),
+                    (intptr_t)((count - *valid) * rect),
+                    clips + (size_t)*valid * 4u);
+  }
+  *valid = count;
 }
 
 void stygian_ap_swap(StygianAP *ap) {
@@ -1313,6 +2067,33 @@ void stygian_ap_set_output_color_transform(
   upload_output_color_transform_uniforms(ap);
 }
 
+void stygian_ap_set_output_color_lut(StygianAP *ap, const uint16_t *rgba16,
+                                     uint32_t size) {
+  if (!ap)
+    return;
+  ap->output_lut_size = 0u;
+  if (rgba16 && size >= 2u && glTexImage3D) {
+    if (!ap->output_lut_tex)
+      glGenTextures(1, &ap->output_lut_tex);
+    // Own unit past the image samplers; 2D binds elsewhere never touch it.
+    glActiveTexture(GL_TEXTURE0 + STYGIAN_GL_OUTPUT_LUT_UNIT);
+    glBindTexture(GL_TEXTURE_3D, ap->output_lut_tex);
+    glTexParameteri(GL_TEXTURE_3D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+    glTexParameteri(GL_TEXTURE_3D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+    glTexParameteri(GL_TEXTURE_3D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+    glTexParameteri(GL_TEXTURE_3D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+    glTexParameteri(GL_TEXTURE_3D, GL_TEXTURE_WRAP_R, GL_CLAMP_TO_EDGE);
+    glTexImage3D(GL_TEXTURE_3D, 0, GL_RGBA16, (GLsizei)size, (GLsizei)size,
+                 (GLsizei)size, 0, GL_RGBA, GL_UNSIGNED_SHORT, rgba16);
+    glActiveTexture(GL_TEXTURE0);
+    ap->output_lut_size = size;
+  }
+  if (!ap->program)
+    return;
+  glUseProgram(ap->program);
+  upload_output_color_transform_uniforms(ap);
+}
+
 // ============================================================================
 // Multi-Surface Support (Floating Windows)
 // ============================================================================
@@ -1368,6 +2149,13 @@ void stygian_ap_surface_begin(StygianAP *ap, StygianAPSurface *surface,
     return;
   }
 
+  // Surfaces draw straight to their window and repaint in full.
+  ap->frame_retained = false;
+  ap->frame_prepared = true;
+  ap->damage_partial = false;
+  if (glBindFramebuffer)
+    glBindFramebuffer(GL_FRAMEBUFFER, 0);
+  glDisable(GL_SCISSOR_TEST);
   glViewport(0, 0, width, height);
   glClearColor(0.235f, 0.259f, 0.294f, 1.0f);
   glClear(GL_COLOR_BUFFER_BIT);
@@ -1397,6 +2185,11 @@ void stygian_ap_surface_begin(StygianAP *ap, StygianAPSurface *surface,
   upload_output_color_transform_uniforms(ap);
 
   glBindVertexArray(ap->vao);
+  if (ap->persistent_upload) {
+    // Surfaces draw from the region the main frame just wrote.
+    gl_bind_upload_region(ap);
+    return;
+  }
   glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 0, ap->soa_ssbo_hot);
   glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 1, ap->soa_ssbo_appearance);
   glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 2, ap->soa_ssbo_effects);
@@ -3,6 +3,7 @@
 #include "../include/stygian.h"
 #include "../include/stygian_memory.h"
 #include "../src/stygian_internal.h" // stygian_cpystr
+#include "../src/stygian_range_alloc.h"
 #include "../window/stygian_window.h"
 #include "stygian_ap.h"
 
@@ -16,6 +17,96 @@
 #define STYGIAN_VK_IMAGE_SAMPLERS 16
 #define STYGIAN_VK_MAX_SWAPCHAIN_IMAGES 3
 #define STYGIAN_VK_FRAMES_IN_FLIGHT 3
+#define STYGIAN_VK_SOA_BUFFERS 3 // hot, appearance, effects
+#define STYGIAN_VK_MAX_TEXTURES 1024
+#define STYGIAN_VK_STAGING_RING_SIZE (16u * 1024u * 1024u)
+#define STYGIAN_VK_IMAGE_BLOCK_SIZE (32u * 1024u * 1024u)
+#define STYGIAN_VK_MAX_MEMORY_BLOCKS 64
+// Timestamps per frame in flight: timer begin, phase marks, timer end. Two
+// marks per layer (layer, then back to the main pass) plus slack.
+#define STYGIAN_VK_GPU_QUERIES 72
+// Draw ranges queued before a flush, and indirect commands per frame.
+#define STYGIAN_VK_MAX_DRAW_BATCH 128
+// Damage rects per frame, and frames of damage kept for swapchain images
+// that come back older than the last one drawn.
+#define STYGIAN_VK_MAX_DAMAGE_RECTS 16
+#define STYGIAN_VK_DAMAGE_HISTORY 4
+
+// ============================================================================
+// Per-Frame Resources
+// ============================================================================
+
+// Dirty element range still owed to one frame's copy of a buffer
+// (min > max = nothing pending).
+typedef struct StygianVKDirtyRange {
+  uint32_t min;
+  uint32_t max;
+} StygianVKDirtyRange;
+
+// Everything the shaders read that the CPU rewrites per frame, once per frame
+// in flight. Buffers stay mapped for their whole life (host-coherent), and a
+// frame's copy is written only after begin_frame has waited on that frame's
+// fence, so the CPU never touches data the GPU may still be reading.
+typedef struct StygianVKFrameResources {
+  VkBuffer soa_buf[STYGIAN_VK_SOA_BUFFERS]; // Bindings 4/5/6
+  VkDeviceMemory soa_mem[STYGIAN_VK_SOA_BUFFERS];
+  void *soa_mapped[STYGIAN_VK_SOA_BUFFERS];
+  // Per chunk: changes made since this copy was last written
+  StygianVKDirtyRange *soa_pending[STYGIAN_VK_SOA_BUFFERS];
+  VkBuffer clip_buf; // Binding 3
+  VkDeviceMemory clip_mem;
+  void *clip_mapped;
+  uint32_t clip_valid; // Leading clip entries this copy holds
+  // Indirect draw commands; only with multiDrawIndirect
+  VkBuffer indirect_buf;
+  VkDeviceMemory indirect_mem;
+  VkDrawIndirectCommand *indirect_mapped;
+  uint32_t indirect_used; // Commands written this frame
+  VkDescriptorSet descriptor_set;
+  // Texture copies recorded since this frame was last submitted; end_frame
+  // submits them ahead of the frame's draws.
+  VkCommandBuffer upload_cmd;
+  bool upload_open;
+  uint64_t serial;      // Submission this frame last made (0 = none yet)
+  uint64_t staging_end; // Staging ring position that submission released
+  // GPU timer: timestamps written by that submission; the interval from
+  // query i to i + 1 belongs to gpu_query_phase[i].
+  uint32_t gpu_query_count;
+  uint8_t gpu_query_phase[STYGIAN_VK_GPU_QUERIES];
+} StygianVKFrameResources;
+
+// ============================================================================
+// Textures
+// ============================================================================
+
+// Device-local allocation that images are placed in. Shared blocks are
+// carved by a range allocator; ranges == NULL marks a dedicated allocation
+// owned by a single large image.
+typedef struct StygianVKMemoryBlock {
+  VkDeviceMemory memory;
+  uint32_t type_index;
+  StygianRangeAlloc *ranges;
+} StygianVKMemoryBlock;
+
+typedef struct StygianVKTexture {
+  VkImage image;
+  VkImageView view;
+  uint32_t block; // Index into memory_blocks
+  VkDeviceSize offset;
+  VkDeviceSize size;
+  int width;
+  int height;
+} StygianVKTexture;
+
+// Storage the GPU may still read, released once submission `serial` has
+// completed: a destroyed texture, or a one-off staging buffer used when an
+// upload did not fit in the ring.
+typedef struct StygianVKRetired {
+  uint64_t serial;
+  StygianVKTexture texture;
+  VkBuffer buffer;
+  VkDeviceMemory buffer_memory;
+} StygianVKRetired;
 
 // ============================================================================
 // Vulkan Access Point Structure
@@ -45,15 +136,14 @@ struct StygianAP {
   VkPipeline graphics_pipeline;
 
   // Resources
-  VkBuffer clip_ssbo;
-  VkDeviceMemory clip_ssbo_memory;
+  StygianVKFrameResources frames[STYGIAN_VK_FRAMES_IN_FLIGHT];
+  uint32_t upload_frame; // Frame whose buffers hold the newest upload
   VkBuffer vertex_buffer;
   VkDeviceMemory vertex_memory;
 
   // Descriptors
   VkDescriptorSetLayout descriptor_layout;
   VkDescriptorPool descriptor_pool;
-  VkDescriptorSet descriptor_set;
 
   // Command buffers
   VkCommandPool command_pool;
@@ -87,15 +177,35 @@ struct StygianAP {
   VkShaderModule vert_module;
   VkShaderModule frag_module;
 
-  // Font texture (placeholder for now)
-  VkImage font_image;
-  VkDeviceMemory font_memory;
+  // Textures (handle = index + 1). The font view/sampler are the ones
+  // currently bound to binding 1 and the image array; the table owns them.
+  StygianVKTexture textures[STYGIAN_VK_MAX_TEXTURES];
+  VkSampler texture_sampler;
   VkImageView font_view;
   VkSampler font_sampler;
+  // Frames whose descriptor sets still name an older font view (bit per
+  // frame); rewritten once the frame's fence says the GPU is done with them
+  uint32_t font_descriptors_stale;
+  StygianVKMemoryBlock memory_blocks[STYGIAN_VK_MAX_MEMORY_BLOCKS];
+
+  // Texture upload staging ring: byte positions only ever grow; the
+  // physical offset is position % STYGIAN_VK_STAGING_RING_SIZE.
+  VkBuffer staging_buf;
+  VkDeviceMemory staging_mem;
+  uint8_t *staging_mapped;
+  uint64_t staging_head; // Next byte to hand out
+  uint64_t staging_tail; // Oldest byte a submission may still read
+  VkDeviceSize staging_align;
+  uint64_t submit_serial;    // Frame submissions made so far
+  uint64_t completed_serial; // Newest submission known to have finished
+  StygianVKRetired *retired;
+  uint32_t retired_count;
+  uint32_t retired_capacity;
 
   // Config
   char shader_dir[256];
   uint32_t max_elements;
+  uint32_t max_clips;
   uint32_t element_count;
   StygianAllocator *allocator;
   uint32_t last_upload_bytes;
@@ -107,7 +217,37 @@ struct StygianAP {
   uint32_t graphics_timestamp_valid_bits;
   float gpu_timestamp_period_ns;
   bool gpu_timer_supported;
+  bool gpu_timer_open; // Between timer_begin and timer_end this frame
+  bool multi_draw_indirect; // multiDrawIndirect + drawIndirectFirstInstance
+  VkDrawIndirectCommand draw_batch[STYGIAN_VK_MAX_DRAW_BATCH];
+  uint32_t draw_batch_count;
+  uint32_t frame_draw_calls;
+  uint32_t last_draw_calls;
   VkQueryPool gpu_timer_query_pool;
+
+  // Partial redraw. Swapchain images keep their pixels (clipped = VK_FALSE),
+  // so an image last drawn in frame N is brought up to date by repainting
+  // the damage of frames N+1..now through render_pass_load. The render pass
+  // opens lazily, once the frame's damage is known.
+  VkRenderPass render_pass_load; // LOAD_OP_LOAD twin of render_pass
+  bool damage_enabled;
+  bool incremental_present; // VK_KHR_incremental_present enabled
+  bool render_pass_open;
+  int damage_w, damage_h; // Core size the damage rects refer to
+  uint64_t damage_serial; // Frames recorded so far
+  uint64_t image_serial[STYGIAN_VK_MAX_SWAPCHAIN_IMAGES]; // 0 = unknown
+  VkRect2D damage_history[STYGIAN_VK_DAMAGE_HISTORY]; // Bbox per frame
+  bool damage_history_full[STYGIAN_VK_DAMAGE_HISTORY];
+  VkRect2D frame_damage[STYGIAN_VK_MAX_DAMAGE_RECTS]; // This frame's own
+  uint32_t frame_damage_count;
+  bool frame_damage_partial;
+  VkRect2D damage_rects[STYGIAN_VK_MAX_DAMAGE_RECTS +
+                        STYGIAN_VK_DAMAGE_HISTORY]; // Repainted this frame
+  uint32_t damage_count;
+  bool damage_partial;
+
+  float last_gpu_phase_ms[STYGIAN_AP_GPU_PHASES];
+  uint32_t last_gpu_phase_count;
   float atlas_width;
   float atlas_height;
   float px_range;
@@ -118,15 +258,7 @@ struct StygianAP {
   bool output_dst_srgb_transfer;
   float output_dst_gamma;
 
-  // SoA SSBOs (bindings 4/5/6 — mirrors GL backend)
-  VkBuffer soa_hot_buf;
-  VkDeviceMemory soa_hot_mem;
-  VkBuffer soa_appearance_buf;
-  VkDeviceMemory soa_appearance_mem;
-  VkBuffer soa_effects_buf;
-  VkDeviceMemory soa_effects_mem;
-
-  // Per-chunk GPU version tracking (for dirty range upload)
+  // Per-chunk versions already folded into every frame's pending ranges
   uint32_t *gpu_hot_versions;
   uint32_t *gpu_appearance_versions;
   uint32_t *gpu_effects_versions;
@@ -250,28 +382,53 @@ static void fill_push_constants(const StygianAP *ap, float screen_w,
   out_pc->gamma[1] = ap->output_dst_gamma;
 }
 
-static void update_image_sampler_array(StygianAP *ap) {
+// Font sampler (binding 1) and the image array (binding 2) of one frame's
+// descriptor set. The set must not be in use by a pending or recording
+// command buffer: it is written without UPDATE_AFTER_BIND.
+static void vk_write_font_descriptors(StygianAP *ap, uint32_t f) {
+  VkDescriptorImageInfo image_infos[STYGIAN_VK_IMAGE_SAMPLERS];
+  VkWriteDescriptorSet writes[2];
   if (!ap || ap->font_sampler == VK_NULL_HANDLE ||
       ap->font_view == VK_NULL_HANDLE)
     return;
 
-  VkDescriptorImageInfo image_infos[STYGIAN_VK_IMAGE_SAMPLERS];
   for (uint32_t i = 0; i < STYGIAN_VK_IMAGE_SAMPLERS; ++i) {
     image_infos[i].sampler = ap->font_sampler;
     image_infos[i].imageView = ap->font_view;
     image_infos[i].imageLayout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
   }
+  for (uint32_t w = 0; w < 2; w++) {
+    writes[w] = (VkWriteDescriptorSet){
+        .sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET,
+        .dstSet = ap->frames[f].descriptor_set,
+        .dstBinding = 1 + w,
+        .dstArrayElement = 0,
+        .descriptorType = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER,
+        .descriptorCount = w == 0 ? 1 : STYGIAN_VK_IMAGE_SAMPLERS,
+        .pImageInfo = image_infos,
+    };
+  }
+  vkUpdateDescriptorSets(ap->device, 2, writes, 0, NULL);
+  ap->font_descriptors_stale &= ~(1u << f);
+}
 
-  VkWriteDescriptorSet image_write = {
-      .sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET,
-      .dstSet = ap->descriptor_set,
-      .dstBinding = 2,
-      .dstArrayElement = 0,
-      .descriptorType = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER,
-      .descriptorCount = STYGIAN_VK_IMAGE_SAMPLERS,
-      .pImageInfo = image_infos,
-  };
-  vkUpdateDescriptorSets(ap->device, 1, &image_write, 0, NULL);
+// Frame f's fence has been waited on (or found signaled): bring its set up
+// to date before it is bound again.
+static void vk_refresh_font_descriptors(StygianAP *ap, uint32_t f) {
+  if (ap->font_descriptors_stale & (1u << f))
+    vk_write_font_descriptors(ap, f);
+}
+
+// The font view changed. Only the current frame's set may be idle right
+// now; every other frame's set can still be read by a submitted command
+// buffer, so it is marked stale and rewritten in stygian_ap_begin_frame
+// after that frame's fence wait.
+static void vk_font_descriptors_changed(StygianAP *ap) {
+  ap->font_descriptors_stale = (1u << STYGIAN_VK_FRAMES_IN_FLIGHT) - 1u;
+  if (!ap->frame_active &&
+      vkGetFenceStatus(ap->device, ap->in_flight[ap->current_frame]) ==
+          VK_SUCCESS)
+    vk_write_font_descriptors(ap, ap->current_frame);
 }
 
 // ============================================================================
@@ -437,17 +594,56 @@ static bool create_logical_device(StygianAP *ap) {
       .pQueuePriorities = &queue_priority,
   };
 
-  const char *device_extensions[] = {
+  const char *device_extensions[2] = {
       VK_KHR_SWAPCHAIN_EXTENSION_NAME,
   };
+  uint32_t device_extension_count = 1;
+
+  // Present damage hints are optional; without them the whole image is
+  // presented.
+  ap->incremental_present = false;
+  if (ap->damage_enabled) {
+    uint32_t ext_count = 0;
+    vkEnumerateDeviceExtensionProperties(ap->physical_device, NULL, &ext_count,
+                                         NULL);
+    VkExtensionProperties *exts =
+        ext_count ? (VkExtensionProperties *)ap_alloc(
+                        ap, ext_count * sizeof(VkExtensionProperties),
+                        _Alignof(VkExtensionProperties))
+                  : NULL;
+    if (exts && vkEnumerateDeviceExtensionProperties(
+                    ap->physical_device, NULL, &ext_count, exts) ==
+                    VK_SUCCESS) {
+      for (uint32_t i = 0; i < ext_count; i++) {
+        if (strcmp(exts[i].extensionName,
+                   VK_KHR_INCREMENTAL_PRESENT_EXTENSION_NAME) == 0) {
+          device_extensions[device_extension_count++] =
+              VK_KHR_INCREMENTAL_PRESENT_EXTENSION_NAME;
+          ap->incremental_present = true;
+          break;
+        }
+      }
+    }
+    ap_free(ap, exts);
+  }
 
+  // Batched layer draws go out as one vkCmdDrawIndirect when the device
+  // can take several commands with non-zero firstInstance.
+  VkPhysicalDeviceFeatures supported_features;
   VkPhysicalDeviceFeatures device_features = {0};
+  vkGetPhysicalDeviceFeatures(ap->physical_device, &supported_features);
+  ap->multi_draw_indirect = supported_features.multiDrawIndirect &&
+                            supported_features.drawIndirectFirstInstance;
+  if (ap->multi_draw_indirect) {
+    device_features.multiDrawIndirect = VK_TRUE;
+    device_features.drawIndirectFirstInstance = VK_TRUE;
+  }
 
   VkDeviceCreateInfo create_info = {
       .sType = VK_STRUCTURE_TYPE_DEVICE_CREATE_INFO,
       .queueCreateInfoCount = 1,
       .pQueueCreateInfos = &queue_create_info,
-      .enabledExtensionCount = 1,
+      .enabledExtensionCount = device_extension_count,
       .ppEnabledExtensionNames = device_extensions,
       .pEnabledFeatures = &device_features,
   };
@@ -479,20 +675,21 @@ static void init_gpu_timer_support(StygianAP *ap) {
   vkGetPhysicalDeviceProperties(ap->physical_device, &props);
   ap->gpu_timestamp_period_ns = props.limits.timestampPeriod;
 
-  if (!props.limits.timestampComputeAndGraphics ||
-      ap->graphics_timestamp_valid_bits == 0 ||
+  // The graphics queue's valid bits are what count; the
+  // timestampComputeAndGraphics limit only promises it for every queue.
+  if (ap->graphics_timestamp_valid_bits == 0 ||
       ap->gpu_timestamp_period_ns <= 0.0f) {
     printf("[Stygian AP VK] GPU timer unavailable "
-           "(timestampComputeAndGraphics=%u, validBits=%u)\n",
-           props.limits.timestampComputeAndGraphics ? 1u : 0u,
-           ap->graphics_timestamp_valid_bits);
+           "(validBits=%u, timestampPeriod=%.3f)\n",
+           ap->graphics_timestamp_valid_bits, ap->gpu_timestamp_period_ns);
     return;
   }
 
   memset(&query_pool_info, 0, sizeof(query_pool_info));
   query_pool_info.sType = VK_STRUCTURE_TYPE_QUERY_POOL_CREATE_INFO;
   query_pool_info.queryType = VK_QUERY_TYPE_TIMESTAMP;
-  query_pool_info.queryCount = STYGIAN_VK_FRAMES_IN_FLIGHT * 2u;
+  query_pool_info.queryCount =
+      STYGIAN_VK_FRAMES_IN_FLIGHT * STYGIAN_VK_GPU_QUERIES;
 
   if (vkCreateQueryPool(ap->device, &query_pool_info, NULL,
                         &ap->gpu_timer_query_pool) != VK_SUCCESS) {
@@ -504,31 +701,48 @@ static void init_gpu_timer_support(StygianAP *ap) {
   ap->gpu_timer_supported = true;
 }
 
+// Called after the frame's fence has been waited on, so its timestamps are
+// available and reading them never blocks.
 static void update_gpu_timer_sample_for_frame(StygianAP *ap,
                                               uint32_t frame_slot) {
-  uint64_t timestamps[2];
-  uint64_t delta;
-  uint32_t query_base;
+  StygianVKFrameResources *fr = &ap->frames[frame_slot];
+  uint64_t timestamps[STYGIAN_VK_GPU_QUERIES];
+  uint64_t mask;
+  double ns_to_ms;
+  uint32_t count, phase_count = 0u;
   VkResult result;
 
   if (!ap || !ap->gpu_timer_supported || !ap->gpu_timer_query_pool)
     return;
+  count = fr->gpu_query_count;
+  fr->gpu_query_count = 0u;
+  if (count < 2u)
+    return; // Not timed (or never submitted): keep the previous sample
 
-  query_base = frame_slot * 2u;
-  timestamps[0] = 0u;
-  timestamps[1] = 0u;
-  // Non-blocking read: if timestamps are not ready yet, keep previous sample.
   result = vkGetQueryPoolResults(
-      ap->device, ap->gpu_timer_query_pool, query_base, 2u, sizeof(timestamps),
+      ap->device, ap->gpu_timer_query_pool,
+      frame_slot * STYGIAN_VK_GPU_QUERIES, count, sizeof(timestamps),
       timestamps, sizeof(uint64_t), VK_QUERY_RESULT_64_BIT);
   if (result != VK_SUCCESS)
     return;
-  if (timestamps[1] <= timestamps[0])
-    return;
 
-  delta = timestamps[1] - timestamps[0];
-  ap->last_gpu_ms = (float)(((double)delta * (double)ap->gpu_timestamp_period_ns) /
-                            1000000.0);
+  // Counters wrap at validBits; differences taken modulo that width.
+  mask = ap->graphics_timestamp_valid_bits >= 64u
+             ? UINT64_MAX
+             : ((uint64_t)1u << ap->graphics_timestamp_valid_bits) - 1u;
+  ns_to_ms = (double)ap->gpu_timestamp_period_ns / 1000000.0;
+  memset(ap->last_gpu_phase_ms, 0, sizeof(ap->last_gpu_phase_ms));
+  for (uint32_t i = 0; i + 1u < count; i++) {
+    uint32_t phase = fr->gpu_query_phase[i];
+    uint64_t delta = (timestamps[i + 1u] - timestamps[i]) & mask;
+    ap->last_gpu_phase_ms[phase] += (float)((double)delta * ns_to_ms);
+    if (phase + 1u > phase_count)
+      phase_count = phase + 1u;
+  }
+  ap->last_gpu_phase_count = phase_count;
+  ap->last_gpu_ms =
+      (float)((double)((timestamps[count - 1u] - timestamps[0]) & mask) *
+              ns_to_ms);
 }
 
 static bool create_surface(StygianAP *ap) {
@@ -631,7 +845,8 @@ static bool create_swapchain(StygianAP *ap, int width, int height,
       .preTransform = capabilities.currentTransform,
       .compositeAlpha = VK_COMPOSITE_ALPHA_OPAQUE_BIT_KHR,
       .presentMode = present_mode,
-      .clipped = VK_TRUE,
+      // Partial redraw reads back the previous contents of each image.
+      .clipped = ap->damage_enabled ? VK_FALSE : VK_TRUE,
       .oldSwapchain = old_swapchain,
   };
 
@@ -696,15 +911,19 @@ static bool create_image_views(StygianAP *ap) {
   return true;
 }
 
-static bool create_render_pass(StygianAP *ap) {
+// Clearing pass, or with `load` the compatible pass that keeps the image's
+// presented contents for partial redraw.
+static bool create_color_render_pass(StygianAP *ap, bool load,
+                                     VkRenderPass *out) {
   VkAttachmentDescription color_attachment = {
       .format = ap->swapchain_format,
       .samples = VK_SAMPLE_COUNT_1_BIT,
-      .loadOp = VK_ATTACHMENT_LOAD_OP_CLEAR,
+      .loadOp = load ? VK_ATTACHMENT_LOAD_OP_LOAD : VK_ATTACHMENT_LOAD_OP_CLEAR,
       .storeOp = VK_ATTACHMENT_STORE_OP_STORE,
       .stencilLoadOp = VK_ATTACHMENT_LOAD_OP_DONT_CARE,
       .stencilStoreOp = VK_ATTACHMENT_STORE_OP_DONT_CARE,
-      .initialLayout = VK_IMAGE_LAYOUT_UNDEFINED,
+      .initialLayout = load ? VK_IMAGE_LAYOUT_PRESENT_SRC_KHR
+                            : VK_IMAGE_LAYOUT_UNDEFINED,
       .finalLayout = VK_IMAGE_LAYOUT_PRESENT_SRC_KHR,
   };
 
@@ -725,7 +944,8 @@ static bool create_render_pass(StygianAP *ap) {
       .srcStageMask = VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT,
       .srcAccessMask = 0,
       .dstStageMask = VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT,
-      .dstAccessMask = VK_ACCESS_COLOR_ATTACHMENT_WRITE_BIT,
+      .dstAccessMask = VK_ACCESS_COLOR_ATTACHMENT_WRITE_BIT |
+                       (load ? VK_ACCESS_COLOR_ATTACHMENT_READ_BIT : 0),
   };
 
   VkRenderPassCreateInfo render_pass_info = {
@@ -739,12 +959,17 @@ static bool create_render_pass(StygianAP *ap) {
   };
 
   VkResult result =
-      vkCreateRenderPass(ap->device, &render_pass_info, NULL, &ap->render_pass);
+      vkCreateRenderPass(ap->device, &render_pass_info, NULL, out);
   if (result != VK_SUCCESS) {
     printf("[Stygian AP VK] Failed to create render pass: %d\n", result);
     return false;
   }
+  return true;
+}
 
+static bool create_render_pass(StygianAP *ap) {
+  if (!create_color_render_pass(ap, false, &ap->render_pass))
+    return false;
   printf("[Stygian AP VK] Render pass created\n");
   return true;
 }
@@ -836,6 +1061,7 @@ static bool recreate_main_swapchain(StygianAP *ap, int width, int height) {
 
   for (uint32_t i = 0; i < STYGIAN_VK_MAX_SWAPCHAIN_IMAGES; ++i) {
     ap->image_in_flight[i] = VK_NULL_HANDLE;
+    ap->image_serial[i] = 0u; // New images hold nothing worth keeping
   }
 
   if (old_swapchain) {
@@ -879,6 +1105,17 @@ static bool create_command_pool(StygianAP *ap) {
     return false;
   }
 
+  // One texture-upload command buffer per frame in flight
+  VkCommandBuffer upload_cmds[STYGIAN_VK_FRAMES_IN_FLIGHT];
+  result = vkAllocateCommandBuffers(ap->device, &alloc_info, upload_cmds);
+  if (result != VK_SUCCESS) {
+    printf("[Stygian AP VK] Failed to allocate upload command buffers: %d\n",
+           result);
+    return false;
+  }
+  for (uint32_t f = 0; f < STYGIAN_VK_FRAMES_IN_FLIGHT; f++)
+    ap->frames[f].upload_cmd = upload_cmds[f];
+
   printf("[Stygian AP VK] Command pool and buffers created\n");
   return true;
 }
@@ -910,89 +1147,131 @@ static bool create_sync_objects(StygianAP *ap) {
   return true;
 }
 
-static bool create_buffers(StygianAP *ap) {
+// Host-visible, host-coherent buffer, mapped until destroyed.
+static bool create_mapped_buffer(StygianAP *ap, VkDeviceSize size,
+                                 VkBufferUsageFlags usage, VkBuffer *out_buf,
+                                 VkDeviceMemory *out_mem, void **out_mapped,
+                                 const char *name) {
   VkMemoryRequirements mem_requirements;
   VkBufferCreateInfo buffer_info = {
       .sType = VK_STRUCTURE_TYPE_BUFFER_CREATE_INFO,
-      .usage = VK_BUFFER_USAGE_STORAGE_BUFFER_BIT,
+      .size = size,
+      .usage = usage,
       .sharingMode = VK_SHARING_MODE_EXCLUSIVE,
   };
   VkMemoryAllocateInfo alloc_info = {
       .sType = VK_STRUCTURE_TYPE_MEMORY_ALLOCATE_INFO,
   };
 
-  // Create clip SSBO (vec4 clip rects)
-  VkDeviceSize clip_size = STYGIAN_MAX_CLIPS * sizeof(float) * 4;
-  buffer_info.size = clip_size;
-  buffer_info.usage = VK_BUFFER_USAGE_STORAGE_BUFFER_BIT;
-
-  if (vkCreateBuffer(ap->device, &buffer_info, NULL, &ap->clip_ssbo) !=
-      VK_SUCCESS) {
-    printf("[Stygian AP VK] Failed to create clip SSBO\n");
+  if (vkCreateBuffer(ap->device, &buffer_info, NULL, out_buf) != VK_SUCCESS) {
+    printf("[Stygian AP VK] Failed to create %s buffer\n", name);
     return false;
   }
-
-  vkGetBufferMemoryRequirements(ap->device, ap->clip_ssbo, &mem_requirements);
+  vkGetBufferMemoryRequirements(ap->device, *out_buf, &mem_requirements);
   alloc_info.allocationSize = mem_requirements.size;
   alloc_info.memoryTypeIndex =
       find_memory_type(ap->physical_device, mem_requirements.memoryTypeBits,
                        VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT |
                            VK_MEMORY_PROPERTY_HOST_COHERENT_BIT);
-  if (vkAllocateMemory(ap->device, &alloc_info, NULL, &ap->clip_ssbo_memory) !=
+  if (vkAllocateMemory(ap->device, &alloc_info, NULL, out_mem) !=
       VK_SUCCESS) {
-    printf("[Stygian AP VK] Failed to allocate clip SSBO memory\n");
+    printf("[Stygian AP VK] Failed to allocate %s memory\n", name);
     return false;
   }
-  vkBindBufferMemory(ap->device, ap->clip_ssbo, ap->clip_ssbo_memory, 0);
-
-  // Create SoA SSBOs (hot=binding 4, appearance=binding 5, effects=binding 6)
-  struct {
-    VkBuffer *buf;
-    VkDeviceMemory *mem;
-    VkDeviceSize size;
-    const char *name;
-  } soa_bufs[3] = {
-      {&ap->soa_hot_buf, &ap->soa_hot_mem,
-       ap->max_elements * sizeof(StygianSoAHot), "hot"},
-      {&ap->soa_appearance_buf, &ap->soa_appearance_mem,
-       ap->max_elements * sizeof(StygianSoAAppearance), "appearance"},
-      {&ap->soa_effects_buf, &ap->soa_effects_mem,
-       ap->max_elements * sizeof(StygianSoAEffects), "effects"},
-  };
-
-  for (int si = 0; si < 3; si++) {
-    buffer_info.size = soa_bufs[si].size;
-    buffer_info.usage = VK_BUFFER_USAGE_STORAGE_BUFFER_BIT;
-
-    if (vkCreateBuffer(ap->device, &buffer_info, NULL, soa_bufs[si].buf) !=
-        VK_SUCCESS) {
-      printf("[Stygian AP VK] Failed to create SoA %s SSBO\n",
-             soa_bufs[si].name);
-      return false;
+  vkBindBufferMemory(ap->device, *out_buf, *out_mem, 0);
+  if (vkMapMemory(ap->device, *out_mem, 0, VK_WHOLE_SIZE, 0, out_mapped) !=
+      VK_SUCCESS) {
+    printf("[Stygian AP VK] Failed to map %s memory\n", name);
+    *out_mapped = NULL;
+    return false;
+  }
+  // Elements never marked dirty must still read as zero on every copy.
+  memset(*out_mapped, 0, (size_t)size);
+  return true;
+}
+
+// Safe on partially created frames; freeing memory also unmaps it.
+static void destroy_frame_resources(StygianAP *ap) {
+  for (uint32_t f = 0; f < STYGIAN_VK_FRAMES_IN_FLIGHT; f++) {
+    StygianVKFrameResources *fr = &ap->frames[f];
+    for (uint32_t b = 0; b < STYGIAN_VK_SOA_BUFFERS; b++) {
+      if (fr->soa_buf[b])
+        vkDestroyBuffer(ap->device, fr->soa_buf[b], NULL);
+      if (fr->soa_mem[b])
+        vkFreeMemory(ap->device, fr->soa_mem[b], NULL);
+      ap_free(ap, fr->soa_pending[b]);
+      fr->soa_buf[b] = VK_NULL_HANDLE;
+      fr->soa_mem[b] = VK_NULL_HANDLE;
+      fr->soa_mapped[b] = NULL;
+      fr->soa_pending[b] = NULL;
     }
+    if (fr->clip_buf)
+      vkDestroyBuffer(ap->device, fr->clip_buf, NULL);
+    if (fr->clip_mem)
+      vkFreeMemory(ap->device, fr->clip_mem, NULL);
+    fr->clip_buf = VK_NULL_HANDLE;
+    fr->clip_mem = VK_NULL_HANDLE;
+    fr->clip_mapped = NULL;
+    if (fr->indirect_buf)
+      vkDestroyBuffer(ap->device, fr->indirect_buf, NULL);
+    if (fr->indirect_mem)
+      vkFreeMemory(ap->device, fr->indirect_mem, NULL);
+    fr->indirect_buf = VK_NULL_HANDLE;
+    fr->indirect_mem = VK_NULL_HANDLE;
+    fr->indirect_mapped = NULL;
+    fr->descriptor_set = VK_NULL_HANDLE; // Freed with the pool
+  }
+}
+
+static bool create_buffers(StygianAP *ap) {
+  VkMemoryRequirements mem_requirements;
+  VkBufferCreateInfo buffer_info = {
+      .sType = VK_STRUCTURE_TYPE_BUFFER_CREATE_INFO,
+      .usage = VK_BUFFER_USAGE_STORAGE_BUFFER_BIT,
+      .sharingMode = VK_SHARING_MODE_EXCLUSIVE,
+  };
+  VkMemoryAllocateInfo alloc_info = {
+      .sType = VK_STRUCTURE_TYPE_MEMORY_ALLOCATE_INFO,
+  };
+
+  // Clip SSBO (vec4 clip rects) and SoA SSBOs (hot=binding 4,
+  // appearance=binding 5, effects=binding 6), one set per frame in flight
+  VkDeviceSize clip_size = (VkDeviceSize)ap->max_clips * sizeof(float) * 4;
+  const VkDeviceSize soa_sizes[STYGIAN_VK_SOA_BUFFERS] = {
+      ap->max_elements * sizeof(StygianSoAHot),
+      ap->max_elements * sizeof(StygianSoAAppearance),
+      ap->max_elements * sizeof(StygianSoAEffects),
+  };
+  static const char *soa_names[STYGIAN_VK_SOA_BUFFERS] = {
+      "SoA hot", "SoA appearance", "SoA effects"};
 
-    vkGetBufferMemoryRequirements(ap->device, *soa_bufs[si].buf,
-                                  &mem_requirements);
-    alloc_info.allocationSize = mem_requirements.size;
-    alloc_info.memoryTypeIndex =
-        find_memory_type(ap->physical_device, mem_requirements.memoryTypeBits,
-                         VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT |
-                             VK_MEMORY_PROPERTY_HOST_COHERENT_BIT);
-
-    if (vkAllocateMemory(ap->device, &alloc_info, NULL, soa_bufs[si].mem) !=
-        VK_SUCCESS) {
-      printf("[Stygian AP VK] Failed to allocate SoA %s memory\n",
-             soa_bufs[si].name);
+  for (uint32_t f = 0; f < STYGIAN_VK_FRAMES_IN_FLIGHT; f++) {
+    StygianVKFrameResources *fr = &ap->frames[f];
+    if (!create_mapped_buffer(ap, clip_size, VK_BUFFER_USAGE_STORAGE_BUFFER_BIT,
+                              &fr->clip_buf, &fr->clip_mem, &fr->clip_mapped,
+                              "clip"))
       return false;
+    fr->clip_valid = 0u;
+    for (uint32_t b = 0; b < STYGIAN_VK_SOA_BUFFERS; b++) {
+      if (!create_mapped_buffer(ap, soa_sizes[b],
+                                VK_BUFFER_USAGE_STORAGE_BUFFER_BIT,
+                                &fr->soa_buf[b], &fr->soa_mem[b],
+                                &fr->soa_mapped[b], soa_names[b]))
+        return false;
     }
-
-    vkBindBufferMemory(ap->device, *soa_bufs[si].buf, *soa_bufs[si].mem, 0);
+    if (ap->multi_draw_indirect &&
+        !create_mapped_buffer(
+            ap, STYGIAN_VK_MAX_DRAW_BATCH * sizeof(VkDrawIndirectCommand),
+            VK_BUFFER_USAGE_INDIRECT_BUFFER_BIT, &fr->indirect_buf,
+            &fr->indirect_mem, (void **)&fr->indirect_mapped, "indirect"))
+      return false;
   }
+  ap->upload_frame = 0u;
 
   printf("[Stygian AP VK] SoA SSBOs created (hot: %zu, appearance: %zu, "
-         "effects: %zu bytes)\n",
-         (size_t)soa_bufs[0].size, (size_t)soa_bufs[1].size,
-         (size_t)soa_bufs[2].size);
+         "effects: %zu bytes, x%d frames in flight)\n",
+         (size_t)soa_sizes[0], (size_t)soa_sizes[1], (size_t)soa_sizes[2],
+         STYGIAN_VK_FRAMES_IN_FLIGHT);
 
   // Create vertex buffer (quad: 6 vertices)
   float quad_vertices[] = {
@@ -1036,8 +1315,8 @@ static bool create_buffers(StygianAP *ap) {
 
   printf("[Stygian AP VK] Buffers created (SoA hot/app/fx: %zu/%zu/%zu, "
          "Clip: %zu, VB: %zu bytes)\n",
-         (size_t)soa_bufs[0].size, (size_t)soa_bufs[1].size,
-         (size_t)soa_bufs[2].size, (size_t)clip_size, (size_t)vb_size);
+         (size_t)soa_sizes[0], (size_t)soa_sizes[1], (size_t)soa_sizes[2],
+         (size_t)clip_size, (size_t)vb_size);
   return true;
 }
 
@@ -1099,18 +1378,21 @@ static bool create_descriptor_sets(StygianAP *ap) {
     return false;
   }
 
-  // Descriptor pool (4 storage buffers: clip + hot + appearance + effects)
+  // Descriptor pool: per frame, 4 storage buffers (clip + hot + appearance +
+  // effects) and the font + image samplers
   VkDescriptorPoolSize pool_sizes[2] = {
-      {.type = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, .descriptorCount = 4},
+      {.type = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER,
+       .descriptorCount = 4 * STYGIAN_VK_FRAMES_IN_FLIGHT},
       {.type = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER,
-       .descriptorCount = 1 + STYGIAN_VK_IMAGE_SAMPLERS},
+       .descriptorCount =
+           (1 + STYGIAN_VK_IMAGE_SAMPLERS) * STYGIAN_VK_FRAMES_IN_FLIGHT},
   };
 
   VkDescriptorPoolCreateInfo pool_info = {
       .sType = VK_STRUCTURE_TYPE_DESCRIPTOR_POOL_CREATE_INFO,
       .poolSizeCount = 2,
       .pPoolSizes = pool_sizes,
-      .maxSets = 1,
+      .maxSets = STYGIAN_VK_FRAMES_IN_FLIGHT,
   };
 
   if (vkCreateDescriptorPool(ap->device, &pool_info, NULL,
@@ -1119,84 +1401,52 @@ static bool create_descriptor_sets(StygianAP *ap) {
     return false;
   }
 
-  // Allocate descriptor set
+  // One descriptor set per frame in flight, each naming that frame's buffers
+  VkDescriptorSetLayout set_layouts[STYGIAN_VK_FRAMES_IN_FLIGHT];
+  VkDescriptorSet sets[STYGIAN_VK_FRAMES_IN_FLIGHT];
+  for (uint32_t f = 0; f < STYGIAN_VK_FRAMES_IN_FLIGHT; f++)
+    set_layouts[f] = ap->descriptor_layout;
   VkDescriptorSetAllocateInfo alloc_info = {
       .sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_ALLOCATE_INFO,
       .descriptorPool = ap->descriptor_pool,
-      .descriptorSetCount = 1,
-      .pSetLayouts = &ap->descriptor_layout,
+      .descriptorSetCount = STYGIAN_VK_FRAMES_IN_FLIGHT,
+      .pSetLayouts = set_layouts,
   };
 
-  if (vkAllocateDescriptorSets(ap->device, &alloc_info, &ap->descriptor_set) !=
-      VK_SUCCESS) {
-    printf("[Stygian AP VK] Failed to allocate descriptor set\n");
+  if (vkAllocateDescriptorSets(ap->device, &alloc_info, sets) != VK_SUCCESS) {
+    printf("[Stygian AP VK] Failed to allocate descriptor sets\n");
     return false;
   }
 
-  // Update descriptor set: clip + SoA hot/appearance/effects
-  VkDescriptorBufferInfo clip_buffer_info = {
-      .buffer = ap->clip_ssbo,
-      .offset = 0,
-      .range = VK_WHOLE_SIZE,
-  };
-  VkDescriptorBufferInfo soa_hot_info = {
-      .buffer = ap->soa_hot_buf,
-      .offset = 0,
-      .range = VK_WHOLE_SIZE,
-  };
-  VkDescriptorBufferInfo soa_appearance_info = {
-      .buffer = ap->soa_appearance_buf,
-      .offset = 0,
-      .range = VK_WHOLE_SIZE,
-  };
-  VkDescriptorBufferInfo soa_effects_info = {
-      .buffer = ap->soa_effects_buf,
-      .offset = 0,
-      .range = VK_WHOLE_SIZE,
-  };
+  for (uint32_t f = 0; f < STYGIAN_VK_FRAMES_IN_FLIGHT; f++) {
+    StygianVKFrameResources *fr = &ap->frames[f];
+    VkDescriptorBufferInfo buffer_infos[4] = {
+        {.buffer = fr->clip_buf, .offset = 0, .range = VK_WHOLE_SIZE},
+        {.buffer = fr->soa_buf[0], .offset = 0, .range = VK_WHOLE_SIZE},
+        {.buffer = fr->soa_buf[1], .offset = 0, .range = VK_WHOLE_SIZE},
+        {.buffer = fr->soa_buf[2], .offset = 0, .range = VK_WHOLE_SIZE},
+    };
+    VkWriteDescriptorSet descriptor_writes[4];
 
-  VkWriteDescriptorSet descriptor_writes[4] = {
-      {
+    fr->descriptor_set = sets[f];
+    // Bindings 3..6: clip, SoA hot, SoA appearance, SoA effects
+    for (uint32_t w = 0; w < 4; w++) {
+      descriptor_writes[w] = (VkWriteDescriptorSet){
           .sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET,
-          .dstSet = ap->descriptor_set,
-          .dstBinding = 3,
+          .dstSet = fr->descriptor_set,
+          .dstBinding = 3 + w,
           .dstArrayElement = 0,
           .descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER,
           .descriptorCount = 1,
-          .pBufferInfo = &clip_buffer_info,
-      },
-      {
-          .sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET,
-          .dstSet = ap->descriptor_set,
-          .dstBinding = 4,
-          .dstArrayElement = 0,
-          .descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER,
-          .descriptorCount = 1,
-          .pBufferInfo = &soa_hot_info,
-      },
-      {
-          .sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET,
-          .dstSet = ap->descriptor_set,
-          .dstBinding = 5,
-          .dstArrayElement = 0,
-          .descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER,
-          .descriptorCount = 1,
-          .pBufferInfo = &soa_appearance_info,
-      },
-      {
-          .sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET,
-          .dstSet = ap->descriptor_set,
-          .dstBinding = 6,
-          .dstArrayElement = 0,
-          .descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER,
-          .descriptorCount = 1,
-          .pBufferInfo = &soa_effects_info,
-      },
-  };
-
-  vkUpdateDescriptorSets(ap->device, 4, descriptor_writes, 0, NULL);
+          .pBufferInfo = &buffer_infos[w],
+      };
+    }
+    vkUpdateDescriptorSets(ap->device, 4, descriptor_writes, 0, NULL);
+  }
 
-  printf("[Stygian AP VK] Descriptor sets created (6 bindings, SoA-only)\n");
+  printf("[Stygian AP VK] Descriptor sets created (6 bindings, SoA-only, "
+         "x%d frames in flight)\n",
+         STYGIAN_VK_FRAMES_IN_FLIGHT);
   return true;
 }
 
@@ -1378,6 +1628,366 @@ static bool load_shaders_and_create_pipeline(StygianAP *ap) {
 // Lifecycle
 // ============================================================================
 
+// ============================================================================
+// Texture Memory & Uploads
+// ============================================================================
+//
+// Pixels are copied into one persistently mapped staging ring and the copy is
+// recorded into the current frame's upload command buffer, which end_frame
+// submits ahead of the frame's draws in the same batch. Creating or updating
+// a texture therefore never waits on the queue. Ring space, and textures
+// destroyed while a frame in flight may still sample them, are released by
+// submission serial once the frame fence that covers them has been waited on.
+
+// Release an image and its memory range. Shared blocks stay allocated for
+// reuse until the AP is destroyed; dedicated ones are freed with their image.
+static void vk_texture_release(StygianAP *ap, StygianVKTexture *tex) {
+  StygianVKMemoryBlock *block;
+  if (tex->view)
+    vkDestroyImageView(ap->device, tex->view, NULL);
+  if (tex->image)
+    vkDestroyImage(ap->device, tex->image, NULL);
+  if (tex->size > 0u && tex->block < STYGIAN_VK_MAX_MEMORY_BLOCKS) {
+    block = &ap->memory_blocks[tex->block];
+    if (block->ranges) {
+      stygian_range_alloc_free(block->ranges, tex->offset, tex->size);
+    } else if (block->memory) {
+      vkFreeMemory(ap->device, block->memory, NULL);
+      block->memory = VK_NULL_HANDLE;
+    }
+  }
+  memset(tex, 0, sizeof(*tex));
+}
+
+static void vk_retired_release(StygianAP *ap, StygianVKRetired *r) {
+  vk_texture_release(ap, &r->texture);
+  if (r->buffer)
+    vkDestroyBuffer(ap->device, r->buffer, NULL);
+  if (r->buffer_memory)
+    vkFreeMemory(ap->device, r->buffer_memory, NULL);
+}
+
+// Queue storage for release after the submission now being recorded (or the
+// next one, between frames) has completed.
+static void vk_retire(StygianAP *ap, const StygianVKRetired *item) {
+  if (ap->retired_count == ap->retired_capacity) {
+    uint32_t next = ap->retired_capacity ? ap->retired_capacity * 2u : 32u;
+    StygianVKRetired *grown = (StygianVKRetired *)ap_alloc(
+        ap, next * sizeof(StygianVKRetired), _Alignof(StygianVKRetired));
+    if (!grown) {
+      // Nowhere to park it: wait for the GPU and release now.
+      StygianVKRetired now = *item;
+      vkDeviceWaitIdle(ap->device);
+      vk_retired_release(ap, &now);
+      return;
+    }
+    if (ap->retired_count > 0u)
+      memcpy(grown, ap->retired, ap->retired_count * sizeof(StygianVKRetired));
+    ap_free(ap, ap->retired);
+    ap->retired = grown;
+    ap->retired_capacity = next;
+  }
+  ap->retired[ap->retired_count] = *item;
+  ap->retired[ap->retired_count].serial = ap->submit_serial + 1u;
+  ap->retired_count++;
+}
+
+// Called once the frame's fence has signalled: everything its last
+// submission staged or kept alive can be reused.
+static void vk_retire_frame(StygianAP *ap, uint32_t frame) {
+  StygianVKFrameResources *fr = &ap->frames[frame];
+  uint32_t kept = 0u;
+  if (fr->serial <= ap->completed_serial)
+    return;
+  ap->completed_serial = fr->serial;
+  if (fr->staging_end > ap->staging_tail)
+    ap->staging_tail = fr->staging_end;
+  for (uint32_t i = 0; i < ap->retired_count; i++) {
+    if (ap->retired[i].serial <= ap->completed_serial)
+      vk_retired_release(ap, &ap->retired[i]);
+    else
+      ap->retired[kept++] = ap->retired[i];
+  }
+  ap->retired_count = kept;
+}
+
+// Retire, oldest first, the frames whose fences have already signalled.
+static void vk_retire_finished_frames(StygianAP *ap) {
+  for (uint32_t k = 1; k <= STYGIAN_VK_FRAMES_IN_FLIGHT; k++) {
+    uint32_t f = (ap->current_frame + k) % STYGIAN_VK_FRAMES_IN_FLIGHT;
+    if (ap->frames[f].serial <= ap->completed_serial)
+      continue;
+    if (vkGetFenceStatus(ap->device, ap->in_flight[f]) != VK_SUCCESS)
+      break;
+    vk_retire_frame(ap, f);
+  }
+}
+
+static bool vk_staging_ring_ensure(StygianAP *ap) {
+  VkPhysicalDeviceProperties props;
+  void *mapped = NULL;
+  if (ap->staging_mapped)
+    return true;
+  if (!create_mapped_buffer(ap, STYGIAN_VK_STAGING_RING_SIZE,
+                            VK_BUFFER_USAGE_TRANSFER_SRC_BIT, &ap->staging_buf,
+                            &ap->staging_mem, &mapped, "staging ring")) {
+    if (ap->staging_buf)
+      vkDestroyBuffer(ap->device, ap->staging_buf, NULL);
+    if (ap->staging_mem)
+      vkFreeMemory(ap->device, ap->staging_mem, NULL);
+    ap->staging_buf = VK_NULL_HANDLE;
+    ap->staging_mem = VK_NULL_HANDLE;
+    return false;
+  }
+  ap->staging_mapped = (uint8_t *)mapped;
+  // Copy offsets must be texel aligned (4 bytes for RGBA8); follow the
+  // driver's preferred alignment when it is a larger power of two.
+  vkGetPhysicalDeviceProperties(ap->physical_device, &props);
+  ap->staging_align = 16u;
+  if (props.limits.optimalBufferCopyOffsetAlignment > ap->staging_align &&
+      props.limits.optimalBufferCopyOffsetAlignment <= 4096u &&
+      (props.limits.optimalBufferCopyOffsetAlignment &
+       (props.limits.optimalBufferCopyOffsetAlignment - 1u)) == 0u)
+    ap->staging_align = props.limits.optimalBufferCopyOffsetAlignment;
+  return true;
+}
+
+// Reserve bytes of contiguous ring space; an allocation never wraps, the
+// tail of the ring is skipped instead. False when in-flight uploads still
+// hold the space.
+static bool vk_staging_alloc(StygianAP *ap, VkDeviceSize bytes,
+                             VkDeviceSize *out_offset) {
+  const uint64_t size = STYGIAN_VK_STAGING_RING_SIZE;
+  uint64_t head, offset;
+  if (!vk_staging_ring_ensure(ap) || bytes > size)
+    return false;
+  head = (ap->staging_head + ap->staging_align - 1u) &
+         ~((uint64_t)ap->staging_align - 1u);
+  offset = head % size;
+  if (offset + bytes > size) {
+    head += size - offset;
+    offset = 0u;
+  }
+  if (head + bytes - ap->staging_tail > size)
+    return false;
+  ap->staging_head = head + bytes;
+  *out_offset = offset;
+  return true;
+}
+
+// Bind device-local memory to a new image: a range of a shared block, or a
+// dedicated allocation when the image would take over a quarter of a block.
+static bool vk_image_memory_bind(StygianAP *ap, StygianVKTexture *tex) {
+  VkMemoryRequirements reqs;
+  uint32_t type_index, free_slot = STYGIAN_VK_MAX_MEMORY_BLOCKS;
+  bool dedicated;
+  uint64_t offset = 0u;
+
+  vkGetImageMemoryRequirements(ap->device, tex->image, &reqs);
+  type_index = find_memory_type(ap->physical_device, reqs.memoryTypeBits,
+                                VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT);
+  if (type_index == UINT32_MAX)
+    return false;
+  dedicated = reqs.size > STYGIAN_VK_IMAGE_BLOCK_SIZE / 4u;
+
+  for (uint32_t b = 0; b < STYGIAN_VK_MAX_MEMORY_BLOCKS; b++) {
+    StygianVKMemoryBlock *block = &ap->memory_blocks[b];
+    if (!block->memory) {
+      if (free_slot == STYGIAN_VK_MAX_MEMORY_BLOCKS)
+        free_slot = b;
+      continue;
+    }
+    if (dedicated || !block->ranges || block->type_index != type_index)
+      continue;
+    if (stygian_range_alloc_alloc(block->ranges, reqs.size, reqs.alignment,
+                                  &offset)) {
+      tex->block = b;
+      tex->offset = offset;
+      tex->size = reqs.size;
+      vkBindImageMemory(ap->device, tex->image, block->memory, offset);
+      return true;
+    }
+  }
+  if (free_slot == STYGIAN_VK_MAX_MEMORY_BLOCKS) {
+    printf("[Stygian AP VK] Out of texture memory blocks\n");
+    return false;
+  }
+
+  StygianVKMemoryBlock *block = &ap->memory_blocks[free_slot];
+  VkMemoryAllocateInfo alloc_info = {
+      .sType = VK_STRUCTURE_TYPE_MEMORY_ALLOCATE_INFO,
+      .allocationSize = dedicated ? reqs.size : STYGIAN_VK_IMAGE_BLOCK_SIZE,
+      .memoryTypeIndex = type_index,
+  };
+  if (!dedicated) {
+    block->ranges = stygian_range_alloc_create(STYGIAN_VK_IMAGE_BLOCK_SIZE);
+    if (!block->ranges ||
+        !stygian_range_alloc_alloc(block->ranges, reqs.size, reqs.alignment,
+                                   &offset)) {
+      stygian_range_alloc_destroy(block->ranges);
+      block->ranges = NULL;
+      return false;
+    }
+  }
+  if (vkAllocateMemory(ap->device, &alloc_info, NULL, &block->memory) !=
+      VK_SUCCESS) {
+    stygian_range_alloc_destroy(block->ranges);
+    block->ranges = NULL;
+    block->memory = VK_NULL_HANDLE;
+    printf("[Stygian AP VK] Failed to allocate texture memory\n");
+    return false;
+  }
+  block->type_index = type_index;
+  tex->block = free_slot;
+  tex->offset = offset;
+  tex->size = reqs.size;
+  vkBindImageMemory(ap->device, tex->image, block->memory, offset);
+  return true;
+}
+
+// Upload commands for the current frame, opened on first use. Between frames
+// the frame's previous submission may still be pending; waiting for it here
+// is the wait begin_frame would do next anyway.
+static VkCommandBuffer vk_upload_commands(StygianAP *ap) {
+  StygianVKFrameResources *fr = &ap->frames[ap->current_frame];
+  if (fr->upload_open)
+    return fr->upload_cmd;
+  if (fr->serial > ap->completed_serial) {
+    vkWaitForFences(ap->device, 1, &ap->in_flight[ap->current_frame], VK_TRUE,
+                    UINT64_MAX);
+    vk_retire_frame(ap, ap->current_frame);
+  }
+
+  VkCommandBufferBeginInfo begin_info = {
+      .sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO,
+      .flags = VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT,
+  };
+  vkResetCommandBuffer(fr->upload_cmd, 0);
+  if (vkBeginCommandBuffer(fr->upload_cmd, &begin_info) != VK_SUCCESS)
+    return VK_NULL_HANDLE;
+  fr->upload_open = true;
+  return fr->upload_cmd;
+}
+
+// Stage a w x h RGBA8 region and record its copy into tex. A fresh image is
+// transitioned from UNDEFINED (nothing to keep); otherwise the copy waits
+// for earlier shader reads and copies of the image.
+static bool vk_texture_upload(StygianAP *ap, StygianVKTexture *tex, int x,
+                              int y, int w, int h, const void *rgba,
+                              bool fresh) {
+  VkDeviceSize bytes = (VkDeviceSize)w * (VkDeviceSize)h * 4u;
+  VkDeviceSize offset = 0u;
+  VkBuffer src = VK_NULL_HANDLE;
+  VkCommandBuffer cmd = vk_upload_commands(ap);
+  if (!cmd)
+    return false;
+
+  if (!vk_staging_alloc(ap, bytes, &offset)) {
+    vk_retire_finished_frames(ap);
+    if (vk_staging_alloc(ap, bytes, &offset))
+      src = ap->staging_buf;
+  } else {
+    src = ap->staging_buf;
+  }
+  if (src) {
+    memcpy(ap->staging_mapped + offset, rgba, (size_t)bytes);
+  } else {
+    // Ring exhausted (or the upload is larger than the ring): stage through
+    // a one-off buffer released with this frame rather than waiting.
+    StygianVKRetired overflow;
+    void *mapped = NULL;
+    memset(&overflow, 0, sizeof(overflow));
+    if (!create_mapped_buffer(ap, bytes, VK_BUFFER_USAGE_TRANSFER_SRC_BIT,
+                              &overflow.buffer, &overflow.buffer_memory,
+                              &mapped, "overflow staging")) {
+      vk_retired_release(ap, &overflow);
+      return false;
+    }
+    memcpy(mapped, rgba, (size_t)bytes);
+    vk_retire(ap, &overflow);
+    src = overflow.buffer;
+    offset = 0u;
+  }
+
+  VkImageMemoryBarrier barrier = {
+      .sType = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER,
+      .srcAccessMask = fresh ? 0 : VK_ACCESS_TRANSFER_WRITE_BIT,
+      .dstAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT,
+      .oldLayout = fresh ? VK_IMAGE_LAYOUT_UNDEFINED
+                         : VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL,
+      .newLayout = VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL,
+      .srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED,
+      .dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED,
+      .image = tex->image,
+      .subresourceRange = {VK_IMAGE_ASPECT_COLOR_BIT, 0, 1, 0, 1},
+  };
+  vkCmdPipelineBarrier(cmd,
+                       fresh ? VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT
+                             : VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT |
+                                   VK_PIPELINE_STAGE_TRANSFER_BIT,
+                       VK_PIPELINE_STAGE_TRANSFER_BIT, 0, 0, NULL, 0, NULL, 1,
+                       &barrier);
+
+  VkBufferImageCopy region = {
+      .bufferOffset = offset,
+      .bufferRowLength = 0,
+      .bufferImageHeight = 0,
+      .imageSubresource = {VK_IMAGE_ASPECT_COLOR_BIT, 0, 0, 1},
+      .imageOffset = {x, y, 0},
+      .imageExtent = {(uint32_t)w, (uint32_t)h, 1},
+  };
+  vkCmdCopyBufferToImage(cmd, src, tex->image,
+                         VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, 1, &region);
+
+  barrier.oldLayout = VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL;
+  barrier.newLayout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
+  barrier.srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
+  barrier.dstAccessMask = VK_ACCESS_SHADER_READ_BIT;
+  vkCmdPipelineBarrier(cmd, VK_PIPELINE_STAGE_TRANSFER_BIT,
+                       VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT, 0, 0, NULL, 0,
+                       NULL, 1, &barrier);
+  return true;
+}
+
+static StygianVKTexture *vk_texture_get(StygianAP *ap, StygianAPTexture tex) {
+  if (!ap || tex == 0u || tex > STYGIAN_VK_MAX_TEXTURES ||
+      !ap->textures[tex - 1u].image)
+    return NULL;
+  return &ap->textures[tex - 1u];
+}
+
+// Release everything texture-side; the device must be idle.
+static void vk_destroy_textures(StygianAP *ap) {
+  for (uint32_t i = 0; i < ap->retired_count; i++)
+    vk_retired_release(ap, &ap->retired[i]);
+  ap_free(ap, ap->retired);
+  ap->retired = NULL;
+  ap->retired_count = ap->retired_capacity = 0u;
+  for (uint32_t i = 0; i < STYGIAN_VK_MAX_TEXTURES; i++) {
+    if (ap->textures[i].image)
+      vk_texture_release(ap, &ap->textures[i]);
+  }
+  for (uint32_t b = 0; b < STYGIAN_VK_MAX_MEMORY_BLOCKS; b++) {
+    StygianVKMemoryBlock *block = &ap->memory_blocks[b];
+    if (block->memory)
+      vkFreeMemory(ap->device, block->memory, NULL);
+    stygian_range_alloc_destroy(block->ranges);
+    memset(block, 0, sizeof(*block));
+  }
+  if (ap->staging_buf)
+    vkDestroyBuffer(ap->device, ap->staging_buf, NULL);
+  if (ap->staging_mem)
+    vkFreeMemory(ap->device, ap->staging_mem, NULL);
+  ap->staging_buf = VK_NULL_HANDLE;
+  ap->staging_mem = VK_NULL_HANDLE;
+  ap->staging_mapped = NULL;
+  if (ap->texture_sampler)
+    vkDestroySampler(ap->device, ap->texture_sampler, NULL);
+  ap->texture_sampler = VK_NULL_HANDLE;
+  ap->font_view = VK_NULL_HANDLE;
+  ap->font_sampler = VK_NULL_HANDLE;
+}
+
 StygianAP *stygian_ap_create(const StygianAPConfig *config) {
   if (!config || !config->window) {
     printf("[Stygian AP VK] Error: window required\n");
@@ -1392,6 +2002,8 @@ StygianAP *stygian_ap_create(const StygianAPConfig *config) {
   ap->allocator = config->allocator;
   ap->window = config->window;
   ap->max_elements = config->max_elements > 0 ? config->max_elements : 16384;
+  ap->max_clips =
+      config->max_clips > 0 ? config->max_clips : STYGIAN_MAX_CLIPS;
   ap->atlas_width = 1.0f;
   ap->atlas_height = 1.0f;
   ap->px_range = 4.0f;
@@ -1404,6 +2016,7 @@ StygianAP *stygian_ap_create(const StygianAPConfig *config) {
   ap->resize_suboptimal_threshold = 3;
   ap->resize_telemetry_enabled = false;
   ap->resize_telemetry_period = 120;
+  ap->damage_enabled = true;
   memset(ap->output_color_matrix, 0, sizeof(ap->output_color_matrix));
   ap->output_color_matrix[0] = 1.0f;
   ap->output_color_matrix[4] = 1.0f;
@@ -1438,6 +2051,11 @@ StygianAP *stygian_ap_create(const StygianAPConfig *config) {
     ap->resize_telemetry_enabled = (telemetry_env && telemetry_env[0] &&
                                     strtol(telemetry_env, NULL, 10) != 0);
   }
+  {
+    const char *damage_env = getenv("STYGIAN_VK_DAMAGE");
+    if (damage_env && damage_env[0] && strtol(damage_env, NULL, 10) == 0)
+      ap->damage_enabled = false;
+  }
   {
     const char *period_env = getenv("STYGIAN_VK_RESIZE_TELEMETRY_PERIOD");
     if (period_env && period_env[0]) {
@@ -1574,6 +2192,7 @@ StygianAP *stygian_ap_create(const StygianAPConfig *config) {
 
   // Create buffers
   if (!create_buffers(ap)) {
+    destroy_frame_resources(ap);
     for (int i = 0; i < STYGIAN_VK_FRAMES_IN_FLIGHT; i++) {
       vkDestroySemaphore(ap->device, ap->render_finished[i], NULL);
       vkDestroySemaphore(ap->device, ap->image_available[i], NULL);
@@ -1599,22 +2218,7 @@ StygianAP *stygian_ap_create(const StygianAPConfig *config) {
   if (!create_descriptor_sets(ap)) {
     vkDestroyBuffer(ap->device, ap->vertex_buffer, NULL);
     vkFreeMemory(ap->device, ap->vertex_memory, NULL);
-    if (ap->clip_ssbo)
-      vkDestroyBuffer(ap->device, ap->clip_ssbo, NULL);
-    if (ap->clip_ssbo_memory)
-      vkFreeMemory(ap->device, ap->clip_ssbo_memory, NULL);
-    if (ap->soa_hot_buf)
-      vkDestroyBuffer(ap->device, ap->soa_hot_buf, NULL);
-    if (ap->soa_hot_mem)
-      vkFreeMemory(ap->device, ap->soa_hot_mem, NULL);
-    if (ap->soa_appearance_buf)
-      vkDestroyBuffer(ap->device, ap->soa_appearance_buf, NULL);
-    if (ap->soa_appearance_mem)
-      vkFreeMemory(ap->device, ap->soa_appearance_mem, NULL);
-    if (ap->soa_effects_buf)
-      vkDestroyBuffer(ap->device, ap->soa_effects_buf, NULL);
-    if (ap->soa_effects_mem)
-      vkFreeMemory(ap->device, ap->soa_effects_mem, NULL);
+    destroy_frame_resources(ap);
     // ... (cleanup sync, command pool, framebuffers, etc.)
     cfg_free(ap->allocator, ap);
     return NULL;
@@ -1649,6 +2253,28 @@ StygianAP *stygian_ap_create(const StygianAPConfig *config) {
       memset(ap->gpu_appearance_versions, 0, cc * sizeof(uint32_t));
     if (ap->gpu_effects_versions)
       memset(ap->gpu_effects_versions, 0, cc * sizeof(uint32_t));
+    // Pending ranges start empty: the buffers were zeroed at creation.
+    for (uint32_t f = 0; f < STYGIAN_VK_FRAMES_IN_FLIGHT; f++) {
+      for (uint32_t b = 0; b < STYGIAN_VK_SOA_BUFFERS; b++) {
+        StygianVKDirtyRange *pending = (StygianVKDirtyRange *)ap_alloc(
+            ap, cc * sizeof(StygianVKDirtyRange),
+            _Alignof(StygianVKDirtyRange));
+        if (pending) {
+          for (uint32_t ci = 0; ci < cc; ci++) {
+            pending[ci].min = UINT32_MAX;
+            pending[ci].max = 0u;
+          }
+        }
+        ap->frames[f].soa_pending[b] = pending;
+      }
+    }
+  }
+
+  // Optional: without the load pass every frame repaints in full.
+  if (ap->damage_enabled &&
+      !create_color_render_pass(ap, true, &ap->render_pass_load)) {
+    ap->render_pass_load = VK_NULL_HANDLE;
+    ap->damage_enabled = false;
   }
 
   printf("[Stygian AP VK] Vulkan backend initialized successfully\n");
@@ -1697,31 +2323,14 @@ void stygian_ap_destroy(StygianAP *ap) {
     vkDestroyBuffer(ap->device, ap->vertex_buffer, NULL);
   if (ap->vertex_memory)
     vkFreeMemory(ap->device, ap->vertex_memory, NULL);
-  if (ap->clip_ssbo)
-    vkDestroyBuffer(ap->device, ap->clip_ssbo, NULL);
-  if (ap->clip_ssbo_memory)
-    vkFreeMemory(ap->device, ap->clip_ssbo_memory, NULL);
-  // SoA buffer cleanup
-  if (ap->soa_hot_buf)
-    vkDestroyBuffer(ap->device, ap->soa_hot_buf, NULL);
-  if (ap->soa_hot_mem)
-    vkFreeMemory(ap->device, ap->soa_hot_mem, NULL);
-  if (ap->soa_appearance_buf)
-    vkDestroyBuffer(ap->device, ap->soa_appearance_buf, NULL);
-  if (ap->soa_appearance_mem)
-    vkFreeMemory(ap->device, ap->soa_appearance_mem, NULL);
-  if (ap->soa_effects_buf)
-    vkDestroyBuffer(ap->device, ap->soa_effects_buf, NULL);
-  if (ap->soa_effects_mem)
-    vkFreeMemory(ap->device, ap->soa_effects_mem, NULL);
-  if (ap->font_sampler)
-    vkDestroySampler(ap->device, ap->font_sampler, NULL);
-  if (ap->font_view)
-    vkDestroyImageView(ap->device, ap->font_view, NULL);
-  if (ap->font_image)
-    vkDestroyImage(ap->device, ap->font_image, NULL);
-  if (ap->font_memory)
-    vkFreeMemory(ap->device, ap->font_memory, NULL);
+  // Per-frame clip/SoA buffers and their descriptor bookkeeping
+  destroy_frame_resources(ap);
+  ap_free(ap, ap->gpu_hot_versions);
+  ap_free(ap, ap->gpu_appearance_versions);
+  ap_free(ap, ap->gpu_effects_versions);
+  // Textures, their memory blocks and the staging ring
+  if (ap->device)
+    vk_destroy_textures(ap);
 
   // Destroy framebuffers
   for (uint32_t i = 0; i < ap->swapchain_image_count; i++) {
@@ -1729,9 +2338,11 @@ void stygian_ap_destroy(StygianAP *ap) {
       vkDestroyFramebuffer(ap->device, ap->framebuffers[i], NULL);
   }
 
-  // Destroy render pass
+  // Destroy render passes
   if (ap->render_pass)
     vkDestroyRenderPass(ap->device, ap->render_pass, NULL);
+  if (ap->render_pass_load)
+    vkDestroyRenderPass(ap->device, ap->render_pass_load, NULL);
 
   // Destroy image views
   for (uint32_t i = 0; i < ap->swapchain_image_count; i++) {
@@ -1784,15 +2395,82 @@ float stygian_ap_get_last_gpu_ms(const StygianAP *ap) {
   return ap->last_gpu_ms;
 }
 
-void stygian_ap_gpu_timer_begin(StygianAP *ap) { (void)ap; }
+static void vk_flush_draws(StygianAP *ap);
+
+// Timestamp slot `index` of the current frame; false when timing is off.
+static bool vk_gpu_timestamp(StygianAP *ap, VkPipelineStageFlagBits stage,
+                             uint32_t index) {
+  if (!ap->frame_active || !ap->gpu_timer_supported ||
+      !ap->gpu_timer_query_pool || index >= STYGIAN_VK_GPU_QUERIES)
+    return false;
+  vkCmdWriteTimestamp(ap->command_buffers[ap->current_frame], stage,
+                      ap->gpu_timer_query_pool,
+                      ap->current_frame * STYGIAN_VK_GPU_QUERIES + index);
+  return true;
+}
+
+void stygian_ap_gpu_timer_begin(StygianAP *ap) {
+  StygianVKFrameResources *fr;
+  if (!ap || ap->gpu_timer_open)
+    return;
+  fr = &ap->frames[ap->current_frame];
+  if (fr->gpu_query_count != 0u ||
+      !vk_gpu_timestamp(ap, VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT, 0u))
+    return;
+  fr->gpu_query_phase[0] = 0u;
+  fr->gpu_query_count = 1u;
+  ap->gpu_timer_open = true;
+}
+
+void stygian_ap_gpu_timer_phase(StygianAP *ap, uint32_t phase) {
+  StygianVKFrameResources *fr;
+  if (!ap || !ap->gpu_timer_open || phase >= STYGIAN_AP_GPU_PHASES)
+    return;
+  fr = &ap->frames[ap->current_frame];
+  if (fr->gpu_query_phase[fr->gpu_query_count - 1u] == phase)
+    return;
+  // Keep the last slot for timer_end; extra marks fold into the open phase.
+  if (fr->gpu_query_count + 1u >= STYGIAN_VK_GPU_QUERIES)
+    return;
+  vk_flush_draws(ap); // Queued draws belong to the phase being closed
+  if (!vk_gpu_timestamp(ap, VK_PIPELINE_STAGE_BOTTOM_OF_PIPE_BIT,
+                        fr->gpu_query_count))
+    return;
+  fr->gpu_query_phase[fr->gpu_query_count++] = (uint8_t)phase;
+}
+
+void stygian_ap_gpu_timer_end(StygianAP *ap) {
+  StygianVKFrameResources *fr;
+  if (!ap || !ap->gpu_timer_open)
+    return;
+  fr = &ap->frames[ap->current_frame];
+  ap->gpu_timer_open = false;
+  vk_flush_draws(ap);
+  if (!vk_gpu_timestamp(ap, VK_PIPELINE_STAGE_BOTTOM_OF_PIPE_BIT,
+                        fr->gpu_query_count))
+    return;
+  fr->gpu_query_phase[fr->gpu_query_count++] = 0u;
+}
 
-void stygian_ap_gpu_timer_end(StygianAP *ap) { (void)ap; }
+uint32_t stygian_ap_get_last_gpu_phases(const StygianAP *ap, float *out_ms,
+                                        uint32_t max_phases) {
+  uint32_t n;
+  if (!ap)
+    return 0u;
+  n = ap->last_gpu_phase_count < max_phases ? ap->last_gpu_phase_count
+                                            : max_phases;
+  if (out_ms && n > 0u)
+    memcpy(out_ms, ap->last_gpu_phase_ms, n * sizeof(float));
+  return ap->last_gpu_phase_count;
+}
 
 void stygian_ap_begin_frame(StygianAP *ap, int width, int height) {
   if (!ap)
     return;
 
   ap->frame_active = false;
+  ap->damage_w = width;
+  ap->damage_h = height;
 
   if (ap->window) {
     int fb_w = 0, fb_h = 0;
@@ -1846,6 +2524,11 @@ void stygian_ap_begin_frame(StygianAP *ap, int width, int height) {
   vkWaitForFences(ap->device, 1, &ap->in_flight[ap->current_frame], VK_TRUE,
                   UINT64_MAX);
   update_gpu_timer_sample_for_frame(ap, ap->current_frame);
+  vk_refresh_font_descriptors(ap, ap->current_frame);
+  vk_retire_frame(ap, ap->current_frame);
+  ap->frames[ap->current_frame].indirect_used = 0u;
+  ap->draw_batch_count = 0u;
+  ap->frame_draw_calls = 0u;
 
   // Acquire next swapchain image
   double acquire_t0 = stygian_vk_now_ms();
@@ -1898,25 +2581,21 @@ void stygian_ap_begin_frame(StygianAP *ap, int width, int height) {
   };
   vkBeginCommandBuffer(cmd, &begin_info);
 
+  // Queries must be reset outside the render pass; the timer writes them
+  // between gpu_timer_begin and gpu_timer_end.
+  ap->gpu_timer_open = false;
   if (ap->gpu_timer_supported && ap->gpu_timer_query_pool) {
-    uint32_t query_base = ap->current_frame * 2u;
-    vkCmdResetQueryPool(cmd, ap->gpu_timer_query_pool, query_base, 2u);
-    vkCmdWriteTimestamp(cmd, VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT,
-                        ap->gpu_timer_query_pool, query_base);
+    vkCmdResetQueryPool(cmd, ap->gpu_timer_query_pool,
+                        ap->current_frame * STYGIAN_VK_GPU_QUERIES,
+                        STYGIAN_VK_GPU_QUERIES);
   }
 
-  // Begin render pass
-  VkClearValue clear_color = {{{0.1f, 0.1f, 0.1f, 1.0f}}};
-  VkRenderPassBeginInfo render_pass_info = {
-      .sType = VK_STRUCTURE_TYPE_RENDER_PASS_BEGIN_INFO,
-      .renderPass = ap->render_pass,
-      .framebuffer = ap->framebuffers[ap->current_image],
-      .renderArea = {.offset = {0, 0}, .extent = ap->swapchain_extent},
-      .clearValueCount = 1,
-      .pClearValues = &clear_color,
-  };
-
-  vkCmdBeginRenderPass(cmd, &render_pass_info, VK_SUBPASS_CONTENTS_INLINE);
+  // The render pass begins with the first draw, once damage is known
+  ap->render_pass_open = false;
+  ap->frame_damage_count = 0u;
+  ap->frame_damage_partial = false;
+  ap->damage_count = 0u;
+  ap->damage_partial = false;
   ap->frame_active = true;
 }
 
@@ -1931,6 +2610,14 @@ void stygian_ap_submit(StygianAP *ap, const StygianSoAHot *soa_hot,
   ap->element_count = count;
 }
 
+// Widen one frame's pending range for a chunk by [lo, hi].
+static void vk_pending_add(StygianVKDirtyRange *r, uint32_t lo, uint32_t hi) {
+  if (lo < r->min)
+    r->min = lo;
+  if (hi > r->max)
+    r->max = hi;
+}
+
 void stygian_ap_submit_soa(StygianAP *ap, const StygianSoAHot *hot,
                            const StygianSoAAppearance *appearance,
                            const StygianSoAEffects *effects,
@@ -1948,116 +2635,222 @@ void stygian_ap_submit_soa(StygianAP *ap, const StygianSoAHot *hot,
   ap->last_upload_bytes = 0u;
   ap->last_upload_ranges = 0u;
 
-  // Map once per frame and copy only dirty ranges to keep upload cost bounded.
-  void *hot_mapped = NULL;
-  void *app_mapped = NULL;
-  void *eff_mapped = NULL;
-
-  vkMapMemory(ap->device, ap->soa_hot_mem, 0, VK_WHOLE_SIZE, 0, &hot_mapped);
-  vkMapMemory(ap->device, ap->soa_appearance_mem, 0, VK_WHOLE_SIZE, 0,
-              &app_mapped);
-  vkMapMemory(ap->device, ap->soa_effects_mem, 0, VK_WHOLE_SIZE, 0,
-              &eff_mapped);
+  const void *sources[STYGIAN_VK_SOA_BUFFERS] = {hot, appearance, effects};
+  const size_t strides[STYGIAN_VK_SOA_BUFFERS] = {
+      sizeof(StygianSoAHot), sizeof(StygianSoAAppearance),
+      sizeof(StygianSoAEffects)};
+  uint32_t *seen[STYGIAN_VK_SOA_BUFFERS] = {ap->gpu_hot_versions,
+                                            ap->gpu_appearance_versions,
+                                            ap->gpu_effects_versions};
+  StygianVKFrameResources *target = &ap->frames[ap->current_frame];
 
   for (uint32_t ci = 0; ci < chunk_count; ci++) {
     const StygianBufferChunk *c = &chunks[ci];
+    const uint32_t versions[STYGIAN_VK_SOA_BUFFERS] = {
+        c->hot_version, c->appearance_version, c->effects_version};
+    const uint32_t dirty_min[STYGIAN_VK_SOA_BUFFERS] = {
+        c->hot_dirty_min, c->appearance_dirty_min, c->effects_dirty_min};
+    const uint32_t dirty_max[STYGIAN_VK_SOA_BUFFERS] = {
+        c->hot_dirty_max, c->appearance_dirty_max, c->effects_dirty_max};
     uint32_t base = ci * chunk_size;
 
-    // --- Hot buffer ---
-    if (ap->gpu_hot_versions && c->hot_version != ap->gpu_hot_versions[ci]) {
-      uint32_t dmin = c->hot_dirty_min;
-      uint32_t dmax = c->hot_dirty_max;
-      if (dmin <= dmax) {
-        uint32_t abs_min = base + dmin;
-        uint32_t abs_max = base + dmax;
-        if (abs_max >= element_count)
-          abs_max = element_count - 1;
-        if (abs_min < element_count && hot_mapped) {
-          uint32_t range_count = abs_max - abs_min + 1;
-          size_t offset = (size_t)abs_min * sizeof(StygianSoAHot);
-          size_t bytes = (size_t)range_count * sizeof(StygianSoAHot);
-          memcpy((char *)hot_mapped + offset, &hot[abs_min], bytes);
-          ap->last_upload_bytes += (uint32_t)bytes;
-          ap->last_upload_ranges++;
+    for (uint32_t b = 0; b < STYGIAN_VK_SOA_BUFFERS; b++) {
+      StygianVKDirtyRange *pending;
+      // A new version is owed to every frame's copy, not just this one.
+      if (seen[b] && versions[b] != seen[b][ci]) {
+        if (dirty_min[b] <= dirty_max[b]) {
+          for (uint32_t f = 0; f < STYGIAN_VK_FRAMES_IN_FLIGHT; f++) {
+            if (ap->frames[f].soa_pending[b])
+              vk_pending_add(&ap->frames[f].soa_pending[b][ci], dirty_min[b],
+                             dirty_max[b]);
+          }
         }
+        seen[b][ci] = versions[b];
       }
-      ap->gpu_hot_versions[ci] = c->hot_version;
-    }
 
-    // --- Appearance buffer ---
-    if (ap->gpu_appearance_versions &&
-        c->appearance_version != ap->gpu_appearance_versions[ci]) {
-      uint32_t dmin = c->appearance_dirty_min;
-      uint32_t dmax = c->appearance_dirty_max;
-      if (dmin <= dmax) {
-        uint32_t abs_min = base + dmin;
-        uint32_t abs_max = base + dmax;
-        if (abs_max >= element_count)
-          abs_max = element_count - 1;
-        if (abs_min < element_count && app_mapped) {
-          uint32_t range_count = abs_max - abs_min + 1;
-          size_t offset = (size_t)abs_min * sizeof(StygianSoAAppearance);
-          size_t bytes = (size_t)range_count * sizeof(StygianSoAAppearance);
-          memcpy((char *)app_mapped + offset, &appearance[abs_min], bytes);
-          ap->last_upload_bytes += (uint32_t)bytes;
-          ap->last_upload_ranges++;
-        }
+      // Outside a frame this copy may still be in use; it stays pending.
+      if (!ap->frame_active || !target->soa_pending[b] ||
+          !target->soa_mapped[b])
+        continue;
+      pending = &target->soa_pending[b][ci];
+      if (pending->min > pending->max)
+        continue;
+      uint32_t abs_min = base + pending->min;
+      uint32_t abs_max = base + pending->max;
+      if (abs_max >= element_count)
+        abs_max = element_count - 1;
+      if (abs_min < element_count) {
+        uint32_t range_count = abs_max - abs_min + 1;
+        size_t offset = (size_t)abs_min * strides[b];
+        size_t bytes = (size_t)range_count * strides[b];
+        memcpy((char *)target->soa_mapped[b] + offset,
+               (const char *)sources[b] + offset, bytes);
+        ap->last_upload_bytes += (uint32_t)bytes;
+        ap->last_upload_ranges++;
       }
-      ap->gpu_appearance_versions[ci] = c->appearance_version;
-    }
-
-    // --- Effects buffer ---
-    if (ap->gpu_effects_versions &&
-        c->effects_version != ap->gpu_effects_versions[ci]) {
-      uint32_t dmin = c->effects_dirty_min;
-      uint32_t dmax = c->effects_dirty_max;
-      if (dmin <= dmax) {
-        uint32_t abs_min = base + dmin;
-        uint32_t abs_max = base + dmax;
-        if (abs_max >= element_count)
-          abs_max = element_count - 1;
-        if (abs_min < element_count && eff_mapped) {
-          uint32_t range_count = abs_max - abs_min + 1;
-          size_t offset = (size_t)abs_min * sizeof(StygianSoAEffects);
-          size_t bytes = (size_t)range_count * sizeof(StygianSoAEffects);
-          memcpy((char *)eff_mapped + offset, &effects[abs_min], bytes);
-          ap->last_upload_bytes += (uint32_t)bytes;
-          ap->last_upload_ranges++;
-        }
-      }
-      ap->gpu_effects_versions[ci] = c->effects_version;
+      pending->min = UINT32_MAX;
+      pending->max = 0u;
     }
   }
+  if (ap->frame_active)
+    ap->upload_frame = ap->current_frame;
+}
 
-  // Unmap all three buffers
-  if (hot_mapped)
-    vkUnmapMemory(ap->device, ap->soa_hot_mem);
-  if (app_mapped)
-    vkUnmapMemory(ap->device, ap->soa_appearance_mem);
-  if (eff_mapped)
-    vkUnmapMemory(ap->device, ap->soa_effects_mem);
+static VkRect2D vk_rect_union(VkRect2D a, VkRect2D b) {
+  int32_t x0 = a.offset.x < b.offset.x ? a.offset.x : b.offset.x;
+  int32_t y0 = a.offset.y < b.offset.y ? a.offset.y : b.offset.y;
+  int32_t ax1 = a.offset.x + (int32_t)a.extent.width;
+  int32_t bx1 = b.offset.x + (int32_t)b.extent.width;
+  int32_t ay1 = a.offset.y + (int32_t)a.extent.height;
+  int32_t by1 = b.offset.y + (int32_t)b.extent.height;
+  VkRect2D u = {{x0, y0},
+                {(uint32_t)((ax1 > bx1 ? ax1 : bx1) - x0),
+                 (uint32_t)((ay1 > by1 ? ay1 : by1) - y0)}};
+  return u;
 }
 
-void stygian_ap_draw(StygianAP *ap) {
-  if (!ap || !ap->frame_active || ap->element_count == 0)
+// Add r to a list of disjoint rects, merging everything it touches, so each
+// pixel is repainted by exactly one scissored pass.
+static void vk_damage_add(VkRect2D *list, uint32_t *count, VkRect2D r) {
+  uint32_t i = 0u;
+  if (r.extent.width == 0u || r.extent.height == 0u)
     return;
-  stygian_ap_draw_range(ap, 0u, ap->element_count);
+  while (i < *count) {
+    const VkRect2D *d = &list[i];
+    if (r.offset.x <= d->offset.x + (int32_t)d->extent.width &&
+        d->offset.x <= r.offset.x + (int32_t)r.extent.width &&
+        r.offset.y <= d->offset.y + (int32_t)d->extent.height &&
+        d->offset.y <= r.offset.y + (int32_t)r.extent.height) {
+      r = vk_rect_union(r, *d);
+      list[i] = list[--*count];
+      i = 0u;
+      continue;
+    }
+    i++;
+  }
+  list[(*count)++] = r;
 }
 
-void stygian_ap_draw_range(StygianAP *ap, uint32_t first_instance,
-                           uint32_t instance_count) {
-  if (!ap || !ap->frame_active || instance_count == 0)
+void stygian_ap_set_damage(StygianAP *ap, const float *rects, uint32_t count) {
+  uint32_t i;
+  uint64_t since;
+  if (!ap)
+    return;
+  if (!ap->frame_active) {
+    // This frame's changes never reach any image: their contents are stale.
+    memset(ap->image_serial, 0, sizeof(ap->image_serial));
+    return;
+  }
+  if (ap->render_pass_open)
+    return; // Drawing already started in full
+
+  ap->frame_damage_count = 0u;
+  ap->frame_damage_partial = false;
+  ap->damage_count = 0u;
+  ap->damage_partial = false;
+  if (!rects || count > STYGIAN_VK_MAX_DAMAGE_RECTS ||
+      ap->damage_w != (int)ap->swapchain_extent.width ||
+      ap->damage_h != (int)ap->swapchain_extent.height)
+    return;
+
+  for (i = 0; i < count; i++) {
+    const float *r = &rects[i * 4u];
+    float x0 = r[0] > 0.0f ? r[0] : 0.0f;
+    float y0 = r[1] > 0.0f ? r[1] : 0.0f;
+    float x1 = r[0] + r[2];
+    float y1 = r[1] + r[3];
+    if (x1 > (float)ap->swapchain_extent.width)
+      x1 = (float)ap->swapchain_extent.width;
+    if (y1 > (float)ap->swapchain_extent.height)
+      y1 = (float)ap->swapchain_extent.height;
+    if (x1 <= x0 || y1 <= y0)
+      continue;
+    VkRect2D rect = {{(int32_t)x0, (int32_t)y0},
+                     {(uint32_t)(x1 - (float)(int32_t)x0 + 0.999f),
+                      (uint32_t)(y1 - (float)(int32_t)y0 + 0.999f)}};
+    vk_damage_add(ap->frame_damage, &ap->frame_damage_count, rect);
+  }
+  ap->frame_damage_partial = true;
+
+  // The image also misses every frame drawn since it was last rendered.
+  if (!ap->damage_enabled || !ap->render_pass_load ||
+      ap->current_image >= STYGIAN_VK_MAX_SWAPCHAIN_IMAGES)
+    return;
+  since = ap->image_serial[ap->current_image];
+  if (since == 0u || ap->damage_serial - since >= STYGIAN_VK_DAMAGE_HISTORY)
     return;
+  for (uint64_t f = since + 1u; f <= ap->damage_serial; f++) {
+    uint32_t slot = (uint32_t)(f % STYGIAN_VK_DAMAGE_HISTORY);
+    if (ap->damage_history_full[slot]) {
+      ap->damage_count = 0u;
+      return;
+    }
+    vk_damage_add(ap->damage_rects, &ap->damage_count,
+                  ap->damage_history[slot]);
+  }
+  for (i = 0; i < ap->frame_damage_count; i++)
+    vk_damage_add(ap->damage_rects, &ap->damage_count, ap->frame_damage[i]);
+  ap->damage_partial = true;
+}
 
+// Begin the render pass on first use. A partial frame loads the image,
+// clears only the damage and renders inside its bounds; false when it has
+// nothing to repaint.
+static bool vk_open_render_pass(StygianAP *ap) {
   VkCommandBuffer cmd = ap->command_buffers[ap->current_frame];
+  VkClearValue clear_color = {{{0.1f, 0.1f, 0.1f, 1.0f}}};
+  VkRenderPassBeginInfo render_pass_info = {
+      .sType = VK_STRUCTURE_TYPE_RENDER_PASS_BEGIN_INFO,
+      .renderPass = ap->render_pass,
+      .framebuffer = ap->framebuffers[ap->current_image],
+      .renderArea = {.offset = {0, 0}, .extent = ap->swapchain_extent},
+      .clearValueCount = 1,
+      .pClearValues = &clear_color,
+  };
+  if (ap->render_pass_open)
+    return true;
+  if (ap->damage_partial) {
+    if (ap->damage_count == 0u)
+      return false;
+    render_pass_info.renderPass = ap->render_pass_load;
+    render_pass_info.renderArea = ap->damage_rects[0];
+    for (uint32_t i = 1; i < ap->damage_count; i++)
+      render_pass_info.renderArea =
+          vk_rect_union(render_pass_info.renderArea, ap->damage_rects[i]);
+  }
+
+  vkCmdBeginRenderPass(cmd, &render_pass_info, VK_SUBPASS_CONTENTS_INLINE);
+  ap->render_pass_open = true;
 
+  if (ap->damage_partial) {
+    VkClearAttachment clear = {
+        .aspectMask = VK_IMAGE_ASPECT_COLOR_BIT,
+        .colorAttachment = 0,
+        .clearValue = clear_color,
+    };
+    VkClearRect clear_rects[STYGIAN_VK_MAX_DAMAGE_RECTS +
+                            STYGIAN_VK_DAMAGE_HISTORY];
+    for (uint32_t i = 0; i < ap->damage_count; i++) {
+      clear_rects[i].rect = ap->damage_rects[i];
+      clear_rects[i].baseArrayLayer = 0;
+      clear_rects[i].layerCount = 1;
+    }
+    vkCmdClearAttachments(cmd, 1, &clear, ap->damage_count, clear_rects);
+  }
+  return true;
+}
+
+// Pipeline, descriptors, push constants and dynamic state for main-pass
+// draws; bound once per flush.
+static void vk_bind_draw_state(StygianAP *ap, VkCommandBuffer cmd) {
   // Bind pipeline
   vkCmdBindPipeline(cmd, VK_PIPELINE_BIND_POINT_GRAPHICS,
                     ap->graphics_pipeline);
 
   // Bind descriptor set (SSBO)
   vkCmdBindDescriptorSets(cmd, VK_PIPELINE_BIND_POINT_GRAPHICS,
-                          ap->pipeline_layout, 0, 1, &ap->descriptor_set, 0,
+                          ap->pipeline_layout, 0, 1,
+                          &ap->frames[ap->current_frame].descriptor_set, 0,
                           NULL);
 
   // Push constants (shared vertex/fragment constants)
@@ -2090,24 +2883,95 @@ void stygian_ap_draw_range(StygianAP *ap, uint32_t first_instance,
   };
   vkCmdSetViewport(cmd, 0, 1, &viewport);
   vkCmdSetScissor(cmd, 0, 1, &scissor);
+}
 
-  // Draw instanced (6 vertices per quad, count instances)
-  vkCmdDraw(cmd, 6, instance_count, 0, first_instance);
+// Submit queued ranges: one vkCmdDrawIndirect when there are several and the
+// device supports it, else one vkCmdDraw per range.
+static void vk_flush_draws(StygianAP *ap) {
+  StygianVKFrameResources *fr = &ap->frames[ap->current_frame];
+  VkCommandBuffer cmd = ap->command_buffers[ap->current_frame];
+  uint32_t n = ap->draw_batch_count;
+  uint32_t passes, indirect_at = UINT32_MAX;
+  if (n == 0u || !ap->frame_active)
+    return;
+  ap->draw_batch_count = 0u;
+  if (!vk_open_render_pass(ap))
+    return;
+  vk_bind_draw_state(ap, cmd);
+  if (n > 1u && fr->indirect_mapped &&
+      fr->indirect_used + n <= STYGIAN_VK_MAX_DRAW_BATCH) {
+    indirect_at = fr->indirect_used;
+    memcpy(&fr->indirect_mapped[indirect_at], ap->draw_batch,
+           n * sizeof(VkDrawIndirectCommand));
+    fr->indirect_used += n;
+  }
+  // A partial frame replays the batch once per damage rect.
+  passes = ap->damage_partial ? ap->damage_count : 1u;
+  for (uint32_t p = 0; p < passes; p++) {
+    if (ap->damage_partial)
+      vkCmdSetScissor(cmd, 0, 1, &ap->damage_rects[p]);
+    if (indirect_at != UINT32_MAX) {
+      vkCmdDrawIndirect(cmd, fr->indirect_buf,
+                        indirect_at * sizeof(VkDrawIndirectCommand), n,
+                        sizeof(VkDrawIndirectCommand));
+      ap->frame_draw_calls++;
+      continue;
+    }
+    for (uint32_t i = 0; i < n; i++) {
+      const VkDrawIndirectCommand *d = &ap->draw_batch[i];
+      vkCmdDraw(cmd, d->vertexCount, d->instanceCount, d->firstVertex,
+                d->firstInstance);
+    }
+    ap->frame_draw_calls += n;
+  }
+}
+
+void stygian_ap_draw(StygianAP *ap) {
+  if (!ap || !ap->frame_active || ap->element_count == 0)
+    return;
+  stygian_ap_draw_range(ap, 0u, ap->element_count);
+}
+
+void stygian_ap_draw_range(StygianAP *ap, uint32_t first_instance,
+                           uint32_t instance_count) {
+  VkDrawIndirectCommand *last;
+  if (!ap || !ap->frame_active || instance_count == 0)
+    return;
+  last = ap->draw_batch_count > 0u ? &ap->draw_batch[ap->draw_batch_count - 1u]
+                                   : NULL;
+  if (last && last->firstInstance + last->instanceCount == first_instance) {
+    last->instanceCount += instance_count;
+    return;
+  }
+  if (ap->draw_batch_count == STYGIAN_VK_MAX_DRAW_BATCH)
+    vk_flush_draws(ap);
+  // 6 vertices per quad, one instance per element
+  last = &ap->draw_batch[ap->draw_batch_count++];
+  last->vertexCount = 6u;
+  last->instanceCount = instance_count;
+  last->firstVertex = 0u;
+  last->firstInstance = first_instance;
+}
+
+uint32_t stygian_ap_get_last_draw_calls(const StygianAP *ap) {
+  return ap ? ap->last_draw_calls : 0u;
 }
 
 void stygian_ap_end_frame(StygianAP *ap) {
   if (!ap || !ap->frame_active)
     return;
 
-  // End render pass
-  VkCommandBuffer cmd = ap->command_buffers[ap->current_frame];
-  vkCmdEndRenderPass(cmd);
+  // Submit queued draws and close a timer the caller left open
+  vk_flush_draws(ap);
+  stygian_ap_gpu_timer_end(ap);
+  ap->last_draw_calls = ap->frame_draw_calls;
 
-  if (ap->gpu_timer_supported && ap->gpu_timer_query_pool) {
-    uint32_t query_base = ap->current_frame * 2u;
-    vkCmdWriteTimestamp(cmd, VK_PIPELINE_STAGE_BOTTOM_OF_PIPE_BIT,
-                        ap->gpu_timer_query_pool, query_base + 1u);
-  }
+  // End render pass; a frame without draws still clears (or, when partial,
+  // may have nothing to repaint at all)
+  VkCommandBuffer cmd = ap->command_buffers[ap->current_frame];
+  if (vk_open_render_pass(ap))
+    vkCmdEndRenderPass(cmd);
+  ap->render_pass_open = false;
 
   // End command buffer
   VkResult result = vkEndCommandBuffer(cmd);
@@ -2116,7 +2980,17 @@ void stygian_ap_end_frame(StygianAP *ap) {
     return;
   }
 
-  // Submit command buffer
+  // Submit texture uploads and the frame together, uploads first
+  StygianVKFrameResources *fr = &ap->frames[ap->current_frame];
+  VkCommandBuffer cmds[2];
+  uint32_t cmd_count = 0;
+  if (fr->upload_open) {
+    fr->upload_open = false;
+    if (vkEndCommandBuffer(fr->upload_cmd) == VK_SUCCESS)
+      cmds[cmd_count++] = fr->upload_cmd;
+  }
+  cmds[cmd_count++] = cmd;
+
   VkSemaphore wait_semaphores[] = {ap->image_available[ap->current_frame]};
   VkPipelineStageFlags wait_stages[] = {
       VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT};
@@ -2127,8 +3001,8 @@ void stygian_ap_end_frame(StygianAP *ap) {
       .waitSemaphoreCount = 1,
       .pWaitSemaphores = wait_semaphores,
       .pWaitDstStageMask = wait_stages,
-      .commandBufferCount = 1,
-      .pCommandBuffers = &cmd,
+      .commandBufferCount = cmd_count,
+      .pCommandBuffers = cmds,
       .signalSemaphoreCount = 1,
       .pSignalSemaphores = signal_semaphores,
   };
@@ -2141,6 +3015,27 @@ void stygian_ap_end_frame(StygianAP *ap) {
   }
   if (result != VK_SUCCESS) {
     printf("[Stygian AP VK] Failed to submit command buffer: %d\n", result);
+    return;
+  }
+  fr->serial = ++ap->submit_serial;
+  fr->staging_end = ap->staging_head;
+
+  // Remember what changed so images drawn earlier can catch up
+  {
+    uint64_t serial = ++ap->damage_serial;
+    uint32_t slot = (uint32_t)(serial % STYGIAN_VK_DAMAGE_HISTORY);
+    ap->damage_history_full[slot] = !ap->frame_damage_partial;
+    ap->damage_history[slot].offset.x = 0;
+    ap->damage_history[slot].offset.y = 0;
+    ap->damage_history[slot].extent.width = 0u;
+    ap->damage_history[slot].extent.height = 0u;
+    for (uint32_t i = 0; i < ap->frame_damage_count; i++)
+      ap->damage_history[slot] =
+          i == 0u ? ap->frame_damage[0]
+                  : vk_rect_union(ap->damage_history[slot],
+                                  ap->frame_damage[i]);
+    if (ap->current_image < STYGIAN_VK_MAX_SWAPCHAIN_IMAGES)
+      ap->image_serial[ap->current_image] = serial;
   }
 }
 
@@ -2161,6 +3056,26 @@ void stygian_ap_swap(StygianAP *ap) {
       .pImageIndices = &ap->current_image,
   };
 
+  // Tell the compositor which parts changed since the last present
+  VkRectLayerKHR present_rects[STYGIAN_VK_MAX_DAMAGE_RECTS];
+  VkPresentRegionKHR present_region = {0};
+  VkPresentRegionsKHR present_regions = {
+      .sType = VK_STRUCTURE_TYPE_PRESENT_REGIONS_KHR,
+      .swapchainCount = 1,
+      .pRegions = &present_region,
+  };
+  if (ap->incremental_present && ap->frame_damage_partial &&
+      ap->frame_damage_count > 0u) {
+    for (uint32_t i = 0; i < ap->frame_damage_count; i++) {
+      present_rects[i].offset = ap->frame_damage[i].offset;
+      present_rects[i].extent = ap->frame_damage[i].extent;
+      present_rects[i].layer = 0;
+    }
+    present_region.rectangleCount = ap->frame_damage_count;
+    present_region.pRectangles = present_rects;
+    present_info.pNext = &present_regions;
+  }
+
   double present_t0 = stygian_vk_now_ms();
   VkResult result = vkQueuePresentKHR(ap->graphics_queue, &present_info);
   if (ap->resize_telemetry_enabled) {
@@ -2206,15 +3121,52 @@ void stygian_ap_swap(StygianAP *ap) {
 
 StygianAPTexture stygian_ap_texture_create(StygianAP *ap, int w, int h,
                                            const void *rgba) {
-  if (!ap || !rgba)
+  StygianVKTexture *tex = NULL;
+  uint32_t index;
+  if (!ap || !rgba || w <= 0 || h <= 0)
     return 0;
 
+  for (index = 0; index < STYGIAN_VK_MAX_TEXTURES; index++) {
+    if (!ap->textures[index].image) {
+      tex = &ap->textures[index];
+      break;
+    }
+  }
+  if (!tex) {
+    printf("[Stygian AP VK] Texture table full (%d)\n",
+           STYGIAN_VK_MAX_TEXTURES);
+    return 0;
+  }
+
+  // Shared sampler for every texture
+  if (!ap->texture_sampler) {
+    VkSamplerCreateInfo sampler_info = {
+        .sType = VK_STRUCTURE_TYPE_SAMPLER_CREATE_INFO,
+        .magFilter = VK_FILTER_LINEAR,
+        .minFilter = VK_FILTER_LINEAR,
+        .addressModeU = VK_SAMPLER_ADDRESS_MODE_CLAMP_TO_EDGE,
+        .addressModeV = VK_SAMPLER_ADDRESS_MODE_CLAMP_TO_EDGE,
+        .addressModeW = VK_SAMPLER_ADDRESS_MODE_CLAMP_TO_EDGE,
+        .anisotropyEnable = VK_FALSE,
+        .borderColor = VK_BORDER_COLOR_INT_OPAQUE_BLACK,
+        .unnormalizedCoordinates = VK_FALSE,
+        .compareEnable = VK_FALSE,
+        .mipmapMode = VK_SAMPLER_MIPMAP_MODE_LINEAR,
+    };
+    if (vkCreateSampler(ap->device, &sampler_info, NULL,
+                        &ap->texture_sampler) != VK_SUCCESS) {
+      ap->texture_sampler = VK_NULL_HANDLE;
+      printf("[Stygian AP VK] Failed to create sampler\n");
+      return 0;
+    }
+  }
+
   // Create image
   VkImageCreateInfo image_info = {
       .sType = VK_STRUCTURE_TYPE_IMAGE_CREATE_INFO,
       .imageType = VK_IMAGE_TYPE_2D,
       .format = VK_FORMAT_R8G8B8A8_UNORM,
-      .extent = {.width = w, .height = h, .depth = 1},
+      .extent = {.width = (uint32_t)w, .height = (uint32_t)h, .depth = 1},
       .mipLevels = 1,
       .arrayLayers = 1,
       .samples = VK_SAMPLE_COUNT_1_BIT,
@@ -2223,232 +3175,86 @@ StygianAPTexture stygian_ap_texture_create(StygianAP *ap, int w, int h,
       .sharingMode = VK_SHARING_MODE_EXCLUSIVE,
       .initialLayout = VK_IMAGE_LAYOUT_UNDEFINED,
   };
-
-  VkImage image;
-  if (vkCreateImage(ap->device, &image_info, NULL, &image) != VK_SUCCESS) {
+  if (vkCreateImage(ap->device, &image_info, NULL, &tex->image) !=
+      VK_SUCCESS) {
+    tex->image = VK_NULL_HANDLE;
     printf("[Stygian AP VK] Failed to create texture image\n");
     return 0;
   }
 
-  // Allocate memory
-  VkMemoryRequirements mem_reqs;
-  vkGetImageMemoryRequirements(ap->device, image, &mem_reqs);
-
-  VkMemoryAllocateInfo alloc_info = {
-      .sType = VK_STRUCTURE_TYPE_MEMORY_ALLOCATE_INFO,
-      .allocationSize = mem_reqs.size,
-      .memoryTypeIndex =
-          find_memory_type(ap->physical_device, mem_reqs.memoryTypeBits,
-                           VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT),
-  };
-
-  VkDeviceMemory memory;
-  if (vkAllocateMemory(ap->device, &alloc_info, NULL, &memory) != VK_SUCCESS) {
-    vkDestroyImage(ap->device, image, NULL);
+  // Place it in a shared device-local block
+  if (!vk_image_memory_bind(ap, tex)) {
+    vk_texture_release(ap, tex);
     printf("[Stygian AP VK] Failed to allocate texture memory\n");
     return 0;
   }
 
-  vkBindImageMemory(ap->device, image, memory, 0);
-
-  // Create staging buffer
-  VkDeviceSize image_size = w * h * 4;
-  VkBuffer staging_buffer;
-  VkDeviceMemory staging_memory;
-
-  VkBufferCreateInfo buffer_info = {
-      .sType = VK_STRUCTURE_TYPE_BUFFER_CREATE_INFO,
-      .size = image_size,
-      .usage = VK_BUFFER_USAGE_TRANSFER_SRC_BIT,
-      .sharingMode = VK_SHARING_MODE_EXCLUSIVE,
-  };
-
-  vkCreateBuffer(ap->device, &buffer_info, NULL, &staging_buffer);
-
-  VkMemoryRequirements buf_mem_reqs;
-  vkGetBufferMemoryRequirements(ap->device, staging_buffer, &buf_mem_reqs);
-
-  VkMemoryAllocateInfo buf_alloc = {
-      .sType = VK_STRUCTURE_TYPE_MEMORY_ALLOCATE_INFO,
-      .allocationSize = buf_mem_reqs.size,
-      .memoryTypeIndex =
-          find_memory_type(ap->physical_device, buf_mem_reqs.memoryTypeBits,
-                           VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT |
-                               VK_MEMORY_PROPERTY_HOST_COHERENT_BIT),
-  };
-
-  vkAllocateMemory(ap->device, &buf_alloc, NULL, &staging_memory);
-  vkBindBufferMemory(ap->device, staging_buffer, staging_memory, 0);
-
-  // Upload to staging buffer
-  void *data;
-  vkMapMemory(ap->device, staging_memory, 0, image_size, 0, &data);
-  memcpy(data, rgba, image_size);
-  vkUnmapMemory(ap->device, staging_memory);
-
-  // Create one-time command buffer for copy
-  VkCommandBufferAllocateInfo cmd_alloc = {
-      .sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_ALLOCATE_INFO,
-      .commandPool = ap->command_pool,
-      .level = VK_COMMAND_BUFFER_LEVEL_PRIMARY,
-      .commandBufferCount = 1,
-  };
-
-  VkCommandBuffer cmd;
-  vkAllocateCommandBuffers(ap->device, &cmd_alloc, &cmd);
-
-  VkCommandBufferBeginInfo begin_info = {
-      .sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO,
-      .flags = VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT,
-  };
-
-  vkBeginCommandBuffer(cmd, &begin_info);
-
-  // Transition image to TRANSFER_DST_OPTIMAL
-  VkImageMemoryBarrier barrier = {
-      .sType = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER,
-      .oldLayout = VK_IMAGE_LAYOUT_UNDEFINED,
-      .newLayout = VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL,
-      .srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED,
-      .dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED,
-      .image = image,
-      .subresourceRange = {VK_IMAGE_ASPECT_COLOR_BIT, 0, 1, 0, 1},
-      .srcAccessMask = 0,
-      .dstAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT,
-  };
-
-  vkCmdPipelineBarrier(cmd, VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT,
-                       VK_PIPELINE_STAGE_TRANSFER_BIT, 0, 0, NULL, 0, NULL, 1,
-                       &barrier);
-
-  // Copy buffer to image
-  VkBufferImageCopy region = {
-      .bufferOffset = 0,
-      .bufferRowLength = 0,
-      .bufferImageHeight = 0,
-      .imageSubresource = {VK_IMAGE_ASPECT_COLOR_BIT, 0, 0, 1},
-      .imageOffset = {0, 0, 0},
-      .imageExtent = {w, h, 1},
-  };
-
-  vkCmdCopyBufferToImage(cmd, staging_buffer, image,
-                         VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, 1, &region);
-
-  // Transition to SHADER_READ_ONLY_OPTIMAL
-  barrier.oldLayout = VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL;
-  barrier.newLayout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
-  barrier.srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
-  barrier.dstAccessMask = VK_ACCESS_SHADER_READ_BIT;
-
-  vkCmdPipelineBarrier(cmd, VK_PIPELINE_STAGE_TRANSFER_BIT,
-                       VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT, 0, 0, NULL, 0,
-                       NULL, 1, &barrier);
-
-  vkEndCommandBuffer(cmd);
-
-  // Submit and wait
-  VkSubmitInfo submit_info = {
-      .sType = VK_STRUCTURE_TYPE_SUBMIT_INFO,
-      .commandBufferCount = 1,
-      .pCommandBuffers = &cmd,
-  };
-
-  vkQueueSubmit(ap->graphics_queue, 1, &submit_info, VK_NULL_HANDLE);
-  vkQueueWaitIdle(ap->graphics_queue);
-
-  vkFreeCommandBuffers(ap->device, ap->command_pool, 1, &cmd);
-  vkDestroyBuffer(ap->device, staging_buffer, NULL);
-  vkFreeMemory(ap->device, staging_memory, NULL);
-
-  // Create image view
   VkImageViewCreateInfo view_info = {
       .sType = VK_STRUCTURE_TYPE_IMAGE_VIEW_CREATE_INFO,
-      .image = image,
+      .image = tex->image,
       .viewType = VK_IMAGE_VIEW_TYPE_2D,
       .format = VK_FORMAT_R8G8B8A8_UNORM,
       .subresourceRange = {VK_IMAGE_ASPECT_COLOR_BIT, 0, 1, 0, 1},
   };
-
-  VkImageView view;
-  if (vkCreateImageView(ap->device, &view_info, NULL, &view) != VK_SUCCESS) {
-    vkDestroyImage(ap->device, image, NULL);
-    vkFreeMemory(ap->device, memory, NULL);
+  if (vkCreateImageView(ap->device, &view_info, NULL, &tex->view) !=
+      VK_SUCCESS) {
+    tex->view = VK_NULL_HANDLE;
+    vk_texture_release(ap, tex);
     printf("[Stygian AP VK] Failed to create image view\n");
     return 0;
   }
 
-  // Create sampler
-  VkSamplerCreateInfo sampler_info = {
-      .sType = VK_STRUCTURE_TYPE_SAMPLER_CREATE_INFO,
-      .magFilter = VK_FILTER_LINEAR,
-      .minFilter = VK_FILTER_LINEAR,
-      .addressModeU = VK_SAMPLER_ADDRESS_MODE_CLAMP_TO_EDGE,
-      .addressModeV = VK_SAMPLER_ADDRESS_MODE_CLAMP_TO_EDGE,
-      .addressModeW = VK_SAMPLER_ADDRESS_MODE_CLAMP_TO_EDGE,
-      .anisotropyEnable = VK_FALSE,
-      .borderColor = VK_BORDER_COLOR_INT_OPAQUE_BLACK,
-      .unnormalizedCoordinates = VK_FALSE,
-      .compareEnable = VK_FALSE,
-      .mipmapMode = VK_SAMPLER_MIPMAP_MODE_LINEAR,
-  };
-
-  VkSampler sampler;
-  if (vkCreateSampler(ap->device, &sampler_info, NULL, &sampler) !=
-      VK_SUCCESS) {
-    vkDestroyImageView(ap->device, view, NULL);
-    vkDestroyImage(ap->device, image, NULL);
-    vkFreeMemory(ap->device, memory, NULL);
-    printf("[Stygian AP VK] Failed to create sampler\n");
+  // Staged copy, submitted with the next frame (no queue wait)
+  if (!vk_texture_upload(ap, tex, 0, 0, w, h, rgba, true)) {
+    vk_texture_release(ap, tex);
+    printf("[Stygian AP VK] Failed to stage texture upload\n");
     return 0;
   }
+  tex->width = w;
+  tex->height = h;
 
-  // Store font texture
-  ap->font_image = image;
-  ap->font_memory = memory;
-  ap->font_view = view;
-  ap->font_sampler = sampler;
-
-  // Update descriptor set with font texture (binding 1)
-  VkDescriptorImageInfo desc_image_info = {
-      .sampler = sampler,
-      .imageView = view,
-      .imageLayout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL,
-  };
-
-  VkWriteDescriptorSet descriptor_write = {
-      .sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET,
-      .dstSet = ap->descriptor_set,
-      .dstBinding = 1,
-      .dstArrayElement = 0,
-      .descriptorType = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER,
-      .descriptorCount = 1,
-      .pImageInfo = &desc_image_info,
-  };
-
-  vkUpdateDescriptorSets(ap->device, 1, &descriptor_write, 0, NULL);
-  update_image_sampler_array(ap);
-
-  printf("[Stygian AP VK] Texture created: %dx%d\n", w, h);
-  return (StygianAPTexture)1;
+  // Descriptor sets need a valid image before the font is set explicitly.
+  if (!ap->font_view) {
+    ap->font_view = tex->view;
+    ap->font_sampler = ap->texture_sampler;
+    vk_font_descriptors_changed(ap);
+  }
+  return (StygianAPTexture)(index + 1u);
 }
 
 bool stygian_ap_texture_update(StygianAP *ap, StygianAPTexture tex, int x,
                                int y, int w, int h, const void *rgba) {
-  (void)ap;
-  (void)tex;
-  (void)x;
-  (void)y;
-  (void)w;
-  (void)h;
-  (void)rgba;
-  return false;
+  StygianVKTexture *t = vk_texture_get(ap, tex);
+  if (!t || !rgba || w <= 0 || h <= 0 || x < 0 || y < 0 ||
+      x + w > t->width || y + h > t->height)
+    return false;
+  return vk_texture_upload(ap, t, x, y, w, h, rgba, false);
 }
 
 void stygian_ap_texture_destroy(StygianAP *ap, StygianAPTexture tex) {
-  if (!ap || !tex)
+  StygianVKTexture *t = vk_texture_get(ap, tex);
+  StygianVKRetired item;
+  if (!t)
     return;
 
-  // TODO: Destroy VkImage and free memory
+  if (ap->font_view == t->view) {
+    // Keep the descriptor sets pointing at a live image.
+    ap->font_view = VK_NULL_HANDLE;
+    for (uint32_t i = 0; i < STYGIAN_VK_MAX_TEXTURES; i++) {
+      if (ap->textures[i].view && &ap->textures[i] != t) {
+        ap->font_view = ap->textures[i].view;
+        break;
+      }
+    }
+    if (ap->font_view)
+      vk_font_descriptors_changed(ap);
+  }
+
+  // Frames in flight (and the one being recorded) may still sample it.
+  memset(&item, 0, sizeof(item));
+  item.texture = *t;
+  memset(t, 0, sizeof(*t));
+  vk_retire(ap, &item);
 }
 
 void stygian_ap_texture_bind(StygianAP *ap, StygianAPTexture tex,
@@ -2463,31 +3269,17 @@ void stygian_ap_texture_bind(StygianAP *ap, StygianAPTexture tex,
 
 void stygian_ap_set_font_texture(StygianAP *ap, StygianAPTexture tex,
                                  int atlas_w, int atlas_h, float px_range) {
-  if (!ap || !tex)
+  StygianVKTexture *t = vk_texture_get(ap, tex);
+  if (!t)
     return;
   ap->atlas_width = atlas_w > 0 ? (float)atlas_w : 1.0f;
   ap->atlas_height = atlas_h > 0 ? (float)atlas_h : 1.0f;
   ap->px_range = px_range > 0.0f ? px_range : 4.0f;
+  ap->font_view = t->view;
+  ap->font_sampler = ap->texture_sampler;
 
-  // Update descriptor set with font texture (binding 1)
-  VkDescriptorImageInfo image_info = {
-      .sampler = ap->font_sampler,
-      .imageView = ap->font_view,
-      .imageLayout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL,
-  };
-
-  VkWriteDescriptorSet descriptor_write = {
-      .sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET,
-      .dstSet = ap->descriptor_set,
-      .dstBinding = 1,
-      .dstArrayElement = 0,
-      .descriptorType = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER,
-      .descriptorCount = 1,
-      .pImageInfo = &image_info,
-  };
-
-  vkUpdateDescriptorSets(ap->device, 1, &descriptor_write, 0, NULL);
-  update_image_sampler_array(ap);
+  // Binding 1 and the image array, as each frame's set becomes idle
+  vk_font_descriptors_changed(ap);
   printf("[Stygian AP VK] Font texture bound: %dx%d, px_range=%.1f\n", atlas_w,
          atlas_h, px_range);
 }
@@ -2509,21 +3301,40 @@ void stygian_ap_set_output_color_transform(
   ap->output_dst_gamma = dst_gamma > 0.0f ? dst_gamma : 2.2f;
 }
 
-void stygian_ap_set_clips(StygianAP *ap, const float *clips, uint32_t count) {
-  if (!ap || ap->clip_ssbo_memory == VK_NULL_HANDLE)
+void stygian_ap_set_output_color_lut(StygianAP *ap, const uint16_t *rgba16,
+                                     uint32_t size) {
+  // The Vulkan pipeline has no 3D LUT binding yet; the push-constant
+  // analytic transform stays in effect.
+  (void)ap;
+  (void)rgba16;
+  (void)size;
+}
+
+void stygian_ap_set_clips(StygianAP *ap, const float *clips, uint32_t count,
+                          uint32_t first_changed) {
+  const size_t rect = sizeof(float) * 4;
+  StygianVKFrameResources *fr;
+  if (!ap)
     return;
-  if (!clips || count == 0)
+  // Every copy loses what changed, even when no frame is open to take it.
+  for (uint32_t f = 0; f < STYGIAN_VK_FRAMES_IN_FLIGHT; f++) {
+    if (ap->frames[f].clip_valid > first_changed)
+      ap->frames[f].clip_valid = first_changed;
+  }
+  // Only the current frame's copy is written (after begin_frame waited on
+  // its fence); it copies just the entries it lacks.
+  fr = &ap->frames[ap->current_frame];
+  if (!ap->frame_active || !fr->clip_mapped || !clips || count == 0)
     return;
-  if (count > STYGIAN_MAX_CLIPS)
-    count = STYGIAN_MAX_CLIPS;
-
-  void *data = NULL;
-  if (vkMapMemory(ap->device, ap->clip_ssbo_memory, 0, VK_WHOLE_SIZE, 0,
-                  &data) != VK_SUCCESS) {
+  if (count > ap->max_clips)
+    count = ap->max_clips;
+  if (fr->clip_valid >= count)
     return;
-  }
-  memcpy(data, clips, count * sizeof(float) * 4);
-  vkUnmapMemory(ap->device, ap->clip_ssbo_memory);
+
+  memcpy((unsigned char *)fr->clip_mapped + fr->clip_valid * rect,
+         clips + (size_t)fr->clip_valid * 4u,
+         (count - fr->clip_valid) * rect);
+  fr->clip_valid = count;
 }
 
 bool stygian_ap_reload_shaders(StygianAP *ap) {
@@ -2894,12 +3705,22 @@ void stygian_ap_surface_begin(StygianAP *ap, StygianAPSurface *surface,
   vkCmdSetViewport(surface->command_buffer, 0, 1, &viewport);
   vkCmdSetScissor(surface->command_buffer, 0, 1, &scissor);
 
-  // Bind pipeline and descriptors
+  // Bind pipeline and descriptors. Floating surfaces draw the newest upload;
+  // the main frame loop does not rewrite it for another
+  // STYGIAN_VK_FRAMES_IN_FLIGHT - 1 frames.
   vkCmdBindPipeline(surface->command_buffer, VK_PIPELINE_BIND_POINT_GRAPHICS,
                     ap->graphics_pipeline);
+  // A font change after that frame began left its set stale; refresh it
+  // once the main frame using it is done (this surface waited above).
+  if ((ap->font_descriptors_stale & (1u << ap->upload_frame)) &&
+      ap->upload_frame != ap->current_frame &&
+      vkGetFenceStatus(ap->device, ap->in_flight[ap->upload_frame]) ==
+          VK_SUCCESS)
+    vk_refresh_font_descriptors(ap, ap->upload_frame);
   vkCmdBindDescriptorSets(surface->command_buffer,
                           VK_PIPELINE_BIND_POINT_GRAPHICS, ap->pipeline_layout,
-                          0, 1, &ap->descriptor_set, 0, NULL);
+                          0, 1, &ap->frames[ap->upload_frame].descriptor_set,
+                          0, NULL);
   surface->frame_active = true;
 }
 
@@ -0,0 +1,5 @@
+@echo off
+setlocal
+cd /d "%~dp0\..\.."
+powershell -NoProfile -ExecutionPolicy Bypass -File compile\windows\build.ps1 -Target color_transform_bench %*
+exit /b %ERRORLEVEL%
\ No newline at end of file
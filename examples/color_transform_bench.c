@@ -0,0 +1,166 @@
+// color_transform_bench.c - RGBA8 profile transform throughput and accuracy
+// Transforms a synthetic 4096x4096 atlas between every pair of built-in
+// profiles with the per-pixel reference and with the table kernel at each
+// supported ISA. Fails if a kernel strays more than 1 code value from the
+// reference or if ISA levels disagree.
+//
+//   color_transform_bench [--size PX] [--iterations N]
+
+#include "../include/stygian_color.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+static double now_seconds(void) {
+  struct timespec ts;
+  timespec_get(&ts, TIME_UTC);
+  return (double)ts.tv_sec + (double)ts.tv_nsec / 1000000000.0;
+}
+
+static const char *isa_name(StygianColorIsa isa) {
+  switch (isa) {
+  case STYGIAN_COLOR_ISA_SSE2:
+    return "sse2";
+  case STYGIAN_COLOR_ISA_AVX2:
+    return "avx2";
+  default:
+    return "scalar";
+  }
+}
+
+static const char *space_name(StygianColorSpace space) {
+  switch (space) {
+  case STYGIAN_COLOR_SPACE_DISPLAY_P3:
+    return "p3";
+  case STYGIAN_COLOR_SPACE_BT2020:
+    return "bt2020";
+  default:
+    return "srgb";
+  }
+}
+
+// Smooth gradients with a hashed low byte, so every channel value occurs and
+// neighbouring pixels differ like an MTSDF atlas does.
+static void fill_atlas(uint8_t *rgba, uint32_t size) {
+  uint32_t x, y;
+  for (y = 0; y < size; y++) {
+    for (x = 0; x < size; x++) {
+      uint8_t *p = rgba + ((size_t)y * size + x) * 4u;
+      uint32_t h = (x * 73856093u) ^ (y * 19349663u);
+      p[0] = (uint8_t)(x * 255u / (size - 1u));
+      p[1] = (uint8_t)(y * 255u / (size - 1u));
+      p[2] = (uint8_t)(h >> 7);
+      p[3] = (uint8_t)(h >> 15);
+    }
+  }
+}
+
+static int max_channel_diff(const uint8_t *a, const uint8_t *b, size_t n) {
+  int worst = 0;
+  size_t i;
+  for (i = 0; i < n; i++) {
+    int d = (int)a[i] - (int)b[i];
+    if (d < 0)
+      d = -d;
+    if (d > worst)
+      worst = d;
+  }
+  return worst;
+}
+
+int main(int argc, char **argv) {
+  static const StygianColorSpace spaces[3] = {
+      STYGIAN_COLOR_SPACE_SRGB, STYGIAN_COLOR_SPACE_DISPLAY_P3,
+      STYGIAN_COLOR_SPACE_BT2020};
+  uint32_t size = 4096u;
+  int iterations = 3;
+  size_t pixels, bytes;
+  uint8_t *source, *reference, *work, *first;
+  bool failed = false;
+  int s, d, level;
+
+  for (int i = 1; i < argc; i++) {
+    if (strcmp(argv[i], "--size") == 0 && (i + 1) < argc) {
+      size = (uint32_t)strtoul(argv[++i], NULL, 10);
+      if (size < 2u)
+        size = 2u;
+    } else if (strcmp(argv[i], "--iterations") == 0 && (i + 1) < argc) {
+      iterations = atoi(argv[++i]);
+      if (iterations < 1)
+        iterations = 1;
+    }
+  }
+
+  pixels = (size_t)size * size;
+  bytes = pixels * 4u;
+  source = (uint8_t *)malloc(bytes);
+  reference = (uint8_t *)malloc(bytes);
+  work = (uint8_t *)malloc(bytes);
+  first = (uint8_t *)malloc(bytes);
+  if (!source || !reference || !work || !first) {
+    fprintf(stderr, "[ERROR] out of memory for a %ux%u atlas\n", size, size);
+    free(source);
+    free(reference);
+    free(work);
+    free(first);
+    return 2;
+  }
+  fill_atlas(source, size);
+
+  for (s = 0; s < 3; s++) {
+    for (d = 0; d < 3; d++) {
+      StygianColorProfile src, dst;
+      double start, elapsed;
+      stygian_color_profile_init_builtin(&src, spaces[s]);
+      stygian_color_profile_init_builtin(&dst, spaces[d]);
+
+      memcpy(reference, source, bytes);
+      start = now_seconds();
+      stygian_color_transform_rgba8_reference(&src, &dst, reference, pixels);
+      elapsed = now_seconds() - start;
+      printf("PERFCASE scenario=color_rgba8 src=%s dst=%s kernel=reference "
+             "size=%u mpix_per_s=%.1f ms=%.2f\n",
+             space_name(spaces[s]), space_name(spaces[d]), size,
+             (double)pixels / elapsed / 1000000.0, elapsed * 1000.0);
+
+      for (level = STYGIAN_COLOR_ISA_SCALAR; level <= STYGIAN_COLOR_ISA_AVX2;
+           level++) {
+        int max_diff;
+        if (level > (int)stygian_color_best_isa())
+          break; // Not supported on this CPU
+        start = now_seconds();
+        for (int it = 0; it < iterations; it++) {
+          memcpy(work, source, bytes);
+          stygian_color_transform_rgba8_isa(&src, &dst, work, pixels,
+                                            (StygianColorIsa)level);
+        }
+        elapsed = (now_seconds() - start) / (double)iterations;
+        max_diff = max_channel_diff(reference, work, bytes);
+        printf("PERFCASE scenario=color_rgba8 src=%s dst=%s kernel=%s "
+               "size=%u mpix_per_s=%.1f ms=%.2f max_diff=%d\n",
+               space_name(spaces[s]), space_name(spaces[d]),
+               isa_name((StygianColorIsa)level), size,
+               (double)pixels / elapsed / 1000000.0, elapsed * 1000.0,
+               max_diff);
+        if (max_diff > 1)
+          failed = true;
+        if (level == STYGIAN_COLOR_ISA_SCALAR)
+          memcpy(first, work, bytes);
+        else if (memcmp(first, work, bytes) != 0)
+          failed = true;
+      }
+    }
+  }
+
+  free(source);
+  free(reference);
+  free(work);
+  free(first);
+  if (failed) {
+    fprintf(stderr, "[FAIL] table kernels exceed 1 code value of the "
+                    "reference or differ between ISA levels\n");
+    return 1;
+  }
+  return 0;
+}
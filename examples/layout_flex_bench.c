@@ -0,0 +1,179 @@
+// layout_flex_bench.c - Flex layout build and compute time for a large tree
+// Builds a settings-style page (rows of label, spacer, wrapped chip group and
+// value) of about --nodes nodes in a frame arena and lays it out, repeating
+// --iterations times. With --budget-ms, fails if the average build + compute
+// exceeds it. tests/run_perf_gates.ps1 gates the default -O0 build; the
+// target for an optimized build (under 1 ms for 10k nodes) only reports.
+//
+// Then keeps the same page in a retained tree and times compute per frame
+// with nothing changed (static) and with one label edited (edit).
+//
+//   layout_flex_bench [--nodes N] [--iterations N] [--budget-ms MS]
+
+#include "../layout/stygian_layout.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#define NODES_PER_ROW 10u
+
+static double now_seconds(void) {
+  struct timespec ts;
+  timespec_get(&ts, TIME_UTC);
+  return (double)ts.tv_sec + (double)ts.tv_nsec / 1000000000.0;
+}
+
+// Stand-in for text: a width that varies per item, one line tall.
+static void measure_label(void *user, float max_w, float max_h, float *out_w,
+                          float *out_h) {
+  uint32_t seed = (uint32_t)(uintptr_t)user;
+  (void)max_w;
+  (void)max_h;
+  *out_w = 40.0f + (float)((seed * 2654435761u) >> 26);
+  *out_h = 18.0f;
+}
+
+static double elapsed_ms(double start, int iterations) {
+  return (now_seconds() - start) * 1000.0 / (double)iterations;
+}
+
+static StygianFlexNode build_page(StygianFlex *flex, uint32_t rows) {
+  StygianFlexNode root = stygian_flex_node(
+      flex, 0u,
+      &(StygianFlexStyle){.dir = STYGIAN_LAYOUT_COLUMN,
+                          .align = STYGIAN_ALIGN_STRETCH,
+                          .gap = 4.0f,
+                          .padding = 12.0f});
+  for (uint32_t r = 0; r < rows; r++) {
+    StygianFlexNode row, label, group, value;
+    row = stygian_flex_node(flex, root,
+                            &(StygianFlexStyle){.dir = STYGIAN_LAYOUT_ROW,
+                                                .align = STYGIAN_ALIGN_CENTER,
+                                                .gap = 8.0f,
+                                                .padding = 4.0f});
+    label = stygian_flex_node(flex, row,
+                              &(StygianFlexStyle){.min_w = 60.0f,
+                                                  .max_w = 220.0f,
+                                                  .shrink = 1.0f});
+    stygian_flex_measure(flex, label, measure_label,
+                         (void *)(uintptr_t)(r + 1u));
+    stygian_flex_node(flex, row, &(StygianFlexStyle){.grow = 1.0f});
+    group = stygian_flex_node(flex, row,
+                              &(StygianFlexStyle){.dir = STYGIAN_LAYOUT_ROW,
+                                                  .wrap = true,
+                                                  .gap = 4.0f,
+                                                  .line_gap = 4.0f,
+                                                  .max_w = 240.0f,
+                                                  .shrink = 1.0f});
+    for (uint32_t c = 0; c < 5u; c++) {
+      StygianFlexNode chip =
+          stygian_flex_node(flex, group,
+                            &(StygianFlexStyle){.height = 20.0f,
+                                                .min_w = 32.0f,
+                                                .padding = 6.0f});
+      stygian_flex_measure(flex, chip, measure_label,
+                           (void *)(uintptr_t)(r * 8u + c));
+    }
+    value = stygian_flex_node(
+        flex, row, &(StygianFlexStyle){.width = 120.0f, .height = 24.0f});
+    (void)value;
+  }
+  return root;
+}
+
+int main(int argc, char **argv) {
+  uint32_t nodes = 10000u, rows;
+  int iterations = 200;
+  double budget_ms = 0.0;
+  double build = 0.0, compute = 0.0, total_ms;
+  StygianArena *arena;
+  float x, y, w, h;
+
+  for (int i = 1; i < argc; i++) {
+    if (strcmp(argv[i], "--nodes") == 0 && (i + 1) < argc) {
+      nodes = (uint32_t)strtoul(argv[++i], NULL, 10);
+    } else if (strcmp(argv[i], "--iterations") == 0 && (i + 1) < argc) {
+      iterations = atoi(argv[++i]);
+      if (iterations < 1)
+        iterations = 1;
+    } else if (strcmp(argv[i], "--budget-ms") == 0 && (i + 1) < argc) {
+      budget_ms = atof(argv[++i]);
+    }
+  }
+  rows = nodes / NODES_PER_ROW;
+  if (rows < 1u)
+    rows = 1u;
+
+  arena = stygian_arena_create(16u * 1024u * 1024u);
+  if (!arena) {
+    fprintf(stderr, "[ERROR] out of memory for the arena\n");
+    return 2;
+  }
+
+  for (int it = 0; it < iterations; it++) {
+    StygianFlex *flex;
+    StygianFlexNode root;
+    double t0, t1, t2;
+    stygian_arena_reset(arena);
+    t0 = now_seconds();
+    flex = stygian_flex_begin_arena(arena);
+    stygian_flex_reserve(flex, rows * NODES_PER_ROW + 1u);
+    root = build_page(flex, rows);
+    t1 = now_seconds();
+    stygian_flex_compute(flex, root, 0.0f, 0.0f, 960.0f, 0.0f);
+    t2 = now_seconds();
+    build += t1 - t0;
+    compute += t2 - t1;
+    if (it == iterations - 1) {
+      stygian_flex_rect(flex, root, &x, &y, &w, &h);
+      nodes = stygian_flex_node_count(flex);
+    }
+  }
+  build = build * 1000.0 / (double)iterations;
+  compute = compute * 1000.0 / (double)iterations;
+  total_ms = build + compute;
+  printf("PERFCASE scenario=flex_layout nodes=%u build_ms=%.3f "
+         "compute_ms=%.3f total_ms=%.3f page_h=%.0f\n",
+         nodes, build, compute, total_ms, h);
+
+  stygian_arena_destroy(arena);
+
+  {
+    StygianFlex *flex = stygian_flex_create(NULL);
+    StygianFlexNode root;
+    double t0, first_ms, static_ms, edit_ms;
+    if (!flex || !stygian_flex_reserve(flex, rows * NODES_PER_ROW + 1u)) {
+      fprintf(stderr, "[ERROR] out of memory for the retained tree\n");
+      stygian_flex_destroy(flex);
+      return 2;
+    }
+    root = build_page(flex, rows);
+    t0 = now_seconds();
+    stygian_flex_compute(flex, root, 0.0f, 0.0f, 960.0f, 0.0f);
+    first_ms = elapsed_ms(t0, 1);
+    t0 = now_seconds();
+    for (int it = 0; it < iterations; it++)
+      stygian_flex_compute(flex, root, 0.0f, 0.0f, 960.0f, 0.0f);
+    static_ms = elapsed_ms(t0, iterations);
+    t0 = now_seconds();
+    for (int it = 0; it < iterations; it++) {
+      // Row r's label is node 3 + r * NODES_PER_ROW.
+      uint32_t r = (uint32_t)it % rows;
+      stygian_flex_invalidate(flex, 3u + r * NODES_PER_ROW);
+      stygian_flex_compute(flex, root, 0.0f, 0.0f, 960.0f, 0.0f);
+    }
+    edit_ms = elapsed_ms(t0, iterations);
+    printf("PERFCASE scenario=flex_layout_incremental nodes=%u first_ms=%.3f "
+           "static_ms=%.4f edit_ms=%.4f\n",
+           stygian_flex_node_count(flex), first_ms, static_ms, edit_ms);
+    stygian_flex_destroy(flex);
+  }
+
+  if (budget_ms > 0.0 && total_ms > budget_ms) {
+    fprintf(stderr, "[FAIL] flex layout took %.3f ms, budget %.3f ms\n",
+            total_ms, budget_ms);
+    return 1;
+  }
+  return 0;
+}
@@ -27,8 +27,21 @@ typedef enum PerfScenario {
   PERF_SCENARIO_CLIP = 3,
   PERF_SCENARIO_SCROLL = 4,
   PERF_SCENARIO_TEXT = 5,
+  PERF_SCENARIO_TEXT_LARGE = 6,
+  PERF_SCENARIO_EMOJI_CHAT = 7,
 } PerfScenario;
 
+// text_large: scroll a 1M-line document; build cost must not track length.
+#define PERF_TEXT_LARGE_LINES 1000000u
+#define PERF_TEXT_LARGE_STEP_ROWS 4099u
+
+// emoji_chat: chat log dense with shortcodes (mount a pack with --triad);
+// the window slides over PERF_EMOJI_DISTINCT ids so the inline emoji cache
+// fills up and then churns. Build cost must stay flat as occupancy grows.
+#define PERF_EMOJI_DISTINCT 480u
+#define PERF_EMOJI_PER_LINE 8u
+#define PERF_EMOJI_STEP 5u
+
 typedef struct PerfIntervalStats {
   uint32_t render_frames;
   uint32_t eval_frames;
@@ -61,6 +74,10 @@ static const char *scenario_name(PerfScenario scenario) {
     return "scroll";
   case PERF_SCENARIO_TEXT:
     return "text";
+  case PERF_SCENARIO_TEXT_LARGE:
+    return "text_large";
+  case PERF_SCENARIO_EMOJI_CHAT:
+    return "emoji_chat";
   default:
     return "idle";
   }
@@ -79,6 +96,10 @@ static PerfScenario parse_scenario(const char *name) {
     return PERF_SCENARIO_SCROLL;
   if (strcmp(name, "text") == 0)
     return PERF_SCENARIO_TEXT;
+  if (strcmp(name, "text_large") == 0)
+    return PERF_SCENARIO_TEXT_LARGE;
+  if (strcmp(name, "emoji_chat") == 0)
+    return PERF_SCENARIO_EMOJI_CHAT;
   return PERF_SCENARIO_IDLE;
 }
 
@@ -226,6 +247,30 @@ static bool render_scroll_rows(StygianContext *ctx, StygianFont font,
   return changed;
 }
 
+static bool fill_large_text(StygianTextBuffer *text, uint32_t line_total) {
+  char chunk[65536];
+  size_t used = 0u;
+  stygian_text_buffer_clear(text);
+  for (uint32_t i = 0u; i < line_total; i++) {
+    char line[96];
+    int n = snprintf(line, sizeof(line),
+                     "%07u  let value = stygian::mutate(row_%u);\n", i + 1u,
+                     i % 977u);
+    if (n <= 0 || (size_t)n >= sizeof(line))
+      return false;
+    if (used + (size_t)n > sizeof(chunk)) {
+      if (!stygian_text_buffer_insert(text, stygian_text_buffer_length(text),
+                                      chunk, used))
+        return false;
+      used = 0u;
+    }
+    memcpy(chunk + used, line, (size_t)n);
+    used += (size_t)n;
+  }
+  return stygian_text_buffer_insert(text, stygian_text_buffer_length(text),
+                                    chunk, used);
+}
+
 static void render_text_scene(StygianContext *ctx, StygianFont font,
                               StygianTextArea *editor) {
   stygian_rect_rounded(ctx, editor->x - 6.0f, editor->y - 6.0f,
@@ -234,6 +279,33 @@ static void render_text_scene(StygianContext *ctx, StygianFont font,
   stygian_text_area(ctx, font, editor);
 }
 
+static void render_emoji_chat(StygianContext *ctx, StygianFont font,
+                              uint32_t tick, int width, int height) {
+  float row_h = stygian_font_line_height(ctx, font, 16.0f) + 6.0f;
+  uint32_t rows;
+  if (row_h <= 7.0f)
+    row_h = 24.0f;
+  rows = (uint32_t)(((float)height - 130.0f) / row_h);
+  stygian_clip_push(ctx, 30.0f, 74.0f, (float)width - 60.0f,
+                    (float)height - 120.0f);
+  for (uint32_t r = 0u; r < rows; r++) {
+    char line[512];
+    uint32_t msg = tick * PERF_EMOJI_STEP + r;
+    int n = snprintf(line, sizeof(line), "user_%02u: ", msg % 37u);
+    for (uint32_t k = 0u; k < PERF_EMOJI_PER_LINE; k++) {
+      uint32_t cp = 0x1F300u + (msg * PERF_EMOJI_PER_LINE + k * 7u) %
+                                   PERF_EMOJI_DISTINCT;
+      if (n <= 0 || (size_t)n >= sizeof(line))
+        break;
+      n += snprintf(line + n, sizeof(line) - (size_t)n, ":emoji_u%x: ok ",
+                    cp);
+    }
+    stygian_text(ctx, font, line, 40.0f, 80.0f + (float)r * row_h, 16.0f,
+                 0.82f, 0.86f, 0.92f, 1.0f);
+  }
+  stygian_clip_pop(ctx);
+}
+
 int main(int argc, char **argv) {
   PerfScenario scenario = PERF_SCENARIO_IDLE;
   int duration_seconds = 12;
@@ -249,7 +321,7 @@ int main(int argc, char **argv) {
   uint32_t tick_count = 0u;
   float auto_scroll_y = 0.0f;
   float auto_scroll_dir = 1.0f;
-  char editor_buffer[32768];
+  StygianTextBuffer *editor_text;
   StygianTextArea editor_state;
   StygianMiniPerfHarness perf;
   PerfIntervalStats interval_stats;
@@ -261,6 +333,7 @@ int main(int argc, char **argv) {
   const StygianScopeId k_scope_perf =
       STYGIAN_OVERLAY_SCOPE_BASE | (StygianScopeId)0x4304u;
   const char *scenario_label;
+  const char *triad_path = NULL;
   StygianWindowConfig win_cfg;
   StygianWindow *window;
   StygianConfig cfg;
@@ -276,6 +349,8 @@ int main(int argc, char **argv) {
         duration_seconds = 2;
     } else if (strcmp(argv[i], "--no-perf") == 0) {
       show_perf = false;
+    } else if (strcmp(argv[i], "--triad") == 0 && (i + 1) < argc) {
+      triad_path = argv[++i];
     }
   }
 
@@ -297,6 +372,8 @@ int main(int argc, char **argv) {
   cfg.max_elements = 0u;
   cfg.max_textures = 0u;
   cfg.glyph_feature_flags = 0u;
+  cfg.emoji_atlas_budget = 0u;
+  cfg.max_clips = 0u;
   cfg.window = window;
   cfg.shader_dir = NULL;
   cfg.persistent_allocator = NULL;
@@ -305,17 +382,30 @@ int main(int argc, char **argv) {
   if (!ctx)
     return 1;
   font = stygian_font_load(ctx, "assets/atlas.png", "assets/atlas.json");
+  if (triad_path && !stygian_triad_mount(ctx, triad_path)) {
+    fprintf(stderr, "[WARN] failed to mount triad pack %s\n", triad_path);
+  }
 
   memset(&interval_stats, 0, sizeof(interval_stats));
-  memset(editor_buffer, 0, sizeof(editor_buffer));
-  snprintf(editor_buffer, sizeof(editor_buffer),
-           "// pathological text churn\n"
-           "let perf = stygian::perf();\n"
-           "fn mutate() { /* append */ }\n");
+  editor_text = stygian_text_buffer_create(0u);
+  if (!editor_text)
+    return 1;
+  {
+    static const char k_initial_text[] = "// pathological text churn\n"
+                                         "let perf = stygian::perf();\n"
+                                         "fn mutate() { /* append */ }\n";
+    stygian_text_buffer_set(editor_text, k_initial_text,
+                            sizeof(k_initial_text) - 1u);
+  }
+  if (scenario == PERF_SCENARIO_TEXT_LARGE &&
+      !fill_large_text(editor_text, PERF_TEXT_LARGE_LINES)) {
+    stygian_text_buffer_destroy(editor_text);
+    return 1;
+  }
   memset(&editor_state, 0, sizeof(editor_state));
-  editor_state.buffer = editor_buffer;
-  editor_state.buffer_size = (int)sizeof(editor_buffer);
-  editor_state.cursor_idx = (int)strlen(editor_buffer);
+  editor_state.text = editor_text;
+  editor_state.no_wrap = scenario == PERF_SCENARIO_TEXT_LARGE;
+  editor_state.cursor_idx = (int)stygian_text_buffer_length(editor_text);
   editor_state.selection_start = editor_state.cursor_idx;
   editor_state.selection_end = editor_state.cursor_idx;
 
@@ -401,16 +491,26 @@ int main(int argc, char **argv) {
         }
         scene_dynamic_changed = true;
       } else if (scenario == PERF_SCENARIO_TEXT) {
-        size_t len = strlen(editor_buffer);
-        if (len + 3 < sizeof(editor_buffer)) {
-          editor_buffer[len] = (char)('a' + (tick_count % 26u));
-          editor_buffer[len + 1] = '\n';
-          editor_buffer[len + 2] = '\0';
+        size_t len = stygian_text_buffer_length(editor_text);
+        char churn[2] = {(char)('a' + (tick_count % 26u)), '\n'};
+        if (len + 2u < 32768u &&
+            stygian_text_buffer_insert(editor_text, len, churn, 2u)) {
           editor_state.cursor_idx = (int)(len + 2u);
           editor_state.selection_start = editor_state.cursor_idx;
           editor_state.selection_end = editor_state.cursor_idx;
           scene_dynamic_changed = true;
         }
+      } else if (scenario == PERF_SCENARIO_TEXT_LARGE) {
+        float row_h = stygian_font_line_height(ctx, font, 16.0f);
+        if (row_h <= 1.0f)
+          row_h = 18.0f;
+        editor_state.scroll_y += row_h * (float)PERF_TEXT_LARGE_STEP_ROWS;
+        if (editor_state.total_height > editor_state.h &&
+            editor_state.scroll_y >= editor_state.total_height - editor_state.h)
+          editor_state.scroll_y = 0.0f;
+        scene_dynamic_changed = true;
+      } else if (scenario == PERF_SCENARIO_EMOJI_CHAT) {
+        scene_dynamic_changed = true;
       }
     }
 
@@ -488,12 +588,15 @@ int main(int argc, char **argv) {
       if (render_scroll_rows(ctx, font, &auto_scroll_y, width, height)) {
         scene_dynamic_changed = true;
       }
-    } else if (scenario == PERF_SCENARIO_TEXT) {
+    } else if (scenario == PERF_SCENARIO_TEXT ||
+               scenario == PERF_SCENARIO_TEXT_LARGE) {
       editor_state.x = 30.0f;
       editor_state.y = 74.0f;
       editor_state.w = (float)width - 60.0f;
       editor_state.h = (float)height - 120.0f;
       render_text_scene(ctx, font, &editor_state);
+    } else if (scenario == PERF_SCENARIO_EMOJI_CHAT && font) {
+      render_emoji_chat(ctx, font, tick_count, width, height);
     }
     stygian_scope_end(ctx);
 
@@ -557,6 +660,8 @@ int main(int argc, char **argv) {
     interval_log(&interval_stats, scenario_label, second_index, ctx);
   }
 
+  stygian_text_area_free(&editor_state);
+  stygian_text_buffer_destroy(editor_text);
   if (font)
     stygian_font_destroy(ctx, font);
   stygian_destroy(ctx);
@@ -47,23 +47,28 @@ int main(void) {
   StygianFont font =
       stygian_font_load(ctx, "assets/atlas.png", "assets/atlas.json");
   StygianMiniPerfHarness perf;
-  char editor_buffer[32768];
+  StygianTextBuffer *editor_text;
   StygianTextArea editor_state;
   bool first_frame = true;
   bool show_perf = true;
 
   stygian_mini_perf_init(&perf, "text_editor_mini");
   perf.widget.renderer_name = STYGIAN_MINI_RENDERER_NAME;
-  memset(editor_buffer, 0, sizeof(editor_buffer));
-  snprintf(editor_buffer, sizeof(editor_buffer),
-           "// Stygian mini editor\n"
-           "int main(void) {\n"
-           "  return 0;\n"
-           "}\n");
+  editor_text = stygian_text_buffer_create(0u);
+  if (!editor_text)
+    return 1;
+  {
+    static const char k_initial_text[] = "// Stygian mini editor\n"
+                                         "int main(void) {\n"
+                                         "  return 0;\n"
+                                         "}\n";
+    stygian_text_buffer_set(editor_text, k_initial_text,
+                            sizeof(k_initial_text) - 1u);
+  }
   memset(&editor_state, 0, sizeof(editor_state));
-  editor_state.buffer = editor_buffer;
-  editor_state.buffer_size = (int)sizeof(editor_buffer);
-  editor_state.cursor_idx = (int)strlen(editor_buffer);
+  editor_state.text = editor_text;
+  editor_state.no_wrap = true; // Gutter numbers one row per line
+  editor_state.cursor_idx = (int)stygian_text_buffer_length(editor_text);
   editor_state.selection_start = editor_state.cursor_idx;
   editor_state.selection_end = editor_state.cursor_idx;
 
@@ -146,24 +151,36 @@ int main(void) {
       content_w = (float)width;
       content_h = (float)height - 40.0f;
 
+      editor_state.x = 64.0f;
+      editor_state.y = content_y + 6.0f;
+      editor_state.w = content_w - 72.0f;
+      editor_state.h = content_h - 12.0f;
+
+      // Gutter follows the editor's row window (same line height/scroll).
       stygian_scope_begin(ctx, k_scope_gutter);
       stygian_rect(ctx, content_x, content_y, 64.0f, content_h, 0.09f, 0.11f,
                    0.14f, 1.0f);
       if (font) {
-        for (int line = 0; line < 40; line++) {
+        float row_h = stygian_text_area_row_height(ctx, font);
+        uint32_t line_count = stygian_text_buffer_line_count(editor_text);
+        uint32_t line = (uint32_t)(editor_state.scroll_y / row_h);
+        stygian_clip_push(ctx, content_x, editor_state.y, 64.0f,
+                          editor_state.h);
+        for (; line < line_count; line++) {
           char label[16];
-          snprintf(label, sizeof(label), "%d", line + 1);
-          stygian_text(ctx, font, label, 10.0f, content_y + 8.0f + line * 18.0f,
-                       13.0f, 0.55f, 0.62f, 0.72f, 1.0f);
+          float ly = editor_state.y + (float)line * row_h -
+                     editor_state.scroll_y;
+          if (ly > editor_state.y + editor_state.h)
+            break;
+          snprintf(label, sizeof(label), "%u", line + 1u);
+          stygian_text(ctx, font, label, 10.0f, ly + 2.0f, 13.0f, 0.55f, 0.62f,
+                       0.72f, 1.0f);
         }
+        stygian_clip_pop(ctx);
       }
       stygian_scope_end(ctx);
 
       stygian_scope_begin(ctx, k_scope_rows);
-      editor_state.x = 64.0f;
-      editor_state.y = content_y + 6.0f;
-      editor_state.w = content_w - 72.0f;
-      editor_state.h = content_h - 12.0f;
       if (stygian_text_area(ctx, font, &editor_state)) {
         rows_changed = true;
       }
@@ -195,6 +212,7 @@ int main(void) {
         stygian_scope_invalidate_next(ctx, k_scope_chrome);
       }
       if (rows_changed || event_mutated) {
+        stygian_scope_invalidate_next(ctx, k_scope_gutter);
         stygian_scope_invalidate_next(ctx, k_scope_rows);
       }
       if (!show_perf) {
@@ -213,6 +231,8 @@ int main(void) {
     }
   }
 
+  stygian_text_area_free(&editor_state);
+  stygian_text_buffer_destroy(editor_text);
   if (font)
     stygian_font_destroy(ctx, font);
   stygian_destroy(ctx);
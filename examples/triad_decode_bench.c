@@ -0,0 +1,181 @@
+// triad_decode_bench.c - Decode every entry of a triad pack at each ISA
+// Reports per-decode cost and verifies output is identical across kernels,
+// then breaks size and decode cost down by entry codec (raw/LZSS/zstd).
+//
+//   triad_decode_bench --pack <file.triad> [--iterations N] [--size PX]
+//
+// --size decodes for display at PX (stygian_triad_runtime_decode_rgba_sized)
+// instead of at the full 256 px.
+
+#include "../src/stygian_triad.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+static double now_seconds(void) {
+  struct timespec ts;
+  timespec_get(&ts, TIME_UTC);
+  return (double)ts.tv_sec + (double)ts.tv_nsec / 1000000000.0;
+}
+
+static const char *isa_name(StygianTriadDecodeIsa isa) {
+  switch (isa) {
+  case STYGIAN_TRIAD_ISA_SSE2:
+    return "sse2";
+  case STYGIAN_TRIAD_ISA_AVX2:
+    return "avx2";
+  default:
+    return "scalar";
+  }
+}
+
+// Entry codec ids as stored in the pack
+#define PERF_CODEC_SLOTS 6u
+static const char *codec_name(uint32_t codec) {
+  static const char *names[PERF_CODEC_SLOTS] = {
+      "svg_raw", "svg_lzss", "v34_raw", "v34_lzss", "svg_zstd", "v34_zstd"};
+  return codec < PERF_CODEC_SLOTS ? names[codec] : "unknown";
+}
+
+static uint64_t fnv1a64(uint64_t h, const uint8_t *data, size_t n) {
+  size_t i;
+  for (i = 0; i < n; i++) {
+    h ^= (uint64_t)data[i];
+    h *= 1099511628211ull;
+  }
+  return h;
+}
+
+int main(int argc, char **argv) {
+  const char *pack_path = NULL;
+  int iterations = 5;
+  uint32_t size = 0u;
+  StygianTriadRuntime *rt;
+  StygianTriadPackInfo info;
+  uint64_t reference = 0u;
+  bool have_reference = false;
+  bool mismatch = false;
+  int level;
+
+  for (int i = 1; i < argc; i++) {
+    if (strcmp(argv[i], "--pack") == 0 && (i + 1) < argc) {
+      pack_path = argv[++i];
+    } else if (strcmp(argv[i], "--iterations") == 0 && (i + 1) < argc) {
+      iterations = atoi(argv[++i]);
+      if (iterations < 1)
+        iterations = 1;
+    } else if (strcmp(argv[i], "--size") == 0 && (i + 1) < argc) {
+      size = (uint32_t)strtoul(argv[++i], NULL, 10);
+    }
+  }
+  if (!pack_path) {
+    fprintf(stderr,
+            "usage: %s --pack <file.triad> [--iterations N] [--size PX]\n",
+            argv[0]);
+    return 2;
+  }
+
+  rt = stygian_triad_runtime_create();
+  if (!rt || !stygian_triad_runtime_mount(rt, pack_path) ||
+      !stygian_triad_runtime_get_pack_info(rt, &info)) {
+    fprintf(stderr, "[ERROR] failed to mount %s\n", pack_path);
+    stygian_triad_runtime_destroy(rt);
+    return 2;
+  }
+
+  for (level = STYGIAN_TRIAD_ISA_SCALAR; level <= STYGIAN_TRIAD_ISA_AVX2;
+       level++) {
+    StygianTriadDecodeIsa isa = stygian_triad_runtime_set_decode_isa(
+        rt, (StygianTriadDecodeIsa)level);
+    uint64_t checksum = 1469598103934665603ull;
+    uint32_t decoded = 0u;
+    double start, elapsed;
+    if ((int)isa != level)
+      continue; // Not supported on this CPU
+
+    start = now_seconds();
+    for (int it = 0; it < iterations; it++) {
+      for (uint32_t i = 0; i < info.entry_count; i++) {
+        StygianTriadEntryInfo entry;
+        uint8_t *rgba = NULL;
+        uint32_t w = 0u, h = 0u;
+        if (!stygian_triad_runtime_entry_at(rt, i, &entry) ||
+            !stygian_triad_runtime_decode_rgba_sized(rt, entry.glyph_hash,
+                                                     size, &rgba, &w, &h)) {
+          continue;
+        }
+        if (it == 0)
+          checksum = fnv1a64(checksum, rgba, (size_t)w * h * 4u);
+        decoded++;
+        stygian_triad_runtime_free_blob(rgba);
+      }
+    }
+    elapsed = now_seconds() - start;
+
+    printf("PERFCASE scenario=triad_decode isa=%s size=%u entries=%u "
+           "iterations=%d decoded=%u us_per_decode=%.2f checksum=%016llx\n",
+           isa_name(isa), size ? size : 256u, info.entry_count, iterations,
+           decoded,
+           decoded ? elapsed * 1000000.0 / (double)decoded : 0.0,
+           (unsigned long long)checksum);
+
+    if (!have_reference) {
+      reference = checksum;
+      have_reference = true;
+    } else if (checksum != reference) {
+      mismatch = true;
+    }
+  }
+
+  // Per-codec breakdown at the best ISA: stored vs raw payload bytes and
+  // full decode cost (inflate + reconstruction).
+  stygian_triad_runtime_set_decode_isa(rt, STYGIAN_TRIAD_ISA_AVX2);
+  for (uint32_t codec = 0u; codec < PERF_CODEC_SLOTS; codec++) {
+    uint64_t stored = 0u, raw = 0u;
+    uint32_t count = 0u, decoded = 0u;
+    double start, elapsed;
+    for (uint32_t i = 0; i < info.entry_count; i++) {
+      StygianTriadEntryInfo entry;
+      if (stygian_triad_runtime_entry_at(rt, i, &entry) &&
+          entry.codec == codec) {
+        stored += entry.payload_size;
+        raw += entry.raw_blob_size;
+        count++;
+      }
+    }
+    if (count == 0u)
+      continue;
+
+    start = now_seconds();
+    for (int it = 0; it < iterations; it++) {
+      for (uint32_t i = 0; i < info.entry_count; i++) {
+        StygianTriadEntryInfo entry;
+        uint8_t *rgba = NULL;
+        uint32_t w = 0u, h = 0u;
+        if (!stygian_triad_runtime_entry_at(rt, i, &entry) ||
+            entry.codec != codec ||
+            !stygian_triad_runtime_decode_rgba_sized(rt, entry.glyph_hash,
+                                                     size, &rgba, &w, &h)) {
+          continue;
+        }
+        decoded++;
+        stygian_triad_runtime_free_blob(rgba);
+      }
+    }
+    elapsed = now_seconds() - start;
+
+    printf("PERFCASE scenario=triad_codec codec=%s entries=%u "
+           "stored_bytes=%llu raw_bytes=%llu ratio=%.3f us_per_decode=%.2f\n",
+           codec_name(codec), count, (unsigned long long)stored,
+           (unsigned long long)raw, raw ? (double)stored / (double)raw : 0.0,
+           decoded ? elapsed * 1000000.0 / (double)decoded : 0.0);
+  }
+
+  stygian_triad_runtime_destroy(rt);
+  if (mismatch) {
+    fprintf(stderr, "[FAIL] decode output differs between ISA levels\n");
+    return 1;
+  }
+  return 0;
+}
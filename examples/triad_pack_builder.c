@@ -0,0 +1,514 @@
+// triad_pack_builder.c - Repack a triad pack with a prebuilt glyph-id index
+// The output keeps every entry (optionally recompressed with zstd and a
+// trained dictionary), sorts the entry table, and appends a hashed index of
+// canonical glyph ids plus aliases so mount and lookup never scan entries.
+//
+//   triad_pack_builder --in <src.triad> --out <dst.triad>
+//                      [--aliases <file>] [--zstd <level>] [--dict <bytes>]
+//
+// Alias file: one "alias target" pair per line ('#' starts a comment); both
+// sides are canonicalized, so ":thumbsup: 1f44d" works. Skin-tone and
+// VS16 spellings of codepoint-named glyphs are added automatically when the
+// pack lacks a dedicated entry.
+
+#include "../src/stygian_triad.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <zdict.h>
+#include <zstd.h>
+
+// On-disk layout; must match stygian_triad.c.
+typedef struct PackHeader {
+  char magic[8];
+  uint32_t version;
+  uint32_t encoding;
+  uint32_t tier;
+  uint32_t entry_count;
+  uint64_t data_offset;
+  uint64_t zstd_dict_offset;
+  uint32_t zstd_dict_size;
+  uint32_t index_size;
+  uint64_t index_offset;
+  uint8_t pad[8];
+} PackHeader;
+
+typedef struct PackEntry {
+  uint64_t glyph_hash;
+  uint64_t blob_hash;
+  uint64_t payload_offset;
+  uint32_t payload_size;
+  uint32_t raw_blob_size;
+  uint32_t glyph_len;
+  uint32_t codec;
+} PackEntry;
+
+typedef struct PackIndexHeader {
+  char magic[8];
+  uint32_t slot_count;
+  uint32_t key_count;
+  uint32_t string_bytes;
+  uint32_t reserved;
+  uint64_t content_hash;
+} PackIndexHeader;
+
+typedef struct PackIndexSlot {
+  uint64_t key_hash;
+  uint32_t name_offset;
+  uint32_t name_len;
+  uint32_t entry_index;
+  uint32_t reserved;
+} PackIndexSlot;
+
+#define CODEC_RAW 0u
+#define CODEC_LZSS 1u
+#define CODEC_V34_RAW 2u
+#define CODEC_V34_LZSS 3u
+#define CODEC_ZSTD 4u
+#define CODEC_V34_ZSTD 5u
+
+#define KEY_MAX 256
+
+typedef struct BuildEntry {
+  PackEntry file;
+  char *glyph_id;  // As stored (not canonical)
+  uint8_t *stored; // Payload bytes written to the pack
+} BuildEntry;
+
+typedef struct BuildKey {
+  char name[KEY_MAX];
+  uint64_t hash;
+  uint32_t entry;
+} BuildKey;
+
+typedef struct KeySet {
+  BuildKey *keys;
+  uint32_t count;
+  uint32_t capacity;
+} KeySet;
+
+static uint64_t fnv1a64(uint64_t h, const void *data, size_t n) {
+  const uint8_t *p = (const uint8_t *)data;
+  size_t i;
+  for (i = 0; i < n; i++) {
+    h ^= (uint64_t)p[i];
+    h *= 1099511628211ull;
+  }
+  return h;
+}
+
+static int key_find(const KeySet *set, const char *name, uint64_t hash) {
+  uint32_t i;
+  for (i = 0; i < set->count; i++) {
+    if (set->keys[i].hash == hash && strcmp(set->keys[i].name, name) == 0)
+      return (int)i;
+  }
+  return -1;
+}
+
+// First spelling wins: real entries are added before aliases and variants.
+static bool key_add(KeySet *set, const char *glyph_id, uint32_t entry) {
+  char name[KEY_MAX];
+  uint64_t hash = stygian_triad_canonical_glyph_id(glyph_id, name,
+                                                   sizeof(name));
+  if (hash == 0u || key_find(set, name, hash) >= 0)
+    return false;
+  if (set->count == set->capacity) {
+    uint32_t cap = set->capacity ? set->capacity * 2u : 256u;
+    BuildKey *grown =
+        (BuildKey *)realloc(set->keys, (size_t)cap * sizeof(BuildKey));
+    if (!grown)
+      return false;
+    set->keys = grown;
+    set->capacity = cap;
+  }
+  memcpy(set->keys[set->count].name, name, sizeof(name));
+  set->keys[set->count].hash = hash;
+  set->keys[set->count].entry = entry;
+  set->count++;
+  return true;
+}
+
+static int key_cmp(const void *a, const void *b) {
+  return strcmp(((const BuildKey *)a)->name, ((const BuildKey *)b)->name);
+}
+
+static bool is_skin_tone(const char *cp, size_t n) {
+  return n == 5u && strncmp(cp, "1f3f", 4) == 0 && cp[4] >= 'b' &&
+         cp[4] <= 'f';
+}
+
+// Skin-tone and VS16 spellings of "emoji_u<seq>" keys that resolve to the
+// same entry when the pack has no dedicated glyph for them.
+static uint32_t add_variants(KeySet *set, uint32_t primary_count) {
+  static const char *tones[5] = {"1f3fb", "1f3fc", "1f3fd", "1f3fe", "1f3ff"};
+  uint32_t added = 0u;
+  uint32_t k;
+  for (k = 0; k < primary_count; k++) {
+    char base[KEY_MAX];
+    char stripped[KEY_MAX];
+    char variant[KEY_MAX + 16];
+    const char *seq;
+    const char *p;
+    size_t sn = 0;
+    bool has_fe0f = false, has_tone = false;
+    uint32_t parts = 0u, entry = set->keys[k].entry;
+    int t;
+
+    memcpy(base, set->keys[k].name, sizeof(base));
+    if (strncmp(base, "emoji_u", 7) != 0)
+      continue;
+    seq = base + 7;
+    for (p = seq; *p;) {
+      size_t n = strcspn(p, "_");
+      if (n == 4u && strncmp(p, "fe0f", 4) == 0) {
+        has_fe0f = true;
+      } else {
+        if (is_skin_tone(p, n))
+          has_tone = true;
+        if (sn)
+          stripped[sn++] = '_';
+        memcpy(stripped + sn, p, n);
+        sn += n;
+        parts++;
+      }
+      p += n;
+      if (*p == '_')
+        p++;
+    }
+    stripped[sn] = '\0';
+
+    if (has_fe0f) {
+      snprintf(variant, sizeof(variant), "emoji_u%s", stripped);
+      added += key_add(set, variant, entry) ? 1u : 0u;
+    } else if (parts == 1u) {
+      snprintf(variant, sizeof(variant), "emoji_u%s_fe0f", stripped);
+      added += key_add(set, variant, entry) ? 1u : 0u;
+    }
+    if (!has_tone && parts == 1u) {
+      for (t = 0; t < 5; t++) {
+        snprintf(variant, sizeof(variant), "emoji_u%s_%s", stripped,
+                 tones[t]);
+        added += key_add(set, variant, entry) ? 1u : 0u;
+      }
+    }
+  }
+  return added;
+}
+
+static uint32_t load_aliases(KeySet *set, const char *path) {
+  char line[1024];
+  uint32_t added = 0u;
+  FILE *f = fopen(path, "r");
+  if (!f) {
+    fprintf(stderr, "[WARN] cannot open alias file %s\n", path);
+    return 0u;
+  }
+  while (fgets(line, sizeof(line), f)) {
+    char alias[KEY_MAX], target[KEY_MAX], canon[KEY_MAX];
+    char *comment = strchr(line, '#');
+    uint64_t hash;
+    int found;
+    if (comment)
+      *comment = '\0';
+    if (sscanf(line, "%255s %255s", alias, target) != 2)
+      continue;
+    hash = stygian_triad_canonical_glyph_id(target, canon, sizeof(canon));
+    if (hash == 0u)
+      continue;
+    found = key_find(set, canon, hash);
+    if (found < 0) {
+      fprintf(stderr, "[WARN] alias %s -> unknown glyph %s\n", alias, target);
+      continue;
+    }
+    added += key_add(set, alias, set->keys[found].entry) ? 1u : 0u;
+  }
+  fclose(f);
+  return added;
+}
+
+static uint32_t zstd_codec_for(uint32_t codec) {
+  return (codec == CODEC_V34_RAW || codec == CODEC_V34_LZSS ||
+          codec == CODEC_V34_ZSTD)
+             ? CODEC_V34_ZSTD
+             : CODEC_ZSTD;
+}
+
+static void usage(const char *argv0) {
+  fprintf(stderr,
+          "usage: %s --in <src.triad> --out <dst.triad> [--aliases <file>] "
+          "[--zstd <level>] [--dict <bytes>]\n",
+          argv0);
+}
+
+int main(int argc, char **argv) {
+  const char *in_path = NULL, *out_path = NULL, *alias_path = NULL;
+  int zstd_level = 0;
+  size_t dict_capacity = 0u;
+  StygianTriadRuntime *rt;
+  StygianTriadPackInfo info;
+  BuildEntry *entries;
+  KeySet keys = {0};
+  uint8_t **raw = NULL;
+  uint8_t *dict = NULL;
+  size_t dict_size = 0u;
+  uint32_t primary, alias_count, variant_count;
+  uint32_t slot_count, string_bytes;
+  uint64_t offset, content_hash, data_bytes = 0u;
+  PackHeader header;
+  PackIndexHeader ih;
+  PackIndexSlot *slots;
+  char *strings;
+  FILE *out;
+  uint32_t i;
+  int rc = 1;
+
+  for (int a = 1; a < argc; a++) {
+    if (strcmp(argv[a], "--in") == 0 && (a + 1) < argc)
+      in_path = argv[++a];
+    else if (strcmp(argv[a], "--out") == 0 && (a + 1) < argc)
+      out_path = argv[++a];
+    else if (strcmp(argv[a], "--aliases") == 0 && (a + 1) < argc)
+      alias_path = argv[++a];
+    else if (strcmp(argv[a], "--zstd") == 0 && (a + 1) < argc)
+      zstd_level = atoi(argv[++a]);
+    else if (strcmp(argv[a], "--dict") == 0 && (a + 1) < argc)
+      dict_capacity = (size_t)strtoul(argv[++a], NULL, 10);
+  }
+  if (!in_path || !out_path) {
+    usage(argv[0]);
+    return 2;
+  }
+
+  rt = stygian_triad_runtime_create();
+  if (!rt || !stygian_triad_runtime_mount(rt, in_path) ||
+      !stygian_triad_runtime_get_pack_info(rt, &info)) {
+    fprintf(stderr, "[ERROR] failed to mount %s\n", in_path);
+    stygian_triad_runtime_destroy(rt);
+    return 2;
+  }
+
+  // Gather entries in glyph-hash order (the runtime keeps its table sorted).
+  entries = (BuildEntry *)calloc(info.entry_count, sizeof(BuildEntry));
+  raw = (uint8_t **)calloc(info.entry_count, sizeof(uint8_t *));
+  if (!entries || !raw)
+    goto done;
+  for (i = 0; i < info.entry_count; i++) {
+    StygianTriadEntryInfo e;
+    const uint8_t *packed = NULL;
+    BuildEntry *b = &entries[i];
+    uint32_t raw_n = 0u;
+    if (!stygian_triad_runtime_entry_at(rt, i, &e) ||
+        !stygian_triad_runtime_payload_view(rt, e.glyph_hash, NULL,
+                                            &packed) ||
+        !stygian_triad_runtime_read_payload(rt, e.glyph_hash, &raw[i],
+                                            &raw_n)) {
+      fprintf(stderr, "[ERROR] unreadable entry %u\n", i);
+      goto done;
+    }
+    b->file.glyph_hash = e.glyph_hash;
+    b->file.blob_hash = e.blob_hash;
+    b->file.raw_blob_size = e.raw_blob_size;
+    b->file.glyph_len = e.glyph_len;
+    b->file.codec = e.codec;
+    b->file.payload_size = e.payload_size;
+    b->glyph_id = (char *)calloc(1, (size_t)e.glyph_len + 1u);
+    b->stored = (uint8_t *)malloc(e.payload_size);
+    if (!b->glyph_id || !b->stored)
+      goto done;
+    memcpy(b->glyph_id, packed - e.glyph_len, e.glyph_len); // Id precedes
+    memcpy(b->stored, packed, e.payload_size);
+  }
+
+  if (zstd_level > 0) {
+    ZSTD_CCtx *cctx = ZSTD_createCCtx();
+    ZSTD_CDict *cdict = NULL;
+    if (!cctx)
+      goto done;
+    if (dict_capacity > 0u) {
+      size_t *sizes = (size_t *)calloc(info.entry_count, sizeof(size_t));
+      uint8_t *samples;
+      size_t total = 0u, at = 0u;
+      for (i = 0; i < info.entry_count; i++)
+        total += entries[i].file.raw_blob_size;
+      samples = (uint8_t *)malloc(total ? total : 1u);
+      dict = (uint8_t *)malloc(dict_capacity);
+      if (sizes && samples && dict) {
+        for (i = 0; i < info.entry_count; i++) {
+          sizes[i] = entries[i].file.raw_blob_size;
+          memcpy(samples + at, raw[i], sizes[i]);
+          at += sizes[i];
+        }
+        dict_size = ZDICT_trainFromBuffer(dict, dict_capacity, samples, sizes,
+                                          info.entry_count);
+        if (ZDICT_isError(dict_size)) {
+          fprintf(stderr, "[WARN] dictionary training failed: %s\n",
+                  ZDICT_getErrorName(dict_size));
+          dict_size = 0u;
+        }
+      }
+      free(sizes);
+      free(samples);
+      if (dict_size > 0u)
+        cdict = ZSTD_createCDict(dict, dict_size, zstd_level);
+    }
+    for (i = 0; i < info.entry_count; i++) {
+      BuildEntry *b = &entries[i];
+      size_t cap = ZSTD_compressBound(b->file.raw_blob_size);
+      uint8_t *packed = (uint8_t *)malloc(cap);
+      size_t n;
+      if (!packed)
+        break;
+      n = cdict ? ZSTD_compress_usingCDict(cctx, packed, cap, raw[i],
+                                           b->file.raw_blob_size, cdict)
+                : ZSTD_compressCCtx(cctx, packed, cap, raw[i],
+                                    b->file.raw_blob_size, zstd_level);
+      if (ZSTD_isError(n)) {
+        free(packed);
+        continue; // Keep the original encoding for this entry
+      }
+      free(b->stored);
+      b->stored = packed;
+      b->file.payload_size = (uint32_t)n;
+      b->file.codec = zstd_codec_for(b->file.codec);
+    }
+    ZSTD_freeCDict(cdict);
+    ZSTD_freeCCtx(cctx);
+    if (i < info.entry_count)
+      goto done;
+  }
+
+  // Keys: canonical ids of real entries, then aliases, then variants.
+  for (i = 0; i < info.entry_count; i++) {
+    if (!key_add(&keys, entries[i].glyph_id, i))
+      fprintf(stderr, "[WARN] duplicate or empty glyph id '%s'\n",
+              entries[i].glyph_id);
+  }
+  primary = keys.count;
+  alias_count = alias_path ? load_aliases(&keys, alias_path) : 0u;
+  variant_count = add_variants(&keys, primary);
+  if (keys.count == 0u)
+    goto done;
+
+  // Layout: header | entries | dictionary | (glyph id + payload)* | index
+  offset = sizeof(PackHeader) + (uint64_t)info.entry_count * sizeof(PackEntry);
+  memset(&header, 0, sizeof(header));
+  memcpy(header.magic, "TRIAD01", 8);
+  header.version = info.version;
+  header.encoding = info.encoding;
+  header.tier = info.tier;
+  header.entry_count = info.entry_count;
+  header.data_offset = offset;
+  if (dict_size > 0u) {
+    header.zstd_dict_offset = offset;
+    header.zstd_dict_size = (uint32_t)dict_size;
+    offset += dict_size;
+  }
+  for (i = 0; i < info.entry_count; i++) {
+    entries[i].file.payload_offset = offset;
+    offset += (uint64_t)entries[i].file.glyph_len + entries[i].file.payload_size;
+  }
+  offset = (offset + 7u) & ~7ull;
+
+  // Sorted string table; slots sized for a load factor of at most 1/2.
+  qsort(keys.keys, keys.count, sizeof(BuildKey), key_cmp);
+  slot_count = 16u;
+  while (slot_count < keys.count * 2u)
+    slot_count *= 2u;
+  string_bytes = 0u;
+  for (i = 0; i < keys.count; i++)
+    string_bytes += (uint32_t)strlen(keys.keys[i].name) + 1u;
+  slots = (PackIndexSlot *)calloc(slot_count, sizeof(PackIndexSlot));
+  strings = (char *)calloc(1, string_bytes ? string_bytes : 1u);
+  if (!slots || !strings) {
+    free(slots);
+    free(strings);
+    goto done;
+  }
+  string_bytes = 0u;
+  for (i = 0; i < keys.count; i++) {
+    const BuildKey *k = &keys.keys[i];
+    uint32_t len = (uint32_t)strlen(k->name);
+    uint32_t s = (uint32_t)k->hash & (slot_count - 1u);
+    while (slots[s].name_len != 0u)
+      s = (s + 1u) & (slot_count - 1u);
+    slots[s].key_hash = k->hash;
+    slots[s].name_offset = string_bytes;
+    slots[s].name_len = len;
+    slots[s].entry_index = k->entry;
+    memcpy(strings + string_bytes, k->name, len + 1u);
+    string_bytes += len + 1u;
+  }
+
+  content_hash = 1469598103934665603ull;
+  for (i = 0; i < info.entry_count; i++)
+    content_hash = fnv1a64(content_hash, &entries[i].file, sizeof(PackEntry));
+  content_hash = fnv1a64(content_hash, dict, dict_size);
+  for (i = 0; i < info.entry_count; i++) {
+    content_hash = fnv1a64(content_hash, entries[i].stored,
+                           entries[i].file.payload_size);
+    data_bytes += entries[i].file.payload_size;
+  }
+
+  memset(&ih, 0, sizeof(ih));
+  memcpy(ih.magic, "TRIDX01", 8);
+  ih.slot_count = slot_count;
+  ih.key_count = keys.count;
+  ih.string_bytes = string_bytes;
+  ih.content_hash = content_hash;
+  header.index_offset = offset;
+  header.index_size = (uint32_t)(sizeof(ih) +
+                                 (size_t)slot_count * sizeof(PackIndexSlot) +
+                                 string_bytes);
+
+  out = fopen(out_path, "wb");
+  if (!out) {
+    fprintf(stderr, "[ERROR] cannot write %s\n", out_path);
+    free(slots);
+    free(strings);
+    goto done;
+  }
+  fwrite(&header, sizeof(header), 1, out);
+  for (i = 0; i < info.entry_count; i++)
+    fwrite(&entries[i].file, sizeof(PackEntry), 1, out);
+  if (dict_size > 0u)
+    fwrite(dict, 1, dict_size, out);
+  for (i = 0; i < info.entry_count; i++) {
+    fwrite(entries[i].glyph_id, 1, entries[i].file.glyph_len, out);
+    fwrite(entries[i].stored, 1, entries[i].file.payload_size, out);
+  }
+  while ((uint64_t)ftell(out) < header.index_offset)
+    fputc(0, out);
+  fwrite(&ih, sizeof(ih), 1, out);
+  fwrite(slots, sizeof(PackIndexSlot), slot_count, out);
+  fwrite(strings, 1, string_bytes, out);
+  rc = ferror(out) ? 1 : 0;
+  fclose(out);
+  free(slots);
+  free(strings);
+
+  if (rc == 0) {
+    printf("[OK] %s entries=%u keys=%u aliases=%u variants=%u "
+           "payload_bytes=%llu dict_bytes=%zu index_bytes=%u\n",
+           out_path, info.entry_count, keys.count, alias_count, variant_count,
+           (unsigned long long)data_bytes, dict_size, header.index_size);
+  }
+
+done:
+  if (entries) {
+    for (i = 0; i < info.entry_count; i++) {
+      free(entries[i].glyph_id);
+      free(entries[i].stored);
+      if (raw)
+        stygian_triad_runtime_free_blob(raw[i]);
+    }
+  }
+  free(entries);
+  free(raw);
+  free(dict);
+  free(keys.keys);
+  stygian_triad_runtime_destroy(rt);
+  if (rc != 0)
+    fprintf(stderr, "[FAIL] pack build failed\n");
+  return rc;
+}
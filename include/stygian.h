@@ -33,7 +33,7 @@ extern "C" {
 #endif
 
 #ifndef STYGIAN_MAX_CLIPS
-#define STYGIAN_MAX_CLIPS 256
+#define STYGIAN_MAX_CLIPS 65536
 #endif
 
 #ifndef STYGIAN_DEFAULT_TRIAD_DIR
@@ -47,6 +47,7 @@ extern "C" {
 typedef uint32_t StygianElement; // Opaque element handle (0 = invalid)
 typedef uint32_t StygianTexture; // Opaque texture handle (0 = invalid)
 typedef uint32_t StygianFont;    // Opaque font handle (0 = invalid)
+typedef uint32_t StygianClipId;  // Clip rect id (0 = no clip)
 typedef uint64_t StygianScopeId; // Opaque retained scope id (0 = invalid)
 
 // DDI: Overlay scope ID range (separate tick domain from base UI)
@@ -94,20 +95,22 @@ typedef enum StygianGlyphFeatureFlags {
   STYGIAN_GLYPH_DECODE_ON_ZOOM = 1u << 4,
   STYGIAN_GLYPH_DECODE_ON_CACHE_MISS = 1u << 5,
   STYGIAN_GLYPH_CACHE_ENABLED = 1u << 6,
+  STYGIAN_GLYPH_DECODE_ASYNC = 1u << 7, // Decode on worker threads
 } StygianGlyphFeatureFlags;
 
 #define STYGIAN_GLYPH_FEATURE_DEFAULT                                          \
   (STYGIAN_GLYPH_TRIAD_PRIMARY | STYGIAN_GLYPH_TRIAD_FALLBACK_R8 |             \
    STYGIAN_GLYPH_FALLBACK_MTSDF | STYGIAN_GLYPH_PREDECODE_STARTUP |            \
    STYGIAN_GLYPH_DECODE_ON_ZOOM | STYGIAN_GLYPH_DECODE_ON_CACHE_MISS |         \
-   STYGIAN_GLYPH_CACHE_ENABLED)
+   STYGIAN_GLYPH_CACHE_ENABLED | STYGIAN_GLYPH_DECODE_ASYNC)
 
 #define STYGIAN_GLYPH_FEATURE_DGPU_INTERACTIVE STYGIAN_GLYPH_FEATURE_DEFAULT
 
 #define STYGIAN_GLYPH_FEATURE_IGPU_BG_DECODE                                   \
   (STYGIAN_GLYPH_TRIAD_PRIMARY | STYGIAN_GLYPH_TRIAD_FALLBACK_R8 |             \
    STYGIAN_GLYPH_FALLBACK_MTSDF | STYGIAN_GLYPH_PREDECODE_STARTUP |            \
-   STYGIAN_GLYPH_DECODE_ON_CACHE_MISS | STYGIAN_GLYPH_CACHE_ENABLED)
+   STYGIAN_GLYPH_DECODE_ON_CACHE_MISS | STYGIAN_GLYPH_CACHE_ENABLED |          \
+   STYGIAN_GLYPH_DECODE_ASYNC)
 
 typedef enum StygianGlyphPath {
   STYGIAN_GLYPH_PATH_TRIAD_BC4 = 0,
@@ -149,7 +152,9 @@ typedef struct StygianConfig {
   StygianBackendType backend;
   uint32_t max_elements;        // Default: STYGIAN_MAX_ELEMENTS
   uint32_t max_textures;        // Default: STYGIAN_MAX_TEXTURES
+  uint32_t max_clips;           // Default: STYGIAN_MAX_CLIPS (max 2^23)
   uint32_t glyph_feature_flags; // Default: STYGIAN_GLYPH_FEATURE_DEFAULT
+  uint32_t emoji_atlas_budget;  // Bytes of inline emoji atlas; Default: 8 MiB
   StygianWindow *window;        // Required: window from stygian_window_create()
   const char *shader_dir;       // Optional: Override shader directory
   StygianAllocator *persistent_allocator; // Optional: defaults to CRT allocator
@@ -206,6 +211,12 @@ bool stygian_get_glyph_source_color_profile(const StygianContext *ctx,
                                             StygianColorProfile *out_profile);
 bool stygian_triad_mount(StygianContext *ctx, const char *triad_path);
 void stygian_triad_unmount(StygianContext *ctx);
+// Persist decoded inline-emoji bitmaps under dir (file stygian_emoji.cache,
+// capped at max_bytes; 0 = 64 MiB) so later runs skip triad decode. The
+// cache is keyed to the mounted pack and resets when the pack changes.
+// NULL/"" disables. Applies immediately if a pack is mounted.
+bool stygian_set_emoji_disk_cache(StygianContext *ctx, const char *dir,
+                                  uint64_t max_bytes);
 bool stygian_triad_is_mounted(const StygianContext *ctx);
 bool stygian_triad_get_pack_info(const StygianContext *ctx,
                                  StygianTriadPackInfo *out_info);
@@ -221,6 +232,14 @@ bool stygian_triad_read_svg_blob(const StygianContext *ctx, uint64_t glyph_hash,
 bool stygian_triad_decode_rgba(const StygianContext *ctx, uint64_t glyph_hash,
                                uint8_t **out_rgba_data, uint32_t *out_width,
                                uint32_t *out_height);
+// Decode for display at about target_px (0 = full 256). Output is the
+// smallest power-of-two edge >= target_px (min 8); 128 and below fold the
+// detail band into the LL grid instead of composing 256 px first.
+bool stygian_triad_decode_rgba_sized(const StygianContext *ctx,
+                                     uint64_t glyph_hash, uint32_t target_px,
+                                     uint8_t **out_rgba_data,
+                                     uint32_t *out_width,
+                                     uint32_t *out_height);
 void stygian_triad_free_blob(void *ptr);
 
 // Debug
@@ -266,10 +285,19 @@ void stygian_end_frame(StygianContext *ctx); // Single draw call by default
 bool stygian_is_eval_only_frame(const StygianContext *ctx);
 
 // Frame stats
+// Draw ranges requested so far this frame (one per layer/gap).
 uint32_t stygian_get_frame_draw_calls(const StygianContext *ctx);
+// GPU draw commands the backend issued for the last frame; ranges are batched
+// (adjacent ones merge, the rest go out as one multi-draw where supported).
 uint32_t stygian_get_last_frame_draw_calls(const StygianContext *ctx);
+// Draw ranges requested by the last frame, before batching.
+uint32_t stygian_get_last_frame_draw_ranges(const StygianContext *ctx);
 uint32_t stygian_get_last_frame_element_count(const StygianContext *ctx);
+// Distinct clips pushed during the last frame, plus the window clip (id 0).
 uint32_t stygian_get_last_frame_clip_count(const StygianContext *ctx);
+// Elements left out of the last frame's draws because their bounds lay
+// entirely outside their clip.
+uint32_t stygian_get_last_frame_clip_rejects(const StygianContext *ctx);
 uint32_t stygian_get_last_frame_upload_bytes(const StygianContext *ctx);
 uint32_t stygian_get_last_frame_upload_ranges(const StygianContext *ctx);
 uint32_t stygian_get_last_frame_scope_replay_hits(const StygianContext *ctx);
@@ -280,6 +308,33 @@ float stygian_get_last_frame_build_ms(const StygianContext *ctx);
 float stygian_get_last_frame_submit_ms(const StygianContext *ctx);
 float stygian_get_last_frame_present_ms(const StygianContext *ctx);
 float stygian_get_last_frame_gpu_ms(const StygianContext *ctx);
+// GPU ms per phase of the last timed frame: [0] is the main pass, [1 + i]
+// layer i. Returns the phase count (0 when the backend cannot split, or
+// phase timing is off).
+uint32_t stygian_get_last_frame_gpu_phases(const StygianContext *ctx,
+                                           float *out_ms, uint32_t max_phases);
+// Per-layer GPU timing (off by default). Each phase boundary ends a draw
+// batch, so layered frames issue more draw calls while it is on.
+void stygian_set_gpu_phase_timing(StygianContext *ctx, bool enabled);
+
+// Damage: screen rectangles (pixels, top-left origin) the last rendered frame
+// repainted, covering the old and new footprint of every element that
+// changed. Backends scissor drawing to them and pass them on as present
+// hints where the platform takes them.
+#define STYGIAN_MAX_DAMAGE_RECTS 8
+typedef struct StygianDamageRect {
+  float x, y, w, h;
+} StygianDamageRect;
+// Copies up to max rects into out; returns the frame's rect count. A full
+// repaint reports one rect covering the window, a skipped frame none.
+uint32_t stygian_get_last_frame_damage(const StygianContext *ctx,
+                                       StygianDamageRect *out, uint32_t max);
+// Share of the window's pixels inside the last frame's damage (0..1).
+float stygian_get_last_frame_damage_fraction(const StygianContext *ctx);
+// Damage tracking (on by default). Off, every rendered frame repaints the
+// whole window.
+void stygian_set_damage_tracking(StygianContext *ctx, bool enabled);
+
 uint32_t stygian_get_last_frame_reason_flags(const StygianContext *ctx);
 uint32_t stygian_get_last_frame_eval_only(const StygianContext *ctx);
 uint32_t stygian_get_active_element_count(const StygianContext *ctx);
@@ -287,7 +342,8 @@ uint32_t stygian_get_element_capacity(const StygianContext *ctx);
 uint32_t stygian_get_free_element_count(const StygianContext *ctx);
 uint32_t stygian_get_font_count(const StygianContext *ctx);
 uint32_t stygian_get_inline_emoji_cache_count(const StygianContext *ctx);
-uint16_t stygian_get_clip_capacity(const StygianContext *ctx);
+// Clip rects the context can hold (config max_clips).
+uint32_t stygian_get_clip_capacity(const StygianContext *ctx);
 uint32_t stygian_get_last_commit_applied(const StygianContext *ctx);
 uint32_t stygian_get_total_command_drops(const StygianContext *ctx);
 
@@ -366,15 +422,24 @@ void stygian_set_blur(StygianContext *ctx, StygianElement e, float radius);
 void stygian_set_glow(StygianContext *ctx, StygianElement e, float intensity);
 
 // Clipping
-void stygian_set_clip(StygianContext *ctx, StygianElement e, uint8_t clip_id);
-uint8_t stygian_clip_push(StygianContext *ctx, float x, float y, float w,
-                          float h);
+void stygian_set_clip(StygianContext *ctx, StygianElement e,
+                      StygianClipId clip_id);
+// Push a clip for elements created until the matching pop. The stored rect is
+// the given one cut by the enclosing clip (possibly empty), so nested scroll
+// regions clip to every level. Returns the clip id, 0 when out of clips.
+// Clip rects outlive the frame: pushing a rect already in the table returns
+// its existing id, so clips that repeat across frames keep their ids (and
+// their GPU copy). The table restarts at begin_frame once half full.
+StygianClipId stygian_clip_push(StygianContext *ctx, float x, float y,
+                                float w, float h);
 void stygian_clip_pop(StygianContext *ctx);
 
 // ============================================================================
 // Textures
 // ============================================================================
 
+// Textures up to 256x256 share atlas pages; handles and texture-space UVs
+// behave the same either way (UVs should stay within 0..1 for those).
 StygianTexture stygian_texture_create(StygianContext *ctx, int w, int h,
                                       const void *rgba);
 bool stygian_texture_update(StygianContext *ctx, StygianTexture tex, int x,
@@ -396,6 +461,9 @@ StygianElement stygian_text(StygianContext *ctx, StygianFont font,
 
 float stygian_text_width(StygianContext *ctx, StygianFont font, const char *str,
                          float size);
+// Baseline-to-baseline advance used for '\n' in stygian_text (0 if invalid).
+float stygian_font_line_height(StygianContext *ctx, StygianFont font,
+                               float size);
 
 // ============================================================================
 // Convenience (Immediate-style, uses internal transient pool)
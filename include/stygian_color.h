@@ -13,6 +13,35 @@ typedef enum StygianColorSpace {
   STYGIAN_COLOR_SPACE_BT2020 = 3,
 } StygianColorSpace;
 
+// Per-channel tone response curve (ICC rTRC/gTRC/bTRC). NONE falls back to
+// the profile's srgb_transfer/gamma. PARAMETRIC holds the ICC type-4 form
+// Y = (a*X + b)^g + e for X >= d, else c*X + f, as {g, a, b, c, d, e, f};
+// gamma-only curv tags and every para type map onto it. TABLE points at a
+// curv table resampled to STYGIAN_COLOR_TRC_SAMPLES points.
+#define STYGIAN_COLOR_TRC_SAMPLES 1024
+
+// Sampled curves are interned: equal tables share one immutable object that
+// lives until exit, so profiles stay small, copy by value and compare tables
+// by pointer. Thread-safe.
+typedef struct StygianColorTrcTable StygianColorTrcTable; // Opaque
+
+// samples holds STYGIAN_COLOR_TRC_SAMPLES points. NULL when out of memory.
+const StygianColorTrcTable *
+stygian_color_trc_table_intern(const uint16_t *samples);
+const uint16_t *stygian_color_trc_table_samples(const StygianColorTrcTable *t);
+
+typedef enum StygianColorTrcType {
+  STYGIAN_COLOR_TRC_NONE = 0,
+  STYGIAN_COLOR_TRC_PARAMETRIC = 1,
+  STYGIAN_COLOR_TRC_TABLE = 2,
+} StygianColorTrcType;
+
+typedef struct StygianColorTrc {
+  StygianColorTrcType type;
+  float params[7];
+  const StygianColorTrcTable *table; // TABLE only
+} StygianColorTrc;
+
 typedef struct StygianColorProfile {
   StygianColorSpace space;
   float rgb_to_xyz[9];
@@ -21,6 +50,7 @@ typedef struct StygianColorProfile {
   bool srgb_transfer;
   bool valid;
   char name[64];
+  StygianColorTrc trc[3]; // r, g, b
 } StygianColorProfile;
 
 void stygian_color_profile_init_builtin(StygianColorProfile *profile,
@@ -32,14 +62,78 @@ bool stygian_color_profile_init_custom(StygianColorProfile *profile,
 bool stygian_color_profile_copy(StygianColorProfile *dst,
                                 const StygianColorProfile *src);
 
+// Encoded [0,1] channel value -> linear light, and back, honoring the
+// channel's TRC. Inputs are clamped to [0,1].
+float stygian_color_profile_to_linear(const StygianColorProfile *profile,
+                                      int channel, float v);
+float stygian_color_profile_from_linear(const StygianColorProfile *profile,
+                                        int channel, float v);
+
 // Transform one RGB triplet in-place from src profile to dst profile.
 void stygian_color_transform_rgb_f32(const StygianColorProfile *src,
                                      const StygianColorProfile *dst, float *r,
                                      float *g, float *b);
 
 // Transform RGBA8 buffer in-place. Alpha is preserved.
+// Table-driven and vectorized (best ISA the CPU supports); every channel is
+// within 1 code value of stygian_color_transform_rgba8_reference.
 void stygian_color_transform_rgba8(const StygianColorProfile *src,
                                    const StygianColorProfile *dst,
                                    uint8_t *rgba, size_t pixel_count);
 
+// Per-pixel float path (powf per channel), kept as the accuracy reference.
+void stygian_color_transform_rgba8_reference(const StygianColorProfile *src,
+                                             const StygianColorProfile *dst,
+                                             uint8_t *rgba,
+                                             size_t pixel_count);
+
+// Kernel ISA for the RGBA8 transform. Output is bit-identical across levels.
+typedef enum StygianColorIsa {
+  STYGIAN_COLOR_ISA_SCALAR = 0,
+  STYGIAN_COLOR_ISA_SSE2 = 1,
+  STYGIAN_COLOR_ISA_AVX2 = 2,
+} StygianColorIsa;
+
+StygianColorIsa stygian_color_best_isa(void);
+// As stygian_color_transform_rgba8 with a requested ISA (clamped to the
+// best supported one). Used by benchmarks and tests.
+void stygian_color_transform_rgba8_isa(const StygianColorProfile *src,
+                                       const StygianColorProfile *dst,
+                                       uint8_t *rgba, size_t pixel_count,
+                                       StygianColorIsa isa);
+
+// ============================================================================
+// Cached Transforms
+// ============================================================================
+
+// A built src -> dst transform: per-channel shaper tables for the RGBA8 CPU
+// path plus a size^3 RGBA16 UNORM lattice (red fastest, then green, then
+// blue) for GPU upload. Lattice axes are sqrt-spaced: sample it at
+// sqrt(input). Building costs a few ms, so callers keep one per profile
+// pair.
+#define STYGIAN_COLOR_LUT3D_DEFAULT_SIZE 33u
+
+typedef struct StygianColorTransform StygianColorTransform;
+
+// lut3d_size 0 = default; clamped to [2, 65].
+StygianColorTransform *
+stygian_color_transform_create(const StygianColorProfile *src,
+                               const StygianColorProfile *dst,
+                               uint32_t lut3d_size);
+void stygian_color_transform_destroy(StygianColorTransform *transform);
+
+// Same result as stygian_color_transform_rgba8 without rebuilding tables.
+void stygian_color_transform_apply_rgba8(const StygianColorTransform *transform,
+                                         uint8_t *rgba, size_t pixel_count);
+
+// Lattice for upload: size^3 texels of 4 uint16 (alpha = 65535).
+const uint16_t *
+stygian_color_transform_lut3d(const StygianColorTransform *transform,
+                              uint32_t *out_size);
+
+// Hash of both profiles' conversion-relevant fields (matrix and transfer),
+// for keying transform caches.
+uint64_t stygian_color_profile_pair_key(const StygianColorProfile *src,
+                                        const StygianColorProfile *dst);
+
 #endif // STYGIAN_COLOR_H
@@ -12,7 +12,9 @@ typedef struct StygianICCInfo {
   bool loaded;
 } StygianICCInfo;
 
-// Load ICC profile and populate color profile as best-effort.
+// Load ICC profile and populate color profile as best-effort. Matrix/TRC
+// (shaper) RGB profiles are read exactly: colorants (adapted to D65) and
+// per-channel curv/para tone curves.
 // Returns false if profile cannot be parsed/loaded.
 bool stygian_icc_load_profile(const char *path, StygianColorProfile *out_profile,
                               StygianICCInfo *out_info);
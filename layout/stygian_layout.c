@@ -4,6 +4,7 @@
 #include "../include/stygian_memory.h"
 #include "../src/stygian_internal.h"
 #include "stygian_layout_internal.h"
+#include <stdlib.h>
 #include <string.h>
 
 // ============================================================================
@@ -153,3 +154,715 @@ void stygian_layout_end(StygianContext *ctx, StygianLayout *layout) {
   (void)ctx;
   (void)layout;
 }
+
+// ============================================================================
+// Flex Layout
+// ============================================================================
+
+#define STYGIAN_FLEX_INITIAL_NODES 256u
+
+typedef struct StygianFlexText {
+  StygianContext *ctx;
+  StygianFont font;
+  const char *text; // Copy after the record in retained trees
+  float size;
+  float w, h; // Valid once measured
+  bool measured;
+} StygianFlexText;
+
+StygianFlex *stygian_flex_begin_arena(StygianArena *arena) {
+  StygianFlex *flex;
+  if (!arena)
+    return NULL;
+  flex = (StygianFlex *)stygian_arena_alloc(arena, sizeof(StygianFlex),
+                                            _Alignof(StygianFlex));
+  if (!flex)
+    return NULL;
+  memset(flex, 0, sizeof(*flex));
+  flex->arena = arena;
+  return flex;
+}
+
+StygianFlex *stygian_flex_begin(StygianContext *ctx) {
+  StygianFlex *flex;
+  if (!ctx || !ctx->frame_arena)
+    return NULL;
+  flex = stygian_flex_begin_arena(ctx->frame_arena);
+  if (flex)
+    flex->ctx = ctx;
+  return flex;
+}
+
+StygianFlex *stygian_flex_create(StygianContext *ctx) {
+  StygianFlex *flex = (StygianFlex *)calloc(1, sizeof(StygianFlex));
+  if (flex)
+    flex->ctx = ctx;
+  return flex;
+}
+
+static void flex_measure_text(void *user, float max_w, float max_h,
+                              float *out_w, float *out_h);
+
+void stygian_flex_destroy(StygianFlex *flex) {
+  uint32_t i;
+  if (!flex || flex->arena)
+    return;
+  for (i = 0; i < flex->node_count; i++) {
+    if (flex->nodes[i].measure == flex_measure_text)
+      free(flex->nodes[i].measure_user);
+  }
+  free(flex->nodes);
+  free(flex);
+}
+
+static StygianFlexNodeData *flex_get(const StygianFlex *flex,
+                                     StygianFlexNode node) {
+  if (!flex || node == 0u || node > flex->node_count)
+    return NULL;
+  return &flex->nodes[node - 1u];
+}
+
+// Mark a node and its ancestors for re-measure and re-arrange. Stops at the
+// first ancestor already dirty: its own ancestors are dirty as well.
+static void flex_invalidate(StygianFlex *flex, StygianFlexNode node) {
+  while (node != 0u) {
+    StygianFlexNodeData *n = &flex->nodes[node - 1u];
+    if (n->dirty)
+      return;
+    n->dirty = true;
+    n->measured = false;
+    node = n->parent;
+  }
+}
+
+// Arena trees cannot grow in place: they move to a bigger block and the old
+// one stays allocated until the arena resets. Retained trees realloc.
+static bool flex_grow(StygianFlex *flex, uint32_t capacity) {
+  StygianFlexNodeData *grown;
+  if (!flex->arena) {
+    grown = (StygianFlexNodeData *)realloc(
+        flex->nodes, (size_t)capacity * sizeof(StygianFlexNodeData));
+    if (!grown)
+      return false;
+    flex->nodes = grown;
+    flex->node_capacity = capacity;
+    return true;
+  }
+  grown = (StygianFlexNodeData *)stygian_arena_alloc(
+      flex->arena, (size_t)capacity * sizeof(StygianFlexNodeData),
+      _Alignof(StygianFlexNodeData));
+  if (!grown)
+    return false;
+  if (flex->node_count > 0u)
+    memcpy(grown, flex->nodes,
+           (size_t)flex->node_count * sizeof(StygianFlexNodeData));
+  flex->nodes = grown;
+  flex->node_capacity = capacity;
+  return true;
+}
+
+bool stygian_flex_reserve(StygianFlex *flex, uint32_t node_count) {
+  if (!flex)
+    return false;
+  return node_count <= flex->node_capacity || flex_grow(flex, node_count);
+}
+
+StygianFlexNode stygian_flex_node(StygianFlex *flex, StygianFlexNode parent,
+                                  const StygianFlexStyle *style) {
+  StygianFlexNodeData *n, *p;
+  StygianFlexNode handle;
+  if (!flex || (parent != 0u && parent > flex->node_count))
+    return 0u;
+  if (flex->node_count == flex->node_capacity &&
+      !flex_grow(flex, flex->node_capacity ? flex->node_capacity * 2u
+                                           : STYGIAN_FLEX_INITIAL_NODES))
+    return 0u;
+
+  handle = ++flex->node_count;
+  n = &flex->nodes[handle - 1u];
+  memset(n, 0, sizeof(*n));
+  if (style)
+    n->style = *style;
+  n->parent = parent;
+  n->dirty = true;
+  if (parent != 0u) {
+    p = &flex->nodes[parent - 1u];
+    if (p->last_child != 0u)
+      flex->nodes[p->last_child - 1u].next_sibling = handle;
+    else
+      p->first_child = handle;
+    p->last_child = handle;
+    flex_invalidate(flex, parent);
+  }
+  return handle;
+}
+
+static bool flex_style_equal(const StygianFlexStyle *a,
+                             const StygianFlexStyle *b) {
+  return a->dir == b->dir && a->justify == b->justify &&
+         a->align == b->align && a->wrap == b->wrap && a->gap == b->gap &&
+         a->line_gap == b->line_gap && a->padding == b->padding &&
+         a->width == b->width && a->height == b->height &&
+         a->min_w == b->min_w && a->min_h == b->min_h &&
+         a->max_w == b->max_w && a->max_h == b->max_h &&
+         a->basis == b->basis && a->grow == b->grow && a->shrink == b->shrink;
+}
+
+void stygian_flex_set_style(StygianFlex *flex, StygianFlexNode node,
+                            const StygianFlexStyle *style) {
+  StygianFlexNodeData *n = flex_get(flex, node);
+  StygianFlexStyle zero = {0};
+  if (!n)
+    return;
+  if (!style)
+    style = &zero;
+  if (flex_style_equal(&n->style, style))
+    return;
+  n->style = *style;
+  flex_invalidate(flex, node);
+}
+
+void stygian_flex_invalidate(StygianFlex *flex, StygianFlexNode node) {
+  if (flex_get(flex, node))
+    flex_invalidate(flex, node);
+}
+
+void stygian_flex_detach(StygianFlex *flex, StygianFlexNode node) {
+  StygianFlexNodeData *n = flex_get(flex, node), *p;
+  StygianFlexNode prev = 0u, c;
+  if (!n || n->parent == 0u)
+    return;
+  p = &flex->nodes[n->parent - 1u];
+  for (c = p->first_child; c != node; c = flex->nodes[c - 1u].next_sibling)
+    prev = c;
+  if (prev != 0u)
+    flex->nodes[prev - 1u].next_sibling = n->next_sibling;
+  else
+    p->first_child = n->next_sibling;
+  if (p->last_child == node)
+    p->last_child = prev;
+  flex_invalidate(flex, n->parent);
+  n->parent = 0u;
+  n->next_sibling = 0u;
+}
+
+void stygian_flex_measure(StygianFlex *flex, StygianFlexNode node,
+                          StygianFlexMeasureFn fn, void *user) {
+  StygianFlexNodeData *n = flex_get(flex, node);
+  if (!n || (n->measure == fn && n->measure_user == user))
+    return;
+  if (!flex->arena && n->measure == flex_measure_text)
+    free(n->measure_user);
+  n->measure = fn;
+  n->measure_user = user;
+  flex_invalidate(flex, node);
+}
+
+static void flex_measure_text(void *user, float max_w, float max_h,
+                              float *out_w, float *out_h) {
+  StygianFlexText *t = (StygianFlexText *)user;
+  (void)max_w;
+  (void)max_h;
+  if (!t->measured) {
+    uint32_t lines = 1u;
+    for (const char *c = t->text; *c; c++) {
+      if (*c == '\n')
+        lines++;
+    }
+    t->w = stygian_text_width(t->ctx, t->font, t->text, t->size);
+    t->h = stygian_font_line_height(t->ctx, t->font, t->size) * (float)lines;
+    t->measured = true;
+  }
+  *out_w = t->w;
+  *out_h = t->h;
+}
+
+// Text record for a node: arena trees point at the caller's string,
+// retained trees keep a copy after the record.
+static StygianFlexText *flex_text_alloc(StygianFlex *flex, const char *text) {
+  StygianFlexText *t;
+  size_t len = strlen(text);
+  if (flex->arena) {
+    t = (StygianFlexText *)stygian_arena_alloc(
+        flex->arena, sizeof(StygianFlexText), _Alignof(StygianFlexText));
+    if (t) {
+      memset(t, 0, sizeof(*t));
+      t->text = text;
+    }
+    return t;
+  }
+  t = (StygianFlexText *)malloc(sizeof(StygianFlexText) + len + 1u);
+  if (t) {
+    memset(t, 0, sizeof(*t));
+    memcpy(t + 1, text, len + 1u);
+    t->text = (const char *)(t + 1);
+  }
+  return t;
+}
+
+StygianFlexNode stygian_flex_text(StygianFlex *flex, StygianFlexNode parent,
+                                  const StygianFlexStyle *style,
+                                  StygianFont font, const char *text,
+                                  float size) {
+  StygianFlexText *t;
+  StygianFlexNode node;
+  if (!flex || !flex->ctx || !text)
+    return 0u;
+  t = flex_text_alloc(flex, text);
+  if (!t)
+    return 0u;
+  node = stygian_flex_node(flex, parent, style);
+  if (node == 0u) {
+    if (!flex->arena)
+      free(t);
+    return 0u;
+  }
+  t->ctx = flex->ctx;
+  t->font = font;
+  t->size = size;
+  stygian_flex_measure(flex, node, flex_measure_text, t);
+  return node;
+}
+
+void stygian_flex_set_text(StygianFlex *flex, StygianFlexNode node,
+                           const char *text) {
+  StygianFlexNodeData *n = flex_get(flex, node);
+  StygianFlexText *t, *next;
+  if (!n || !text || n->measure != flex_measure_text)
+    return;
+  t = (StygianFlexText *)n->measure_user;
+  if (strcmp(t->text, text) == 0)
+    return;
+  next = flex_text_alloc(flex, text);
+  if (!next)
+    return;
+  next->ctx = t->ctx;
+  next->font = t->font;
+  next->size = t->size;
+  if (!flex->arena)
+    free(t);
+  n->measure_user = next;
+  flex_invalidate(flex, node);
+}
+
+// ----------------------------------------------------------------------------
+// Measure pass
+// ----------------------------------------------------------------------------
+
+static float flex_clamp(float v, float min_v, float max_v) {
+  if (max_v > 0.0f && v > max_v)
+    v = max_v;
+  if (v < min_v)
+    v = min_v;
+  return v < 0.0f ? 0.0f : v;
+}
+
+static float flex_clamp_main(const StygianFlexStyle *s, StygianLayoutDir dir,
+                             float v) {
+  return dir == STYGIAN_LAYOUT_ROW ? flex_clamp(v, s->min_w, s->max_w)
+                                   : flex_clamp(v, s->min_h, s->max_h);
+}
+
+static void flex_measure(StygianFlex *flex, StygianFlexNodeData *n,
+                         float avail_w, float avail_h, float *out_w,
+                         float *out_h);
+
+// Size of an item before its main size is known: unbounded along a row
+// (max-content), at the container's inner width down a column. Both passes
+// ask the same question, so the second is a cache hit.
+static void flex_measure_item(StygianFlex *flex, StygianFlexNodeData *item,
+                              bool row, float inner_w, float *out_w,
+                              float *out_h) {
+  flex_measure(flex, item, row ? STYGIAN_FLEX_UNBOUNDED : inner_w,
+               STYGIAN_FLEX_UNBOUNDED, out_w, out_h);
+}
+
+// Cross size of an item once its main size is resolved.
+static float flex_item_cross(StygianFlex *flex, StygianFlexNodeData *item,
+                             bool row, float inner_w) {
+  float fixed = row ? item->style.height : item->style.width;
+  float w, h;
+  if (fixed > 0.0f)
+    return fixed;
+  if (row) {
+    flex_measure(flex, item, item->flex_main, STYGIAN_FLEX_UNBOUNDED, &w, &h);
+    return h;
+  }
+  flex_measure_item(flex, item, false, inner_w, &w, &h);
+  return w;
+}
+
+// Content size of a container's children within an inner available size:
+// lines as wrap would break them, each line as wide as its items.
+static void flex_measure_children(StygianFlex *flex,
+                                  const StygianFlexNodeData *n, float avail_w,
+                                  float avail_h, float *out_w, float *out_h) {
+  const StygianFlexStyle *s = &n->style;
+  bool row = s->dir == STYGIAN_LAYOUT_ROW;
+  float avail_main = row ? avail_w : avail_h;
+  float line_main = 0.0f, line_cross = 0.0f;
+  float content_main = 0.0f, content_cross = 0.0f;
+  uint32_t in_line = 0u, lines = 0u;
+
+  for (StygianFlexNode c = n->first_child; c != 0u;
+       c = flex->nodes[c - 1u].next_sibling) {
+    StygianFlexNodeData *child = &flex->nodes[c - 1u];
+    float cw, ch, main, cross;
+    flex_measure_item(flex, child, row, avail_w, &cw, &ch);
+    main = row ? cw : ch;
+    cross = row ? ch : cw;
+    if (child->style.basis > 0.0f)
+      main = flex_clamp_main(&child->style, s->dir, child->style.basis);
+    if (s->wrap && in_line > 0u && line_main + s->gap + main > avail_main) {
+      if (line_main > content_main)
+        content_main = line_main;
+      content_cross += line_cross + (lines > 0u ? s->line_gap : 0.0f);
+      lines++;
+      line_main = 0.0f;
+      line_cross = 0.0f;
+      in_line = 0u;
+    }
+    line_main += (in_line > 0u ? s->gap : 0.0f) + main;
+    if (cross > line_cross)
+      line_cross = cross;
+    in_line++;
+  }
+  if (in_line > 0u) {
+    if (line_main > content_main)
+      content_main = line_main;
+    content_cross += line_cross + (lines > 0u ? s->line_gap : 0.0f);
+  }
+  *out_w = row ? content_main : content_cross;
+  *out_h = row ? content_cross : content_main;
+}
+
+// A cached size still holds for the same inner space, or for less space
+// that the measured content fits in: content that did not use all the room
+// it had lays out the same with less.
+static bool flex_cache_fits(float avail, float cached_avail, float content) {
+  return avail == cached_avail || (avail <= cached_avail && avail >= content);
+}
+
+// Outer size of a node from its fixed size or content, within min/max.
+static void flex_measure(StygianFlex *flex, StygianFlexNodeData *n,
+                         float avail_w, float avail_h, float *out_w,
+                         float *out_h) {
+  const StygianFlexStyle *s = &n->style;
+  float pad2 = s->padding * 2.0f;
+  float w = s->width, h = s->height;
+  float inner_w = (w > 0.0f ? w : flex_clamp(avail_w, 0.0f, s->max_w)) - pad2;
+  float inner_h = (h > 0.0f ? h : flex_clamp(avail_h, 0.0f, s->max_h)) - pad2;
+  float cw = 0.0f, ch = 0.0f;
+
+  if (inner_w < 0.0f)
+    inner_w = 0.0f;
+  if (inner_h < 0.0f)
+    inner_h = 0.0f;
+  if (n->measured &&
+      flex_cache_fits(inner_w, n->measure_avail_w, n->measure_content_w) &&
+      flex_cache_fits(inner_h, n->measure_avail_h, n->measure_content_h)) {
+    *out_w = n->measure_w;
+    *out_h = n->measure_h;
+    return;
+  }
+  if (w <= 0.0f || h <= 0.0f) {
+    if (n->measure)
+      n->measure(n->measure_user, inner_w, inner_h, &cw, &ch);
+    else if (n->first_child != 0u)
+      flex_measure_children(flex, n, inner_w, inner_h, &cw, &ch);
+    if (w <= 0.0f)
+      w = cw + pad2;
+    if (h <= 0.0f)
+      h = ch + pad2;
+  }
+  w = flex_clamp(w, s->min_w, s->max_w);
+  h = flex_clamp(h, s->min_h, s->max_h);
+
+  n->measure_avail_w = inner_w;
+  n->measure_avail_h = inner_h;
+  n->measure_content_w = cw;
+  n->measure_content_h = ch;
+  n->measure_w = w;
+  n->measure_h = h;
+  n->measured = true;
+  *out_w = w;
+  *out_h = h;
+}
+
+// ----------------------------------------------------------------------------
+// Arrange pass
+// ----------------------------------------------------------------------------
+
+// Resolve main sizes for the items [first, end) of one line to fill space
+// (the line minus its gaps). Items that hit min/max are frozen and the rest
+// share again, the way CSS flexbox resolves flexible lengths. Returns the
+// sum of the resolved sizes.
+static float flex_resolve_line(StygianFlex *flex, StygianLayoutDir dir,
+                               StygianFlexNode first, StygianFlexNode end,
+                               float space, float hypothetical) {
+  bool growing = hypothetical < space;
+  uint32_t flexible = 0u;
+  StygianFlexNode c;
+
+  for (c = first; c != end; c = flex->nodes[c - 1u].next_sibling) {
+    StygianFlexNodeData *n = &flex->nodes[c - 1u];
+    float factor = growing ? n->style.grow : n->style.shrink;
+    n->frozen = factor <= 0.0f || hypothetical == space ||
+                (growing && n->flex_base > n->flex_main) ||
+                (!growing && n->flex_base < n->flex_main);
+    if (!n->frozen)
+      flexible++;
+  }
+  if (flexible == 0u)
+    return hypothetical; // Every item keeps its hypothetical size
+
+  for (;;) {
+    float remaining = space, factors = 0.0f, violation = 0.0f;
+    bool any = false;
+    for (c = first; c != end; c = flex->nodes[c - 1u].next_sibling) {
+      StygianFlexNodeData *n = &flex->nodes[c - 1u];
+      if (n->frozen) {
+        remaining -= n->flex_main;
+      } else {
+        remaining -= n->flex_base;
+        factors += growing ? n->style.grow : n->style.shrink * n->flex_base;
+        any = true;
+      }
+    }
+    if (!any)
+      break;
+
+    for (c = first; c != end; c = flex->nodes[c - 1u].next_sibling) {
+      StygianFlexNodeData *n = &flex->nodes[c - 1u];
+      float target, clamped;
+      if (n->frozen)
+        continue;
+      if (factors <= 0.0f)
+        target = n->flex_base;
+      else if (growing)
+        target = n->flex_base + remaining * n->style.grow / factors;
+      else
+        target = n->flex_base +
+                 remaining * n->style.shrink * n->flex_base / factors;
+      clamped = flex_clamp_main(&n->style, dir, target);
+      violation += clamped - target;
+      n->flex_target = target;
+      n->flex_main = clamped;
+    }
+    // No clamping: done. Otherwise freeze the items clamped the way the
+    // total moved and share what they gave up or took among the rest.
+    if (violation == 0.0f)
+      break;
+    for (c = first; c != end; c = flex->nodes[c - 1u].next_sibling) {
+      StygianFlexNodeData *n = &flex->nodes[c - 1u];
+      if (!n->frozen && ((violation > 0.0f && n->flex_main > n->flex_target) ||
+                         (violation < 0.0f && n->flex_main < n->flex_target)))
+        n->frozen = true;
+    }
+  }
+
+  hypothetical = 0.0f;
+  for (c = first; c != end; c = flex->nodes[c - 1u].next_sibling)
+    hypothetical += flex->nodes[c - 1u].flex_main;
+  return hypothetical;
+}
+
+static void flex_arrange(StygianFlex *flex, StygianFlexNodeData *n) {
+  const StygianFlexStyle *s = &n->style;
+  bool row = s->dir == STYGIAN_LAYOUT_ROW;
+  float inner_x = s->padding, inner_y = s->padding;
+  float inner_w = n->w - s->padding * 2.0f;
+  float inner_h = n->h - s->padding * 2.0f;
+  float main_size, cross_size, cross_pos = 0.0f, total = 0.0f;
+  uint32_t child_count = 0u;
+  StygianFlexNode c, start;
+
+  if (inner_w < 0.0f)
+    inner_w = 0.0f;
+  if (inner_h < 0.0f)
+    inner_h = 0.0f;
+  main_size = row ? inner_w : inner_h;
+  cross_size = row ? inner_h : inner_w;
+
+  // Hypothetical main sizes: basis, else fixed size, else content.
+  for (c = n->first_child; c != 0u; c = flex->nodes[c - 1u].next_sibling) {
+    StygianFlexNodeData *child = &flex->nodes[c - 1u];
+    float cw, ch, fixed = row ? child->style.width : child->style.height;
+    if (child->style.basis > 0.0f) {
+      child->flex_base = child->style.basis;
+    } else if (fixed > 0.0f) {
+      child->flex_base = fixed;
+    } else {
+      flex_measure_item(flex, child, row, inner_w, &cw, &ch);
+      child->flex_base = row ? cw : ch;
+    }
+    child->flex_main = flex_clamp_main(&child->style, s->dir, child->flex_base);
+    total += child->flex_main;
+    child_count++;
+  }
+
+  start = n->first_child;
+  while (start != 0u) {
+    StygianFlexNode end = 0u;
+    float used = total, line_cross = cross_size, free_space, pos;
+    float between = 0.0f, gaps;
+    uint32_t count = child_count;
+
+    // Break the line before the first item that would overflow it. A single
+    // line spans the container's cross size.
+    if (s->wrap) {
+      used = 0.0f;
+      count = 0u;
+      for (end = start; end != 0u;) {
+        const StygianFlexNodeData *child = &flex->nodes[end - 1u];
+        float add = child->flex_main + (count > 0u ? s->gap : 0.0f);
+        if (count > 0u && used + add > main_size)
+          break;
+        used += add;
+        count++;
+        end = child->next_sibling;
+      }
+      used -= s->gap * (float)(count - 1u);
+    }
+
+    gaps = s->gap * (float)(count - 1u);
+    used = gaps + flex_resolve_line(flex, s->dir, start, end, main_size - gaps,
+                                    used);
+    if (s->wrap) {
+      line_cross = 0.0f;
+      for (c = start; c != end; c = flex->nodes[c - 1u].next_sibling) {
+        float cross = flex_item_cross(flex, &flex->nodes[c - 1u], row, inner_w);
+        if (cross > line_cross)
+          line_cross = cross;
+      }
+    }
+
+    free_space = main_size - used;
+    pos = 0.0f;
+    switch (s->justify) {
+    case STYGIAN_JUSTIFY_CENTER:
+      pos = free_space * 0.5f;
+      break;
+    case STYGIAN_JUSTIFY_END:
+      pos = free_space;
+      break;
+    case STYGIAN_JUSTIFY_SPACE_BETWEEN:
+      if (free_space > 0.0f && count > 1u)
+        between = free_space / (float)(count - 1u);
+      break;
+    case STYGIAN_JUSTIFY_SPACE_AROUND:
+      if (free_space > 0.0f) {
+        between = free_space / (float)count;
+        pos = between * 0.5f;
+      }
+      break;
+    default:
+      break;
+    }
+
+    for (c = start; c != end; c = flex->nodes[c - 1u].next_sibling) {
+      StygianFlexNodeData *child = &flex->nodes[c - 1u];
+      const StygianFlexStyle *cs = &child->style;
+      float fixed = row ? cs->height : cs->width;
+      float cross, offset = 0.0f, prev_w = child->w, prev_h = child->h;
+      if (s->align == STYGIAN_ALIGN_STRETCH && fixed <= 0.0f)
+        cross = line_cross;
+      else
+        cross = flex_item_cross(flex, child, row, inner_w);
+      cross = row ? flex_clamp(cross, cs->min_h, cs->max_h)
+                  : flex_clamp(cross, cs->min_w, cs->max_w);
+      if (s->align == STYGIAN_ALIGN_CENTER)
+        offset = (line_cross - cross) * 0.5f;
+      else if (s->align == STYGIAN_ALIGN_END)
+        offset = line_cross - cross;
+
+      if (row) {
+        child->x = inner_x + pos;
+        child->y = inner_y + cross_pos + offset;
+        child->w = child->flex_main;
+        child->h = cross;
+      } else {
+        child->x = inner_x + cross_pos + offset;
+        child->y = inner_y + pos;
+        child->w = cross;
+        child->h = child->flex_main;
+      }
+      // A clean subtree laid out at the same size last time is unchanged;
+      // positions are parent-relative, so moving it costs nothing.
+      if (child->first_child != 0u &&
+          (child->dirty || child->w != prev_w || child->h != prev_h))
+        flex_arrange(flex, child);
+      child->dirty = false;
+      pos += child->flex_main + s->gap + between;
+    }
+
+    cross_pos += line_cross + s->line_gap;
+    start = end;
+  }
+  n->dirty = false;
+}
+
+// Absolute position of a node: its offset plus every ancestor's.
+static void flex_origin(const StygianFlex *flex, const StygianFlexNodeData *n,
+                        float *out_x, float *out_y) {
+  float x = n->x, y = n->y;
+  while (n->parent != 0u) {
+    n = &flex->nodes[n->parent - 1u];
+    x += n->x;
+    y += n->y;
+  }
+  *out_x = x;
+  *out_y = y;
+}
+
+void stygian_flex_compute(StygianFlex *flex, StygianFlexNode root, float x,
+                          float y, float w, float h) {
+  StygianFlexNodeData *n = flex_get(flex, root);
+  if (!n)
+    return;
+  if (w <= 0.0f || h <= 0.0f) {
+    float cw, ch;
+    flex_measure(flex, n, w > 0.0f ? w : STYGIAN_FLEX_UNBOUNDED,
+                 h > 0.0f ? h : STYGIAN_FLEX_UNBOUNDED, &cw, &ch);
+    if (w <= 0.0f)
+      w = cw;
+    if (h <= 0.0f)
+      h = ch;
+  }
+  if (n->parent != 0u) {
+    // A subtree laid out on its own: keep the result absolute.
+    float px, py;
+    flex_origin(flex, &flex->nodes[n->parent - 1u], &px, &py);
+    x -= px;
+    y -= py;
+  }
+  n->x = x;
+  n->y = y;
+  if (!n->dirty && n->w == w && n->h == h)
+    return; // Nothing inside changed
+  n->w = w;
+  n->h = h;
+  flex_arrange(flex, n);
+}
+
+bool stygian_flex_rect(const StygianFlex *flex, StygianFlexNode node,
+                       float *out_x, float *out_y, float *out_w, float *out_h) {
+  const StygianFlexNodeData *n = flex_get(flex, node);
+  float x, y;
+  if (!n)
+    return false;
+  flex_origin(flex, n, &x, &y);
+  if (out_x)
+    *out_x = x;
+  if (out_y)
+    *out_y = y;
+  if (out_w)
+    *out_w = n->w;
+  if (out_h)
+    *out_h = n->h;
+  return true;
+}
+
+uint32_t stygian_flex_node_count(const StygianFlex *flex) {
+  return flex ? flex->node_count : 0u;
+}
@@ -4,6 +4,7 @@
 #define STYGIAN_LAYOUT_H
 
 #include "../include/stygian.h"
+#include "../include/stygian_memory.h"
 
 #ifdef __cplusplus
 extern "C" {
@@ -66,6 +67,99 @@ void stygian_layout_remaining(StygianLayout *layout, float *out_w,
 // End layout container (frees layout)
 void stygian_layout_end(StygianContext *ctx, StygianLayout *layout);
 
+// ============================================================================
+// Flex Layout
+// ============================================================================
+
+// Two-pass flex layout over a node tree. Add nodes with stygian_flex_node /
+// stygian_flex_text, run stygian_flex_compute, then read rects back. A tree
+// from stygian_flex_begin lives in the frame arena (or the arena given to
+// stygian_flex_begin_arena) and dies with it; one from stygian_flex_create
+// is retained across frames, so handles stay stable identities.
+//
+// The measure pass sizes nodes bottom-up from their content; a leaf's measure
+// callback runs once per distinct available size. The arrange pass breaks
+// children into lines, splits free space by grow or overflow by shrink
+// within min/max, then justifies and aligns each line.
+//
+// Compute is incremental. Nodes remember their last layout, and only
+// subtrees whose inputs changed (style, measure source, text, children) or
+// whose container size changed are re-measured and re-arranged; a retained
+// tree with nothing changed costs O(1) per compute. Content a callback
+// measures is opaque: call stygian_flex_invalidate when it changes.
+
+typedef uint32_t StygianFlexNode;       // Node handle (0 = none)
+typedef struct StygianFlex StygianFlex; // Opaque
+
+// A zeroed style is valid: sizes of 0 come from content, max of 0 is
+// unbounded, and items neither grow nor shrink.
+typedef struct StygianFlexStyle {
+  StygianLayoutDir dir;         // Main axis for children
+  StygianLayoutJustify justify; // Main-axis distribution within a line
+  StygianLayoutAlign align;     // Cross-axis alignment within a line
+  bool wrap;                    // Break children into lines
+  float gap;                    // Between items on a line
+  float line_gap;               // Between wrapped lines
+  float padding;                // Inner padding
+  float width, height;          // Fixed size (0 = content)
+  float min_w, min_h;
+  float max_w, max_h; // 0 = unbounded
+  float basis;        // Main size before grow/shrink (0 = fixed or content)
+  float grow;         // Share of a line's free space
+  float shrink;       // Share of a line's overflow, weighted by basis
+} StygianFlexStyle;
+
+// Available size passed to measure callbacks along an unconstrained axis.
+#define STYGIAN_FLEX_UNBOUNDED 1.0e30f
+
+// Content size of a leaf laid out within max_w x max_h.
+typedef void (*StygianFlexMeasureFn)(void *user, float max_w, float max_h,
+                                     float *out_w, float *out_h);
+
+StygianFlex *stygian_flex_begin(StygianContext *ctx);
+// Standalone tree (no text nodes); the arena must outlive the rects.
+StygianFlex *stygian_flex_begin_arena(StygianArena *arena);
+// Retained tree on the heap. ctx is needed only for text nodes.
+StygianFlex *stygian_flex_create(StygianContext *ctx);
+// Frees a retained tree; arena trees are freed with their arena.
+void stygian_flex_destroy(StygianFlex *flex);
+// Size the node array for node_count nodes up front, so a tree of known size
+// never copies while it is built. False when out of memory.
+bool stygian_flex_reserve(StygianFlex *flex, uint32_t node_count);
+
+// Append a child to parent (0 = a new root). Returns 0 when out of memory.
+StygianFlexNode stygian_flex_node(StygianFlex *flex, StygianFlexNode parent,
+                                  const StygianFlexStyle *style);
+// Size a leaf from a callback instead of children.
+void stygian_flex_measure(StygianFlex *flex, StygianFlexNode node,
+                          StygianFlexMeasureFn fn, void *user);
+// Leaf sized by its text, measured once per change. Retained trees copy
+// text; arena trees keep the pointer, which must stay valid until
+// stygian_flex_compute returns.
+StygianFlexNode stygian_flex_text(StygianFlex *flex, StygianFlexNode parent,
+                                  const StygianFlexStyle *style,
+                                  StygianFont font, const char *text,
+                                  float size);
+// Replace a text node's text; a no-op when it is unchanged.
+void stygian_flex_set_text(StygianFlex *flex, StygianFlexNode node,
+                           const char *text);
+// Replace a node's style; a no-op when it is unchanged.
+void stygian_flex_set_style(StygianFlex *flex, StygianFlexNode node,
+                            const StygianFlexStyle *style);
+// Mark a node's measured content as changed.
+void stygian_flex_invalidate(StygianFlex *flex, StygianFlexNode node);
+// Unlink a node (and its subtree) from its parent. The handle stays valid
+// as a root until the tree is freed.
+void stygian_flex_detach(StygianFlex *flex, StygianFlexNode node);
+
+// Lay out root's tree in the given rect; w or h of 0 fits that axis to
+// content. Rects are absolute; reading one walks the node's ancestors.
+void stygian_flex_compute(StygianFlex *flex, StygianFlexNode root, float x,
+                          float y, float w, float h);
+bool stygian_flex_rect(const StygianFlex *flex, StygianFlexNode node,
+                       float *out_x, float *out_y, float *out_w, float *out_h);
+uint32_t stygian_flex_node_count(const StygianFlex *flex);
+
 // ============================================================================
 // Convenience Macros
 // ============================================================================
@@ -20,4 +20,38 @@ struct StygianLayout {
   int item_count;           // Number of children added
 };
 
+typedef struct StygianFlexNodeData {
+  StygianFlexStyle style;
+  StygianFlexNode parent;
+  StygianFlexNode first_child, last_child, next_sibling;
+  StygianFlexMeasureFn measure;
+  void *measure_user;
+
+  // Measure cache: inner space and content size of the last measure, and
+  // the outer size it produced
+  float measure_avail_w, measure_avail_h;
+  float measure_content_w, measure_content_h;
+  float measure_w, measure_h;
+  bool measured;
+  // Inputs in this subtree changed since the last compute; implies the
+  // measure cache is stale and every ancestor is dirty too
+  bool dirty;
+
+  // Arrange scratch: basis, unclamped share and resolved main size
+  float flex_base;
+  float flex_target;
+  float flex_main;
+  bool frozen;
+
+  float x, y, w, h; // Result; x, y relative to the parent (roots absolute)
+} StygianFlexNodeData;
+
+struct StygianFlex {
+  StygianContext *ctx; // NULL for standalone trees
+  StygianArena *arena;        // NULL for retained trees (heap-owned)
+  StygianFlexNodeData *nodes; // handle = index + 1
+  uint32_t node_count;
+  uint32_t node_capacity;
+};
+
 #endif // STYGIAN_LAYOUT_INTERNAL_H
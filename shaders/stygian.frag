@@ -95,6 +95,8 @@ uniform int uOutputSrcIsSRGB;
 uniform float uOutputSrcGamma;
 uniform int uOutputDstIsSRGB;
 uniform float uOutputDstGamma;
+uniform sampler3D uOutputLut;  // Sampled transform (real output tone curves)
+uniform float uOutputLutSize;  // Lattice edge; 0 = analytic path below
 #endif
 
 float stygian_to_linear_channel(float c, bool srgb_transfer, float gamma_val) {
@@ -123,6 +125,12 @@ vec4 apply_output_color_transform(vec4 color_in) {
         return color_in;
     }
     vec3 c = clamp(color_in.rgb, 0.0, 1.0);
+    if (uOutputLutSize > 1.5) {
+        // sqrt-spaced lattice; nodes sit on texel centers.
+        vec3 coord = sqrt(c) * ((uOutputLutSize - 1.0) / uOutputLutSize) +
+                     0.5 / uOutputLutSize;
+        return vec4(texture(uOutputLut, coord).rgb, color_in.a);
+    }
     vec3 linear_rgb = vec3(
         stygian_to_linear_channel(c.r, uOutputSrcIsSRGB != 0, uOutputSrcGamma),
         stygian_to_linear_channel(c.g, uOutputSrcIsSRGB != 0, uOutputSrcGamma),
@@ -202,7 +210,7 @@ void main() {
 
     // Clip test — read flags from SoA hot buffer
     SoAHot h_clip = soa_hot[vInstanceID];
-    uint clip_id = (h_clip.flags & 0x0000FF00u) >> 8u;
+    uint clip_id = h_clip.flags >> 8u; // Top 24 bits
     if (clip_id != 0u) {
         vec4 clip_rect = clip_rects[clip_id];
         vec2 worldP = vec2(h_clip.x, h_clip.y) + vLocalPos;
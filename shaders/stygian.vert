@@ -49,8 +49,11 @@ layout(std430, binding = 6) readonly buffer SoAEffectsBuffer {
 // Per-frame uniforms - different for OpenGL vs Vulkan
 #ifdef STYGIAN_GL
 uniform vec2 uScreenSize;
+// gl_InstanceID ignores the base instance; the backend feeds the element
+// index as an instanced attribute, which honours it.
+layout(location = 1) in uint aElementIndex;
 #define SCREEN_SIZE uScreenSize
-#define INSTANCE_ID gl_InstanceID
+#define INSTANCE_ID aElementIndex
 #else
 layout(push_constant) uniform PushConstants {
     vec4 uScreenAtlas;   // xy=screen size, zw=atlas size
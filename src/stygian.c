@@ -5,9 +5,12 @@
 #include "../include/stygian_error.h"
 #include "../window/stygian_window.h"
 #include "stygian_color.h"
+#include "stygian_decode_pool.h"
+#include "stygian_glyph_disk_cache.h"
 #include "stygian_icc.h"
 #include "stygian_internal.h"
 #include "stygian_mtsdf.h"
+#include "stygian_texture_atlas.h"
 #include "stygian_triad.h"
 #include "stygian_unicode.h"
 #include <ctype.h>
@@ -201,9 +204,41 @@ static bool stygian_profiles_equal(const StygianColorProfile *a,
     if (a->rgb_to_xyz[i] != b->rgb_to_xyz[i])
       return false;
   }
+  for (i = 0; i < 3; i++) {
+    const StygianColorTrc *ta = &a->trc[i], *tb = &b->trc[i];
+    // Tables are interned, so equal curves share one pointer.
+    if (ta->type != tb->type || ta->table != tb->table ||
+        memcmp(ta->params, tb->params, sizeof(ta->params)) != 0)
+      return false;
+  }
   return true;
 }
 
+// Built transform for a profile pair, from the context cache when the pair
+// was seen before. The key only narrows the search; a hit is confirmed
+// against the stored profiles. NULL if either profile is invalid or
+// allocation fails.
+static StygianColorTransform *
+stygian_color_transform_cached(StygianContext *ctx,
+                               const StygianColorProfile *src,
+                               const StygianColorProfile *dst) {
+  uint64_t key = stygian_color_profile_pair_key(src, dst);
+  uint32_t i, slot;
+  for (i = 0; i < STYGIAN_COLOR_TRANSFORM_CACHE; i++) {
+    if (ctx->color_transforms[i] && ctx->color_transform_keys[i] == key &&
+        stygian_profiles_equal(&ctx->color_transform_src[i], src) &&
+        stygian_profiles_equal(&ctx->color_transform_dst[i], dst))
+      return ctx->color_transforms[i];
+  }
+  slot = ctx->color_transform_next++ % STYGIAN_COLOR_TRANSFORM_CACHE;
+  stygian_color_transform_destroy(ctx->color_transforms[slot]);
+  ctx->color_transforms[slot] = stygian_color_transform_create(src, dst, 0u);
+  ctx->color_transform_keys[slot] = key;
+  ctx->color_transform_src[slot] = *src;
+  ctx->color_transform_dst[slot] = *dst;
+  return ctx->color_transforms[slot];
+}
+
 static void stygian_update_color_transform_state(StygianContext *ctx) {
   if (!ctx)
     return;
@@ -250,6 +285,21 @@ static void stygian_push_output_color_transform(StygianContext *ctx) {
   stygian_ap_set_output_color_transform(
       ctx->ap, enabled, rgb3x3, src_profile.srgb_transfer, src_profile.gamma,
       ctx->output_color_profile.srgb_transfer, ctx->output_color_profile.gamma);
+
+  // The sampled transform carries the output profile's real tone curves;
+  // backends that take it use it in place of the gamma approximation above.
+  {
+    const uint16_t *lut = NULL;
+    uint32_t lut_size = 0u;
+    if (enabled) {
+      lut = stygian_color_transform_lut3d(
+          stygian_color_transform_cached(ctx, &src_profile,
+                                         &ctx->output_color_profile),
+          &lut_size);
+    }
+    stygian_ap_set_output_color_lut(ctx->ap, lut, lut_size);
+  }
+  ctx->damage_full = true; // Every pixel is re-encoded
 }
 
 static uint32_t stygian_hash_u32(uint32_t v) {
@@ -801,44 +851,167 @@ static uint64_t stygian_hash_str64(const char *s) {
   return h;
 }
 
+static uint32_t stygian_inline_emoji_index_home(uint64_t key_hash) {
+  return (uint32_t)(key_hash ^ (key_hash >> 32)) &
+         (STYGIAN_INLINE_EMOJI_INDEX_SIZE - 1u);
+}
+
+// Index position holding key_hash, or -1.
+static int stygian_inline_emoji_index_probe(const StygianContext *ctx,
+                                            uint64_t key_hash) {
+  uint32_t pos = stygian_inline_emoji_index_home(key_hash);
+  for (;;) {
+    uint16_t ref = ctx->inline_emoji_index[pos];
+    if (ref == 0u)
+      return -1;
+    if (ctx->inline_emoji_cache[ref - 1u].glyph_hash == key_hash)
+      return (int)pos;
+    pos = (pos + 1u) & (STYGIAN_INLINE_EMOJI_INDEX_SIZE - 1u);
+  }
+}
+
+static void stygian_inline_emoji_index_insert(StygianContext *ctx,
+                                              uint64_t key_hash, int slot) {
+  uint32_t pos = stygian_inline_emoji_index_home(key_hash);
+  while (ctx->inline_emoji_index[pos] != 0u)
+    pos = (pos + 1u) & (STYGIAN_INLINE_EMOJI_INDEX_SIZE - 1u);
+  ctx->inline_emoji_index[pos] = (uint16_t)(slot + 1);
+}
+
+// Backward-shift deletion: pull later members of the probe run into the hole
+// so lookups never need tombstones.
+static void stygian_inline_emoji_index_remove(StygianContext *ctx,
+                                              uint64_t key_hash) {
+  const uint32_t mask = STYGIAN_INLINE_EMOJI_INDEX_SIZE - 1u;
+  int found = stygian_inline_emoji_index_probe(ctx, key_hash);
+  uint32_t hole, pos;
+  if (found < 0)
+    return;
+  hole = (uint32_t)found;
+  pos = (hole + 1u) & mask;
+  while (ctx->inline_emoji_index[pos] != 0u) {
+    uint16_t ref = ctx->inline_emoji_index[pos];
+    uint32_t home = stygian_inline_emoji_index_home(
+        ctx->inline_emoji_cache[ref - 1u].glyph_hash);
+    // Move it unless its home lies cyclically in (hole, pos]
+    if (((pos - home) & mask) >= ((pos - hole) & mask)) {
+      ctx->inline_emoji_index[hole] = ref;
+      hole = pos;
+    }
+    pos = (pos + 1u) & mask;
+  }
+  ctx->inline_emoji_index[hole] = 0u;
+}
+
 static int stygian_inline_emoji_cache_find(const StygianContext *ctx,
                                            uint64_t key_hash) {
-  int i;
+  int pos;
   if (!ctx || key_hash == 0ull)
     return -1;
-  for (i = 0; i < STYGIAN_INLINE_EMOJI_CACHE_SIZE; i++) {
-    if (ctx->inline_emoji_cache[i].used &&
-        ctx->inline_emoji_cache[i].glyph_hash == key_hash) {
-      return i;
-    }
-  }
-  return -1;
+  pos = stygian_inline_emoji_index_probe(ctx, key_hash);
+  return pos < 0 ? -1 : (int)ctx->inline_emoji_index[pos] - 1;
+}
+
+static void stygian_inline_emoji_lru_unlink(StygianContext *ctx, int slot) {
+  StygianInlineEmojiCacheEntry *e = &ctx->inline_emoji_cache[slot];
+  if (e->lru_prev)
+    ctx->inline_emoji_cache[e->lru_prev - 1u].lru_next = e->lru_next;
+  else if (ctx->inline_emoji_lru_head == (uint16_t)(slot + 1))
+    ctx->inline_emoji_lru_head = e->lru_next;
+  if (e->lru_next)
+    ctx->inline_emoji_cache[e->lru_next - 1u].lru_prev = e->lru_prev;
+  else if (ctx->inline_emoji_lru_tail == (uint16_t)(slot + 1))
+    ctx->inline_emoji_lru_tail = e->lru_prev;
+  e->lru_prev = 0u;
+  e->lru_next = 0u;
+}
+
+static void stygian_inline_emoji_lru_push_front(StygianContext *ctx,
+                                                int slot) {
+  StygianInlineEmojiCacheEntry *e = &ctx->inline_emoji_cache[slot];
+  e->lru_prev = 0u;
+  e->lru_next = ctx->inline_emoji_lru_head;
+  if (ctx->inline_emoji_lru_head)
+    ctx->inline_emoji_cache[ctx->inline_emoji_lru_head - 1u].lru_prev =
+        (uint16_t)(slot + 1);
+  else
+    ctx->inline_emoji_lru_tail = (uint16_t)(slot + 1);
+  ctx->inline_emoji_lru_head = (uint16_t)(slot + 1);
 }
 
+// Slot the next claim will use: a released slot, a never-used one, or the
+// least recently drawn entry. Slots drawn this frame are kept (their atlas
+// cell is already referenced by emitted quads), so a screen needing more
+// emoji than the budget holds gets -1 and draws the overflow as text.
 static int stygian_inline_emoji_cache_choose_slot(const StygianContext *ctx) {
-  int i;
-  int oldest_idx = -1;
-  uint32_t oldest_tick = UINT_MAX;
+  uint16_t ref;
   if (!ctx)
     return -1;
-  for (i = 0; i < STYGIAN_INLINE_EMOJI_CACHE_SIZE; i++) {
-    if (!ctx->inline_emoji_cache[i].used)
-      return i;
-    if (ctx->inline_emoji_cache[i].last_used < oldest_tick) {
-      oldest_tick = ctx->inline_emoji_cache[i].last_used;
-      oldest_idx = i;
-    }
+  if (ctx->inline_emoji_free_count > 0u)
+    return (int)ctx->inline_emoji_free[ctx->inline_emoji_free_count - 1u];
+  if (ctx->inline_emoji_fresh < ctx->inline_emoji_slot_limit)
+    return (int)ctx->inline_emoji_fresh;
+  // Walk from the cold end past slots owned by in-flight decodes (bounded by
+  // the decode queue depth).
+  for (ref = ctx->inline_emoji_lru_tail; ref != 0u;
+       ref = ctx->inline_emoji_cache[ref - 1u].lru_prev) {
+    const StygianInlineEmojiCacheEntry *e = &ctx->inline_emoji_cache[ref - 1u];
+    if (e->pending)
+      continue;
+    if (e->last_frame == ctx->frame_index)
+      return -1; // Everything hotter was drawn this frame too
+    return (int)ref - 1;
   }
-  return oldest_idx;
+  return -1;
 }
 
 static void stygian_inline_emoji_cache_touch(StygianContext *ctx, int idx) {
   if (!ctx || idx < 0 || idx >= STYGIAN_INLINE_EMOJI_CACHE_SIZE)
     return;
-  ctx->inline_emoji_clock++;
-  if (ctx->inline_emoji_clock == 0u)
-    ctx->inline_emoji_clock = 1u;
-  ctx->inline_emoji_cache[idx].last_used = ctx->inline_emoji_clock;
+  if (ctx->inline_emoji_lru_head != (uint16_t)(idx + 1)) {
+    stygian_inline_emoji_lru_unlink(ctx, idx);
+    stygian_inline_emoji_lru_push_front(ctx, idx);
+  }
+  ctx->inline_emoji_cache[idx].last_frame = ctx->frame_index;
+}
+
+// Drop a slot's key and recency; the caller decides where the slot goes.
+static void stygian_inline_emoji_cache_unlink(StygianContext *ctx, int slot) {
+  if (!ctx->inline_emoji_cache[slot].used)
+    return;
+  stygian_inline_emoji_index_remove(ctx,
+                                    ctx->inline_emoji_cache[slot].glyph_hash);
+  stygian_inline_emoji_lru_unlink(ctx, slot);
+  memset(&ctx->inline_emoji_cache[slot], 0,
+         sizeof(ctx->inline_emoji_cache[slot]));
+  ctx->inline_emoji_used_count--;
+}
+
+static void stygian_inline_emoji_cache_release(StygianContext *ctx, int slot) {
+  if (!ctx->inline_emoji_cache[slot].used)
+    return;
+  stygian_inline_emoji_cache_unlink(ctx, slot);
+  ctx->inline_emoji_free[ctx->inline_emoji_free_count++] = (uint16_t)slot;
+}
+
+// Take the slot returned by choose_slot for key_hash (evicting its old entry).
+static void stygian_inline_emoji_cache_claim(StygianContext *ctx, int slot,
+                                             uint64_t key_hash) {
+  if (ctx->inline_emoji_cache[slot].used) {
+    stygian_inline_emoji_cache_unlink(ctx, slot);
+  } else if (ctx->inline_emoji_free_count > 0u &&
+             ctx->inline_emoji_free[ctx->inline_emoji_free_count - 1u] ==
+                 (uint16_t)slot) {
+    ctx->inline_emoji_free_count--;
+  } else {
+    ctx->inline_emoji_fresh++;
+  }
+  ctx->inline_emoji_cache[slot].used = true;
+  ctx->inline_emoji_cache[slot].glyph_hash = key_hash;
+  stygian_inline_emoji_index_insert(ctx, key_hash, slot);
+  stygian_inline_emoji_lru_push_front(ctx, slot);
+  ctx->inline_emoji_cache[slot].last_frame = ctx->frame_index;
+  ctx->inline_emoji_used_count++;
 }
 
 static int stygian_try_parse_shortcode(const char *str, size_t text_len,
@@ -886,67 +1059,277 @@ static int stygian_inline_emoji_has_entry(const StygianContext *ctx,
   return stygian_triad_lookup_glyph_id(ctx, normalized_id, &entry) ? 1 : 0;
 }
 
-static int stygian_inline_emoji_resolve_texture(StygianContext *ctx,
-                                                const char *normalized_id,
-                                                uint32_t *out_texture) {
-  StygianTriadEntryInfo entry;
+typedef enum StygianInlineEmojiState {
+  STYGIAN_INLINE_EMOJI_MISSING = 0, // Not in the pack (or failed): draw text
+  STYGIAN_INLINE_EMOJI_READY = 1,
+  STYGIAN_INLINE_EMOJI_PENDING = 2, // Decoding in the background
+} StygianInlineEmojiState;
+
+// Like stygian_request_repaint_after_ms, but tagged as async work so the
+// frame reason reads "decode" instead of a timer.
+static void stygian_request_repaint_async(StygianContext *ctx, uint32_t ms) {
+  uint64_t due_ms;
+  if (!ctx)
+    return;
+  due_ms = stygian_now_ms() + (uint64_t)ms;
+  if (ctx->repaint.deferred_due_ms == 0ull ||
+      due_ms < ctx->repaint.deferred_due_ms) {
+    ctx->repaint.deferred_due_ms = due_ms;
+  }
+  if (!ctx->repaint.has_pending || ctx->repaint.due_ms == 0ull ||
+      due_ms < ctx->repaint.due_ms) {
+    ctx->repaint.due_ms = due_ms;
+  }
+  ctx->repaint.has_pending = true;
+  stygian_mark_repaint_reason(ctx, STYGIAN_REPAINT_REASON_ASYNC);
+  if (ctx->repaint.source[0] == '\0') {
+    stygian_cpystr(ctx->repaint.source, sizeof(ctx->repaint.source),
+                   "decode");
+  }
+}
+
+static void stygian_inline_emoji_note_waiting_scope(StygianContext *ctx) {
+  StygianScopeId id;
+  uint32_t i;
+  if (!ctx || ctx->active_scope_index < 0)
+    return; // Unscoped content is re-emitted on every rebuilt frame
+  id = ctx->scope_cache[ctx->active_scope_index].id;
+  for (i = 0; i < ctx->decode_waiting_count; i++) {
+    if (ctx->decode_waiting_scopes[i] == id)
+      return;
+  }
+  if (ctx->decode_waiting_count < STYGIAN_DECODE_WAITING_SCOPES)
+    ctx->decode_waiting_scopes[ctx->decode_waiting_count++] = id;
+  else
+    ctx->decode_waiting_overflow = true;
+}
+
+static void stygian_emoji_atlas_cell_uv(int slot, float out_uv[4]) {
+  const float inv = 1.0f / (float)STYGIAN_EMOJI_ATLAS_PAGE_SIZE;
+  uint32_t cell = (uint32_t)slot % STYGIAN_EMOJI_ATLAS_CELLS_PER_PAGE;
+  float x0 = (float)((cell % STYGIAN_EMOJI_ATLAS_CELLS_PER_ROW) *
+                     STYGIAN_EMOJI_ATLAS_CELL_SIZE);
+  float y0 = (float)((cell / STYGIAN_EMOJI_ATLAS_CELLS_PER_ROW) *
+                     STYGIAN_EMOJI_ATLAS_CELL_SIZE);
+  // Half-texel inset keeps bilinear taps inside the cell
+  out_uv[0] = (x0 + 0.5f) * inv;
+  out_uv[1] = (y0 + 0.5f) * inv;
+  out_uv[2] = (x0 + (float)STYGIAN_EMOJI_ATLAS_CELL_SIZE - 0.5f) * inv;
+  out_uv[3] = (y0 + (float)STYGIAN_EMOJI_ATLAS_CELL_SIZE - 0.5f) * inv;
+}
+
+// Pages are created on first use; VK needs initial contents, so start clear.
+static StygianTexture stygian_emoji_atlas_page(StygianContext *ctx,
+                                               uint32_t page) {
+  uint8_t *blank;
+  if (page >= STYGIAN_EMOJI_ATLAS_MAX_PAGES)
+    return 0u;
+  if (ctx->emoji_atlas_pages[page] != 0u)
+    return ctx->emoji_atlas_pages[page];
+  blank = (uint8_t *)calloc(1, STYGIAN_EMOJI_ATLAS_PAGE_BYTES);
+  if (!blank)
+    return 0u;
+  ctx->emoji_atlas_pages[page] =
+      stygian_texture_create(ctx, STYGIAN_EMOJI_ATLAS_PAGE_SIZE,
+                             STYGIAN_EMOJI_ATLAS_PAGE_SIZE, blank);
+  free(blank);
+  return ctx->emoji_atlas_pages[page];
+}
+
+// Copy a CELL x CELL bitmap into its slot's atlas cell and mark it ready (or
+// failed when there is no bitmap or no page to put it in).
+static bool stygian_inline_emoji_cache_upload(StygianContext *ctx, int slot,
+                                              const uint8_t *cell) {
+  uint32_t index = (uint32_t)slot % STYGIAN_EMOJI_ATLAS_CELLS_PER_PAGE;
+  StygianTexture page = stygian_emoji_atlas_page(
+      ctx, (uint32_t)slot / STYGIAN_EMOJI_ATLAS_CELLS_PER_PAGE);
+  bool ok = false;
+
+  if (page != 0u && cell) {
+    ok = stygian_texture_update(
+        ctx, page,
+        (int)((index % STYGIAN_EMOJI_ATLAS_CELLS_PER_ROW) *
+              STYGIAN_EMOJI_ATLAS_CELL_SIZE),
+        (int)((index / STYGIAN_EMOJI_ATLAS_CELLS_PER_ROW) *
+              STYGIAN_EMOJI_ATLAS_CELL_SIZE),
+        STYGIAN_EMOJI_ATLAS_CELL_SIZE, STYGIAN_EMOJI_ATLAS_CELL_SIZE, cell);
+  }
+  ctx->inline_emoji_cache[slot].pending = false;
+  ctx->inline_emoji_cache[slot].ready = ok;
+  ctx->inline_emoji_cache[slot].failed = !ok;
+  return ok;
+}
+
+// Synchronous cell production: persistent disk cache first, else decode at
+// cell size (writing the result back). Goes through the pool when one exists
+// so the disk cache stays behind its lock.
+static bool stygian_inline_emoji_produce_cell(StygianContext *ctx,
+                                              uint64_t glyph_hash,
+                                              uint8_t *cell) {
   uint8_t *rgba = NULL;
   uint32_t w = 0, h = 0;
+  if (ctx->decode_pool)
+    return stygian_decode_pool_decode_now(ctx->decode_pool, glyph_hash, cell);
+  if (stygian_glyph_disk_cache_load(ctx->emoji_disk_cache, glyph_hash, cell))
+    return true;
+  if (!stygian_triad_decode_rgba_sized(ctx, glyph_hash,
+                                       STYGIAN_EMOJI_ATLAS_CELL_SIZE, &rgba,
+                                       &w, &h) ||
+      !rgba || w == 0u || h == 0u) {
+    stygian_triad_free_blob(rgba);
+    return false;
+  }
+  stygian_triad_downsample_rgba(rgba, w, h, cell,
+                                STYGIAN_EMOJI_ATLAS_CELL_SIZE);
+  stygian_triad_free_blob(rgba);
+  stygian_glyph_disk_cache_store(ctx->emoji_disk_cache, glyph_hash, cell);
+  return true;
+}
+
+static StygianInlineEmojiState
+stygian_inline_emoji_resolve_texture(StygianContext *ctx,
+                                     const char *normalized_id,
+                                     StygianTexture *out_texture,
+                                     float out_uv[4]) {
+  StygianTriadEntryInfo entry;
+  uint8_t cell[STYGIAN_EMOJI_ATLAS_CELL_SIZE * STYGIAN_EMOJI_ATLAS_CELL_SIZE *
+               4];
   uint64_t key_hash;
   int slot;
-  uint32_t tex = 0;
 
-  if (!ctx || !normalized_id || !normalized_id[0] || !out_texture)
-    return 0;
-  *out_texture = 0;
+  if (!ctx || !normalized_id || !normalized_id[0] || !out_texture || !out_uv)
+    return STYGIAN_INLINE_EMOJI_MISSING;
+  *out_texture = 0u;
 
   key_hash = stygian_hash_str64(normalized_id);
   slot = stygian_inline_emoji_cache_find(ctx, key_hash);
-  if (slot >= 0 && ctx->inline_emoji_cache[slot].texture_id != 0u) {
+  if (slot >= 0) {
+    const StygianInlineEmojiCacheEntry *cached =
+        &ctx->inline_emoji_cache[slot];
     stygian_inline_emoji_cache_touch(ctx, slot);
-    *out_texture = ctx->inline_emoji_cache[slot].texture_id;
-    return 1;
+    if (cached->ready) {
+      *out_texture = ctx->emoji_atlas_pages[(uint32_t)slot /
+                                            STYGIAN_EMOJI_ATLAS_CELLS_PER_PAGE];
+      stygian_emoji_atlas_cell_uv(slot, out_uv);
+      return STYGIAN_INLINE_EMOJI_READY;
+    }
+    if (cached->pending)
+      return STYGIAN_INLINE_EMOJI_PENDING;
+    if (cached->failed)
+      return STYGIAN_INLINE_EMOJI_MISSING;
   }
 
   if (!stygian_triad_is_mounted(ctx) ||
       !stygian_triad_lookup_glyph_id(ctx, normalized_id, &entry)) {
-    return 0;
-  }
-  if (!stygian_triad_decode_rgba(ctx, entry.glyph_hash, &rgba, &w, &h) ||
-      !rgba || w == 0u || h == 0u) {
-    return 0;
+    return STYGIAN_INLINE_EMOJI_MISSING;
   }
 
   slot = stygian_inline_emoji_cache_choose_slot(ctx);
-  if (slot < 0) {
-    stygian_triad_free_blob(rgba);
-    return 0;
+  if (slot < 0)
+    return STYGIAN_INLINE_EMOJI_MISSING; // Atlas budget full this frame
+
+  // Background path: claim the slot and let the frame-start drain upload it.
+  // A full queue leaves the slot unclaimed so a later frame retries.
+  if (ctx->decode_pool &&
+      (ctx->glyph_feature_flags & STYGIAN_GLYPH_DECODE_ASYNC) != 0u) {
+    if (!stygian_decode_pool_submit(ctx->decode_pool, key_hash,
+                                    entry.glyph_hash)) {
+      return STYGIAN_INLINE_EMOJI_PENDING;
+    }
+    stygian_inline_emoji_cache_claim(ctx, slot, key_hash);
+    ctx->inline_emoji_cache[slot].pending = true;
+    return STYGIAN_INLINE_EMOJI_PENDING;
   }
 
-  if (ctx->inline_emoji_cache[slot].used &&
-      ctx->inline_emoji_cache[slot].texture_id != 0u) {
-    stygian_texture_destroy(ctx, ctx->inline_emoji_cache[slot].texture_id);
-    ctx->inline_emoji_cache[slot].texture_id = 0u;
+  if (!stygian_inline_emoji_produce_cell(ctx, entry.glyph_hash, cell))
+    return STYGIAN_INLINE_EMOJI_MISSING;
+  stygian_inline_emoji_cache_claim(ctx, slot, key_hash);
+  if (!stygian_inline_emoji_cache_upload(ctx, slot, cell))
+    return STYGIAN_INLINE_EMOJI_MISSING;
+
+  *out_texture = ctx->emoji_atlas_pages[(uint32_t)slot /
+                                        STYGIAN_EMOJI_ATLAS_CELLS_PER_PAGE];
+  stygian_emoji_atlas_cell_uv(slot, out_uv);
+  return STYGIAN_INLINE_EMOJI_READY;
+}
+
+// Upload finished background decodes and re-dirty the scopes that drew
+// placeholders for them. Runs at frame start, before dirty-scope routing.
+static void stygian_inline_emoji_drain_decodes(StygianContext *ctx) {
+  StygianDecodeResult done[STYGIAN_DECODE_DRAIN_PER_FRAME];
+  uint32_t count;
+  uint32_t i;
+  if (!ctx || !ctx->decode_pool)
+    return;
+
+  count = stygian_decode_pool_drain(ctx->decode_pool, done,
+                                    STYGIAN_DECODE_DRAIN_PER_FRAME);
+  for (i = 0; i < count; i++) {
+    int slot = stygian_inline_emoji_cache_find(ctx, done[i].key_hash);
+    if (slot >= 0 && ctx->inline_emoji_cache[slot].pending) {
+      stygian_inline_emoji_cache_upload(ctx, slot,
+                                        done[i].ok ? done[i].rgba : NULL);
+    }
+    stygian_triad_free_blob(done[i].rgba);
   }
 
-  tex = stygian_texture_create(ctx, (int)w, (int)h, rgba);
-  stygian_triad_free_blob(rgba);
-  if (!tex)
-    return 0;
+  if (count > 0u) {
+    uint32_t reason = STYGIAN_REPAINT_REASON_ASYNC;
+    uint32_t source_tag = stygian_hash_cstr("decode");
+    if (ctx->decode_waiting_overflow) {
+      for (i = 0; i < ctx->scope_count; i++) {
+        stygian_scope_dirty_reason(ctx, ctx->scope_cache[i].id, false, reason,
+                                   source_tag);
+      }
+    } else {
+      for (i = 0; i < ctx->decode_waiting_count; i++) {
+        stygian_scope_dirty_reason(ctx, ctx->decode_waiting_scopes[i], false,
+                                   reason, source_tag);
+      }
+    }
+    ctx->decode_waiting_count = 0u;
+    ctx->decode_waiting_overflow = false;
+    stygian_mark_repaint_reason(ctx, reason);
+  }
+  if (stygian_decode_pool_outstanding(ctx->decode_pool) > 0u)
+    stygian_request_repaint_async(ctx, 16u);
+}
 
-  memset(&ctx->inline_emoji_cache[slot], 0,
-         sizeof(ctx->inline_emoji_cache[slot]));
-  ctx->inline_emoji_cache[slot].used = true;
-  ctx->inline_emoji_cache[slot].glyph_hash = key_hash;
-  ctx->inline_emoji_cache[slot].texture_id = tex;
-  ctx->inline_emoji_cache[slot].width =
-      (uint16_t)(w > UINT16_MAX ? UINT16_MAX : w);
-  ctx->inline_emoji_cache[slot].height =
-      (uint16_t)(h > UINT16_MAX ? UINT16_MAX : h);
-  stygian_inline_emoji_cache_touch(ctx, slot);
-
-  *out_texture = tex;
-  return 1;
+// Stop background decoding (before unmount/remount/destroy) and close the
+// disk cache. Slots still waiting on the pool are released so the next
+// lookup resubmits them.
+static void stygian_inline_emoji_stop_decodes(StygianContext *ctx) {
+  int i;
+  if (!ctx)
+    return;
+  if (ctx->decode_pool) {
+    stygian_decode_pool_destroy(ctx->decode_pool);
+    ctx->decode_pool = NULL;
+    for (i = 0; i < STYGIAN_INLINE_EMOJI_CACHE_SIZE; i++) {
+      if (ctx->inline_emoji_cache[i].pending)
+        stygian_inline_emoji_cache_release(ctx, i);
+    }
+    ctx->decode_waiting_count = 0u;
+    ctx->decode_waiting_overflow = false;
+  }
+  stygian_glyph_disk_cache_close(ctx->emoji_disk_cache);
+  ctx->emoji_disk_cache = NULL;
+}
+
+// Open the disk cache (when configured) and start workers for the mounted
+// pack. Without a pool (thread creation failed) emoji decode synchronously.
+static void stygian_inline_emoji_start_decodes(StygianContext *ctx) {
+  if (!stygian_triad_is_mounted(ctx))
+    return;
+  if (ctx->emoji_disk_cache_dir[0]) {
+    ctx->emoji_disk_cache = stygian_glyph_disk_cache_open(
+        ctx->emoji_disk_cache_dir,
+        stygian_triad_runtime_identity(ctx->triad_runtime),
+        STYGIAN_EMOJI_ATLAS_CELL_SIZE, ctx->emoji_disk_cache_bytes);
+  }
+  ctx->decode_pool = stygian_decode_pool_create(
+      ctx->triad_runtime, ctx->emoji_disk_cache, STYGIAN_EMOJI_ATLAS_CELL_SIZE,
+      STYGIAN_DECODE_POOL_WORKERS, STYGIAN_DECODE_POOL_QUEUE);
 }
 
 // ============================================================================
@@ -1216,6 +1599,7 @@ void stygian_scope_begin(StygianContext *ctx, StygianScopeId id) {
   }
 
   if (!entry->dirty && entry->range_count > 0u && !ctx->scope_replay_active &&
+      entry->clip_epoch == ctx->clip_epoch &&
       entry->range_start == ctx->element_count &&
       ctx->free_count >= entry->range_count) {
     can_replay = true;
@@ -1248,6 +1632,7 @@ void stygian_scope_begin(StygianContext *ctx, StygianScopeId id) {
     entry->clip_snapshot = ctx->clip_stack_top > 0u
                                ? ctx->clip_stack[ctx->clip_stack_top - 1u]
                                : 0u;
+    entry->clip_epoch = ctx->clip_epoch;
     entry->z_snapshot = 0.0f;
     ctx->scope_replay_active = false;
     ctx->scope_replay_cursor = 0u;
@@ -1394,11 +1779,30 @@ StygianContext *stygian_create(const StygianConfig *config) {
     ctx->config.max_elements = STYGIAN_MAX_ELEMENTS;
   if (ctx->config.max_textures == 0)
     ctx->config.max_textures = STYGIAN_MAX_TEXTURES;
+  if (ctx->config.max_clips == 0)
+    ctx->config.max_clips = STYGIAN_MAX_CLIPS;
+  if (ctx->config.max_clips > STYGIAN_CLIP_ID_LIMIT)
+    ctx->config.max_clips = STYGIAN_CLIP_ID_LIMIT;
+  if (ctx->config.max_clips > STYGIAN_CLIP_BUFFER_LIMIT)
+    ctx->config.max_clips = STYGIAN_CLIP_BUFFER_LIMIT;
   if (ctx->config.glyph_feature_flags == 0) {
     ctx->config.glyph_feature_flags = STYGIAN_GLYPH_FEATURE_DEFAULT;
   }
+  if (ctx->config.emoji_atlas_budget == 0) {
+    ctx->config.emoji_atlas_budget =
+        STYGIAN_EMOJI_ATLAS_MAX_PAGES * STYGIAN_EMOJI_ATLAS_PAGE_BYTES;
+  }
   ctx->allocator = allocator;
   ctx->glyph_feature_flags = ctx->config.glyph_feature_flags;
+  {
+    uint32_t pages =
+        ctx->config.emoji_atlas_budget / STYGIAN_EMOJI_ATLAS_PAGE_BYTES;
+    if (pages < 1u)
+      pages = 1u;
+    if (pages > STYGIAN_EMOJI_ATLAS_MAX_PAGES)
+      pages = STYGIAN_EMOJI_ATLAS_MAX_PAGES;
+    ctx->inline_emoji_slot_limit = pages * STYGIAN_EMOJI_ATLAS_CELLS_PER_PAGE;
+  }
   ctx->repaint.requested_hz_max = 0u;
   ctx->repaint.deferred_due_ms = 0ull;
   ctx->repaint.due_ms = 0ull;
@@ -1459,9 +1863,16 @@ StygianContext *stygian_create(const StygianConfig *config) {
   ctx->texture_backend_ids = (uint32_t *)stygian_alloc_array(
       allocator, ctx->config.max_textures, sizeof(uint32_t),
       _Alignof(uint32_t), true);
+  ctx->texture_atlas_ids = (uint32_t *)stygian_alloc_array(
+      allocator, ctx->config.max_textures, sizeof(uint32_t),
+      _Alignof(uint32_t), true);
+  ctx->texture_atlas_pixels = (uint8_t **)stygian_alloc_array(
+      allocator, ctx->config.max_textures, sizeof(uint8_t *),
+      _Alignof(uint8_t *), true);
 
   if (!ctx->free_list || !ctx->element_generations || !ctx->texture_free_list ||
-      !ctx->texture_generations || !ctx->texture_backend_ids) {
+      !ctx->texture_generations || !ctx->texture_backend_ids ||
+      !ctx->texture_atlas_ids || !ctx->texture_atlas_pixels) {
     stygian_destroy(ctx);
     return NULL;
   }
@@ -1510,6 +1921,21 @@ StygianContext *stygian_create(const StygianConfig *config) {
       stygian_destroy(ctx);
       return NULL;
     }
+    ctx->damage_hash = (uint64_t *)stygian_alloc_array(
+        allocator, max_el, sizeof(uint64_t), _Alignof(uint64_t), true);
+    ctx->damage_footprint = (StygianClipRect *)stygian_alloc_array(
+        allocator, max_el, sizeof(StygianClipRect), _Alignof(StygianClipRect),
+        true);
+    ctx->damage_chunk_versions = (uint32_t *)stygian_alloc_array(
+        allocator, (size_t)ctx->chunk_count * 3u, sizeof(uint32_t),
+        _Alignof(uint32_t), true);
+    if (!ctx->damage_hash || !ctx->damage_footprint ||
+        !ctx->damage_chunk_versions) {
+      stygian_destroy(ctx);
+      return NULL;
+    }
+    ctx->damage_tracking = true;
+    ctx->damage_full = true;
     // Init all chunks: dirty_min > dirty_max means "no dirty range"
     for (uint32_t ci = 0; ci < ctx->chunk_count; ci++) {
       ctx->chunks[ci].hot_dirty_min = UINT32_MAX;
@@ -1544,10 +1970,24 @@ StygianContext *stygian_create(const StygianConfig *config) {
     }
   }
 
-  // Allocate clip regions
+  // Allocate clip regions; the lookup stays at most half full.
   ctx->clips = (StygianClipRect *)stygian_alloc_array(
-      allocator, STYGIAN_MAX_CLIPS, sizeof(StygianClipRect),
+      allocator, ctx->config.max_clips, sizeof(StygianClipRect),
       _Alignof(StygianClipRect), true);
+  ctx->clip_frame = (uint32_t *)stygian_alloc_array(
+      allocator, ctx->config.max_clips, sizeof(uint32_t), _Alignof(uint32_t),
+      true);
+  ctx->clip_lookup_mask = 1u;
+  while (ctx->clip_lookup_mask < ctx->config.max_clips * 2u - 1u)
+    ctx->clip_lookup_mask = (ctx->clip_lookup_mask << 1) | 1u;
+  ctx->clip_lookup = (uint32_t *)stygian_alloc_array(
+      allocator, (size_t)ctx->clip_lookup_mask + 1u, sizeof(uint32_t),
+      _Alignof(uint32_t), true);
+  if (!ctx->clips || !ctx->clip_frame || !ctx->clip_lookup) {
+    stygian_destroy(ctx);
+    return NULL;
+  }
+  ctx->clip_count = 1u;
 
   // Allocate font storage
   ctx->fonts = (StygianFontAtlas *)stygian_alloc_array(
@@ -1609,6 +2049,7 @@ StygianContext *stygian_create(const StygianConfig *config) {
       .window = config->window,
       .max_elements = ctx->config.max_elements,
       .max_textures = ctx->config.max_textures,
+      .max_clips = ctx->config.max_clips,
       .shader_dir = resolved_shader_dir,
       .allocator = allocator,
   };
@@ -1671,15 +2112,38 @@ void stygian_destroy(StygianContext *ctx) {
     }
   }
 
-  for (i = 0; i < STYGIAN_INLINE_EMOJI_CACHE_SIZE; i++) {
-    if (ctx->inline_emoji_cache[i].used &&
-        ctx->inline_emoji_cache[i].texture_id != 0u) {
-      stygian_texture_destroy(ctx, ctx->inline_emoji_cache[i].texture_id);
-      ctx->inline_emoji_cache[i].texture_id = 0u;
+  stygian_inline_emoji_stop_decodes(ctx);
+  for (i = 0; i < STYGIAN_EMOJI_ATLAS_MAX_PAGES; i++) {
+    if (ctx->emoji_atlas_pages[i] != 0u) {
+      stygian_texture_destroy(ctx, ctx->emoji_atlas_pages[i]);
+      ctx->emoji_atlas_pages[i] = 0u;
     }
-    ctx->inline_emoji_cache[i].used = false;
+  }
+  memset(ctx->inline_emoji_cache, 0, sizeof(ctx->inline_emoji_cache));
+  memset(ctx->inline_emoji_index, 0, sizeof(ctx->inline_emoji_index));
+  ctx->inline_emoji_lru_head = 0u;
+  ctx->inline_emoji_lru_tail = 0u;
+  ctx->inline_emoji_free_count = 0u;
+  ctx->inline_emoji_fresh = 0u;
+  ctx->inline_emoji_used_count = 0u;
+
+  for (i = 0; i < (int)STYGIAN_COLOR_TRANSFORM_CACHE; i++) {
+    stygian_color_transform_destroy(ctx->color_transforms[i]);
+    ctx->color_transforms[i] = NULL;
   }
 
+  if (ctx->texture_atlas_pixels) {
+    for (uint32_t slot = 0u; slot < ctx->config.max_textures; slot++)
+      free(ctx->texture_atlas_pixels[slot]);
+  }
+  for (i = 0; i < (int)STYGIAN_TEXTURE_ATLAS_MAX_PAGES; i++) {
+    if (ctx->ap && ctx->texture_atlas_pages[i] != 0u)
+      stygian_ap_texture_destroy(ctx->ap, ctx->texture_atlas_pages[i]);
+    ctx->texture_atlas_pages[i] = 0u;
+  }
+  stygian_texture_atlas_destroy(ctx->texture_atlas);
+  ctx->texture_atlas = NULL;
+
   // Destroy graphics access point
   if (ctx->ap) {
     stygian_ap_destroy(ctx->ap);
@@ -1702,11 +2166,18 @@ void stygian_destroy(StygianContext *ctx) {
   stygian_free_raw(allocator, ctx->texture_free_list);
   stygian_free_raw(allocator, ctx->texture_generations);
   stygian_free_raw(allocator, ctx->texture_backend_ids);
+  stygian_free_raw(allocator, ctx->texture_atlas_ids);
+  stygian_free_raw(allocator, ctx->texture_atlas_pixels);
   stygian_free_raw(allocator, ctx->soa.hot);
   stygian_free_raw(allocator, ctx->soa.appearance);
   stygian_free_raw(allocator, ctx->soa.effects);
   stygian_free_raw(allocator, ctx->chunks);
+  stygian_free_raw(allocator, ctx->damage_hash);
+  stygian_free_raw(allocator, ctx->damage_footprint);
+  stygian_free_raw(allocator, ctx->damage_chunk_versions);
   stygian_free_raw(allocator, ctx->clips);
+  stygian_free_raw(allocator, ctx->clip_frame);
+  stygian_free_raw(allocator, ctx->clip_lookup);
   stygian_free_raw(allocator, ctx->fonts);
   stygian_free_raw(allocator, ctx->font_free_list);
   stygian_free_raw(allocator, ctx->font_generations);
@@ -1722,6 +2193,329 @@ void stygian_destroy(StygianContext *ctx) {
 
 StygianAP *stygian_get_ap(StygianContext *ctx) { return ctx ? ctx->ap : NULL; }
 
+// ============================================================================
+// Damage Tracking
+// ============================================================================
+
+// Each slot remembers a hash of the SoA rows it drew (and its clip rect) and
+// the screen rect they covered. At end of frame, slots in chunks that were
+// written since then are re-hashed; a changed slot damages its old and new
+// rect. Chunks nobody wrote were not re-uploaded either, so the GPU still
+// draws exactly what the hash describes. Texel changes are invisible to the
+// rows and damage the whole frame instead.
+
+static uint64_t stygian_damage_mix(uint64_t h, const void *data, size_t bytes) {
+  const uint32_t *w = (const uint32_t *)data;
+  for (size_t i = 0; i < bytes / sizeof(uint32_t); i++) {
+    h ^= w[i];
+    h *= 0x100000001b3ull;
+  }
+  return h;
+}
+
+// Pixel rect a visible slot covers: bounds, cut by its clip and the window,
+// grown to whole pixels. False when nothing is left.
+static bool stygian_damage_footprint(const StygianContext *ctx, uint32_t id,
+                                     StygianClipRect *out) {
+  const StygianSoAHot *hot = &ctx->soa.hot[id];
+  uint32_t clip_id = (hot->flags & STYGIAN_CLIP_MASK) >> STYGIAN_CLIP_SHIFT;
+  float x0 = hot->x, y0 = hot->y;
+  float x1 = hot->x + hot->w, y1 = hot->y + hot->h;
+  int ix0, iy0, ix1, iy1;
+  if (clip_id != 0u && clip_id < ctx->clip_count) {
+    const StygianClipRect *c = &ctx->clips[clip_id];
+    if (x0 < c->x)
+      x0 = c->x;
+    if (y0 < c->y)
+      y0 = c->y;
+    if (x1 > c->x + c->w)
+      x1 = c->x + c->w;
+    if (y1 > c->y + c->h)
+      y1 = c->y + c->h;
+  }
+  if (x0 < 0.0f)
+    x0 = 0.0f;
+  if (y0 < 0.0f)
+    y0 = 0.0f;
+  if (x1 > (float)ctx->width)
+    x1 = (float)ctx->width;
+  if (y1 > (float)ctx->height)
+    y1 = (float)ctx->height;
+  if (!(x1 > x0 && y1 > y0)) // Also rejects NaN bounds
+    return false;
+  ix0 = (int)x0;
+  iy0 = (int)y0;
+  ix1 = (int)x1;
+  iy1 = (int)y1;
+  if ((float)ix1 < x1)
+    ix1++;
+  if ((float)iy1 < y1)
+    iy1++;
+  out->x = (float)ix0;
+  out->y = (float)iy0;
+  out->w = (float)(ix1 - ix0);
+  out->h = (float)(iy1 - iy0);
+  return true;
+}
+
+static StygianDamageRect stygian_damage_union(const StygianDamageRect *a,
+                                              const StygianDamageRect *b) {
+  StygianDamageRect u;
+  float x1 = a->x + a->w > b->x + b->w ? a->x + a->w : b->x + b->w;
+  float y1 = a->y + a->h > b->y + b->h ? a->y + a->h : b->y + b->h;
+  u.x = a->x < b->x ? a->x : b->x;
+  u.y = a->y < b->y ? a->y : b->y;
+  u.w = x1 - u.x;
+  u.h = y1 - u.y;
+  return u;
+}
+
+// Add r to the frame's damage. Rects that touch merge; when the list is full
+// r merges with the rect whose union grows least, and the union then absorbs
+// whatever it reaches.
+static void stygian_damage_add(StygianContext *ctx,
+                               const StygianClipRect *clip) {
+  StygianDamageRect *list = ctx->last_frame_damage;
+  StygianDamageRect r = {clip->x, clip->y, clip->w, clip->h};
+  for (;;) {
+    uint32_t i = 0u, best = 0u;
+    float best_growth = 0.0f;
+    while (i < ctx->last_frame_damage_count) {
+      const StygianDamageRect *d = &list[i];
+      if (r.x <= d->x + d->w && d->x <= r.x + r.w && r.y <= d->y + d->h &&
+          d->y <= r.y + r.h) {
+        r = stygian_damage_union(&r, d);
+        list[i] = list[--ctx->last_frame_damage_count];
+        i = 0u;
+        continue;
+      }
+      i++;
+    }
+    if (ctx->last_frame_damage_count < STYGIAN_MAX_DAMAGE_RECTS) {
+      list[ctx->last_frame_damage_count++] = r;
+      return;
+    }
+    for (i = 0u; i < ctx->last_frame_damage_count; i++) {
+      StygianDamageRect u = stygian_damage_union(&r, &list[i]);
+      float growth = u.w * u.h - list[i].w * list[i].h;
+      if (i == 0u || growth < best_growth) {
+        best = i;
+        best_growth = growth;
+      }
+    }
+    r = stygian_damage_union(&r, &list[best]);
+    list[best] = list[--ctx->last_frame_damage_count];
+  }
+}
+
+// Diff the frame against what the last rendered frame drew and fill
+// last_frame_damage*. Render frames only: skipped and eval-only frames leave
+// the snapshot alone, so their changes land in the next rendered frame.
+static void stygian_damage_collect(StygianContext *ctx) {
+  uint32_t scan_end, chunk_end, ci;
+  bool rescan_all;
+  double area = 0.0;
+
+  ctx->last_frame_damage_count = 0u;
+  // Clip ids keep their rects until the table restarts, so only a restart
+  // can move an element's clip without touching its slot.
+  rescan_all = ctx->damage_full || !ctx->damage_hash ||
+               ctx->clip_epoch != ctx->damage_clip_epoch ||
+               ctx->width != ctx->damage_width ||
+               ctx->height != ctx->damage_height;
+  ctx->last_frame_damage_full = rescan_all;
+  ctx->damage_full = !ctx->damage_tracking;
+  ctx->damage_clip_epoch = ctx->clip_epoch;
+  ctx->damage_width = ctx->width;
+  ctx->damage_height = ctx->height;
+
+  if (ctx->damage_hash && ctx->damage_tracking) {
+    scan_end = ctx->element_count > ctx->damage_element_count
+                   ? ctx->element_count
+                   : ctx->damage_element_count;
+    for (ci = 0u; ci * ctx->chunk_size < scan_end; ci++) {
+      const StygianBufferChunk *c = &ctx->chunks[ci];
+      uint32_t *seen = &ctx->damage_chunk_versions[ci * 3u];
+      uint32_t base = ci * ctx->chunk_size;
+      bool written = seen[0] != c->hot_version ||
+                     seen[1] != c->appearance_version ||
+                     seen[2] != c->effects_version;
+      chunk_end = base + ctx->chunk_size;
+      if (chunk_end > scan_end)
+        chunk_end = scan_end;
+      // Slots leaving or joining the drawn range count as written.
+      if (!rescan_all && !written &&
+          chunk_end <= ctx->element_count &&
+          chunk_end <= ctx->damage_element_count)
+        continue;
+      seen[0] = c->hot_version;
+      seen[1] = c->appearance_version;
+      seen[2] = c->effects_version;
+      for (uint32_t id = base; id < chunk_end; id++) {
+        StygianClipRect now;
+        uint64_t h = 0u;
+        bool drawn = id < ctx->element_count &&
+                     (ctx->soa.hot[id].flags & STYGIAN_FLAG_VISIBLE) &&
+                     stygian_damage_footprint(ctx, id, &now);
+        if (drawn) {
+          uint32_t flags = ctx->soa.hot[id].flags;
+          uint32_t clip_id = (flags & STYGIAN_CLIP_MASK) >> STYGIAN_CLIP_SHIFT;
+          h = stygian_damage_mix(0xcbf29ce484222325ull, &ctx->soa.hot[id],
+                                 sizeof(StygianSoAHot));
+          h = stygian_damage_mix(h, &ctx->soa.appearance[id],
+                                 sizeof(StygianSoAAppearance));
+          h = stygian_damage_mix(h, &ctx->soa.effects[id],
+                                 sizeof(StygianSoAEffects));
+          if (clip_id != 0u && clip_id < ctx->clip_count)
+            h = stygian_damage_mix(h, &ctx->clips[clip_id],
+                                   sizeof(StygianClipRect));
+          h |= 1u; // 0 means "drew nothing"
+        }
+        if (h == ctx->damage_hash[id])
+          continue;
+        if (!rescan_all) {
+          if (ctx->damage_hash[id] != 0u)
+            stygian_damage_add(ctx, &ctx->damage_footprint[id]);
+          if (drawn)
+            stygian_damage_add(ctx, &now);
+        }
+        ctx->damage_hash[id] = h;
+        if (drawn)
+          ctx->damage_footprint[id] = now;
+      }
+    }
+    ctx->damage_element_count = ctx->element_count;
+  }
+
+  if (rescan_all) {
+    ctx->last_frame_damage[0] = (StygianDamageRect){
+        0.0f, 0.0f, (float)ctx->width, (float)ctx->height};
+    ctx->last_frame_damage_count = 1u;
+  }
+  for (uint32_t i = 0u; i < ctx->last_frame_damage_count; i++)
+    area += (double)ctx->last_frame_damage[i].w * ctx->last_frame_damage[i].h;
+  ctx->last_frame_damage_fraction =
+      ctx->width > 0 && ctx->height > 0
+          ? (float)(area / ((double)ctx->width * (double)ctx->height))
+          : 0.0f;
+  if (ctx->last_frame_damage_fraction > 1.0f)
+    ctx->last_frame_damage_fraction = 1.0f;
+}
+
+void stygian_set_damage_tracking(StygianContext *ctx, bool enabled) {
+  if (!ctx)
+    return;
+  ctx->damage_tracking = enabled;
+  ctx->damage_full = true;
+}
+
+uint32_t stygian_get_last_frame_damage(const StygianContext *ctx,
+                                       StygianDamageRect *out, uint32_t max) {
+  if (!ctx)
+    return 0u;
+  if (out) {
+    uint32_t n = ctx->last_frame_damage_count < max
+                     ? ctx->last_frame_damage_count
+                     : max;
+    memcpy(out, ctx->last_frame_damage, n * sizeof(StygianDamageRect));
+  }
+  return ctx->last_frame_damage_count;
+}
+
+float stygian_get_last_frame_damage_fraction(const StygianContext *ctx) {
+  return ctx ? ctx->last_frame_damage_fraction : 0.0f;
+}
+
+// ============================================================================
+// Clip Table
+// ============================================================================
+
+static uint32_t stygian_clip_hash(const StygianClipRect *r) {
+  uint32_t bits[4];
+  uint32_t h = 2166136261u;
+  memcpy(bits, r, sizeof(bits));
+  for (int i = 0; i < 4; i++) {
+    h ^= bits[i];
+    h *= 16777619u;
+  }
+  return h ^ (h >> 15);
+}
+
+// Drop every user clip. Ids handed out before now mean nothing afterwards:
+// scopes recorded against the old table rebuild instead of replaying.
+static void stygian_clip_table_reset(StygianContext *ctx) {
+  memset(ctx->clip_lookup, 0,
+         ((size_t)ctx->clip_lookup_mask + 1u) * sizeof(uint32_t));
+  ctx->clip_count = 1u;
+  ctx->clip_epoch++;
+  if (ctx->clip_upload_from > 1u)
+    ctx->clip_upload_from = 1u;
+}
+
+// Id of an equal rect already in the table, else a new one; 0 when full.
+static StygianClipId stygian_clip_intern(StygianContext *ctx,
+                                         const StygianClipRect *r) {
+  uint32_t slot = stygian_clip_hash(r) & ctx->clip_lookup_mask;
+  StygianClipId id;
+  while ((id = ctx->clip_lookup[slot]) != 0u) {
+    if (memcmp(&ctx->clips[id], r, sizeof(*r)) == 0)
+      return id;
+    slot = (slot + 1u) & ctx->clip_lookup_mask;
+  }
+  if (ctx->clip_count >= ctx->config.max_clips)
+    return 0u;
+  id = ctx->clip_count++;
+  ctx->clips[id] = *r;
+  ctx->clip_lookup[slot] = id;
+  return id;
+}
+
+// ============================================================================
+// Clip Reject
+// ============================================================================
+
+// Clips are stored already cut by their parents, so a slot whose bounds miss
+// its clip would be discarded by every fragment: leave it out of the draw.
+static bool stygian_clip_rejects(const StygianContext *ctx, uint32_t id) {
+  const StygianSoAHot *hot = &ctx->soa.hot[id];
+  uint32_t clip_id = (hot->flags & STYGIAN_CLIP_MASK) >> STYGIAN_CLIP_SHIFT;
+  const StygianClipRect *c;
+  if (clip_id == 0u || clip_id >= ctx->clip_count)
+    return false;
+  c = &ctx->clips[clip_id];
+  return !(c->w > 0.0f && c->h > 0.0f && hot->x < c->x + c->w &&
+           hot->x + hot->w > c->x && hot->y < c->y + c->h &&
+           hot->y + hot->h > c->y);
+}
+
+// Queue [start, start + count) as the runs of slots that survive the clip
+// reject; rejects in the middle of a range split it.
+static void stygian_draw_clipped_range(StygianContext *ctx, uint32_t start,
+                                       uint32_t count) {
+  uint32_t end = start + count, run = start;
+  if (count == 0u)
+    return;
+  if (ctx->clip_count <= 1u) {
+    stygian_ap_draw_range(ctx->ap, start, count);
+    ctx->frame_draw_calls++;
+    return;
+  }
+  for (uint32_t id = start; id < end; id++) {
+    if (!stygian_clip_rejects(ctx, id))
+      continue;
+    if (id > run) {
+      stygian_ap_draw_range(ctx->ap, run, id - run);
+      ctx->frame_draw_calls++;
+    }
+    ctx->frame_clip_rejects++;
+    run = id + 1u;
+  }
+  if (end > run) {
+    stygian_ap_draw_range(ctx->ap, run, end - run);
+    ctx->frame_draw_calls++;
+  }
+}
+
 // ============================================================================
 // Frame Management
 // ============================================================================
@@ -1748,6 +2542,7 @@ void stygian_begin_frame_intent(StygianContext *ctx, int width, int height,
 
   stygian_repaint_begin_frame(ctx);
   stygian_commit_pending_commands(ctx);
+  stygian_inline_emoji_drain_decodes(ctx);
 
   ctx->width = width;
   ctx->height = height;
@@ -1803,16 +2598,26 @@ void stygian_begin_frame_intent(StygianContext *ctx, int width, int height,
     ctx->skip_frame = true;
   }
 
-  // Reset clip stack
-  ctx->clip_count = 1;
-  ctx->clips[0] = (StygianClipRect){0.0f, 0.0f, (float)width, (float)height};
+  // The clip table carries over so repeated rects keep their ids; frames
+  // that rebuild restart it once it is half full.
+  if (!ctx->skip_frame && ctx->clip_count > ctx->config.max_clips / 2u)
+    stygian_clip_table_reset(ctx);
+  {
+    StygianClipRect window = {0.0f, 0.0f, (float)width, (float)height};
+    if (memcmp(&ctx->clips[0], &window, sizeof(window)) != 0) {
+      ctx->clips[0] = window;
+      ctx->clip_upload_from = 0u;
+    }
+  }
   ctx->clip_stack_top = 0;
+  ctx->frame_clip_uses = 0u;
 
   // Reset render layers
   ctx->layer_count = 0;
   ctx->layer_active = false;
   ctx->layer_start = 0;
   ctx->frame_draw_calls = 0;
+  ctx->frame_clip_rejects = 0;
   ctx->frame_begin_cpu_ms = stygian_now_ms();
   ctx->active_scope_stack_top = 0u;
   ctx->active_scope_index = -1;
@@ -1937,12 +2742,32 @@ bool stygian_get_glyph_source_color_profile(const StygianContext *ctx,
 bool stygian_triad_mount(StygianContext *ctx, const char *triad_path) {
   if (!ctx || !ctx->triad_runtime)
     return false;
-  return stygian_triad_runtime_mount(ctx->triad_runtime, triad_path);
+  stygian_inline_emoji_stop_decodes(ctx);
+  if (!stygian_triad_runtime_mount(ctx->triad_runtime, triad_path))
+    return false;
+  stygian_inline_emoji_start_decodes(ctx);
+  return true;
+}
+
+bool stygian_set_emoji_disk_cache(StygianContext *ctx, const char *dir,
+                                  uint64_t max_bytes) {
+  if (!ctx)
+    return false;
+  if (dir && strlen(dir) >= sizeof(ctx->emoji_disk_cache_dir))
+    return false;
+  stygian_inline_emoji_stop_decodes(ctx);
+  stygian_cpystr(ctx->emoji_disk_cache_dir, sizeof(ctx->emoji_disk_cache_dir),
+                 dir ? dir : "");
+  ctx->emoji_disk_cache_bytes = max_bytes;
+  stygian_inline_emoji_start_decodes(ctx);
+  return !ctx->emoji_disk_cache_dir[0] || !stygian_triad_is_mounted(ctx) ||
+         ctx->emoji_disk_cache != NULL;
 }
 
 void stygian_triad_unmount(StygianContext *ctx) {
   if (!ctx || !ctx->triad_runtime)
     return;
+  stygian_inline_emoji_stop_decodes(ctx);
   stygian_triad_runtime_unmount(ctx->triad_runtime);
 }
 
@@ -1998,6 +2823,19 @@ bool stygian_triad_decode_rgba(const StygianContext *ctx, uint64_t glyph_hash,
       ctx->triad_runtime, glyph_hash, out_rgba_data, out_width, out_height);
 }
 
+bool stygian_triad_decode_rgba_sized(const StygianContext *ctx,
+                                     uint64_t glyph_hash, uint32_t target_px,
+                                     uint8_t **out_rgba_data,
+                                     uint32_t *out_width,
+                                     uint32_t *out_height) {
+  if (!ctx || !ctx->triad_runtime)
+    return false;
+  return stygian_triad_runtime_decode_rgba_sized(ctx->triad_runtime,
+                                                 glyph_hash, target_px,
+                                                 out_rgba_data, out_width,
+                                                 out_height);
+}
+
 void stygian_triad_free_blob(void *ptr) {
   stygian_triad_runtime_free_blob(ptr);
 }
@@ -2048,8 +2886,10 @@ void stygian_end_frame(StygianContext *ctx) {
   if (ctx->skip_frame || ctx->eval_only_frame) {
     ctx->frames_skipped++;
     ctx->last_frame_element_count = ctx->element_count;
-    ctx->last_frame_clip_count = ctx->clip_count;
+    ctx->last_frame_clip_count = 1u + ctx->frame_clip_uses;
+    ctx->last_frame_clip_rejects = 0;
     ctx->last_frame_draw_calls = 0;
+    ctx->last_frame_draw_ranges = 0;
     ctx->last_frame_upload_bytes = 0;
     ctx->last_frame_upload_ranges = 0;
     ctx->last_frame_scope_replay_hits = ctx->frame_scope_replay_hits;
@@ -2059,6 +2899,10 @@ void stygian_end_frame(StygianContext *ctx) {
     ctx->last_frame_submit_ms = 0.0f;
     ctx->last_frame_present_ms = 0.0f;
     ctx->last_frame_gpu_ms = 0.0f;
+    ctx->last_frame_gpu_phase_count = 0;
+    ctx->last_frame_damage_count = 0u;
+    ctx->last_frame_damage_fraction = 0.0f;
+    ctx->last_frame_damage_full = false;
     ctx->last_frame_reason_flags = ctx->repaint.reason_flags;
     ctx->last_frame_eval_only = ctx->eval_only_frame ? 1u : 0u;
     ctx->frame_index++;
@@ -2079,17 +2923,24 @@ void stygian_end_frame(StygianContext *ctx) {
     return;
   }
 
+  stygian_damage_collect(ctx);
   stygian_ap_gpu_timer_begin(ctx->ap);
-  stygian_ap_set_clips(ctx->ap, (const float *)ctx->clips, ctx->clip_count);
+  stygian_ap_set_clips(ctx->ap, (const float *)ctx->clips, ctx->clip_count,
+                       ctx->clip_upload_from);
+  ctx->clip_upload_from = ctx->clip_count;
   stygian_ap_submit(ctx->ap, ctx->soa.hot, ctx->element_count);
   stygian_ap_submit_soa(ctx->ap, ctx->soa.hot, ctx->soa.appearance,
                         ctx->soa.effects, ctx->soa.element_count, ctx->chunks,
                         ctx->chunk_count, ctx->chunk_size);
+  stygian_ap_set_damage(ctx->ap,
+                        ctx->last_frame_damage_full
+                            ? NULL
+                            : (const float *)ctx->last_frame_damage,
+                        ctx->last_frame_damage_count);
 
   if (ctx->layer_count == 0) {
     // Single pass when no layered ordering is requested.
-    stygian_ap_draw(ctx->ap);
-    ctx->frame_draw_calls++;
+    stygian_draw_clipped_range(ctx, 0u, ctx->element_count);
   } else {
     // Layered draws preserve ordering while keeping contiguous gap ranges valid.
     uint32_t prev_end = 0;
@@ -2099,13 +2950,16 @@ void stygian_end_frame(StygianContext *ctx) {
 
       if (layer_start > prev_end) {
         uint32_t gap_count = layer_start - prev_end;
-        stygian_ap_draw_range(ctx->ap, prev_end, gap_count);
-        ctx->frame_draw_calls++;
+        if (ctx->gpu_phase_timing)
+          stygian_ap_gpu_timer_phase(ctx->ap, 0);
+        stygian_draw_clipped_range(ctx, prev_end, gap_count);
       }
 
       if (layer_count > 0) {
-        stygian_ap_draw_range(ctx->ap, layer_start, layer_count);
-        ctx->frame_draw_calls++;
+        // GPU phase 1 + i times layer i; gaps belong to the main pass.
+        if (ctx->gpu_phase_timing)
+          stygian_ap_gpu_timer_phase(ctx->ap, 1u + i);
+        stygian_draw_clipped_range(ctx, layer_start, layer_count);
       }
 
       prev_end = layer_start + layer_count;
@@ -2113,19 +2967,25 @@ void stygian_end_frame(StygianContext *ctx) {
 
     if (ctx->element_count > prev_end) {
       uint32_t gap_count = ctx->element_count - prev_end;
-      stygian_ap_draw_range(ctx->ap, prev_end, gap_count);
-      ctx->frame_draw_calls++;
+      if (ctx->gpu_phase_timing)
+        stygian_ap_gpu_timer_phase(ctx->ap, 0);
+      stygian_draw_clipped_range(ctx, prev_end, gap_count);
     }
   }
   t_submit_end = stygian_now_ms();
   stygian_ap_gpu_timer_end(ctx->ap);
 
   ctx->last_frame_element_count = ctx->element_count;
-  ctx->last_frame_clip_count = ctx->clip_count;
-  ctx->last_frame_draw_calls = ctx->frame_draw_calls;
+  ctx->last_frame_clip_count = 1u + ctx->frame_clip_uses;
+  ctx->last_frame_clip_rejects = ctx->frame_clip_rejects;
+  ctx->last_frame_draw_ranges = ctx->frame_draw_calls;
   ctx->last_frame_upload_bytes = stygian_ap_get_last_upload_bytes(ctx->ap);
   ctx->last_frame_upload_ranges = stygian_ap_get_last_upload_ranges(ctx->ap);
   ctx->last_frame_gpu_ms = stygian_ap_get_last_gpu_ms(ctx->ap);
+  ctx->last_frame_gpu_phase_count = stygian_ap_get_last_gpu_phases(
+      ctx->ap, ctx->last_frame_gpu_phase_ms, STYGIAN_AP_GPU_PHASES);
+  if (ctx->last_frame_gpu_phase_count > STYGIAN_AP_GPU_PHASES)
+    ctx->last_frame_gpu_phase_count = STYGIAN_AP_GPU_PHASES;
   ctx->last_frame_scope_replay_hits = ctx->frame_scope_replay_hits;
   ctx->last_frame_scope_replay_misses = ctx->frame_scope_replay_misses;
   ctx->last_frame_scope_forced_rebuilds = ctx->frame_scope_forced_rebuilds;
@@ -2135,8 +2995,9 @@ void stygian_end_frame(StygianContext *ctx) {
   ctx->last_frame_eval_only = 0u;
   ctx->frame_index++;
 
-  // Finalize backend frame state before present.
+  // Finalize backend frame state before present; queued draws go out here.
   stygian_ap_end_frame(ctx->ap);
+  ctx->last_frame_draw_calls = stygian_ap_get_last_draw_calls(ctx->ap);
 
   // Present only on render-intent frames.
   stygian_ap_swap(ctx->ap);
@@ -2224,6 +3085,10 @@ uint32_t stygian_get_last_frame_draw_calls(const StygianContext *ctx) {
   return ctx ? ctx->last_frame_draw_calls : 0u;
 }
 
+uint32_t stygian_get_last_frame_draw_ranges(const StygianContext *ctx) {
+  return ctx ? ctx->last_frame_draw_ranges : 0u;
+}
+
 uint32_t stygian_get_last_frame_element_count(const StygianContext *ctx) {
   return ctx ? ctx->last_frame_element_count : 0u;
 }
@@ -2232,6 +3097,10 @@ uint32_t stygian_get_last_frame_clip_count(const StygianContext *ctx) {
   return ctx ? ctx->last_frame_clip_count : 0u;
 }
 
+uint32_t stygian_get_last_frame_clip_rejects(const StygianContext *ctx) {
+  return ctx ? ctx->last_frame_clip_rejects : 0u;
+}
+
 uint32_t stygian_get_last_frame_upload_bytes(const StygianContext *ctx) {
   return ctx ? ctx->last_frame_upload_bytes : 0u;
 }
@@ -2269,6 +3138,24 @@ float stygian_get_last_frame_gpu_ms(const StygianContext *ctx) {
   return ctx ? ctx->last_frame_gpu_ms : 0.0f;
 }
 
+void stygian_set_gpu_phase_timing(StygianContext *ctx, bool enabled) {
+  if (ctx)
+    ctx->gpu_phase_timing = enabled;
+}
+
+uint32_t stygian_get_last_frame_gpu_phases(const StygianContext *ctx,
+                                           float *out_ms, uint32_t max_phases) {
+  uint32_t n;
+  if (!ctx)
+    return 0;
+  n = ctx->last_frame_gpu_phase_count < max_phases
+          ? ctx->last_frame_gpu_phase_count
+          : max_phases;
+  if (out_ms && n > 0)
+    memcpy(out_ms, ctx->last_frame_gpu_phase_ms, n * sizeof(float));
+  return ctx->last_frame_gpu_phase_count;
+}
+
 uint32_t stygian_get_last_frame_reason_flags(const StygianContext *ctx) {
   return ctx ? ctx->last_frame_reason_flags : STYGIAN_REPAINT_REASON_NONE;
 }
@@ -2302,20 +3189,11 @@ uint32_t stygian_get_font_count(const StygianContext *ctx) {
 }
 
 uint32_t stygian_get_inline_emoji_cache_count(const StygianContext *ctx) {
-  uint32_t count = 0u;
-  uint32_t i = 0u;
-  if (!ctx)
-    return 0u;
-  for (i = 0u; i < STYGIAN_INLINE_EMOJI_CACHE_SIZE; ++i) {
-    if (ctx->inline_emoji_cache[i].used)
-      count++;
-  }
-  return count;
+  return ctx ? ctx->inline_emoji_used_count : 0u;
 }
 
-uint16_t stygian_get_clip_capacity(const StygianContext *ctx) {
-  (void)ctx;
-  return STYGIAN_MAX_CLIPS;
+uint32_t stygian_get_clip_capacity(const StygianContext *ctx) {
+  return ctx ? ctx->config.max_clips : 0u;
 }
 
 uint32_t stygian_get_last_commit_applied(const StygianContext *ctx) {
@@ -2427,7 +3305,7 @@ StygianElement stygian_element(StygianContext *ctx) {
 
   uint32_t flags = STYGIAN_FLAG_ALLOCATED | STYGIAN_FLAG_VISIBLE;
   if (ctx->clip_stack_top > 0) {
-    uint8_t active_clip = ctx->clip_stack[ctx->clip_stack_top - 1];
+    StygianClipId active_clip = ctx->clip_stack[ctx->clip_stack_top - 1];
     flags |= ((uint32_t)active_clip << STYGIAN_CLIP_SHIFT);
   }
   ctx->soa.hot[id].flags = flags;
@@ -2489,7 +3367,7 @@ uint32_t stygian_element_batch(StygianContext *ctx, uint32_t count,
   // Compute clip flag once for all elements
   uint32_t base_flags = STYGIAN_FLAG_ALLOCATED | STYGIAN_FLAG_VISIBLE;
   if (ctx->clip_stack_top > 0) {
-    uint8_t active_clip = ctx->clip_stack[ctx->clip_stack_top - 1];
+    StygianClipId active_clip = ctx->clip_stack[ctx->clip_stack_top - 1];
     base_flags |= ((uint32_t)active_clip << STYGIAN_CLIP_SHIFT);
   }
 
@@ -2640,12 +3518,26 @@ void stygian_set_texture(StygianContext *ctx, StygianElement e,
                          StygianTexture tex, float u0, float v0, float u1,
                          float v1) {
   uint32_t id;
+  uint32_t slot = 0u;
   uint32_t backend_tex = 0u;
+  StygianTextureAtlasRect rect;
   if (!stygian_resolve_element_slot(ctx, e, &id))
     return;
-  if (tex != 0u && !stygian_resolve_texture_slot(ctx, tex, NULL, &backend_tex))
+  if (tex != 0u &&
+      !stygian_resolve_texture_slot(ctx, tex, &slot, &backend_tex))
     return;
 
+  // Atlased textures: map the caller's texture-space UVs onto their page.
+  if (tex != 0u && ctx->texture_atlas_ids[slot] != 0u &&
+      stygian_texture_atlas_rect(ctx->texture_atlas,
+                                 ctx->texture_atlas_ids[slot], &rect)) {
+    const float inv_page = 1.0f / (float)STYGIAN_TEXTURE_ATLAS_PAGE_SIZE;
+    u0 = ((float)rect.x + u0 * (float)rect.w) * inv_page;
+    u1 = ((float)rect.x + u1 * (float)rect.w) * inv_page;
+    v0 = ((float)rect.y + v0 * (float)rect.h) * inv_page;
+    v1 = ((float)rect.y + v1 * (float)rect.h) * inv_page;
+  }
+
   ctx->soa.hot[id].texture_id = backend_tex;
   stygian_mark_soa_hot_dirty(ctx, id);
   ctx->soa.appearance[id].uv[0] = u0;
@@ -3058,7 +3950,8 @@ bool stygian_cmd_set_glow(StygianCmdBuffer *buffer, StygianElement element,
   return stygian_cmd_append_record(buffer, &record);
 }
 
-void stygian_set_clip(StygianContext *ctx, StygianElement e, uint8_t clip_id) {
+void stygian_set_clip(StygianContext *ctx, StygianElement e,
+                      StygianClipId clip_id) {
   uint32_t id;
   if (!stygian_resolve_element_slot(ctx, e, &id))
     return;
@@ -3076,21 +3969,42 @@ void stygian_set_clip(StygianContext *ctx, StygianElement e, uint8_t clip_id) {
 // Clip Stack
 // ============================================================================
 
-uint8_t stygian_clip_push(StygianContext *ctx, float x, float y, float w,
-                          float h) {
+StygianClipId stygian_clip_push(StygianContext *ctx, float x, float y,
+                                float w, float h) {
+  StygianClipRect r;
+  StygianClipId id;
   if (!ctx)
     return 0;
 
-  if (ctx->clip_count == 0) {
-    ctx->clip_count = 1;
-  }
+  // Resolve against the enclosing clip now: the GPU tests one rect per
+  // fragment, and the draw pass rejects against the same rect.
+  if (ctx->clip_stack_top > 0) {
+    const StygianClipRect *parent =
+        &ctx->clips[ctx->clip_stack[ctx->clip_stack_top - 1]];
+    float x1 = x + w, y1 = y + h;
+    if (x < parent->x)
+      x = parent->x;
+    if (y < parent->y)
+      y = parent->y;
+    if (x1 > parent->x + parent->w)
+      x1 = parent->x + parent->w;
+    if (y1 > parent->y + parent->h)
+      y1 = parent->y + parent->h;
+    w = x1 > x ? x1 - x : 0.0f;
+    h = y1 > y ? y1 - y : 0.0f;
+  }
+  // Every empty clip hides the same nothing: share one entry.
+  r = (w > 0.0f && h > 0.0f) ? (StygianClipRect){x, y, w, h}
+                             : (StygianClipRect){0.0f, 0.0f, 0.0f, 0.0f};
 
   // clip id 0 is reserved for "no clip".
-  if (ctx->clip_count >= STYGIAN_MAX_CLIPS || ctx->clip_count > 0xFFu)
+  id = stygian_clip_intern(ctx, &r);
+  if (id == 0u)
     return 0;
-
-  uint8_t id = (uint8_t)ctx->clip_count;
-  ctx->clips[ctx->clip_count++] = (StygianClipRect){x, y, w, h};
+  if (ctx->clip_frame[id] != ctx->frame_index + 1u) {
+    ctx->clip_frame[id] = ctx->frame_index + 1u;
+    ctx->frame_clip_uses++;
+  }
 
   if (ctx->clip_stack_top < 32) {
     ctx->clip_stack[ctx->clip_stack_top++] = id;
@@ -3454,12 +4368,214 @@ StygianWindow *stygian_get_window(StygianContext *ctx) {
 // Texture API (delegates to AP)
 // ============================================================================
 
-StygianTexture stygian_texture_create(StygianContext *ctx, int w, int h,
-                                      const void *rgba) {
+// Upload texels [x, x+w) x [y, y+h) of an atlased slot from its CPU copy.
+// Edges of the texture also refresh the gutter with clamped texels, so
+// bilinear filtering at the border matches a standalone clamp-to-edge
+// texture.
+static bool stygian_texture_atlas_upload(StygianContext *ctx, uint32_t slot,
+                                         int x, int y, int w, int h) {
+  StygianTextureAtlasRect rect;
+  const uint8_t *src = ctx->texture_atlas_pixels[slot];
+  int x0, y0, x1, y1, px, py;
+  uint8_t *staging;
+  bool ok;
+  if (!src || !stygian_texture_atlas_rect(ctx->texture_atlas,
+                                          ctx->texture_atlas_ids[slot], &rect))
+    return false;
+  x0 = x == 0 ? -(int)STYGIAN_TEXTURE_ATLAS_PADDING : x;
+  y0 = y == 0 ? -(int)STYGIAN_TEXTURE_ATLAS_PADDING : y;
+  x1 = x + w == (int)rect.w ? (int)(rect.w + STYGIAN_TEXTURE_ATLAS_PADDING)
+                            : x + w;
+  y1 = y + h == (int)rect.h ? (int)(rect.h + STYGIAN_TEXTURE_ATLAS_PADDING)
+                            : y + h;
+  staging = (uint8_t *)malloc((size_t)(x1 - x0) * (size_t)(y1 - y0) * 4u);
+  if (!staging)
+    return false;
+  for (py = y0; py < y1; py++) {
+    int sy = py < 0 ? 0 : (py >= (int)rect.h ? (int)rect.h - 1 : py);
+    uint8_t *dst = staging + (size_t)(py - y0) * (size_t)(x1 - x0) * 4u;
+    for (px = x0; px < x1; px++) {
+      int sx = px < 0 ? 0 : (px >= (int)rect.w ? (int)rect.w - 1 : px);
+      memcpy(dst + (size_t)(px - x0) * 4u,
+             src + ((size_t)sy * rect.w + (size_t)sx) * 4u, 4u);
+    }
+  }
+  ok = stygian_ap_texture_update(ctx->ap,
+                                 ctx->texture_atlas_pages[rect.page],
+                                 (int)rect.x + x0, (int)rect.y + y0, x1 - x0,
+                                 y1 - y0, staging);
+  free(staging);
+  return ok;
+}
+
+// Pages are created on first use; VK needs initial contents, so start clear.
+static bool stygian_texture_atlas_ensure_pages(StygianContext *ctx) {
+  uint32_t count = stygian_texture_atlas_page_count(ctx->texture_atlas);
+  uint8_t *blank = NULL;
+  bool ok = true;
+  for (uint32_t p = 0u; p < count && ok; p++) {
+    if (ctx->texture_atlas_pages[p] != 0u)
+      continue;
+    if (!blank) {
+      blank = (uint8_t *)calloc(1, (size_t)STYGIAN_TEXTURE_ATLAS_PAGE_SIZE *
+                                       STYGIAN_TEXTURE_ATLAS_PAGE_SIZE * 4u);
+      if (!blank)
+        return false;
+    }
+    ctx->texture_atlas_pages[p] = stygian_ap_texture_create(
+        ctx->ap, (int)STYGIAN_TEXTURE_ATLAS_PAGE_SIZE,
+        (int)STYGIAN_TEXTURE_ATLAS_PAGE_SIZE, blank);
+    ok = ctx->texture_atlas_pages[p] != 0u;
+  }
+  free(blank);
+  return ok;
+}
+
+static uint32_t stygian_texture_atlas_page_of(const StygianContext *ctx,
+                                              uint32_t backend_id) {
+  uint32_t p;
+  for (p = 0u; p < STYGIAN_TEXTURE_ATLAS_MAX_PAGES; p++) {
+    if (backend_id != 0u && ctx->texture_atlas_pages[p] == backend_id)
+      return p;
+  }
+  return UINT32_MAX;
+}
+
+// Close the holes left by destroyed textures. Every atlased slot is
+// re-uploaded at its new place and elements already pointing into a page
+// are moved with it: an element's UV centre identifies the slot whose old
+// rect it samples, since rects never overlap.
+static bool stygian_texture_atlas_compact(StygianContext *ctx) {
+  StygianTextureAtlasRect *old_rects;
+  uint32_t max_textures = ctx->config.max_textures;
+  uint32_t slot, id;
+  bool ok = true;
+
+  // Cleared up front: a repack that fails now fails again until something
+  // is freed, so failed allocs must not retry it on every texture create.
+  ctx->texture_atlas_has_holes = false;
+  old_rects = (StygianTextureAtlasRect *)calloc(max_textures,
+                                                sizeof(*old_rects));
+  if (!old_rects)
+    return false;
+  for (slot = 0u; slot < max_textures; slot++) {
+    if (ctx->texture_atlas_ids[slot] != 0u)
+      stygian_texture_atlas_rect(ctx->texture_atlas,
+                                 ctx->texture_atlas_ids[slot],
+                                 &old_rects[slot]);
+  }
+  if (!stygian_texture_atlas_repack(ctx->texture_atlas)) {
+    free(old_rects);
+    return false;
+  }
+  ctx->damage_full = true;
+  // The layout has moved either way; a page that cannot be created only
+  // loses the uploads aimed at it.
+  ok = stygian_texture_atlas_ensure_pages(ctx);
+
+  for (id = 0u; id < ctx->element_count; id++) {
+    StygianSoAHot *hot = &ctx->soa.hot[id];
+    float *uv = ctx->soa.appearance[id].uv;
+    uint32_t page = stygian_texture_atlas_page_of(ctx, hot->texture_id);
+    float cx, cy;
+    if (page == UINT32_MAX)
+      continue;
+    cx = (uv[0] + uv[2]) * 0.5f * (float)STYGIAN_TEXTURE_ATLAS_PAGE_SIZE;
+    cy = (uv[1] + uv[3]) * 0.5f * (float)STYGIAN_TEXTURE_ATLAS_PAGE_SIZE;
+    for (slot = 0u; slot < max_textures; slot++) {
+      const StygianTextureAtlasRect *o = &old_rects[slot];
+      StygianTextureAtlasRect now;
+      float dx, dy;
+      if (ctx->texture_atlas_ids[slot] == 0u || o->page != page ||
+          cx < (float)o->x || cy < (float)o->y ||
+          cx > (float)(o->x + o->w) || cy > (float)(o->y + o->h))
+        continue;
+      stygian_texture_atlas_rect(ctx->texture_atlas,
+                                 ctx->texture_atlas_ids[slot], &now);
+      dx = ((float)now.x - (float)o->x) /
+           (float)STYGIAN_TEXTURE_ATLAS_PAGE_SIZE;
+      dy = ((float)now.y - (float)o->y) /
+           (float)STYGIAN_TEXTURE_ATLAS_PAGE_SIZE;
+      uv[0] += dx;
+      uv[2] += dx;
+      uv[1] += dy;
+      uv[3] += dy;
+      hot->texture_id = ctx->texture_atlas_pages[now.page];
+      stygian_mark_soa_hot_dirty(ctx, id);
+      stygian_mark_soa_appearance_dirty(ctx, id);
+      break;
+    }
+  }
+
+  for (slot = 0u; slot < max_textures; slot++) {
+    StygianTextureAtlasRect now;
+    if (ctx->texture_atlas_ids[slot] == 0u ||
+        !stygian_texture_atlas_rect(ctx->texture_atlas,
+                                    ctx->texture_atlas_ids[slot], &now))
+      continue;
+    ctx->texture_backend_ids[slot] = ctx->texture_atlas_pages[now.page];
+    if (!stygian_texture_atlas_upload(ctx, slot, 0, 0, (int)now.w,
+                                      (int)now.h))
+      ok = false;
+  }
+  free(old_rects);
+  return ok;
+}
+
+// Place a small texture on a shared page. 0 leaves the caller to fall back
+// to a texture of its own (pages full even after compaction).
+static StygianTexture stygian_texture_atlas_insert(StygianContext *ctx, int w,
+                                                   int h, const void *rgba) {
+  StygianTextureAtlasRect rect;
+  size_t bytes = (size_t)w * (size_t)h * 4u;
+  uint8_t *pixels;
+  uint32_t id, slot;
+
+  if (ctx->texture_free_count == 0u)
+    return 0u;
+  if (!ctx->texture_atlas) {
+    ctx->texture_atlas = stygian_texture_atlas_create(
+        STYGIAN_TEXTURE_ATLAS_PAGE_SIZE, STYGIAN_TEXTURE_ATLAS_MAX_PAGES,
+        STYGIAN_TEXTURE_ATLAS_PADDING);
+    if (!ctx->texture_atlas)
+      return 0u;
+  }
+  id = stygian_texture_atlas_alloc(ctx->texture_atlas, (uint32_t)w,
+                                   (uint32_t)h);
+  if (id == 0u && ctx->texture_atlas_has_holes &&
+      stygian_texture_atlas_compact(ctx))
+    id = stygian_texture_atlas_alloc(ctx->texture_atlas, (uint32_t)w,
+                                     (uint32_t)h);
+  if (id == 0u)
+    return 0u;
+  pixels = (uint8_t *)malloc(bytes);
+  if (!pixels || !stygian_texture_atlas_ensure_pages(ctx) ||
+      !stygian_texture_atlas_rect(ctx->texture_atlas, id, &rect)) {
+    free(pixels);
+    stygian_texture_atlas_free(ctx->texture_atlas, id);
+    return 0u;
+  }
+  if (rgba)
+    memcpy(pixels, rgba, bytes);
+  else
+    memset(pixels, 0, bytes);
+
+  slot = ctx->texture_free_list[--ctx->texture_free_count];
+  ctx->texture_backend_ids[slot] = ctx->texture_atlas_pages[rect.page];
+  ctx->texture_atlas_ids[slot] = id;
+  ctx->texture_atlas_pixels[slot] = pixels;
+  ctx->texture_count++;
+  stygian_texture_atlas_upload(ctx, slot, 0, 0, w, h);
+  return (StygianTexture)stygian_make_handle(slot, ctx->texture_generations[slot]);
+}
+
+// A texture with a backend id of its own. Internal atlases (fonts) use this
+// directly: they write page UVs themselves and must not be repacked.
+static StygianTexture stygian_texture_create_standalone(StygianContext *ctx,
+                                                        int w, int h,
+                                                        const void *rgba) {
   uint32_t backend_id;
   uint32_t slot;
-  if (!ctx || !ctx->ap)
-    return 0;
   backend_id = stygian_ap_texture_create(ctx->ap, w, h, rgba);
   if (backend_id == 0u)
     return 0u;
@@ -3473,14 +4589,46 @@ StygianTexture stygian_texture_create(StygianContext *ctx, int w, int h,
   return (StygianTexture)stygian_make_handle(slot, ctx->texture_generations[slot]);
 }
 
+StygianTexture stygian_texture_create(StygianContext *ctx, int w, int h,
+                                      const void *rgba) {
+  if (!ctx || !ctx->ap)
+    return 0;
+  if (w > 0 && h > 0 && w <= STYGIAN_TEXTURE_ATLAS_MAX_ITEM &&
+      h <= STYGIAN_TEXTURE_ATLAS_MAX_ITEM) {
+    StygianTexture atlased = stygian_texture_atlas_insert(ctx, w, h, rgba);
+    if (atlased != 0u)
+      return atlased;
+  }
+  return stygian_texture_create_standalone(ctx, w, h, rgba);
+}
+
 bool stygian_texture_update(StygianContext *ctx, StygianTexture tex, int x,
                             int y, int w, int h, const void *rgba) {
+  uint32_t slot;
   uint32_t backend_id;
+  StygianTextureAtlasRect rect;
   if (!ctx || !ctx->ap || !tex)
     return false;
-  if (!stygian_resolve_texture_slot(ctx, tex, NULL, &backend_id))
+  if (!stygian_resolve_texture_slot(ctx, tex, &slot, &backend_id))
+    return false;
+  // Elements sampling the texture do not change, only their pixels.
+  ctx->damage_full = true;
+  if (ctx->texture_atlas_ids[slot] == 0u)
+    return stygian_ap_texture_update(ctx->ap, backend_id, x, y, w, h, rgba);
+
+  // Atlased: keep the CPU copy current, then upload the touched rows.
+  if (!rgba || w <= 0 || h <= 0 || x < 0 || y < 0 ||
+      !stygian_texture_atlas_rect(ctx->texture_atlas,
+                                  ctx->texture_atlas_ids[slot], &rect) ||
+      x + w > (int)rect.w || y + h > (int)rect.h)
     return false;
-  return stygian_ap_texture_update(ctx->ap, backend_id, x, y, w, h, rgba);
+  for (int row = 0; row < h; row++) {
+    memcpy(ctx->texture_atlas_pixels[slot] +
+               ((size_t)(y + row) * rect.w + (size_t)x) * 4u,
+           (const uint8_t *)rgba + (size_t)row * (size_t)w * 4u,
+           (size_t)w * 4u);
+  }
+  return stygian_texture_atlas_upload(ctx, slot, x, y, w, h);
 }
 
 void stygian_texture_destroy(StygianContext *ctx, StygianTexture tex) {
@@ -3490,13 +4638,24 @@ void stygian_texture_destroy(StygianContext *ctx, StygianTexture tex) {
     return;
   if (!stygian_resolve_texture_slot(ctx, tex, &slot, &backend_id))
     return;
-  stygian_ap_texture_destroy(ctx->ap, backend_id);
+  if (ctx->texture_atlas_ids[slot] != 0u) {
+    // The page stays; its texels are reused by the next small texture.
+    stygian_texture_atlas_free(ctx->texture_atlas,
+                               ctx->texture_atlas_ids[slot]);
+    free(ctx->texture_atlas_pixels[slot]);
+    ctx->texture_atlas_ids[slot] = 0u;
+    ctx->texture_atlas_pixels[slot] = NULL;
+    ctx->texture_atlas_has_holes = true;
+  } else {
+    stygian_ap_texture_destroy(ctx->ap, backend_id);
+  }
   ctx->texture_backend_ids[slot] = 0u;
   ctx->texture_generations[slot] =
       stygian_bump_generation(ctx->texture_generations[slot]);
   ctx->texture_free_list[ctx->texture_free_count++] = slot;
   if (ctx->texture_count > 0u)
     ctx->texture_count--;
+  ctx->damage_full = true;
 }
 
 // ============================================================================
@@ -3541,14 +4700,16 @@ StygianFont stygian_font_load(StygianContext *ctx, const char *atlas_png,
   if (ctx->glyph_color_transform_enabled && mtsdf.pixels &&
       mtsdf.atlas_width > 0 && mtsdf.atlas_height > 0) {
     size_t pixel_count = (size_t)mtsdf.atlas_width * (size_t)mtsdf.atlas_height;
-    stygian_color_transform_rgba8(&ctx->glyph_source_color_profile,
-                                  &ctx->output_color_profile, mtsdf.pixels,
-                                  pixel_count);
+    stygian_color_transform_apply_rgba8(
+        stygian_color_transform_cached(ctx, &ctx->glyph_source_color_profile,
+                                       &ctx->output_color_profile),
+        mtsdf.pixels, pixel_count);
   }
 
   // Create texture via backend (proper abstraction!)
-  tex_handle = stygian_texture_create(ctx, mtsdf.atlas_width, mtsdf.atlas_height,
-                                      mtsdf.pixels);
+  tex_handle = stygian_texture_create_standalone(ctx, mtsdf.atlas_width,
+                                                 mtsdf.atlas_height,
+                                                 mtsdf.pixels);
   if (!tex_handle) {
     mtsdf_free_atlas(&mtsdf);
     return 0;
@@ -3675,6 +4836,7 @@ StygianFont stygian_font_load(StygianContext *ctx, const char *atlas_png,
   // Bind font texture for text rendering
   stygian_ap_set_font_texture(ctx->ap, tex_backend_id, font->atlas_width,
                               font->atlas_height, font->px_range);
+  ctx->damage_full = true;
   ctx->font_alive[font_slot] = 1u;
   ctx->font_count++;
 
@@ -3776,14 +4938,22 @@ StygianElement stygian_text(StygianContext *ctx, StygianFont font,
     if (cp == ':') {
       char emoji_id[128];
       size_t emoji_after = 0;
-      uint32_t emoji_tex = 0;
+      StygianTexture emoji_tex = 0u;
       uint32_t emoji_backend_tex = 0;
+      float emoji_uv[4] = {0.0f, 0.0f, 1.0f, 1.0f};
+      StygianInlineEmojiState emoji_state = STYGIAN_INLINE_EMOJI_MISSING;
       if (stygian_try_parse_shortcode(str, text_len, cp_start, emoji_id,
-                                      sizeof(emoji_id), &emoji_after) &&
-          stygian_inline_emoji_resolve_texture(ctx, emoji_id, &emoji_tex) &&
-          emoji_tex != 0u &&
-          stygian_resolve_texture_slot(ctx, emoji_tex, NULL,
-                                       &emoji_backend_tex)) {
+                                      sizeof(emoji_id), &emoji_after)) {
+        emoji_state =
+            stygian_inline_emoji_resolve_texture(ctx, emoji_id, &emoji_tex,
+                                                 emoji_uv);
+        if (emoji_state == STYGIAN_INLINE_EMOJI_READY &&
+            !stygian_resolve_texture_slot(ctx, emoji_tex, NULL,
+                                          &emoji_backend_tex)) {
+          emoji_state = STYGIAN_INLINE_EMOJI_MISSING;
+        }
+      }
+      if (emoji_state != STYGIAN_INLINE_EMOJI_MISSING) {
         float emoji_px = f->line_height * size;
         StygianElement e = batch_stack[slot++];
         uint32_t id;
@@ -3797,18 +4967,38 @@ StygianElement stygian_text(StygianContext *ctx, StygianFont font,
         ctx->soa.hot[id].y = cursor_y;
         ctx->soa.hot[id].w = emoji_px;
         ctx->soa.hot[id].h = emoji_px;
-        ctx->soa.hot[id].color[0] = 1.0f;
-        ctx->soa.hot[id].color[1] = 1.0f;
-        ctx->soa.hot[id].color[2] = 1.0f;
-        ctx->soa.hot[id].color[3] = a;
-        ctx->soa.hot[id].type = STYGIAN_TEXTURE;
-        ctx->soa.hot[id].texture_id = emoji_backend_tex;
+        if (emoji_state == STYGIAN_INLINE_EMOJI_READY) {
+          ctx->soa.hot[id].color[0] = 1.0f;
+          ctx->soa.hot[id].color[1] = 1.0f;
+          ctx->soa.hot[id].color[2] = 1.0f;
+          ctx->soa.hot[id].color[3] = a;
+          ctx->soa.hot[id].type = STYGIAN_TEXTURE;
+          ctx->soa.hot[id].texture_id = emoji_backend_tex;
+
+          ctx->soa.appearance[id].uv[0] = emoji_uv[0];
+          ctx->soa.appearance[id].uv[1] = emoji_uv[1];
+          ctx->soa.appearance[id].uv[2] = emoji_uv[2];
+          ctx->soa.appearance[id].uv[3] = emoji_uv[3];
+        } else {
+          // Placeholder: faint rounded cell until the decode lands; the
+          // drain at frame start re-dirties this scope.
+          float radius = emoji_px * 0.2f;
+          ctx->soa.hot[id].color[0] = 0.5f;
+          ctx->soa.hot[id].color[1] = 0.5f;
+          ctx->soa.hot[id].color[2] = 0.5f;
+          ctx->soa.hot[id].color[3] = a * 0.25f;
+          ctx->soa.hot[id].type = STYGIAN_RECT;
+          ctx->soa.hot[id].texture_id = 0u;
+
+          memset(&ctx->soa.appearance[id], 0, sizeof(ctx->soa.appearance[id]));
+          ctx->soa.appearance[id].radius[0] = radius;
+          ctx->soa.appearance[id].radius[1] = radius;
+          ctx->soa.appearance[id].radius[2] = radius;
+          ctx->soa.appearance[id].radius[3] = radius;
+          stygian_inline_emoji_note_waiting_scope(ctx);
+          stygian_request_repaint_async(ctx, 16u);
+        }
         stygian_mark_soa_hot_dirty(ctx, id);
-
-        ctx->soa.appearance[id].uv[0] = 0.0f;
-        ctx->soa.appearance[id].uv[1] = 0.0f;
-        ctx->soa.appearance[id].uv[2] = 1.0f;
-        ctx->soa.appearance[id].uv[3] = 1.0f;
         stygian_mark_soa_appearance_dirty(ctx, id);
 
         cursor = emoji_after;
@@ -3944,6 +5134,19 @@ float stygian_text_width(StygianContext *ctx, StygianFont font, const char *str,
   return width;
 }
 
+float stygian_font_line_height(StygianContext *ctx, StygianFont font,
+                               float size) {
+  uint32_t font_slot;
+  if (!ctx)
+    return 0.0f;
+  if (font == 0) {
+    font = stygian_first_alive_font(ctx);
+  }
+  if (!stygian_resolve_font_slot(ctx, font, &font_slot))
+    return 0.0f;
+  return ctx->fonts[font_slot].line_height * size;
+}
+
 // ============================================================================
 // Debug Tools
 // ============================================================================
@@ -3980,8 +5183,10 @@ void stygian_debug_overlay_draw(StygianContext *ctx) {
   }
 
   // 2. Draw Clip Rects (Red)
-  for (int i = 1; i < ctx->clip_count; i++) {
+  for (uint32_t i = 1; i < ctx->clip_count; i++) {
     StygianClipRect *c = &ctx->clips[i];
+    if (ctx->clip_frame[i] != ctx->frame_index + 1u)
+      continue; // Kept from an earlier frame, not pushed this one
     StygianElement clip_dbg =
         stygian_rect(ctx, c->x, c->y, c->w, c->h, 0, 0, 0, 0);
     stygian_set_type(ctx, clip_dbg, STYGIAN_RECT_OUTLINE);
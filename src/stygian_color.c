@@ -1,9 +1,23 @@
+#if !defined(_WIN32) && !defined(_POSIX_C_SOURCE)
+#define _POSIX_C_SOURCE 200809L // pthread under -std=c2x
+#endif
+
 #include "stygian_color.h"
 #include "stygian_internal.h" // stygian_cpystr
+#include "stygian_platform.h"
 
 #include <math.h>
+#include <stdlib.h>
 #include <string.h>
 
+#ifndef _WIN32
+#include <pthread.h>
+#endif
+
+// Encode table resolution. It is indexed by sqrt(linear), which spends its
+// entries near black where both transfer curves are steepest.
+#define STYGIAN_COLOR_ENCODE_STEPS 4096
+
 static float clamp01(float v) {
   if (v < 0.0f)
     return 0.0f;
@@ -130,6 +144,154 @@ bool stygian_color_profile_copy(StygianColorProfile *dst,
   return true;
 }
 
+// ============================================================================
+// Tone Response Curves
+// ============================================================================
+
+// Interned tables, chained by hash. Never freed: a process sees a handful
+// of distinct curves, and profiles copied by value may point at any of them.
+#define STYGIAN_COLOR_TRC_BUCKETS 64u
+
+struct StygianColorTrcTable {
+  StygianColorTrcTable *next;
+  uint64_t hash;
+  uint16_t samples[STYGIAN_COLOR_TRC_SAMPLES];
+};
+
+static StygianColorTrcTable *g_trc_tables[STYGIAN_COLOR_TRC_BUCKETS];
+#ifdef _WIN32
+static SRWLOCK g_trc_lock = SRWLOCK_INIT;
+#define trc_lock() AcquireSRWLockExclusive(&g_trc_lock)
+#define trc_unlock() ReleaseSRWLockExclusive(&g_trc_lock)
+#else
+static pthread_mutex_t g_trc_lock = PTHREAD_MUTEX_INITIALIZER;
+#define trc_lock() pthread_mutex_lock(&g_trc_lock)
+#define trc_unlock() pthread_mutex_unlock(&g_trc_lock)
+#endif
+
+static uint64_t color_fnv1a64(uint64_t h, const void *data, size_t n);
+
+const StygianColorTrcTable *
+stygian_color_trc_table_intern(const uint16_t *samples) {
+  uint64_t hash;
+  StygianColorTrcTable **bucket, *t;
+  if (!samples)
+    return NULL;
+  hash = color_fnv1a64(1469598103934665603ull, samples,
+                       sizeof(t->samples));
+  bucket = &g_trc_tables[hash % STYGIAN_COLOR_TRC_BUCKETS];
+  trc_lock();
+  for (t = *bucket; t; t = t->next) {
+    if (t->hash == hash && memcmp(t->samples, samples, sizeof(t->samples)) == 0)
+      break;
+  }
+  if (!t) {
+    t = (StygianColorTrcTable *)malloc(sizeof(*t));
+    if (t) {
+      t->hash = hash;
+      memcpy(t->samples, samples, sizeof(t->samples));
+      t->next = *bucket;
+      *bucket = t;
+    }
+  }
+  trc_unlock();
+  return t;
+}
+
+const uint16_t *stygian_color_trc_table_samples(const StygianColorTrcTable *t) {
+  return t ? t->samples : NULL;
+}
+
+// A TABLE curve without its table (out of memory) falls back like NONE.
+static bool trc_active(const StygianColorTrc *t) {
+  return t->type == STYGIAN_COLOR_TRC_PARAMETRIC ||
+         (t->type == STYGIAN_COLOR_TRC_TABLE && t->table);
+}
+
+static float trc_eval(const StygianColorTrc *t, float x) {
+  if (t->type == STYGIAN_COLOR_TRC_PARAMETRIC) {
+    const float *p = t->params; // g, a, b, c, d, e, f
+    if (x >= p[4]) {
+      float base = p[1] * x + p[2];
+      return (base > 0.0f ? powf(base, p[0]) : 0.0f) + p[5];
+    }
+    return p[3] * x + p[6];
+  } else {
+    const uint16_t *table = t->table->samples;
+    float pos = x * (float)(STYGIAN_COLOR_TRC_SAMPLES - 1);
+    int i = (int)pos;
+    float frac;
+    if (i >= STYGIAN_COLOR_TRC_SAMPLES - 1)
+      return (float)table[STYGIAN_COLOR_TRC_SAMPLES - 1] / 65535.0f;
+    frac = pos - (float)i;
+    return ((float)table[i] +
+            ((float)table[i + 1] - (float)table[i]) * frac) /
+           65535.0f;
+  }
+}
+
+// Inverse of trc_eval for non-decreasing curves.
+static float trc_invert(const StygianColorTrc *t, float y) {
+  if (t->type == STYGIAN_COLOR_TRC_PARAMETRIC) {
+    const float *p = t->params;
+    float base = p[1] * p[4] + p[2];
+    float y_break = (base > 0.0f ? powf(base, p[0]) : 0.0f) + p[5];
+    float x;
+    if (p[4] > 0.0f && y < y_break) {
+      x = (p[3] != 0.0f) ? (y - p[6]) / p[3] : 0.0f;
+      return x > p[4] ? p[4] : clamp01(x);
+    }
+    if (y - p[5] <= 0.0f || p[0] == 0.0f || p[1] == 0.0f)
+      return clamp01(p[4]);
+    x = (powf(y - p[5], 1.0f / p[0]) - p[2]) / p[1];
+    return clamp01(x < p[4] ? p[4] : x);
+  } else {
+    const uint16_t *table = t->table->samples;
+    float target = y * 65535.0f;
+    int lo = 0, hi = STYGIAN_COLOR_TRC_SAMPLES - 1;
+    float a, b;
+    if (target <= (float)table[0])
+      return 0.0f;
+    if (target >= (float)table[hi])
+      return 1.0f;
+    while (hi - lo > 1) { // table[lo] < target <= table[hi]
+      int mid = (lo + hi) / 2;
+      if ((float)table[mid] < target)
+        lo = mid;
+      else
+        hi = mid;
+    }
+    a = (float)table[lo];
+    b = (float)table[hi];
+    return ((float)lo + (b > a ? (target - a) / (b - a) : 0.0f)) /
+           (float)(STYGIAN_COLOR_TRC_SAMPLES - 1);
+  }
+}
+
+float stygian_color_profile_to_linear(const StygianColorProfile *profile,
+                                      int channel, float v) {
+  v = clamp01(v);
+  if (!profile || channel < 0 || channel > 2)
+    return v;
+  if (trc_active(&profile->trc[channel]))
+    return trc_eval(&profile->trc[channel], v);
+  if (profile->srgb_transfer)
+    return srgb_to_linear(v);
+  return powf(v, (profile->gamma > 0.0f) ? profile->gamma : 2.2f);
+}
+
+float stygian_color_profile_from_linear(const StygianColorProfile *profile,
+                                        int channel, float v) {
+  v = clamp01(v);
+  if (!profile || channel < 0 || channel > 2)
+    return v;
+  if (trc_active(&profile->trc[channel]))
+    return trc_invert(&profile->trc[channel], v);
+  if (profile->srgb_transfer)
+    return linear_to_srgb(v);
+  return powf(v, 1.0f / ((profile->gamma > 0.0f) ? profile->gamma : 2.2f));
+}
+
 void stygian_color_transform_rgb_f32(const StygianColorProfile *src,
                                      const StygianColorProfile *dst, float *r,
                                      float *g, float *b) {
@@ -151,43 +313,26 @@ void stygian_color_transform_rgb_f32(const StygianColorProfile *src,
     return;
   }
 
-  if (src->srgb_transfer) {
-    in_r = srgb_to_linear(in_r);
-    in_g = srgb_to_linear(in_g);
-    in_b = srgb_to_linear(in_b);
-  } else {
-    float inv_gamma = (src->gamma > 0.0f) ? src->gamma : 2.2f;
-    in_r = powf(in_r, inv_gamma);
-    in_g = powf(in_g, inv_gamma);
-    in_b = powf(in_b, inv_gamma);
-  }
+  in_r = stygian_color_profile_to_linear(src, 0, in_r);
+  in_g = stygian_color_profile_to_linear(src, 1, in_g);
+  in_b = stygian_color_profile_to_linear(src, 2, in_b);
 
   mul3x3_vec(src->rgb_to_xyz, in_r, in_g, in_b, &x, &y, &z);
   mul3x3_vec(dst->xyz_to_rgb, x, y, z, &out_r, &out_g, &out_b);
 
-  out_r = clamp01(out_r);
-  out_g = clamp01(out_g);
-  out_b = clamp01(out_b);
-
-  if (dst->srgb_transfer) {
-    out_r = linear_to_srgb(out_r);
-    out_g = linear_to_srgb(out_g);
-    out_b = linear_to_srgb(out_b);
-  } else {
-    float gamma = (dst->gamma > 0.0f) ? dst->gamma : 2.2f;
-    out_r = powf(out_r, 1.0f / gamma);
-    out_g = powf(out_g, 1.0f / gamma);
-    out_b = powf(out_b, 1.0f / gamma);
-  }
+  out_r = stygian_color_profile_from_linear(dst, 0, out_r);
+  out_g = stygian_color_profile_from_linear(dst, 1, out_g);
+  out_b = stygian_color_profile_from_linear(dst, 2, out_b);
 
   *r = clamp01(out_r);
   *g = clamp01(out_g);
   *b = clamp01(out_b);
 }
 
-void stygian_color_transform_rgba8(const StygianColorProfile *src,
-                                   const StygianColorProfile *dst,
-                                   uint8_t *rgba, size_t pixel_count) {
+void stygian_color_transform_rgba8_reference(const StygianColorProfile *src,
+                                             const StygianColorProfile *dst,
+                                             uint8_t *rgba,
+                                             size_t pixel_count) {
   size_t i;
   if (!rgba || pixel_count == 0)
     return;
@@ -203,3 +348,327 @@ void stygian_color_transform_rgba8(const StygianColorProfile *src,
     rgba[i * 4 + 2] = (uint8_t)(clamp01(b) * 255.0f + 0.5f);
   }
 }
+
+// ============================================================================
+// Table-driven RGBA8 transform
+// ============================================================================
+
+// 8-bit input has only 256 decoded values per channel, and the source and
+// destination matrices fold into one. Output curves are sampled on a
+// sqrt(linear) grid; the trailing pad lets the AVX2 path gather 32 bits at
+// any index.
+typedef struct StygianColorLut {
+  float decode[3][256];
+  float m[9]; // dst->xyz_to_rgb * src->rgb_to_xyz
+  uint8_t encode[3][STYGIAN_COLOR_ENCODE_STEPS + 4];
+} StygianColorLut;
+
+static void color_lut_build(const StygianColorProfile *src,
+                            const StygianColorProfile *dst,
+                            StygianColorLut *lut) {
+  int i, r, c;
+  for (c = 0; c < 3; c++) {
+    for (i = 0; i < 256; i++) {
+      lut->decode[c][i] =
+          stygian_color_profile_to_linear(src, c, (float)i / 255.0f);
+    }
+  }
+  for (r = 0; r < 3; r++) {
+    for (c = 0; c < 3; c++) {
+      lut->m[r * 3 + c] = dst->xyz_to_rgb[r * 3 + 0] * src->rgb_to_xyz[c] +
+                          dst->xyz_to_rgb[r * 3 + 1] * src->rgb_to_xyz[3 + c] +
+                          dst->xyz_to_rgb[r * 3 + 2] * src->rgb_to_xyz[6 + c];
+    }
+  }
+  for (c = 0; c < 3; c++) {
+    for (i = 0; i < STYGIAN_COLOR_ENCODE_STEPS; i++) {
+      float u = (float)i / (float)(STYGIAN_COLOR_ENCODE_STEPS - 1);
+      float v = stygian_color_profile_from_linear(dst, c, u * u);
+      lut->encode[c][i] = (uint8_t)(clamp01(v) * 255.0f + 0.5f);
+    }
+    memset(lut->encode[c] + STYGIAN_COLOR_ENCODE_STEPS, 0, 4);
+  }
+}
+
+static uint32_t color_encode_index(float v) {
+  v = clamp01(v);
+  return (uint32_t)(sqrtf(v) * (float)(STYGIAN_COLOR_ENCODE_STEPS - 1) +
+                    0.5f);
+}
+
+static void color_transform_scalar(const StygianColorLut *lut, uint8_t *rgba,
+                                   size_t n) {
+  const float *m = lut->m;
+  size_t i;
+  for (i = 0; i < n; i++) {
+    uint8_t *p = rgba + i * 4;
+    float r = lut->decode[0][p[0]];
+    float g = lut->decode[1][p[1]];
+    float b = lut->decode[2][p[2]];
+    p[0] = lut->encode[0][color_encode_index(m[0] * r + m[1] * g + m[2] * b)];
+    p[1] = lut->encode[1][color_encode_index(m[3] * r + m[4] * g + m[5] * b)];
+    p[2] = lut->encode[2][color_encode_index(m[6] * r + m[7] * g + m[8] * b)];
+  }
+}
+
+#if STYGIAN_X86_SIMD
+// Four pixels per step: table loads stay scalar (SSE2 has no gather), the
+// matrix, clamp, sqrt and index math run four-wide.
+static void color_transform_sse2(const StygianColorLut *lut, uint8_t *rgba,
+                                 size_t n) {
+  const __m128 lo = _mm_setzero_ps();
+  const __m128 hi = _mm_set1_ps(1.0f);
+  const __m128 steps = _mm_set1_ps((float)(STYGIAN_COLOR_ENCODE_STEPS - 1));
+  const __m128 half = _mm_set1_ps(0.5f);
+  __m128 m[9];
+  size_t i;
+  int k;
+  for (k = 0; k < 9; k++)
+    m[k] = _mm_set1_ps(lut->m[k]);
+  for (i = 0; i + 4 <= n; i += 4) {
+    uint8_t *p = rgba + i * 4;
+    __m128 r = _mm_setr_ps(lut->decode[0][p[0]], lut->decode[0][p[4]],
+                           lut->decode[0][p[8]], lut->decode[0][p[12]]);
+    __m128 g = _mm_setr_ps(lut->decode[1][p[1]], lut->decode[1][p[5]],
+                           lut->decode[1][p[9]], lut->decode[1][p[13]]);
+    __m128 b = _mm_setr_ps(lut->decode[2][p[2]], lut->decode[2][p[6]],
+                           lut->decode[2][p[10]], lut->decode[2][p[14]]);
+    __m128 out[3];
+    int32_t idx[3][4];
+    for (k = 0; k < 3; k++) {
+      __m128 v = _mm_add_ps(_mm_add_ps(_mm_mul_ps(m[k * 3 + 0], r),
+                                       _mm_mul_ps(m[k * 3 + 1], g)),
+                            _mm_mul_ps(m[k * 3 + 2], b));
+      v = _mm_sqrt_ps(_mm_min_ps(_mm_max_ps(v, lo), hi));
+      out[k] = _mm_add_ps(_mm_mul_ps(v, steps), half);
+      _mm_storeu_si128((__m128i *)idx[k], _mm_cvttps_epi32(out[k]));
+    }
+    for (k = 0; k < 4; k++) {
+      p[k * 4 + 0] = lut->encode[0][idx[0][k]];
+      p[k * 4 + 1] = lut->encode[1][idx[1][k]];
+      p[k * 4 + 2] = lut->encode[2][idx[2][k]];
+    }
+  }
+  color_transform_scalar(lut, rgba + i * 4, n - i);
+}
+
+// Eight pixels per step with gathers for both tables. Encode gathers read
+// 32 bits at a byte offset (hence the table pad) and keep the low byte.
+STYGIAN_TARGET_AVX2
+static void color_transform_avx2(const StygianColorLut *lut, uint8_t *rgba,
+                                 size_t n) {
+  const __m256 lo = _mm256_setzero_ps();
+  const __m256 hi = _mm256_set1_ps(1.0f);
+  const __m256 steps =
+      _mm256_set1_ps((float)(STYGIAN_COLOR_ENCODE_STEPS - 1));
+  const __m256 half = _mm256_set1_ps(0.5f);
+  const __m256i byte = _mm256_set1_epi32(0xFF);
+  const __m256i alpha = _mm256_set1_epi32((int)0xFF000000u);
+  __m256 m[9];
+  size_t i;
+  int k;
+  for (k = 0; k < 9; k++)
+    m[k] = _mm256_set1_ps(lut->m[k]);
+  for (i = 0; i + 8 <= n; i += 8) {
+    __m256i px = _mm256_loadu_si256((const __m256i *)(rgba + i * 4));
+    __m256 c[3];
+    __m256i out = _mm256_and_si256(px, alpha);
+    for (k = 0; k < 3; k++) {
+      __m256i ch = _mm256_and_si256(_mm256_srli_epi32(px, k * 8), byte);
+      c[k] = _mm256_i32gather_ps(lut->decode[k], ch, 4);
+    }
+    for (k = 0; k < 3; k++) {
+      __m256 v = _mm256_add_ps(
+          _mm256_add_ps(_mm256_mul_ps(m[k * 3 + 0], c[0]),
+                        _mm256_mul_ps(m[k * 3 + 1], c[1])),
+          _mm256_mul_ps(m[k * 3 + 2], c[2]));
+      __m256i idx, e;
+      v = _mm256_sqrt_ps(_mm256_min_ps(_mm256_max_ps(v, lo), hi));
+      idx = _mm256_cvttps_epi32(_mm256_add_ps(_mm256_mul_ps(v, steps), half));
+      e = _mm256_and_si256(
+          _mm256_i32gather_epi32((const int *)(const void *)lut->encode[k],
+                                 idx, 1),
+          byte);
+      out = _mm256_or_si256(out, _mm256_slli_epi32(e, k * 8));
+    }
+    _mm256_storeu_si256((__m256i *)(rgba + i * 4), out);
+  }
+  color_transform_scalar(lut, rgba + i * 4, n - i);
+}
+#endif
+
+StygianColorIsa stygian_color_best_isa(void) {
+#if STYGIAN_X86_SIMD
+  if (stygian_cpu_has_avx2())
+    return STYGIAN_COLOR_ISA_AVX2;
+  return STYGIAN_COLOR_ISA_SSE2; // x86-64 baseline
+#else
+  return STYGIAN_COLOR_ISA_SCALAR;
+#endif
+}
+
+static void color_lut_apply(const StygianColorLut *lut, StygianColorIsa isa,
+                            uint8_t *rgba, size_t n) {
+#if STYGIAN_X86_SIMD
+  if (isa == STYGIAN_COLOR_ISA_AVX2) {
+    color_transform_avx2(lut, rgba, n);
+    return;
+  }
+  if (isa == STYGIAN_COLOR_ISA_SSE2) {
+    color_transform_sse2(lut, rgba, n);
+    return;
+  }
+#endif
+  (void)isa;
+  color_transform_scalar(lut, rgba, n);
+}
+
+void stygian_color_transform_rgba8_isa(const StygianColorProfile *src,
+                                       const StygianColorProfile *dst,
+                                       uint8_t *rgba, size_t pixel_count,
+                                       StygianColorIsa isa) {
+  StygianColorLut lut;
+  StygianColorIsa best;
+  if (!rgba || pixel_count == 0)
+    return;
+  if (!src || !dst || !src->valid || !dst->valid)
+    return;
+  best = stygian_color_best_isa();
+  if (isa > best)
+    isa = best;
+  color_lut_build(src, dst, &lut);
+  color_lut_apply(&lut, isa, rgba, pixel_count);
+}
+
+void stygian_color_transform_rgba8(const StygianColorProfile *src,
+                                   const StygianColorProfile *dst,
+                                   uint8_t *rgba, size_t pixel_count) {
+  stygian_color_transform_rgba8_isa(src, dst, rgba, pixel_count,
+                                    STYGIAN_COLOR_ISA_AVX2);
+}
+
+// ============================================================================
+// Cached Transforms
+// ============================================================================
+
+struct StygianColorTransform {
+  StygianColorLut lut;
+  StygianColorIsa isa;
+  uint32_t lut3d_size;
+  uint16_t *lut3d;
+};
+
+StygianColorTransform *
+stygian_color_transform_create(const StygianColorProfile *src,
+                               const StygianColorProfile *dst,
+                               uint32_t lut3d_size) {
+  StygianColorTransform *t;
+  float axis[3][65];
+  uint32_t n, r, g, b, c;
+  uint16_t *texel;
+
+  if (!src || !dst || !src->valid || !dst->valid)
+    return NULL;
+  n = lut3d_size ? lut3d_size : STYGIAN_COLOR_LUT3D_DEFAULT_SIZE;
+  if (n < 2u)
+    n = 2u;
+  if (n > 65u)
+    n = 65u;
+
+  t = (StygianColorTransform *)calloc(1, sizeof(StygianColorTransform));
+  if (!t)
+    return NULL;
+  t->lut3d = (uint16_t *)malloc((size_t)n * n * n * 4u * sizeof(uint16_t));
+  if (!t->lut3d) {
+    free(t);
+    return NULL;
+  }
+  t->lut3d_size = n;
+  t->isa = stygian_color_best_isa();
+  color_lut_build(src, dst, &t->lut);
+
+  // Node i samples encoded input (i / (n - 1))^2, so each node is the exact
+  // transform of that colour and nodes crowd toward black, where output
+  // curves bend hardest. Samplers index the lattice with sqrt(input).
+  for (c = 0; c < 3; c++) {
+    for (r = 0; r < n; r++) {
+      float u = (float)r / (float)(n - 1u);
+      axis[c][r] = stygian_color_profile_to_linear(src, (int)c, u * u);
+    }
+  }
+  texel = t->lut3d;
+  for (b = 0; b < n; b++) {
+    for (g = 0; g < n; g++) {
+      for (r = 0; r < n; r++) {
+        const float *m = t->lut.m;
+        float lin[3];
+        lin[0] = m[0] * axis[0][r] + m[1] * axis[1][g] + m[2] * axis[2][b];
+        lin[1] = m[3] * axis[0][r] + m[4] * axis[1][g] + m[5] * axis[2][b];
+        lin[2] = m[6] * axis[0][r] + m[7] * axis[1][g] + m[8] * axis[2][b];
+        for (c = 0; c < 3; c++) {
+          float v = stygian_color_profile_from_linear(dst, (int)c, lin[c]);
+          texel[c] = (uint16_t)(clamp01(v) * 65535.0f + 0.5f);
+        }
+        texel[3] = 65535u;
+        texel += 4;
+      }
+    }
+  }
+  return t;
+}
+
+void stygian_color_transform_destroy(StygianColorTransform *transform) {
+  if (!transform)
+    return;
+  free(transform->lut3d);
+  free(transform);
+}
+
+void stygian_color_transform_apply_rgba8(const StygianColorTransform *transform,
+                                         uint8_t *rgba, size_t pixel_count) {
+  if (!transform || !rgba || pixel_count == 0)
+    return;
+  color_lut_apply(&transform->lut, transform->isa, rgba, pixel_count);
+}
+
+const uint16_t *
+stygian_color_transform_lut3d(const StygianColorTransform *transform,
+                              uint32_t *out_size) {
+  if (out_size)
+    *out_size = transform ? transform->lut3d_size : 0u;
+  return transform ? transform->lut3d : NULL;
+}
+
+static uint64_t color_fnv1a64(uint64_t h, const void *data, size_t n) {
+  const uint8_t *p = (const uint8_t *)data;
+  size_t i;
+  for (i = 0; i < n; i++) {
+    h ^= p[i];
+    h *= 1099511628211ull;
+  }
+  return h;
+}
+
+static uint64_t color_profile_key(uint64_t h, const StygianColorProfile *p) {
+  uint8_t srgb = p->srgb_transfer ? 1u : 0u;
+  h = color_fnv1a64(h, p->rgb_to_xyz, sizeof(p->rgb_to_xyz));
+  h = color_fnv1a64(h, &p->gamma, sizeof(p->gamma));
+  h = color_fnv1a64(h, &srgb, 1u);
+  for (int c = 0; c < 3; c++) {
+    const StygianColorTrc *t = &p->trc[c];
+    uint64_t table = t->table ? t->table->hash : 0u;
+    h = color_fnv1a64(h, &t->type, sizeof(t->type));
+    h = color_fnv1a64(h, t->params, sizeof(t->params));
+    h = color_fnv1a64(h, &table, sizeof(table));
+  }
+  return h;
+}
+
+uint64_t stygian_color_profile_pair_key(const StygianColorProfile *src,
+                                        const StygianColorProfile *dst) {
+  uint64_t h = 1469598103934665603ull;
+  if (!src || !dst)
+    return 0u;
+  h = color_profile_key(h, src);
+  return color_profile_key(h, dst);
+}
@@ -0,0 +1,322 @@
+// stygian_decode_pool.c - Background triad decode workers
+// Fixed job/completion queues guarded by one lock; workers block on a
+// condition variable and never touch the GPU (texture upload stays on the
+// frame thread when results are drained). The optional disk cache has its
+// own lock so file I/O never stalls submit/drain.
+
+#if !defined(_WIN32) && !defined(_POSIX_C_SOURCE)
+#define _POSIX_C_SOURCE 200809L // pthread under -std=c2x
+#endif
+
+#include "stygian_decode_pool.h"
+#include <stdlib.h>
+#include <string.h>
+
+#ifdef _WIN32
+#define WIN32_LEAN_AND_MEAN
+#include <windows.h>
+typedef SRWLOCK StygianPoolLock;
+typedef CONDITION_VARIABLE StygianPoolCond;
+typedef HANDLE StygianPoolThread;
+#else
+#include <pthread.h>
+typedef pthread_mutex_t StygianPoolLock;
+typedef pthread_cond_t StygianPoolCond;
+typedef pthread_t StygianPoolThread;
+#endif
+
+#define STYGIAN_DECODE_POOL_MAX_WORKERS 8u
+
+typedef struct StygianDecodeJob {
+  uint64_t key_hash;
+  uint64_t glyph_hash;
+} StygianDecodeJob;
+
+struct StygianDecodePool {
+  const StygianTriadRuntime *rt;
+  StygianGlyphDiskCache *disk_cache; // Optional; guarded by io_lock
+  uint32_t cell_size;
+
+  StygianPoolLock lock;
+  StygianPoolLock io_lock;
+  StygianPoolCond wake;
+  StygianPoolThread threads[STYGIAN_DECODE_POOL_MAX_WORKERS];
+  uint32_t thread_count;
+
+  // Both rings share one capacity; submit refuses work once queued +
+  // decoding + undrained reaches it, so completions can never overflow.
+  uint32_t capacity;
+  StygianDecodeJob *jobs;
+  uint32_t job_head;
+  uint32_t job_count;
+  StygianDecodeResult *results;
+  uint32_t result_head;
+  uint32_t result_count;
+  uint32_t in_flight;
+  bool shutdown;
+};
+
+// ============================================================================
+// Lock / Thread Shims
+// ============================================================================
+
+#ifdef _WIN32
+static void pool_lock_init(StygianPoolLock *l) { InitializeSRWLock(l); }
+static void pool_lock_fini(StygianPoolLock *l) { (void)l; }
+static void pool_lock(StygianPoolLock *l) { AcquireSRWLockExclusive(l); }
+static void pool_unlock(StygianPoolLock *l) { ReleaseSRWLockExclusive(l); }
+static void pool_cond_init(StygianDecodePool *p) {
+  InitializeConditionVariable(&p->wake);
+}
+static void pool_cond_fini(StygianDecodePool *p) { (void)p; }
+static void pool_wait(StygianDecodePool *p) {
+  SleepConditionVariableSRW(&p->wake, &p->lock, INFINITE, 0);
+}
+static void pool_signal(StygianDecodePool *p) {
+  WakeConditionVariable(&p->wake);
+}
+static void pool_broadcast(StygianDecodePool *p) {
+  WakeAllConditionVariable(&p->wake);
+}
+#else
+static void pool_lock_init(StygianPoolLock *l) { pthread_mutex_init(l, NULL); }
+static void pool_lock_fini(StygianPoolLock *l) { pthread_mutex_destroy(l); }
+static void pool_lock(StygianPoolLock *l) { pthread_mutex_lock(l); }
+static void pool_unlock(StygianPoolLock *l) { pthread_mutex_unlock(l); }
+static void pool_cond_init(StygianDecodePool *p) {
+  pthread_cond_init(&p->wake, NULL);
+}
+static void pool_cond_fini(StygianDecodePool *p) {
+  pthread_cond_destroy(&p->wake);
+}
+static void pool_wait(StygianDecodePool *p) {
+  pthread_cond_wait(&p->wake, &p->lock);
+}
+static void pool_signal(StygianDecodePool *p) {
+  pthread_cond_signal(&p->wake);
+}
+static void pool_broadcast(StygianDecodePool *p) {
+  pthread_cond_broadcast(&p->wake);
+}
+#endif
+
+// ============================================================================
+// Worker
+// ============================================================================
+
+// Disk hit, else decode at cell size (+ write back) into a cell_size^2 RGBA
+// buffer. Safe from any thread.
+static bool pool_produce_cell(StygianDecodePool *p, uint64_t glyph_hash,
+                              uint8_t *cell) {
+  uint8_t *rgba = NULL;
+  uint32_t w = 0u, h = 0u;
+  bool hit = false;
+
+  if (p->disk_cache) {
+    pool_lock(&p->io_lock);
+    hit = stygian_glyph_disk_cache_load(p->disk_cache, glyph_hash, cell);
+    pool_unlock(&p->io_lock);
+    if (hit)
+      return true;
+  }
+  if (!stygian_triad_runtime_decode_rgba_sized(p->rt, glyph_hash,
+                                               p->cell_size, &rgba, &w, &h) ||
+      !rgba || w == 0u || h == 0u) {
+    stygian_triad_runtime_free_blob(rgba);
+    return false;
+  }
+  stygian_triad_downsample_rgba(rgba, w, h, cell, p->cell_size);
+  stygian_triad_runtime_free_blob(rgba);
+  if (p->disk_cache) {
+    pool_lock(&p->io_lock);
+    stygian_glyph_disk_cache_store(p->disk_cache, glyph_hash, cell);
+    pool_unlock(&p->io_lock);
+  }
+  return true;
+}
+
+static void pool_worker_loop(StygianDecodePool *p) {
+  pool_lock(&p->lock);
+  for (;;) {
+    StygianDecodeJob job;
+    StygianDecodeResult res;
+    while (!p->shutdown && p->job_count == 0u)
+      pool_wait(p);
+    if (p->shutdown)
+      break;
+    job = p->jobs[p->job_head];
+    p->job_head = (p->job_head + 1u) % p->capacity;
+    p->job_count--;
+    p->in_flight++;
+    pool_unlock(&p->lock);
+
+    memset(&res, 0, sizeof(res));
+    res.key_hash = job.key_hash;
+    res.glyph_hash = job.glyph_hash;
+    res.rgba = (uint8_t *)malloc((size_t)p->cell_size * p->cell_size * 4u);
+    res.ok = res.rgba && pool_produce_cell(p, job.glyph_hash, res.rgba);
+    if (res.ok)
+      res.width = res.height = p->cell_size;
+
+    pool_lock(&p->lock);
+    p->results[(p->result_head + p->result_count) % p->capacity] = res;
+    p->result_count++;
+    p->in_flight--;
+  }
+  pool_unlock(&p->lock);
+}
+
+#ifdef _WIN32
+static DWORD WINAPI pool_worker_main(LPVOID arg) {
+  pool_worker_loop((StygianDecodePool *)arg);
+  return 0;
+}
+#else
+static void *pool_worker_main(void *arg) {
+  pool_worker_loop((StygianDecodePool *)arg);
+  return NULL;
+}
+#endif
+
+static bool pool_spawn(StygianDecodePool *p, StygianPoolThread *out) {
+#ifdef _WIN32
+  *out = CreateThread(NULL, 0, pool_worker_main, p, 0, NULL);
+  return *out != NULL;
+#else
+  return pthread_create(out, NULL, pool_worker_main, p) == 0;
+#endif
+}
+
+static void pool_join(StygianPoolThread t) {
+#ifdef _WIN32
+  WaitForSingleObject(t, INFINITE);
+  CloseHandle(t);
+#else
+  pthread_join(t, NULL);
+#endif
+}
+
+// ============================================================================
+// Public API
+// ============================================================================
+
+StygianDecodePool *stygian_decode_pool_create(const StygianTriadRuntime *rt,
+                                              StygianGlyphDiskCache *disk_cache,
+                                              uint32_t cell_size,
+                                              uint32_t worker_count,
+                                              uint32_t queue_capacity) {
+  StygianDecodePool *p;
+  uint32_t i;
+  if (!rt || cell_size == 0u || worker_count == 0u || queue_capacity == 0u)
+    return NULL;
+  if (worker_count > STYGIAN_DECODE_POOL_MAX_WORKERS)
+    worker_count = STYGIAN_DECODE_POOL_MAX_WORKERS;
+
+  p = (StygianDecodePool *)calloc(1, sizeof(StygianDecodePool));
+  if (!p)
+    return NULL;
+  p->rt = rt;
+  p->disk_cache = disk_cache;
+  p->cell_size = cell_size;
+  p->capacity = queue_capacity;
+  p->jobs = (StygianDecodeJob *)calloc(queue_capacity,
+                                       sizeof(StygianDecodeJob));
+  p->results = (StygianDecodeResult *)calloc(queue_capacity,
+                                             sizeof(StygianDecodeResult));
+  if (!p->jobs || !p->results) {
+    free(p->jobs);
+    free(p->results);
+    free(p);
+    return NULL;
+  }
+  pool_lock_init(&p->lock);
+  pool_lock_init(&p->io_lock);
+  pool_cond_init(p);
+
+  for (i = 0u; i < worker_count; i++) {
+    if (!pool_spawn(p, &p->threads[i]))
+      break;
+    p->thread_count++;
+  }
+  if (p->thread_count == 0u) {
+    stygian_decode_pool_destroy(p);
+    return NULL;
+  }
+  return p;
+}
+
+void stygian_decode_pool_destroy(StygianDecodePool *p) {
+  uint32_t i;
+  if (!p)
+    return;
+  pool_lock(&p->lock);
+  p->shutdown = true;
+  p->job_count = 0u; // Queued jobs are dropped; in-flight ones finish
+  pool_broadcast(p);
+  pool_unlock(&p->lock);
+  for (i = 0u; i < p->thread_count; i++)
+    pool_join(p->threads[i]);
+
+  for (i = 0u; i < p->result_count; i++) {
+    StygianDecodeResult *r = &p->results[(p->result_head + i) % p->capacity];
+    stygian_triad_runtime_free_blob(r->rgba);
+  }
+  pool_cond_fini(p);
+  pool_lock_fini(&p->io_lock);
+  pool_lock_fini(&p->lock);
+  free(p->jobs);
+  free(p->results);
+  free(p);
+}
+
+bool stygian_decode_pool_submit(StygianDecodePool *p, uint64_t key_hash,
+                                uint64_t glyph_hash) {
+  bool queued = false;
+  if (!p)
+    return false;
+  pool_lock(&p->lock);
+  if (!p->shutdown &&
+      p->job_count + p->in_flight + p->result_count < p->capacity) {
+    StygianDecodeJob *job =
+        &p->jobs[(p->job_head + p->job_count) % p->capacity];
+    job->key_hash = key_hash;
+    job->glyph_hash = glyph_hash;
+    p->job_count++;
+    queued = true;
+    pool_signal(p);
+  }
+  pool_unlock(&p->lock);
+  return queued;
+}
+
+bool stygian_decode_pool_decode_now(StygianDecodePool *p, uint64_t glyph_hash,
+                                    uint8_t *out_cell) {
+  if (!p || !out_cell)
+    return false;
+  return pool_produce_cell(p, glyph_hash, out_cell);
+}
+
+uint32_t stygian_decode_pool_drain(StygianDecodePool *p,
+                                   StygianDecodeResult *out, uint32_t max) {
+  uint32_t n = 0u;
+  if (!p || !out || max == 0u)
+    return 0u;
+  pool_lock(&p->lock);
+  while (n < max && p->result_count > 0u) {
+    out[n++] = p->results[p->result_head];
+    p->result_head = (p->result_head + 1u) % p->capacity;
+    p->result_count--;
+  }
+  pool_unlock(&p->lock);
+  return n;
+}
+
+uint32_t stygian_decode_pool_outstanding(StygianDecodePool *p) {
+  uint32_t n;
+  if (!p)
+    return 0u;
+  pool_lock(&p->lock);
+  n = p->job_count + p->in_flight + p->result_count;
+  pool_unlock(&p->lock);
+  return n;
+}
@@ -0,0 +1,56 @@
+#ifndef STYGIAN_DECODE_POOL_H
+#define STYGIAN_DECODE_POOL_H
+
+#include "stygian_glyph_disk_cache.h"
+#include "stygian_triad.h"
+#include <stdbool.h>
+#include <stdint.h>
+
+// Background triad decode workers.
+//
+// Jobs (glyph hash -> RGBA cell) are queued by the frame thread and decoded
+// on worker threads against a mounted runtime, then downsampled to a
+// cell_size x cell_size bitmap; finished results wait in a completion queue
+// until the frame thread drains them. Queues are fixed size and allocated
+// at create. With a disk cache, workers check it before decoding and write
+// fresh cells back.
+//
+// The runtime (and disk cache) must outlive the pool: destroy the pool
+// before unmounting, remounting or closing the cache.
+
+typedef struct StygianDecodePool StygianDecodePool;
+
+typedef struct StygianDecodeResult {
+  uint64_t key_hash;   // Caller key passed to submit
+  uint64_t glyph_hash; // Triad entry decoded
+  uint8_t *rgba;       // Receiver frees (stygian_triad_runtime_free_blob)
+  uint32_t width;      // cell_size when ok
+  uint32_t height;
+  bool ok;
+} StygianDecodeResult;
+
+StygianDecodePool *stygian_decode_pool_create(const StygianTriadRuntime *rt,
+                                              StygianGlyphDiskCache *disk_cache,
+                                              uint32_t cell_size,
+                                              uint32_t worker_count,
+                                              uint32_t queue_capacity);
+// Cancels queued jobs, joins workers and frees undrained results.
+void stygian_decode_pool_destroy(StygianDecodePool *pool);
+
+// Queue a decode. Returns false when the job queue is full.
+bool stygian_decode_pool_submit(StygianDecodePool *pool, uint64_t key_hash,
+                                uint64_t glyph_hash);
+
+// Produce one cell on the calling thread (disk cache, else decode), sharing
+// the workers' cache lock. out_cell holds cell_size^2 RGBA.
+bool stygian_decode_pool_decode_now(StygianDecodePool *pool,
+                                    uint64_t glyph_hash, uint8_t *out_cell);
+
+// Move up to max finished results into out. Never blocks on a decode.
+uint32_t stygian_decode_pool_drain(StygianDecodePool *pool,
+                                   StygianDecodeResult *out, uint32_t max);
+
+// Jobs queued, decoding, or finished but not yet drained.
+uint32_t stygian_decode_pool_outstanding(StygianDecodePool *pool);
+
+#endif // STYGIAN_DECODE_POOL_H
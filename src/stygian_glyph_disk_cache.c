@@ -0,0 +1,361 @@
+// stygian_glyph_disk_cache.c - Fixed-slot on-disk cache of decoded glyphs
+// File layout: header | slot table (slot_count records) | cell data
+
+#include "stygian_glyph_disk_cache.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define STYGIAN_GLYPH_DISK_CACHE_MAGIC "STYGEDC1"
+#define STYGIAN_GLYPH_DISK_CACHE_VERSION 2u // 2: cells decoded at size
+#define STYGIAN_GLYPH_DISK_CACHE_FILE "stygian_emoji.cache"
+#define STYGIAN_GLYPH_DISK_CACHE_DEFAULT_BYTES (64ull * 1024ull * 1024ull)
+#define STYGIAN_GLYPH_DISK_CACHE_MAX_BYTES (1024ull * 1024ull * 1024ull)
+#define STYGIAN_GLYPH_DISK_CACHE_MIN_SLOTS 16u
+
+typedef struct StygianGlyphDiskHeader {
+  char magic[8];
+  uint32_t version;
+  uint32_t cell_size;
+  uint32_t slot_count;
+  uint32_t reserved;
+  uint64_t pack_identity;
+} StygianGlyphDiskHeader;
+
+typedef struct StygianGlyphDiskSlot {
+  uint64_t key; // 0 = empty
+  uint32_t checksum;
+  uint32_t stamp; // LRU clock value of the last load/store
+} StygianGlyphDiskSlot;
+
+#define GDC_NIL UINT32_MAX
+
+struct StygianGlyphDiskCache {
+  FILE *file;
+  StygianGlyphDiskHeader header;
+  StygianGlyphDiskSlot *slots;
+  size_t cell_bytes;
+  uint32_t clock;
+  // Key -> slot + 1 (0 = empty bucket), open addressing, built at open
+  uint32_t *index;
+  uint32_t index_mask;
+  // Slots from least to most recently used; empty slots sit at the front
+  uint32_t *lru_prev, *lru_next;
+  uint32_t lru_head, lru_tail;
+  bool stamps_dirty; // Load stamps not yet written back
+};
+
+static uint32_t gdc_checksum(uint64_t key, const uint8_t *data, size_t n) {
+  uint32_t h = 2166136261u;
+  size_t i;
+  for (i = 0; i < sizeof(key); i++) {
+    h ^= (uint32_t)((key >> (i * 8u)) & 0xFFu);
+    h *= 16777619u;
+  }
+  for (i = 0; i < n; i++) {
+    h ^= data[i];
+    h *= 16777619u;
+  }
+  return h;
+}
+
+static long gdc_slot_offset(uint32_t slot) {
+  return (long)(sizeof(StygianGlyphDiskHeader) +
+                (size_t)slot * sizeof(StygianGlyphDiskSlot));
+}
+
+static long gdc_cell_offset(const StygianGlyphDiskCache *c, uint32_t slot) {
+  return gdc_slot_offset(c->header.slot_count) +
+         (long)((size_t)slot * c->cell_bytes);
+}
+
+// Whole slot table in one write: stamps bumped by loads go back in batches.
+static bool gdc_write_table(StygianGlyphDiskCache *c) {
+  if (fseek(c->file, gdc_slot_offset(0u), SEEK_SET) != 0 ||
+      fwrite(c->slots, sizeof(StygianGlyphDiskSlot), c->header.slot_count,
+             c->file) != c->header.slot_count ||
+      fflush(c->file) != 0)
+    return false;
+  c->stamps_dirty = false;
+  return true;
+}
+
+static bool gdc_write_slot(StygianGlyphDiskCache *c, uint32_t slot) {
+  if (fseek(c->file, gdc_slot_offset(slot), SEEK_SET) != 0 ||
+      fwrite(&c->slots[slot], sizeof(StygianGlyphDiskSlot), 1, c->file) != 1)
+    return false;
+  return fflush(c->file) == 0;
+}
+
+static bool gdc_reset(StygianGlyphDiskCache *c, const char *path) {
+  if (c->file)
+    fclose(c->file);
+  c->file = fopen(path, "w+b");
+  if (!c->file)
+    return false;
+  memset(c->slots, 0,
+         (size_t)c->header.slot_count * sizeof(StygianGlyphDiskSlot));
+  c->clock = 0u;
+  return fwrite(&c->header, sizeof(c->header), 1, c->file) == 1 &&
+         fwrite(c->slots, sizeof(StygianGlyphDiskSlot),
+                c->header.slot_count,
+                c->file) == c->header.slot_count &&
+         fflush(c->file) == 0;
+}
+
+// ----------------------------------------------------------------------------
+// Key index and LRU order
+// ----------------------------------------------------------------------------
+
+static uint32_t gdc_bucket(const StygianGlyphDiskCache *c, uint64_t key) {
+  return (uint32_t)((key * 0x9E3779B97F4A7C15ull) >> 32) & c->index_mask;
+}
+
+static int gdc_find(const StygianGlyphDiskCache *c, uint64_t key) {
+  uint32_t b = gdc_bucket(c, key);
+  while (c->index[b] != 0u) {
+    if (c->slots[c->index[b] - 1u].key == key)
+      return (int)(c->index[b] - 1u);
+    b = (b + 1u) & c->index_mask;
+  }
+  return -1;
+}
+
+static void gdc_index_insert(StygianGlyphDiskCache *c, uint32_t slot) {
+  uint32_t b = gdc_bucket(c, c->slots[slot].key);
+  while (c->index[b] != 0u)
+    b = (b + 1u) & c->index_mask;
+  c->index[b] = slot + 1u;
+}
+
+// Drop the key of an occupied slot; call before the slot record changes.
+// Later entries of the probe run shift back so lookups never stop early.
+static void gdc_index_remove(StygianGlyphDiskCache *c, uint32_t slot) {
+  uint32_t b = gdc_bucket(c, c->slots[slot].key), j;
+  while (c->index[b] != slot + 1u) {
+    if (c->index[b] == 0u)
+      return;
+    b = (b + 1u) & c->index_mask;
+  }
+  c->index[b] = 0u;
+  for (j = (b + 1u) & c->index_mask; c->index[j] != 0u;
+       j = (j + 1u) & c->index_mask) {
+    uint32_t home = gdc_bucket(c, c->slots[c->index[j] - 1u].key);
+    // Movable unless its home lies cyclically in (b, j]
+    if (((j - home) & c->index_mask) >= ((j - b) & c->index_mask)) {
+      c->index[b] = c->index[j];
+      c->index[j] = 0u;
+      b = j;
+    }
+  }
+}
+
+static void gdc_lru_unlink(StygianGlyphDiskCache *c, uint32_t slot) {
+  uint32_t prev = c->lru_prev[slot], next = c->lru_next[slot];
+  if (prev != GDC_NIL)
+    c->lru_next[prev] = next;
+  else
+    c->lru_head = next;
+  if (next != GDC_NIL)
+    c->lru_prev[next] = prev;
+  else
+    c->lru_tail = prev;
+}
+
+static void gdc_lru_push_back(StygianGlyphDiskCache *c, uint32_t slot) {
+  c->lru_prev[slot] = c->lru_tail;
+  c->lru_next[slot] = GDC_NIL;
+  if (c->lru_tail != GDC_NIL)
+    c->lru_next[c->lru_tail] = slot;
+  else
+    c->lru_head = slot;
+  c->lru_tail = slot;
+}
+
+static void gdc_lru_push_front(StygianGlyphDiskCache *c, uint32_t slot) {
+  c->lru_prev[slot] = GDC_NIL;
+  c->lru_next[slot] = c->lru_head;
+  if (c->lru_head != GDC_NIL)
+    c->lru_prev[c->lru_head] = slot;
+  else
+    c->lru_tail = slot;
+  c->lru_head = slot;
+}
+
+static int gdc_order_cmp(const void *a, const void *b) {
+  uint64_t x = *(const uint64_t *)a, y = *(const uint64_t *)b;
+  return x < y ? -1 : (x > y ? 1 : 0);
+}
+
+// Index every occupied slot and chain all slots by stamp, empty ones first.
+// A key stored twice keeps its first slot; the other ages out.
+static bool gdc_build_index(StygianGlyphDiskCache *c) {
+  uint32_t count = c->header.slot_count, i;
+  uint64_t *order = (uint64_t *)malloc((size_t)count * sizeof(uint64_t));
+  if (!order)
+    return false;
+  memset(c->index, 0, ((size_t)c->index_mask + 1u) * sizeof(uint32_t));
+  c->lru_head = c->lru_tail = GDC_NIL;
+  for (i = 0; i < count; i++) {
+    const StygianGlyphDiskSlot *s = &c->slots[i];
+    order[i] = ((uint64_t)(s->key ? s->stamp : 0u) << 32) | i;
+    if (s->key != 0ull && gdc_find(c, s->key) < 0)
+      gdc_index_insert(c, i);
+  }
+  qsort(order, count, sizeof(uint64_t), gdc_order_cmp);
+  for (i = 0; i < count; i++)
+    gdc_lru_push_back(c, (uint32_t)order[i]);
+  free(order);
+  return true;
+}
+
+// ----------------------------------------------------------------------------
+// Public API
+// ----------------------------------------------------------------------------
+
+StygianGlyphDiskCache *stygian_glyph_disk_cache_open(const char *dir,
+                                                     uint64_t pack_identity,
+                                                     uint32_t cell_size,
+                                                     uint64_t max_bytes) {
+  StygianGlyphDiskCache *c;
+  StygianGlyphDiskHeader disk;
+  char path[1024];
+  uint64_t slot_count, index_size;
+  bool valid = false;
+  uint32_t i;
+  int n;
+
+  if (!dir || !dir[0] || cell_size == 0u || pack_identity == 0ull)
+    return NULL;
+  n = snprintf(path, sizeof(path), "%s/%s", dir,
+               STYGIAN_GLYPH_DISK_CACHE_FILE);
+  if (n <= 0 || (size_t)n >= sizeof(path))
+    return NULL;
+
+  if (max_bytes == 0ull)
+    max_bytes = STYGIAN_GLYPH_DISK_CACHE_DEFAULT_BYTES;
+  if (max_bytes > STYGIAN_GLYPH_DISK_CACHE_MAX_BYTES)
+    max_bytes = STYGIAN_GLYPH_DISK_CACHE_MAX_BYTES;
+
+  c = (StygianGlyphDiskCache *)calloc(1, sizeof(StygianGlyphDiskCache));
+  if (!c)
+    return NULL;
+  c->cell_bytes = (size_t)cell_size * cell_size * 4u;
+  slot_count = (max_bytes - sizeof(StygianGlyphDiskHeader)) /
+               (c->cell_bytes + sizeof(StygianGlyphDiskSlot));
+  if (slot_count < STYGIAN_GLYPH_DISK_CACHE_MIN_SLOTS)
+    slot_count = STYGIAN_GLYPH_DISK_CACHE_MIN_SLOTS;
+
+  memcpy(c->header.magic, STYGIAN_GLYPH_DISK_CACHE_MAGIC, 8);
+  c->header.version = STYGIAN_GLYPH_DISK_CACHE_VERSION;
+  c->header.cell_size = cell_size;
+  c->header.slot_count = (uint32_t)slot_count;
+  c->header.pack_identity = pack_identity;
+  c->slots = (StygianGlyphDiskSlot *)calloc((size_t)slot_count,
+                                            sizeof(StygianGlyphDiskSlot));
+  index_size = 1u;
+  while (index_size < slot_count * 2u) // Load factor at most 1/2
+    index_size <<= 1;
+  c->index_mask = (uint32_t)(index_size - 1u);
+  c->index = (uint32_t *)calloc(index_size, sizeof(uint32_t));
+  c->lru_prev = (uint32_t *)malloc((size_t)slot_count * sizeof(uint32_t));
+  c->lru_next = (uint32_t *)malloc((size_t)slot_count * sizeof(uint32_t));
+  if (!c->slots || !c->index || !c->lru_prev || !c->lru_next) {
+    stygian_glyph_disk_cache_close(c);
+    return NULL;
+  }
+
+  // Reuse the existing file only if it was built for this pack and layout.
+  c->file = fopen(path, "r+b");
+  if (c->file && fread(&disk, sizeof(disk), 1, c->file) == 1 &&
+      memcmp(&disk, &c->header, sizeof(disk)) == 0 &&
+      fread(c->slots, sizeof(StygianGlyphDiskSlot), c->header.slot_count,
+            c->file) == c->header.slot_count) {
+    valid = true;
+    for (i = 0; i < c->header.slot_count; i++) {
+      if (c->slots[i].stamp > c->clock)
+        c->clock = c->slots[i].stamp;
+    }
+  }
+  if ((!valid && !gdc_reset(c, path)) || !gdc_build_index(c)) {
+    stygian_glyph_disk_cache_close(c);
+    return NULL;
+  }
+  return c;
+}
+
+void stygian_glyph_disk_cache_close(StygianGlyphDiskCache *c) {
+  if (!c)
+    return;
+  if (c->file) {
+    if (c->stamps_dirty)
+      gdc_write_table(c);
+    fclose(c->file);
+  }
+  free(c->slots);
+  free(c->index);
+  free(c->lru_prev);
+  free(c->lru_next);
+  free(c);
+}
+
+bool stygian_glyph_disk_cache_load(StygianGlyphDiskCache *c, uint64_t key,
+                                   uint8_t *out_rgba) {
+  int slot;
+  if (!c || !c->file || key == 0ull || !out_rgba)
+    return false;
+  slot = gdc_find(c, key);
+  if (slot < 0)
+    return false;
+  gdc_lru_unlink(c, (uint32_t)slot);
+  if (fseek(c->file, gdc_cell_offset(c, (uint32_t)slot), SEEK_SET) != 0 ||
+      fread(out_rgba, 1, c->cell_bytes, c->file) != c->cell_bytes ||
+      gdc_checksum(key, out_rgba, c->cell_bytes) != c->slots[slot].checksum) {
+    gdc_index_remove(c, (uint32_t)slot);
+    memset(&c->slots[slot], 0, sizeof(c->slots[slot]));
+    gdc_write_slot(c, (uint32_t)slot);
+    gdc_lru_push_front(c, (uint32_t)slot);
+    return false;
+  }
+  // Hits only reorder in memory; the stamp reaches disk with the next
+  // eviction or at close.
+  c->slots[slot].stamp = ++c->clock;
+  c->stamps_dirty = true;
+  gdc_lru_push_back(c, (uint32_t)slot);
+  return true;
+}
+
+bool stygian_glyph_disk_cache_store(StygianGlyphDiskCache *c, uint64_t key,
+                                    const uint8_t *rgba) {
+  int slot;
+  bool fresh = false, evicted = false;
+  if (!c || !c->file || key == 0ull || !rgba)
+    return false;
+  slot = gdc_find(c, key);
+  if (slot < 0) {
+    // Least recently used slot; empty slots come first.
+    slot = (int)c->lru_head;
+    if (c->slots[slot].key != 0ull) {
+      gdc_index_remove(c, (uint32_t)slot);
+      memset(&c->slots[slot], 0, sizeof(c->slots[slot]));
+      evicted = true;
+    }
+    fresh = true;
+  }
+
+  // Pixels first, then the slot record: a torn write leaves a checksum that
+  // no longer matches instead of a valid-looking cell.
+  if (fseek(c->file, gdc_cell_offset(c, (uint32_t)slot), SEEK_SET) != 0 ||
+      fwrite(rgba, 1, c->cell_bytes, c->file) != c->cell_bytes)
+    return false;
+  c->slots[slot].key = key;
+  c->slots[slot].checksum = gdc_checksum(key, rgba, c->cell_bytes);
+  c->slots[slot].stamp = ++c->clock;
+  if (fresh)
+    gdc_index_insert(c, (uint32_t)slot);
+  gdc_lru_unlink(c, (uint32_t)slot);
+  gdc_lru_push_back(c, (uint32_t)slot);
+  if (evicted) // Batch the pending load stamps with the new record
+    return gdc_write_table(c);
+  return gdc_write_slot(c, (uint32_t)slot);
+}
@@ -0,0 +1,37 @@
+#ifndef STYGIAN_GLYPH_DISK_CACHE_H
+#define STYGIAN_GLYPH_DISK_CACHE_H
+
+#include <stdbool.h>
+#include <stdint.h>
+
+// On-disk cache of decoded, downsampled glyph bitmaps.
+//
+// One file per directory holds a fixed number of fixed-size RGBA cells plus
+// a slot table, so its size never exceeds the byte budget given at open.
+// The header records the source pack identity and cell size; any mismatch
+// (or a damaged header) resets the file. Each slot carries a checksum of its
+// key and pixels, written after the pixels, so torn or corrupted cells are
+// detected on load and dropped. Full caches evict the least recently used
+// slot. Lookups and the LRU order live in memory, built at open; the stamps
+// that loads bump are written back with the slot table on eviction and at
+// close, so the order persists across clean runs.
+//
+// Not thread-safe: callers serialize access.
+
+typedef struct StygianGlyphDiskCache StygianGlyphDiskCache;
+
+// Open (or create) <dir>/stygian_emoji.cache. max_bytes 0 = default.
+StygianGlyphDiskCache *stygian_glyph_disk_cache_open(const char *dir,
+                                                     uint64_t pack_identity,
+                                                     uint32_t cell_size,
+                                                     uint64_t max_bytes);
+void stygian_glyph_disk_cache_close(StygianGlyphDiskCache *cache);
+
+// Copy a cached cell (cell_size^2 RGBA) into out. False on miss or when the
+// stored cell fails its checksum (the slot is then discarded).
+bool stygian_glyph_disk_cache_load(StygianGlyphDiskCache *cache, uint64_t key,
+                                   uint8_t *out_rgba);
+bool stygian_glyph_disk_cache_store(StygianGlyphDiskCache *cache, uint64_t key,
+                                    const uint8_t *rgba);
+
+#endif // STYGIAN_GLYPH_DISK_CACHE_H
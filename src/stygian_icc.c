@@ -112,6 +112,94 @@ static bool parse_desc_tag(const uint8_t *buf, size_t len,
   return true;
 }
 
+static float s15f16(const uint8_t *p) { return (float)be32s(p) / 65536.0f; }
+
+// rTRC/gTRC/bTRC: 'curv' (identity, u8Fixed8 gamma or a 16-bit table) or
+// 'para' (function types 0-4), normalized to StygianColorTrc.
+static bool parse_trc_tag(const uint8_t *buf, size_t len, const ICCTagRecord *t,
+                          StygianColorTrc *out) {
+  const uint8_t *p;
+  uint32_t type;
+  if (!buf || !t || !out)
+    return false;
+  if ((size_t)t->offset + (size_t)t->size > len || t->size < 12u)
+    return false;
+  p = buf + t->offset;
+  type = be32(p);
+  memset(out, 0, sizeof(*out));
+
+  if (type == fourcc('c', 'u', 'r', 'v')) {
+    uint32_t count = be32(p + 8);
+    uint16_t samples[STYGIAN_COLOR_TRC_SAMPLES];
+    uint32_t i;
+    if (12u + (size_t)count * 2u > t->size)
+      return false;
+    if (count <= 1u) {
+      out->type = STYGIAN_COLOR_TRC_PARAMETRIC;
+      out->params[0] = count ? (float)((p[12] << 8) | p[13]) / 256.0f : 1.0f;
+      out->params[1] = 1.0f;
+      return out->params[0] > 0.0f;
+    }
+    for (i = 0; i < STYGIAN_COLOR_TRC_SAMPLES; i++) {
+      float pos = (float)i * (float)(count - 1u) /
+                  (float)(STYGIAN_COLOR_TRC_SAMPLES - 1);
+      uint32_t k = (uint32_t)pos;
+      float frac = pos - (float)k;
+      float a, b;
+      if (k >= count - 1u) {
+        k = count - 2u;
+        frac = 1.0f;
+      }
+      a = (float)((p[12 + k * 2] << 8) | p[13 + k * 2]);
+      b = (float)((p[14 + k * 2] << 8) | p[15 + k * 2]);
+      samples[i] = (uint16_t)(a + (b - a) * frac + 0.5f);
+    }
+    out->type = STYGIAN_COLOR_TRC_TABLE;
+    out->table = stygian_color_trc_table_intern(samples);
+    return out->table != NULL;
+  }
+
+  if (type == fourcc('p', 'a', 'r', 'a')) {
+    static const uint32_t param_count[5] = {1u, 3u, 4u, 5u, 7u};
+    uint32_t fn = ((uint32_t)p[8] << 8) | p[9];
+    float v[7] = {0};
+    float *o = out->params; // g, a, b, c, d, e, f
+    uint32_t i;
+    if (fn > 4u || 12u + (size_t)param_count[fn] * 4u > t->size)
+      return false;
+    for (i = 0; i < param_count[fn]; i++)
+      v[i] = s15f16(p + 12 + i * 4);
+    o[0] = v[0];
+    o[1] = (fn == 0u) ? 1.0f : v[1];
+    o[2] = (fn == 0u) ? 0.0f : v[2];
+    switch (fn) {
+    case 1u: // (aX + b)^g for X >= -b/a, else 0
+      o[4] = (v[1] != 0.0f) ? -v[2] / v[1] : 0.0f;
+      break;
+    case 2u: // (aX + b)^g + c for X >= -b/a, else c
+      o[4] = (v[1] != 0.0f) ? -v[2] / v[1] : 0.0f;
+      o[5] = v[3];
+      o[6] = v[3];
+      break;
+    case 3u: // (aX + b)^g for X >= d, else cX
+      o[3] = v[3];
+      o[4] = v[4];
+      break;
+    case 4u:
+      o[3] = v[3];
+      o[4] = v[4];
+      o[5] = v[5];
+      o[6] = v[6];
+      break;
+    default:
+      break;
+    }
+    out->type = STYGIAN_COLOR_TRC_PARAMETRIC;
+    return o[0] > 0.0f;
+  }
+  return false;
+}
+
 bool stygian_icc_load_profile(const char *path,
                               StygianColorProfile *out_profile,
                               StygianICCInfo *out_info) {
@@ -184,19 +272,43 @@ bool stygian_icc_load_profile(const char *path,
   }
 
   if (has_r && has_g && has_b) {
-    float m[9];
-    m[0] = r_xyz[0];
-    m[1] = g_xyz[0];
-    m[2] = b_xyz[0];
-    m[3] = r_xyz[1];
-    m[4] = g_xyz[1];
-    m[5] = b_xyz[1];
-    m[6] = r_xyz[2];
-    m[7] = g_xyz[2];
-    m[8] = b_xyz[2];
+    // ICC colorants are adapted to the D50 PCS; Bradford-adapt them back to
+    // D65 so they share a white with the built-in profiles.
+    static const float d50_to_d65[9] = {
+        0.9555766f,  -0.0230393f, 0.0631636f, -0.0282895f, 1.0099416f,
+        0.0210077f,  0.0122982f,  -0.0204830f, 1.3299098f,
+    };
+    float pcs[9], m[9];
+    int row;
+    pcs[0] = r_xyz[0];
+    pcs[1] = g_xyz[0];
+    pcs[2] = b_xyz[0];
+    pcs[3] = r_xyz[1];
+    pcs[4] = g_xyz[1];
+    pcs[5] = b_xyz[1];
+    pcs[6] = r_xyz[2];
+    pcs[7] = g_xyz[2];
+    pcs[8] = b_xyz[2];
+    for (row = 0; row < 3; row++) {
+      for (i = 0; i < 3u; i++) {
+        m[row * 3 + i] = d50_to_d65[row * 3 + 0] * pcs[i] +
+                         d50_to_d65[row * 3 + 1] * pcs[3 + i] +
+                         d50_to_d65[row * 3 + 2] * pcs[6 + i];
+      }
+    }
     if (!stygian_color_profile_init_custom(out_profile, "ICC RGB", m, true,
                                            2.4f)) {
       stygian_color_profile_init_builtin(out_profile, STYGIAN_COLOR_SPACE_SRGB);
+    } else {
+      // Tone curves; channels without a readable TRC keep the sRGB curve.
+      const uint32_t trc_sig[3] = {fourcc('r', 'T', 'R', 'C'),
+                                   fourcc('g', 'T', 'R', 'C'),
+                                   fourcc('b', 'T', 'R', 'C')};
+      for (i = 0; i < 3u; i++) {
+        const ICCTagRecord *t = find_tag(tags, tag_count, trc_sig[i]);
+        if (!t || !parse_trc_tag(buf, len, t, &out_profile->trc[i]))
+          memset(&out_profile->trc[i], 0, sizeof(out_profile->trc[i]));
+      }
     }
   } else {
     // Heuristic fallback by description/path
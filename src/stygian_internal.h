@@ -71,12 +71,39 @@ static inline void stygian_cpystr(char *dst, size_t dstsz, const char *src) {
 typedef struct StygianWindow StygianWindow;
 typedef struct StygianAP StygianAP;
 typedef struct StygianTriadRuntime StygianTriadRuntime;
+typedef struct StygianDecodePool StygianDecodePool;
+typedef struct StygianGlyphDiskCache StygianGlyphDiskCache;
+typedef struct StygianTextureAtlas StygianTextureAtlas;
 
 // ============================================================================
 // Configuration Constants
 // ============================================================================
 
 #define STYGIAN_INLINE_EMOJI_CACHE_SIZE 512
+#define STYGIAN_INLINE_EMOJI_INDEX_SIZE 1024 // Power of two, >= 2x cache
+// Inline emoji share atlas pages: cache slot i owns cell (i % cells/page) of
+// page (i / cells/page), so the LRU cache doubles as the atlas allocator.
+#define STYGIAN_EMOJI_ATLAS_PAGE_SIZE 1024
+#define STYGIAN_EMOJI_ATLAS_CELL_SIZE 64
+#define STYGIAN_EMOJI_ATLAS_CELLS_PER_ROW                                      \
+  (STYGIAN_EMOJI_ATLAS_PAGE_SIZE / STYGIAN_EMOJI_ATLAS_CELL_SIZE)
+#define STYGIAN_EMOJI_ATLAS_CELLS_PER_PAGE                                     \
+  (STYGIAN_EMOJI_ATLAS_CELLS_PER_ROW * STYGIAN_EMOJI_ATLAS_CELLS_PER_ROW)
+#define STYGIAN_EMOJI_ATLAS_MAX_PAGES                                          \
+  (STYGIAN_INLINE_EMOJI_CACHE_SIZE / STYGIAN_EMOJI_ATLAS_CELLS_PER_PAGE)
+#define STYGIAN_EMOJI_ATLAS_PAGE_BYTES                                         \
+  (STYGIAN_EMOJI_ATLAS_PAGE_SIZE * STYGIAN_EMOJI_ATLAS_PAGE_SIZE * 4u)
+// User textures up to MAX_ITEM on a side share atlas pages instead of
+// taking a sampler each (see stygian_texture_atlas.h).
+#define STYGIAN_TEXTURE_ATLAS_PAGE_SIZE 2048u
+#define STYGIAN_TEXTURE_ATLAS_MAX_PAGES 4u
+#define STYGIAN_TEXTURE_ATLAS_MAX_ITEM 256
+#define STYGIAN_TEXTURE_ATLAS_PADDING 1u
+#define STYGIAN_DECODE_POOL_WORKERS 2u
+#define STYGIAN_DECODE_POOL_QUEUE 128u
+#define STYGIAN_DECODE_DRAIN_PER_FRAME 32u
+#define STYGIAN_DECODE_WAITING_SCOPES 16u
+#define STYGIAN_COLOR_TRANSFORM_CACHE 4u // Built src/dst profile pairs
 #define STYGIAN_MAX_FONTS 16u
 
 // ============================================================================
@@ -86,8 +113,13 @@ typedef struct StygianTriadRuntime StygianTriadRuntime;
 #define STYGIAN_FLAG_VISIBLE (1 << 0)
 #define STYGIAN_FLAG_ALLOCATED (1 << 1)
 #define STYGIAN_FLAG_TRANSIENT (1 << 2)
-#define STYGIAN_CLIP_MASK 0xFF00
+#define STYGIAN_CLIP_MASK 0xFFFFFF00u // Clip id: the top 24 bits
 #define STYGIAN_CLIP_SHIFT 8
+#define STYGIAN_CLIP_ID_LIMIT (1u << 24)
+// Clip rects one storage block may hold: the minimum guaranteed
+// GL_MAX_SHADER_STORAGE_BLOCK_SIZE / maxStorageBufferRange (2^27 bytes)
+// over 16-byte rects.
+#define STYGIAN_CLIP_BUFFER_LIMIT ((1u << 27) / 16u)
 
 // ============================================================================
 // Clip Region
@@ -99,11 +131,13 @@ typedef struct {
 
 typedef struct {
   bool used;
+  bool ready;   // Atlas cell holds the decoded image
+  bool pending; // Submitted to the decode pool, cell not ready yet
+  bool failed;  // Decode failed; render the shortcode as text
   uint64_t glyph_hash;
-  uint32_t texture_id;
-  uint16_t width;
-  uint16_t height;
-  uint32_t last_used;
+  uint16_t lru_prev;   // Slot + 1 (0 = none); list head = most recently used
+  uint16_t lru_next;   // Slot + 1 (0 = none)
+  uint32_t last_frame; // Drawn this frame: not evictable until the next one
 } StygianInlineEmojiCacheEntry;
 
 typedef struct {
@@ -143,7 +177,8 @@ typedef struct {
   uint32_t generation;
   uint32_t range_start;
   uint32_t range_count;
-  uint8_t clip_snapshot;
+  StygianClipId clip_snapshot;
+  uint32_t clip_epoch; // Clip table generation the range was built against
   float z_snapshot;
   uint32_t last_dirty_reason;
   uint32_t last_source_tag;
@@ -286,7 +321,7 @@ typedef struct StygianSoAHot {
   float color[4];      // 16 - primary RGBA
   uint32_t texture_id; //  4
   uint32_t type;       //  4 - element type | (render_mode << 16)
-  uint32_t flags;      //  4 - visible(1), clip_id(8), etc.
+  uint32_t flags;      //  4 - visible(1), clip_id(24), etc.
   float z;             //  4
 } StygianSoAHot;       // 48 bytes
 
@@ -388,6 +423,13 @@ struct StygianContext {
   uint16_t *texture_generations;
   uint32_t *texture_backend_ids;
   uint32_t texture_count;
+  // Atlased slots: backend id is their page's texture, the packer id is
+  // nonzero and a CPU copy of the pixels feeds gutter and repack uploads.
+  StygianTextureAtlas *texture_atlas;
+  uint32_t texture_atlas_pages[STYGIAN_TEXTURE_ATLAS_MAX_PAGES]; // Backend ids
+  uint32_t *texture_atlas_ids;
+  uint8_t **texture_atlas_pixels;
+  bool texture_atlas_has_holes; // Freed since the last compaction attempt
 
   // SoA element storage (Hot/Cold split — 3 SSBOs)
   StygianSoA soa;
@@ -400,10 +442,17 @@ struct StygianContext {
   uint32_t transient_start;
   uint32_t transient_count;
 
-  // Clip stack
+  // Clip table: rects persist across frames and are found again by value
+  // through clip_lookup (open addressing on ids, 0 = empty slot).
   StygianClipRect *clips;
-  uint16_t clip_count;
-  uint8_t clip_stack[32];
+  uint32_t clip_count;
+  uint32_t *clip_lookup;
+  uint32_t clip_lookup_mask;
+  uint32_t *clip_frame;      // frame_index + 1 of each id's last push
+  uint32_t clip_upload_from; // First entry changed since the last upload
+  uint32_t clip_epoch;       // Bumped each time the table restarts
+  uint32_t frame_clip_uses;  // Distinct clips pushed this frame
+  StygianClipId clip_stack[32];
   uint8_t clip_stack_top;
 
   // Fonts
@@ -416,12 +465,40 @@ struct StygianContext {
 
   StygianInlineEmojiCacheEntry
       inline_emoji_cache[STYGIAN_INLINE_EMOJI_CACHE_SIZE];
-  uint32_t inline_emoji_clock;
+  // Open-addressed key -> slot + 1 index (0 = empty, linear probing with
+  // backward-shift deletion) and an intrusive LRU list through the entries,
+  // so lookup, touch and eviction never scan the cache.
+  uint16_t inline_emoji_index[STYGIAN_INLINE_EMOJI_INDEX_SIZE];
+  uint16_t inline_emoji_lru_head; // Slot + 1 (0 = empty list)
+  uint16_t inline_emoji_lru_tail;
+  uint16_t inline_emoji_free[STYGIAN_INLINE_EMOJI_CACHE_SIZE]; // Released
+  uint32_t inline_emoji_free_count;
+  uint32_t inline_emoji_fresh;      // Slots [fresh, limit) never used yet
+  uint32_t inline_emoji_used_count;
+  uint32_t inline_emoji_slot_limit; // Slots backed by the atlas budget
+  StygianTexture emoji_atlas_pages[STYGIAN_EMOJI_ATLAS_MAX_PAGES];
 
   StygianTriadRuntime *triad_runtime;
+  StygianDecodePool *decode_pool; // Present while a pack is mounted
+  // Persistent decoded-cell cache (stygian_set_emoji_disk_cache); open while
+  // a pack is mounted and a directory is set
+  char emoji_disk_cache_dir[512];
+  uint64_t emoji_disk_cache_bytes;
+  StygianGlyphDiskCache *emoji_disk_cache;
+  // Scopes that drew an emoji placeholder; dirtied when decodes complete
+  StygianScopeId decode_waiting_scopes[STYGIAN_DECODE_WAITING_SCOPES];
+  uint32_t decode_waiting_count;
+  bool decode_waiting_overflow; // Unscoped or too many: dirty everything
   StygianColorProfile output_color_profile;
   StygianColorProfile glyph_source_color_profile;
   bool glyph_color_transform_enabled;
+  // Built transforms (shaper tables + 3D LUT) keyed by profile pair; slots
+  // are reused round-robin
+  StygianColorTransform *color_transforms[STYGIAN_COLOR_TRANSFORM_CACHE];
+  uint64_t color_transform_keys[STYGIAN_COLOR_TRANSFORM_CACHE];
+  StygianColorProfile color_transform_src[STYGIAN_COLOR_TRANSFORM_CACHE];
+  StygianColorProfile color_transform_dst[STYGIAN_COLOR_TRANSFORM_CACHE];
+  uint32_t color_transform_next;
 
   // Render layers (optional multi-pass draws)
   uint32_t layer_start;
@@ -433,10 +510,13 @@ struct StygianContext {
   } layers[32];
 
   // Frame stats
-  uint32_t frame_draw_calls;
+  uint32_t frame_draw_calls; // Draw ranges requested this frame
   uint32_t last_frame_draw_calls;
+  uint32_t last_frame_draw_ranges;
   uint32_t last_frame_element_count;
   uint32_t last_frame_clip_count;
+  uint32_t frame_clip_rejects; // Slots left out of this frame's draw ranges
+  uint32_t last_frame_clip_rejects;
   uint32_t last_frame_upload_bytes;
   uint32_t last_frame_upload_ranges;
   uint32_t frame_scope_replay_hits;
@@ -449,6 +529,23 @@ struct StygianContext {
   float last_frame_submit_ms;
   float last_frame_present_ms;
   float last_frame_gpu_ms;
+  float last_frame_gpu_phase_ms[33]; // Main pass + layers[32]
+  uint32_t last_frame_gpu_phase_count;
+  bool gpu_phase_timing; // Mark per-layer GPU phases in the draw loop
+  StygianDamageRect last_frame_damage[STYGIAN_MAX_DAMAGE_RECTS];
+  uint32_t last_frame_damage_count;
+  float last_frame_damage_fraction;
+  bool last_frame_damage_full;
+
+  // Damage tracking: what each slot drew in the last rendered frame
+  bool damage_tracking;
+  bool damage_full;                  // Next rendered frame repaints all
+  uint64_t *damage_hash;             // Per slot; 0 = drew nothing
+  StygianClipRect *damage_footprint; // Per slot screen rect it drew
+  uint32_t *damage_chunk_versions;   // hot/appearance/effects, per chunk
+  uint32_t damage_element_count;     // element_count of that frame
+  uint32_t damage_clip_epoch;
+  int damage_width, damage_height;
   uint32_t last_frame_reason_flags;
   uint32_t last_frame_eval_only;
   uint32_t frame_index;
@@ -3,13 +3,17 @@
 
 #include <stdbool.h>
 #include <stddef.h>
+#include <stdint.h>
 #include <stdio.h>
+#include <string.h>
 
 #ifdef _WIN32
 #define WIN32_LEAN_AND_MEAN
 #include <windows.h>
 #else
+#include <fcntl.h>
 #include <limits.h>
+#include <sys/mman.h>
 #include <sys/stat.h>
 #include <unistd.h>
 
@@ -18,6 +22,19 @@
 #endif
 #endif
 
+#if defined(__x86_64__) || defined(_M_X64)
+#define STYGIAN_X86_SIMD 1
+#include <immintrin.h>
+#if defined(_MSC_VER) && !defined(__clang__)
+#include <intrin.h>
+#define STYGIAN_TARGET_AVX2 // MSVC emits AVX2 intrinsics without a target
+#else
+#define STYGIAN_TARGET_AVX2 __attribute__((target("avx2")))
+#endif
+#else
+#define STYGIAN_X86_SIMD 0
+#endif
+
 // ============================================================================
 // Platform Abstraction Helpers
 // ============================================================================
@@ -76,4 +93,113 @@ static inline bool stygian_get_binary_dir(char *buffer, size_t size) {
 #endif
 }
 
+// ============================================================================
+// CPU Feature Detection
+// ============================================================================
+
+// AVX2 kernels may run: the CPU has AVX2 and the OS saves YMM state. Always
+// false off x86-64.
+static inline bool stygian_cpu_has_avx2(void) {
+#if STYGIAN_X86_SIMD
+#if defined(_MSC_VER) && !defined(__clang__)
+  int regs[4];
+  __cpuid(regs, 0);
+  if (regs[0] >= 7) {
+    __cpuid(regs, 1);
+    // OSXSAVE + AVX, and the OS saves YMM state
+    if ((regs[2] & (1 << 27)) && (regs[2] & (1 << 28)) &&
+        (_xgetbv(0) & 6u) == 6u) {
+      __cpuidex(regs, 7, 0);
+      return (regs[1] & (1 << 5)) != 0;
+    }
+  }
+  return false;
+#else
+  __builtin_cpu_init();
+  return __builtin_cpu_supports("avx2") != 0;
+#endif
+#else
+  return false;
+#endif
+}
+
+// ============================================================================
+// Read-only File Mapping
+// ============================================================================
+
+typedef struct StygianMappedFile {
+  const unsigned char *data;
+  size_t size;
+#ifdef _WIN32
+  HANDLE file;
+  HANDLE mapping;
+#endif
+} StygianMappedFile;
+
+// Map a whole file read-only. Pages are faulted in on first touch, and the
+// view has no file position, so concurrent readers need no lock.
+static inline bool stygian_map_file_readonly(const char *path,
+                                             StygianMappedFile *out) {
+  if (!path || !path[0] || !out)
+    return false;
+  memset(out, 0, sizeof(*out));
+#ifdef _WIN32
+  LARGE_INTEGER size;
+  HANDLE file = CreateFileA(path, GENERIC_READ, FILE_SHARE_READ, NULL,
+                            OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, NULL);
+  if (file == INVALID_HANDLE_VALUE)
+    return false;
+  if (!GetFileSizeEx(file, &size) || size.QuadPart <= 0 ||
+      (unsigned long long)size.QuadPart > (unsigned long long)SIZE_MAX) {
+    CloseHandle(file);
+    return false;
+  }
+  HANDLE mapping = CreateFileMappingA(file, NULL, PAGE_READONLY, 0, 0, NULL);
+  if (!mapping) {
+    CloseHandle(file);
+    return false;
+  }
+  const void *view = MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0);
+  if (!view) {
+    CloseHandle(mapping);
+    CloseHandle(file);
+    return false;
+  }
+  out->data = (const unsigned char *)view;
+  out->size = (size_t)size.QuadPart;
+  out->file = file;
+  out->mapping = mapping;
+  return true;
+#else
+  struct stat st;
+  int fd = open(path, O_RDONLY);
+  if (fd < 0)
+    return false;
+  if (fstat(fd, &st) != 0 || st.st_size <= 0) {
+    close(fd);
+    return false;
+  }
+  void *view = mmap(NULL, (size_t)st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+  close(fd); // The mapping keeps its own reference to the file
+  if (view == MAP_FAILED)
+    return false;
+  out->data = (const unsigned char *)view;
+  out->size = (size_t)st.st_size;
+  return true;
+#endif
+}
+
+static inline void stygian_unmap_file(StygianMappedFile *map) {
+  if (!map || !map->data)
+    return;
+#ifdef _WIN32
+  UnmapViewOfFile(map->data);
+  CloseHandle(map->mapping);
+  CloseHandle(map->file);
+#else
+  munmap((void *)map->data, map->size);
+#endif
+  memset(map, 0, sizeof(*map));
+}
+
 #endif // STYGIAN_PLATFORM_H
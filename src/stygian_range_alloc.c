@@ -0,0 +1,157 @@
+// stygian_range_alloc.c - First-fit offset allocator with coalescing free list
+
+#include "stygian_range_alloc.h"
+#include <stdlib.h>
+#include <string.h>
+
+typedef struct RangeAllocSpan {
+  uint64_t offset;
+  uint64_t size;
+} RangeAllocSpan;
+
+struct StygianRangeAlloc {
+  uint64_t capacity;
+  uint64_t free_bytes;
+  RangeAllocSpan *spans; // Free ranges, sorted by offset, never adjacent
+  uint32_t span_count;
+  uint32_t span_capacity;
+};
+
+StygianRangeAlloc *stygian_range_alloc_create(uint64_t capacity) {
+  StygianRangeAlloc *ra;
+  if (capacity == 0u)
+    return NULL;
+  ra = (StygianRangeAlloc *)calloc(1, sizeof(StygianRangeAlloc));
+  if (!ra)
+    return NULL;
+  ra->span_capacity = 16u;
+  ra->spans = (RangeAllocSpan *)malloc(ra->span_capacity * sizeof(*ra->spans));
+  if (!ra->spans) {
+    free(ra);
+    return NULL;
+  }
+  ra->capacity = capacity;
+  ra->free_bytes = capacity;
+  ra->spans[0].offset = 0u;
+  ra->spans[0].size = capacity;
+  ra->span_count = 1u;
+  return ra;
+}
+
+void stygian_range_alloc_destroy(StygianRangeAlloc *ra) {
+  if (!ra)
+    return;
+  free(ra->spans);
+  free(ra);
+}
+
+// Open a hole at index for one more span.
+static bool ral_insert(StygianRangeAlloc *ra, uint32_t index) {
+  if (ra->span_count == ra->span_capacity) {
+    uint32_t next = ra->span_capacity * 2u;
+    RangeAllocSpan *grown = (RangeAllocSpan *)realloc(
+        ra->spans, (size_t)next * sizeof(*ra->spans));
+    if (!grown)
+      return false;
+    ra->spans = grown;
+    ra->span_capacity = next;
+  }
+  memmove(&ra->spans[index + 1u], &ra->spans[index],
+          (size_t)(ra->span_count - index) * sizeof(*ra->spans));
+  ra->span_count++;
+  return true;
+}
+
+static void ral_remove(StygianRangeAlloc *ra, uint32_t index) {
+  memmove(&ra->spans[index], &ra->spans[index + 1u],
+          (size_t)(ra->span_count - index - 1u) * sizeof(*ra->spans));
+  ra->span_count--;
+}
+
+bool stygian_range_alloc_alloc(StygianRangeAlloc *ra, uint64_t size,
+                               uint64_t alignment, uint64_t *out_offset) {
+  uint32_t i;
+  if (!ra || size == 0u || size > ra->free_bytes)
+    return false;
+  if (alignment == 0u)
+    alignment = 1u;
+  if ((alignment & (alignment - 1u)) != 0u)
+    return false;
+
+  for (i = 0; i < ra->span_count; i++) {
+    RangeAllocSpan *s = &ra->spans[i];
+    uint64_t start = (s->offset + alignment - 1u) & ~(alignment - 1u);
+    uint64_t pad = start - s->offset;
+    uint64_t end = s->offset + s->size;
+    if (start < s->offset || pad > s->size || s->size - pad < size)
+      continue;
+    if (pad > 0u && start + size < end) {
+      // Both a leading pad and a tail survive: split in two.
+      if (!ral_insert(ra, i + 1u))
+        return false;
+      s = &ra->spans[i];
+      ra->spans[i + 1u].offset = start + size;
+      ra->spans[i + 1u].size = end - (start + size);
+      s->size = pad;
+    } else if (pad > 0u) {
+      s->size = pad;
+    } else if (start + size < end) {
+      s->offset = start + size;
+      s->size = end - s->offset;
+    } else {
+      ral_remove(ra, i);
+    }
+    ra->free_bytes -= size;
+    if (out_offset)
+      *out_offset = start;
+    return true;
+  }
+  return false;
+}
+
+void stygian_range_alloc_free(StygianRangeAlloc *ra, uint64_t offset,
+                              uint64_t size) {
+  uint32_t lo = 0u, hi, i;
+  bool merge_prev, merge_next;
+  if (!ra || size == 0u || offset >= ra->capacity ||
+      size > ra->capacity - offset)
+    return;
+
+  // First span starting after the freed range.
+  hi = ra->span_count;
+  while (lo < hi) {
+    uint32_t mid = (lo + hi) / 2u;
+    if (ra->spans[mid].offset <= offset)
+      lo = mid + 1u;
+    else
+      hi = mid;
+  }
+  i = lo;
+  merge_prev =
+      i > 0u && ra->spans[i - 1u].offset + ra->spans[i - 1u].size == offset;
+  merge_next = i < ra->span_count && offset + size == ra->spans[i].offset;
+
+  if (merge_prev && merge_next) {
+    ra->spans[i - 1u].size += size + ra->spans[i].size;
+    ral_remove(ra, i);
+  } else if (merge_prev) {
+    ra->spans[i - 1u].size += size;
+  } else if (merge_next) {
+    ra->spans[i].offset = offset;
+    ra->spans[i].size += size;
+  } else {
+    if (!ral_insert(ra, i))
+      return; // Out of memory: the range leaks rather than corrupting the list
+    ra->spans[i].offset = offset;
+    ra->spans[i].size = size;
+  }
+  ra->free_bytes += size;
+}
+
+uint64_t stygian_range_alloc_free_bytes(const StygianRangeAlloc *ra) {
+  return ra ? ra->free_bytes : 0u;
+}
+
+uint32_t stygian_range_alloc_fragments(const StygianRangeAlloc *ra) {
+  return ra ? ra->span_count : 0u;
+}
@@ -0,0 +1,34 @@
+#ifndef STYGIAN_RANGE_ALLOC_H
+#define STYGIAN_RANGE_ALLOC_H
+
+#include <stdbool.h>
+#include <stdint.h>
+
+// Offset allocator over a fixed span [0, capacity), for carving GPU memory
+// blocks into sub-allocations.
+//
+// Free space is a list of ranges sorted by offset. Allocation is first fit
+// with the requested alignment (any power of two); the padding skipped to
+// align stays free. Freeing merges with both neighbours, so a fully freed
+// span is one range again. The allocator never touches the memory itself.
+//
+// Not thread-safe: callers serialize access.
+
+typedef struct StygianRangeAlloc StygianRangeAlloc;
+
+StygianRangeAlloc *stygian_range_alloc_create(uint64_t capacity);
+void stygian_range_alloc_destroy(StygianRangeAlloc *ra);
+
+// Reserve size bytes at an offset that is a multiple of alignment (0 or 1 =
+// unaligned). False when no free range fits.
+bool stygian_range_alloc_alloc(StygianRangeAlloc *ra, uint64_t size,
+                               uint64_t alignment, uint64_t *out_offset);
+// Return a range previously handed out; size must match the allocation.
+void stygian_range_alloc_free(StygianRangeAlloc *ra, uint64_t offset,
+                              uint64_t size);
+
+uint64_t stygian_range_alloc_free_bytes(const StygianRangeAlloc *ra);
+// Free ranges; 1 on an empty allocator, more as space fragments.
+uint32_t stygian_range_alloc_fragments(const StygianRangeAlloc *ra);
+
+#endif // STYGIAN_RANGE_ALLOC_H
@@ -0,0 +1,277 @@
+// stygian_texture_atlas.c - Shelf packer for small textures on shared pages
+// Items are stored padded (gutter included); rects handed out are content.
+
+#include "stygian_texture_atlas.h"
+#include <stdlib.h>
+#include <string.h>
+
+typedef struct TextureAtlasShelf {
+  uint32_t page;
+  uint32_t y;
+  uint32_t height;
+  uint32_t cursor; // First free column
+  uint32_t live;   // Live items on the shelf
+} TextureAtlasShelf;
+
+typedef struct TextureAtlasItem {
+  uint32_t shelf;
+  uint32_t x, y; // Padded cell origin
+  uint32_t w, h; // Padded cell size
+  bool live;
+} TextureAtlasItem;
+
+struct StygianTextureAtlas {
+  uint32_t page_size;
+  uint32_t max_pages;
+  uint32_t padding;
+  uint32_t page_count;
+  uint32_t *page_top; // First row not yet claimed by a shelf, per page
+  TextureAtlasShelf *shelves;
+  uint32_t shelf_count;
+  uint32_t shelf_capacity;
+  TextureAtlasItem *items; // id = index + 1
+  uint32_t item_count;
+  uint32_t item_capacity;
+  uint32_t *free_ids;
+  uint32_t free_id_count;
+};
+
+StygianTextureAtlas *stygian_texture_atlas_create(uint32_t page_size,
+                                                  uint32_t max_pages,
+                                                  uint32_t padding) {
+  StygianTextureAtlas *a;
+  if (page_size == 0u || max_pages == 0u || padding * 2u >= page_size)
+    return NULL;
+  a = (StygianTextureAtlas *)calloc(1, sizeof(StygianTextureAtlas));
+  if (!a)
+    return NULL;
+  a->page_size = page_size;
+  a->max_pages = max_pages;
+  a->padding = padding;
+  a->page_top = (uint32_t *)calloc(max_pages, sizeof(uint32_t));
+  if (!a->page_top) {
+    free(a);
+    return NULL;
+  }
+  return a;
+}
+
+void stygian_texture_atlas_destroy(StygianTextureAtlas *a) {
+  if (!a)
+    return;
+  free(a->page_top);
+  free(a->shelves);
+  free(a->items);
+  free(a->free_ids);
+  free(a);
+}
+
+static bool tal_grow(void **array, uint32_t *capacity, size_t elem) {
+  uint32_t next = *capacity ? *capacity * 2u : 32u;
+  void *grown = realloc(*array, (size_t)next * elem);
+  if (!grown)
+    return false;
+  *array = grown;
+  *capacity = next;
+  return true;
+}
+
+// Best-fit shelf, else a new shelf on the first page with headroom, else a
+// new page. Shelves taller than the item by more than half its height are
+// skipped unless empty, so short items do not strand tall rows.
+static bool tal_place(StygianTextureAtlas *a, TextureAtlasItem *item) {
+  int best = -1;
+  uint32_t i, p;
+  TextureAtlasShelf *s;
+
+  for (i = 0; i < a->shelf_count; i++) {
+    s = &a->shelves[i];
+    if (s->height < item->h || a->page_size - s->cursor < item->w)
+      continue;
+    if (s->live > 0u && s->height - item->h > item->h / 2u)
+      continue;
+    if (best < 0 || s->height < a->shelves[best].height)
+      best = (int)i;
+  }
+  if (best < 0) {
+    for (p = 0; p < a->page_count; p++) {
+      if (a->page_size - a->page_top[p] >= item->h)
+        break;
+    }
+    if (p == a->page_count) {
+      if (a->page_count == a->max_pages)
+        return false;
+      a->page_top[a->page_count++] = 0u;
+    }
+    if (a->shelf_count == a->shelf_capacity &&
+        !tal_grow((void **)&a->shelves, &a->shelf_capacity,
+                  sizeof(TextureAtlasShelf)))
+      return false;
+    best = (int)a->shelf_count++;
+    s = &a->shelves[best];
+    s->page = p;
+    s->y = a->page_top[p];
+    s->height = item->h;
+    s->cursor = 0u;
+    s->live = 0u;
+    a->page_top[p] += item->h;
+  }
+
+  s = &a->shelves[best];
+  item->shelf = (uint32_t)best;
+  item->x = s->cursor;
+  item->y = s->y;
+  s->cursor += item->w;
+  s->live++;
+  return true;
+}
+
+uint32_t stygian_texture_atlas_alloc(StygianTextureAtlas *a, uint32_t w,
+                                     uint32_t h) {
+  TextureAtlasItem item;
+  uint32_t index;
+  if (!a || w == 0u || h == 0u || w > a->page_size - a->padding * 2u ||
+      h > a->page_size - a->padding * 2u)
+    return 0u;
+  memset(&item, 0, sizeof(item));
+  item.w = w + a->padding * 2u;
+  item.h = h + a->padding * 2u;
+  item.live = true;
+  if (a->free_id_count == 0u && a->item_count == a->item_capacity) {
+    // free_ids never holds more entries than there are items.
+    uint32_t *ids;
+    uint32_t capacity = a->item_capacity;
+    if (!tal_grow((void **)&a->items, &capacity, sizeof(TextureAtlasItem)))
+      return 0u;
+    ids = (uint32_t *)realloc(a->free_ids, (size_t)capacity * sizeof(uint32_t));
+    if (!ids)
+      return 0u;
+    a->free_ids = ids;
+    a->item_capacity = capacity;
+  }
+  if (!tal_place(a, &item))
+    return 0u;
+  index = a->free_id_count > 0u ? a->free_ids[--a->free_id_count]
+                                : a->item_count++;
+  a->items[index] = item;
+  return index + 1u;
+}
+
+void stygian_texture_atlas_free(StygianTextureAtlas *a, uint32_t id) {
+  TextureAtlasItem *item;
+  TextureAtlasShelf *s;
+  if (!a || id == 0u || id > a->item_count || !a->items[id - 1u].live)
+    return;
+  item = &a->items[id - 1u];
+  s = &a->shelves[item->shelf];
+  item->live = false;
+  s->live--;
+  if (s->live == 0u)
+    s->cursor = 0u;
+  else if (item->x + item->w == s->cursor)
+    s->cursor = item->x; // Tail of the shelf; inner holes wait for repack
+  a->free_ids[a->free_id_count++] = id - 1u;
+}
+
+bool stygian_texture_atlas_rect(const StygianTextureAtlas *a, uint32_t id,
+                                StygianTextureAtlasRect *out) {
+  const TextureAtlasItem *item;
+  if (!a || id == 0u || id > a->item_count || !a->items[id - 1u].live)
+    return false;
+  item = &a->items[id - 1u];
+  if (out) {
+    out->page = a->shelves[item->shelf].page;
+    out->x = item->x + a->padding;
+    out->y = item->y + a->padding;
+    out->w = item->w - a->padding * 2u;
+    out->h = item->h - a->padding * 2u;
+  }
+  return true;
+}
+
+uint32_t stygian_texture_atlas_page_count(const StygianTextureAtlas *a) {
+  return a ? a->page_count : 0u;
+}
+
+static int tal_compare_height(const void *lhs, const void *rhs) {
+  const TextureAtlasItem *l = *(const TextureAtlasItem *const *)lhs;
+  const TextureAtlasItem *r = *(const TextureAtlasItem *const *)rhs;
+  if (l->h != r->h)
+    return l->h > r->h ? -1 : 1;
+  if (l->w != r->w)
+    return l->w > r->w ? -1 : 1;
+  return 0;
+}
+
+bool stygian_texture_atlas_repack(StygianTextureAtlas *a) {
+  TextureAtlasItem **order = NULL;
+  TextureAtlasItem *saved_items = NULL;
+  TextureAtlasShelf *saved_shelves = NULL;
+  uint32_t *saved_tops = NULL;
+  uint32_t saved_shelf_count, saved_page_count;
+  uint32_t live = 0u, i;
+  bool ok = true;
+
+  if (!a)
+    return false;
+  if (a->item_count > 0u) {
+    order = (TextureAtlasItem **)malloc((size_t)a->item_count *
+                                        sizeof(TextureAtlasItem *));
+    saved_items = (TextureAtlasItem *)malloc((size_t)a->item_count *
+                                             sizeof(TextureAtlasItem));
+  }
+  if (a->shelf_count > 0u)
+    saved_shelves = (TextureAtlasShelf *)malloc((size_t)a->shelf_count *
+                                                sizeof(TextureAtlasShelf));
+  saved_tops = (uint32_t *)malloc((size_t)a->max_pages * sizeof(uint32_t));
+  if ((a->item_count > 0u && (!order || !saved_items)) ||
+      (a->shelf_count > 0u && !saved_shelves) || !saved_tops) {
+    free(order);
+    free(saved_items);
+    free(saved_shelves);
+    free(saved_tops);
+    return false;
+  }
+
+  if (a->item_count > 0u)
+    memcpy(saved_items, a->items, (size_t)a->item_count * sizeof(*a->items));
+  if (a->shelf_count > 0u)
+    memcpy(saved_shelves, a->shelves,
+           (size_t)a->shelf_count * sizeof(*a->shelves));
+  memcpy(saved_tops, a->page_top, (size_t)a->max_pages * sizeof(uint32_t));
+  saved_shelf_count = a->shelf_count;
+  saved_page_count = a->page_count;
+
+  for (i = 0; i < a->item_count; i++) {
+    if (a->items[i].live)
+      order[live++] = &a->items[i];
+  }
+  if (live > 1u)
+    qsort(order, live, sizeof(*order), tal_compare_height);
+
+  a->shelf_count = 0u;
+  a->page_count = 0u;
+  memset(a->page_top, 0, (size_t)a->max_pages * sizeof(uint32_t));
+  for (i = 0; i < live && ok; i++)
+    ok = tal_place(a, order[i]);
+  // Pages already opened stay open: the caller owns their textures.
+  if (a->page_count < saved_page_count)
+    a->page_count = saved_page_count;
+
+  if (!ok) {
+    // Shelves may have been reallocated while placing; restore by value.
+    if (a->item_count > 0u)
+      memcpy(a->items, saved_items, (size_t)a->item_count * sizeof(*a->items));
+    if (saved_shelf_count > 0u)
+      memcpy(a->shelves, saved_shelves,
+             (size_t)saved_shelf_count * sizeof(*a->shelves));
+    memcpy(a->page_top, saved_tops, (size_t)a->max_pages * sizeof(uint32_t));
+    a->shelf_count = saved_shelf_count;
+    a->page_count = saved_page_count;
+  }
+  free(order);
+  free(saved_items);
+  free(saved_shelves);
+  free(saved_tops);
+  return ok;
+}
@@ -0,0 +1,47 @@
+#ifndef STYGIAN_TEXTURE_ATLAS_H
+#define STYGIAN_TEXTURE_ATLAS_H
+
+#include <stdbool.h>
+#include <stdint.h>
+
+// Rectangle packer for small textures that share atlas pages.
+//
+// Pages are square and packed in horizontal shelves; every item gets a
+// gutter of `padding` texels on each side so bilinear sampling at its edges
+// never reads a neighbour. Freeing an item returns its space to the shelf
+// when it is the last one on it (or the shelf empties); the holes left
+// elsewhere are reclaimed by repack, which re-shelves every live item by
+// height. The packer only hands out rectangles: pixels and GPU pages belong
+// to the caller, which must re-upload everything after a repack.
+//
+// Not thread-safe: callers serialize access.
+
+typedef struct StygianTextureAtlas StygianTextureAtlas;
+
+typedef struct StygianTextureAtlasRect {
+  uint32_t page;
+  uint32_t x, y; // Content origin in page texels (inside the gutter)
+  uint32_t w, h;
+} StygianTextureAtlasRect;
+
+StygianTextureAtlas *stygian_texture_atlas_create(uint32_t page_size,
+                                                  uint32_t max_pages,
+                                                  uint32_t padding);
+void stygian_texture_atlas_destroy(StygianTextureAtlas *atlas);
+
+// Reserve a w x h item. Returns its id (never 0), or 0 when no page has
+// room; a repack may then make room.
+uint32_t stygian_texture_atlas_alloc(StygianTextureAtlas *atlas, uint32_t w,
+                                     uint32_t h);
+void stygian_texture_atlas_free(StygianTextureAtlas *atlas, uint32_t id);
+bool stygian_texture_atlas_rect(const StygianTextureAtlas *atlas, uint32_t id,
+                                StygianTextureAtlasRect *out);
+
+// Pages ever opened; page indices in rects are always below this.
+uint32_t stygian_texture_atlas_page_count(const StygianTextureAtlas *atlas);
+
+// Re-shelve all live items tallest first. Ids stay valid but rects move.
+// False (layout untouched) if the items would no longer fit.
+bool stygian_texture_atlas_repack(StygianTextureAtlas *atlas);
+
+#endif // STYGIAN_TEXTURE_ATLAS_H
@@ -1,16 +1,24 @@
+#if !defined(_WIN32) && !defined(_POSIX_C_SOURCE)
+#define _POSIX_C_SOURCE 200809L // open/mmap under -std=c2x
+#endif
+
 #include "stygian_triad.h"
 #include "../include/stygian_memory.h"
 #include "stygian_internal.h" // stygian_cpystr
+#include "stygian_platform.h"
 #include <ctype.h>
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
+#include <zstd.h>
 
 #define STYGIAN_TRIAD_MAGIC "TRIAD01"
 #define STYGIAN_TRIAD_CODEC_RAW 0u
 #define STYGIAN_TRIAD_CODEC_LZSS 1u
 #define STYGIAN_TRIAD_CODEC_TRIAD_V34_RAW 2u
 #define STYGIAN_TRIAD_CODEC_TRIAD_V34_LZSS 3u
+#define STYGIAN_TRIAD_CODEC_ZSTD 4u
+#define STYGIAN_TRIAD_CODEC_TRIAD_V34_ZSTD 5u
 
 typedef struct StygianTriadHeaderFile {
   char magic[8];
@@ -19,7 +27,14 @@ typedef struct StygianTriadHeaderFile {
   uint32_t tier;
   uint32_t entry_count;
   uint64_t data_offset;
-  uint8_t pad[32];
+  // Optional shared zstd dictionary for the *_ZSTD codecs. Older writers
+  // zero this area, so a zero size means "no dictionary".
+  uint64_t zstd_dict_offset;
+  uint32_t zstd_dict_size;
+  // Optional prebuilt glyph-id index (triad_pack_builder); zero = none.
+  uint32_t index_size;
+  uint64_t index_offset;
+  uint8_t pad[8];
 } StygianTriadHeaderFile;
 
 typedef struct StygianTriadEntryFile {
@@ -32,8 +47,33 @@ typedef struct StygianTriadEntryFile {
   uint32_t codec;
 } StygianTriadEntryFile;
 
+// Glyph-id index section: header, power-of-two slot table (linear probing,
+// keyed by the hash of the canonical id), then the sorted, NUL-separated
+// string table the slots point into. Packs carrying it also have their
+// entry table sorted by glyph hash.
+#define STYGIAN_TRIAD_INDEX_MAGIC "TRIDX01"
+
+typedef struct StygianTriadIndexHeader {
+  char magic[8];
+  uint32_t slot_count;
+  uint32_t key_count;
+  uint32_t string_bytes;
+  uint32_t reserved;
+  uint64_t content_hash; // Builder hash of entry table + payload bytes
+} StygianTriadIndexHeader;
+
+typedef struct StygianTriadIndexSlot {
+  uint64_t key_hash;
+  uint32_t name_offset; // Into the string table
+  uint32_t name_len;    // 0 = empty slot
+  uint32_t entry_index;
+  uint32_t reserved;
+} StygianTriadIndexSlot;
+
+// glyph_id points into the mapped pack (not NUL-terminated).
 typedef struct StygianTriadGlyphMapEntry {
-  char *glyph_id;
+  const char *glyph_id;
+  uint32_t glyph_len;
   uint64_t glyph_hash;
 } StygianTriadGlyphMapEntry;
 
@@ -51,11 +91,20 @@ typedef struct StygianTriadV34PayloadHeader {
 } StygianTriadV34PayloadHeader;
 
 struct StygianTriadRuntime {
-  FILE *file;
+  StygianMappedFile map; // Read-only view; no shared file position
   StygianTriadPackInfo pack;
-  StygianTriadEntryFile *entries;
-  StygianTriadGlyphMapEntry *glyph_map;
+  const StygianTriadEntryFile *entries;
+  StygianTriadGlyphMapEntry *glyph_map; // Only for packs without an index
+  bool entries_mapped;                  // entries points into map
+  // Prebuilt index (NULL when the pack has none)
+  const StygianTriadIndexSlot *index_slots;
+  uint32_t index_mask;
+  const char *index_strings;
+  uint32_t index_string_bytes;
   StygianAllocator *allocator;
+  StygianTriadDecodeIsa decode_isa; // Best supported, chosen at create
+  uint64_t identity;                // Content hash of header + entry table
+  ZSTD_DDict *zstd_dict;            // Pack dictionary; NULL if none
   char path[512];
 };
 
@@ -74,24 +123,6 @@ static void *triad_calloc(StygianTriadRuntime *rt, size_t count, size_t size,
     memset(p, 0, count * size);
   return p;
 }
-static void *triad_realloc(StygianTriadRuntime *rt, void *ptr, size_t old_size,
-                           size_t new_size, size_t alignment) {
-  // If using allocator, we need to alloc new + copy + free old
-  if (rt && rt->allocator && rt->allocator->alloc) {
-    void *np = rt->allocator->alloc(rt->allocator, new_size, alignment);
-    if (!np)
-      return NULL;
-    if (ptr && old_size > 0) {
-      memcpy(np, ptr, old_size < new_size ? old_size : new_size);
-      if (rt->allocator->free)
-        rt->allocator->free(rt->allocator, ptr);
-    }
-    return np;
-  }
-  (void)old_size;
-  (void)alignment;
-  return realloc(ptr, new_size);
-}
 static void triad_free(StygianTriadRuntime *rt, void *ptr) {
   if (!ptr)
     return;
@@ -127,6 +158,15 @@ static int stygian_triad_entry_cmp(const void *a, const void *b) {
   return 0;
 }
 
+// Byte-wise order matching strcmp on NUL-terminated copies.
+static int stygian_triad_id_cmp(const char *a, size_t a_len, const char *b,
+                                size_t b_len) {
+  int cmp = memcmp(a, b, a_len < b_len ? a_len : b_len);
+  if (cmp != 0)
+    return cmp;
+  return (a_len > b_len) - (a_len < b_len);
+}
+
 static int stygian_triad_glyph_map_cmp(const void *a, const void *b) {
   const StygianTriadGlyphMapEntry *ga = (const StygianTriadGlyphMapEntry *)a;
   const StygianTriadGlyphMapEntry *gb = (const StygianTriadGlyphMapEntry *)b;
@@ -136,30 +176,41 @@ static int stygian_triad_glyph_map_cmp(const void *a, const void *b) {
     return -1;
   if (!gb->glyph_id)
     return 1;
-  return strcmp(ga->glyph_id, gb->glyph_id);
+  return stygian_triad_id_cmp(ga->glyph_id, ga->glyph_len, gb->glyph_id,
+                              gb->glyph_len);
+}
+
+// Bounds-checked slice of the mapped pack (NULL if out of range).
+static const uint8_t *stygian_triad_slice(const StygianTriadRuntime *rt,
+                                          uint64_t offset, uint64_t size) {
+  if (!rt->map.data || offset > rt->map.size ||
+      size > rt->map.size - offset)
+    return NULL;
+  return rt->map.data + offset;
 }
 
 static void stygian_triad_runtime_reset(StygianTriadRuntime *rt) {
-  uint32_t i;
   if (!rt)
     return;
-  if (rt->file) {
-    fclose(rt->file);
-    rt->file = NULL;
-  }
-  triad_free(rt, rt->entries);
+  ZSTD_freeDDict(rt->zstd_dict);
+  rt->zstd_dict = NULL;
+  stygian_unmap_file(&rt->map);
+  if (!rt->entries_mapped)
+    triad_free(rt, (void *)rt->entries);
   rt->entries = NULL;
-  if (rt->glyph_map) {
-    for (i = 0; i < rt->pack.entry_count; i++) {
-      triad_free(rt, rt->glyph_map[i].glyph_id);
-    }
-    triad_free(rt, rt->glyph_map);
-    rt->glyph_map = NULL;
-  }
+  rt->entries_mapped = false;
+  rt->index_slots = NULL;
+  rt->index_mask = 0u;
+  rt->index_strings = NULL;
+  rt->index_string_bytes = 0u;
+  triad_free(rt, rt->glyph_map);
+  rt->glyph_map = NULL;
   memset(&rt->pack, 0, sizeof(rt->pack));
   rt->path[0] = '\0';
 }
 
+// Literal runs and non-overlapping matches copy in blocks; overlapping
+// matches (off < len) must stay byte-serial to replicate the run.
 static int stygian_lzss_decompress(const uint8_t *in, uint32_t in_n,
                                    uint8_t *out, uint32_t out_n) {
   uint32_t ip = 0;
@@ -169,6 +220,12 @@ static int stygian_lzss_decompress(const uint8_t *in, uint32_t in_n,
   while (ip < in_n && op < out_n) {
     uint8_t flags = in[ip++];
     int bit;
+    if (flags == 0xFFu && in_n - ip >= 8u && out_n - op >= 8u) {
+      memcpy(out + op, in + ip, 8u);
+      ip += 8u;
+      op += 8u;
+      continue;
+    }
     for (bit = 0; bit < 8 && ip < in_n && op < out_n; bit++) {
       if (flags & (1u << bit)) {
         out[op++] = in[ip++];
@@ -186,8 +243,14 @@ static int stygian_lzss_decompress(const uint8_t *in, uint32_t in_n,
         if (off == 0 || off > op)
           return 0;
         back = op - off;
-        while (len-- && op < out_n) {
-          out[op++] = out[back++];
+        if (len > out_n - op)
+          len = out_n - op;
+        if (off >= len) {
+          memcpy(out + op, out + back, len);
+          op += len;
+        } else {
+          while (len--)
+            out[op++] = out[back++];
         }
       }
     }
@@ -195,6 +258,24 @@ static int stygian_lzss_decompress(const uint8_t *in, uint32_t in_n,
   return op == out_n;
 }
 
+// zstd frame into exactly out_n bytes, with the pack dictionary when present.
+// A context per call keeps concurrent decodes independent.
+static int stygian_zstd_decompress(const StygianTriadRuntime *rt,
+                                   const uint8_t *in, uint32_t in_n,
+                                   uint8_t *out, uint32_t out_n) {
+  ZSTD_DCtx *dctx = ZSTD_createDCtx();
+  size_t got;
+  if (!dctx)
+    return 0;
+  if (rt->zstd_dict)
+    got = ZSTD_decompress_usingDDict(dctx, out, out_n, in, in_n,
+                                     rt->zstd_dict);
+  else
+    got = ZSTD_decompressDCtx(dctx, out, out_n, in, in_n);
+  ZSTD_freeDCtx(dctx);
+  return !ZSTD_isError(got) && got == out_n;
+}
+
 static uint64_t stygian_fnv1a64_append(uint64_t h, const char *s) {
   size_t i;
   if (!s)
@@ -206,22 +287,276 @@ static uint64_t stygian_fnv1a64_append(uint64_t h, const char *s) {
   return h;
 }
 
-static float stygian_clamp01(float v) {
+static uint64_t stygian_fnv1a64_bytes(uint64_t h, const uint8_t *data,
+                                      size_t n) {
+  size_t i;
+  for (i = 0; i < n; i++) {
+    h ^= (uint64_t)data[i];
+    h *= 1099511628211ull;
+  }
+  return h;
+}
+
+// ============================================================================
+// Decode Kernels (scalar / SSE2 / AVX2)
+// ============================================================================
+//
+// Every path performs the same single-precision operations in the same
+// order (no FMA contraction, truncating conversion), so RGBA output is
+// bit-identical regardless of the ISA selected at runtime.
+
+// Blend two horizontally interpolated source rows into one 8-bit LL row:
+// v = h0 + (h1 - h0) * wy, clamped to [0, 255], rounded half-up.
+static void triad_ll_blend_row_scalar(const float *h0, const float *h1,
+                                      float wy, uint8_t *dst, int n) {
+  int x;
+  for (x = 0; x < n; x++) {
+    float v = h0[x] + (h1[x] - h0[x]) * wy;
+    if (v < 0.0f)
+      v = 0.0f;
+    if (v > 255.0f)
+      v = 255.0f;
+    dst[x] = (uint8_t)(v + 0.5f);
+  }
+}
+
+// One composed texel, as triad_compose_row writes it.
+static uint32_t triad_compose_gray(float v) {
   if (v < 0.0f)
-    return 0.0f;
+    v = 0.0f;
   if (v > 1.0f)
-    return 1.0f;
-  return v;
+    v = 1.0f;
+  return (uint32_t)(uint8_t)(v * 255.0f + 0.5f);
+}
+
+// Combine LL and signed detail terms into grey RGBA pixels:
+// g = clamp01(ll + t) * 255, rounded half-up, alpha 255.
+static void triad_compose_row_scalar(const float *ll, const float *t,
+                                     uint8_t *rgba, int n) {
+  int x;
+  for (x = 0; x < n; x++) {
+    float v = ll[x] + t[x];
+    uint8_t g;
+    if (v < 0.0f)
+      v = 0.0f;
+    if (v > 1.0f)
+      v = 1.0f;
+    g = (uint8_t)(v * 255.0f + 0.5f);
+    rgba[x * 4 + 0] = g;
+    rgba[x * 4 + 1] = g;
+    rgba[x * 4 + 2] = g;
+    rgba[x * 4 + 3] = 255u;
+  }
+}
+
+#if STYGIAN_X86_SIMD
+static void triad_ll_blend_row_sse2(const float *h0, const float *h1, float wy,
+                                    uint8_t *dst, int n) {
+  const __m128 vwy = _mm_set1_ps(wy);
+  const __m128 lo = _mm_setzero_ps();
+  const __m128 hi = _mm_set1_ps(255.0f);
+  const __m128 half = _mm_set1_ps(0.5f);
+  __m128i q[4];
+  int x, k;
+  for (x = 0; x + 16 <= n; x += 16) {
+    for (k = 0; k < 4; k++) {
+      __m128 a = _mm_loadu_ps(h0 + x + k * 4);
+      __m128 b = _mm_loadu_ps(h1 + x + k * 4);
+      __m128 v = _mm_add_ps(a, _mm_mul_ps(_mm_sub_ps(b, a), vwy));
+      v = _mm_min_ps(_mm_max_ps(v, lo), hi);
+      q[k] = _mm_cvttps_epi32(_mm_add_ps(v, half));
+    }
+    _mm_storeu_si128((__m128i *)(dst + x),
+                     _mm_packus_epi16(_mm_packs_epi32(q[0], q[1]),
+                                      _mm_packs_epi32(q[2], q[3])));
+  }
+  triad_ll_blend_row_scalar(h0 + x, h1 + x, wy, dst + x, n - x);
+}
+
+static void triad_compose_row_sse2(const float *ll, const float *t,
+                                   uint8_t *rgba, int n) {
+  const __m128 lo = _mm_setzero_ps();
+  const __m128 hi = _mm_set1_ps(1.0f);
+  const __m128 scale = _mm_set1_ps(255.0f);
+  const __m128 half = _mm_set1_ps(0.5f);
+  const __m128i alpha = _mm_set1_epi32((int)0xFF000000u);
+  int x;
+  for (x = 0; x + 4 <= n; x += 4) {
+    __m128 v = _mm_add_ps(_mm_loadu_ps(ll + x), _mm_loadu_ps(t + x));
+    __m128i g;
+    v = _mm_min_ps(_mm_max_ps(v, lo), hi);
+    g = _mm_cvttps_epi32(_mm_add_ps(_mm_mul_ps(v, scale), half));
+    g = _mm_or_si128(_mm_or_si128(g, _mm_slli_epi32(g, 8)),
+                     _mm_or_si128(_mm_slli_epi32(g, 16), alpha));
+    _mm_storeu_si128((__m128i *)(rgba + x * 4), g);
+  }
+  triad_compose_row_scalar(ll + x, t + x, rgba + x * 4, n - x);
+}
+
+STYGIAN_TARGET_AVX2
+static void triad_ll_blend_row_avx2(const float *h0, const float *h1, float wy,
+                                    uint8_t *dst, int n) {
+  const __m256 vwy = _mm256_set1_ps(wy);
+  const __m256 lo = _mm256_setzero_ps();
+  const __m256 hi = _mm256_set1_ps(255.0f);
+  const __m256 half = _mm256_set1_ps(0.5f);
+  // packs/packus interleave 128-bit lanes; this restores pixel order.
+  const __m256i order = _mm256_setr_epi32(0, 4, 1, 5, 2, 6, 3, 7);
+  __m256i q[4];
+  int x, k;
+  for (x = 0; x + 32 <= n; x += 32) {
+    for (k = 0; k < 4; k++) {
+      __m256 a = _mm256_loadu_ps(h0 + x + k * 8);
+      __m256 b = _mm256_loadu_ps(h1 + x + k * 8);
+      __m256 v = _mm256_add_ps(a, _mm256_mul_ps(_mm256_sub_ps(b, a), vwy));
+      v = _mm256_min_ps(_mm256_max_ps(v, lo), hi);
+      q[k] = _mm256_cvttps_epi32(_mm256_add_ps(v, half));
+    }
+    _mm256_storeu_si256(
+        (__m256i *)(dst + x),
+        _mm256_permutevar8x32_epi32(
+            _mm256_packus_epi16(_mm256_packs_epi32(q[0], q[1]),
+                                _mm256_packs_epi32(q[2], q[3])),
+            order));
+  }
+  triad_ll_blend_row_scalar(h0 + x, h1 + x, wy, dst + x, n - x);
+}
+
+STYGIAN_TARGET_AVX2
+static void triad_compose_row_avx2(const float *ll, const float *t,
+                                   uint8_t *rgba, int n) {
+  const __m256 lo = _mm256_setzero_ps();
+  const __m256 hi = _mm256_set1_ps(1.0f);
+  const __m256 scale = _mm256_set1_ps(255.0f);
+  const __m256 half = _mm256_set1_ps(0.5f);
+  const __m256i alpha = _mm256_set1_epi32((int)0xFF000000u);
+  int x;
+  for (x = 0; x + 8 <= n; x += 8) {
+    __m256 v = _mm256_add_ps(_mm256_loadu_ps(ll + x), _mm256_loadu_ps(t + x));
+    __m256i g;
+    v = _mm256_min_ps(_mm256_max_ps(v, lo), hi);
+    g = _mm256_cvttps_epi32(_mm256_add_ps(_mm256_mul_ps(v, scale), half));
+    g = _mm256_or_si256(_mm256_or_si256(g, _mm256_slli_epi32(g, 8)),
+                        _mm256_or_si256(_mm256_slli_epi32(g, 16), alpha));
+    _mm256_storeu_si256((__m256i *)(rgba + x * 4), g);
+  }
+  triad_compose_row_scalar(ll + x, t + x, rgba + x * 4, n - x);
+}
+#endif
+
+static StygianTriadDecodeIsa triad_detect_isa(void) {
+#if STYGIAN_X86_SIMD
+  if (stygian_cpu_has_avx2())
+    return STYGIAN_TRIAD_ISA_AVX2;
+  return STYGIAN_TRIAD_ISA_SSE2; // x86-64 baseline
+#else
+  return STYGIAN_TRIAD_ISA_SCALAR;
+#endif
+}
+
+static void triad_ll_blend_row(StygianTriadDecodeIsa isa, const float *h0,
+                               const float *h1, float wy, uint8_t *dst,
+                               int n) {
+#if STYGIAN_X86_SIMD
+  if (isa == STYGIAN_TRIAD_ISA_AVX2) {
+    triad_ll_blend_row_avx2(h0, h1, wy, dst, n);
+    return;
+  }
+  if (isa == STYGIAN_TRIAD_ISA_SSE2) {
+    triad_ll_blend_row_sse2(h0, h1, wy, dst, n);
+    return;
+  }
+#endif
+  (void)isa;
+  triad_ll_blend_row_scalar(h0, h1, wy, dst, n);
+}
+
+static void triad_compose_row(StygianTriadDecodeIsa isa, const float *ll,
+                              const float *t, uint8_t *rgba, int n) {
+#if STYGIAN_X86_SIMD
+  if (isa == STYGIAN_TRIAD_ISA_AVX2) {
+    triad_compose_row_avx2(ll, t, rgba, n);
+    return;
+  }
+  if (isa == STYGIAN_TRIAD_ISA_SSE2) {
+    triad_compose_row_sse2(ll, t, rgba, n);
+    return;
+  }
+#endif
+  (void)isa;
+  triad_compose_row_scalar(ll, t, rgba, n);
 }
 
-static void stygian_upscale_ll_to_128(const uint8_t *src, int src_res,
+// Horizontal pass for one LL source row (taps shared by all output rows).
+typedef struct StygianTriadLLRows {
+  const uint8_t *src;
+  int src_res;
+  uint16_t x0[128];
+  uint16_t x1[128];
+  float wx[128];
+  float row[2][128];
+  int id[2];
+} StygianTriadLLRows;
+
+// Slot holding the horizontally interpolated source row `sy`, computing it
+// into the slot that does not hold `keep` when missing.
+static const float *triad_ll_row(StygianTriadLLRows *rows, int sy, int keep) {
+  const uint8_t *src;
+  int slot, x;
+  if (rows->id[0] == sy)
+    return rows->row[0];
+  if (rows->id[1] == sy)
+    return rows->row[1];
+  slot = rows->id[0] == keep ? 1 : 0;
+  src = rows->src + (size_t)sy * (size_t)rows->src_res;
+  for (x = 0; x < 128; x++) {
+    float v00 = (float)src[rows->x0[x]];
+    float v01 = (float)src[rows->x1[x]];
+    rows->row[slot][x] = v00 + (v01 - v00) * rows->wx[x];
+  }
+  rows->id[slot] = sy;
+  return rows->row[slot];
+}
+
+// Bilinear LL upscale to 128x128. Separable: each source row is
+// interpolated horizontally once, then output rows blend two cached rows.
+static void stygian_upscale_ll_to_128(StygianTriadDecodeIsa isa,
+                                      const uint8_t *src, int src_res,
                                       uint8_t *dst128) {
+  StygianTriadLLRows rows;
   int y, x;
+
+  rows.src = src;
+  rows.src_res = src_res;
+  rows.id[0] = -1;
+  rows.id[1] = -1;
+  for (x = 0; x < 128; x++) {
+    float fx = ((float)x + 0.5f) * ((float)src_res / 128.0f) - 0.5f;
+    int x0 = (int)fx;
+    int x1;
+    float wx;
+    if (x0 < 0)
+      x0 = 0;
+    x1 = x0 + 1;
+    if (x1 >= src_res)
+      x1 = src_res - 1;
+    wx = fx - (float)x0;
+    if (wx < 0.0f)
+      wx = 0.0f;
+    if (wx > 1.0f)
+      wx = 1.0f;
+    rows.x0[x] = (uint16_t)x0;
+    rows.x1[x] = (uint16_t)x1;
+    rows.wx[x] = wx;
+  }
+
   for (y = 0; y < 128; y++) {
     float fy = ((float)y + 0.5f) * ((float)src_res / 128.0f) - 0.5f;
     int y0 = (int)fy;
     int y1;
     float wy;
+    const float *h0;
+    const float *h1;
     if (y0 < 0)
       y0 = 0;
     y1 = y0 + 1;
@@ -232,58 +567,9 @@ static void stygian_upscale_ll_to_128(const uint8_t *src, int src_res,
       wy = 0.0f;
     if (wy > 1.0f)
       wy = 1.0f;
-    for (x = 0; x < 128; x++) {
-      float fx = ((float)x + 0.5f) * ((float)src_res / 128.0f) - 0.5f;
-      int x0 = (int)fx;
-      int x1;
-      float wx;
-      float v00, v01, v10, v11, v0, v1, v;
-      if (x0 < 0)
-        x0 = 0;
-      x1 = x0 + 1;
-      if (x1 >= src_res)
-        x1 = src_res - 1;
-      wx = fx - (float)x0;
-      if (wx < 0.0f)
-        wx = 0.0f;
-      if (wx > 1.0f)
-        wx = 1.0f;
-      v00 = (float)src[(size_t)y0 * (size_t)src_res + (size_t)x0];
-      v01 = (float)src[(size_t)y0 * (size_t)src_res + (size_t)x1];
-      v10 = (float)src[(size_t)y1 * (size_t)src_res + (size_t)x0];
-      v11 = (float)src[(size_t)y1 * (size_t)src_res + (size_t)x1];
-      v0 = v00 + (v01 - v00) * wx;
-      v1 = v10 + (v11 - v10) * wx;
-      v = v0 + (v1 - v0) * wy;
-      if (v < 0.0f)
-        v = 0.0f;
-      if (v > 255.0f)
-        v = 255.0f;
-      dst128[(size_t)y * 128u + (size_t)x] = (uint8_t)(v + 0.5f);
-    }
-  }
-}
-
-static void stygian_upscale_sparse_to_256(const uint8_t *src, int src_res,
-                                          uint8_t *dst256) {
-  int y, x;
-  for (y = 0; y < 256; y++) {
-    float fy = ((float)y + 0.5f) * ((float)src_res / 256.0f) - 0.5f;
-    int sy = (int)(fy + 0.5f);
-    if (sy < 0)
-      sy = 0;
-    if (sy >= src_res)
-      sy = src_res - 1;
-    for (x = 0; x < 256; x++) {
-      float fx = ((float)x + 0.5f) * ((float)src_res / 256.0f) - 0.5f;
-      int sx = (int)(fx + 0.5f);
-      if (sx < 0)
-        sx = 0;
-      if (sx >= src_res)
-        sx = src_res - 1;
-      dst256[(size_t)y * 256u + (size_t)x] =
-          src[(size_t)sy * (size_t)src_res + (size_t)sx];
-    }
+    h0 = triad_ll_row(&rows, y0, y1);
+    h1 = triad_ll_row(&rows, y1, y0);
+    triad_ll_blend_row(isa, h0, h1, wy, dst128 + (size_t)y * 128u, 128);
   }
 }
 
@@ -299,6 +585,7 @@ stygian_triad_runtime_create_ex(StygianAllocator *allocator) {
     return NULL;
   memset(rt, 0, sizeof(StygianTriadRuntime));
   rt->allocator = allocator;
+  rt->decode_isa = triad_detect_isa();
   return rt;
 }
 
@@ -310,109 +597,172 @@ void stygian_triad_runtime_destroy(StygianTriadRuntime *rt) {
   triad_cfg_free(allocator, rt);
 }
 
+// Validate the optional glyph-id index section. Only its header is read;
+// slot and string bounds are checked per probe.
+static bool stygian_triad_index_view(const StygianMappedFile *map,
+                                     const StygianTriadHeaderFile *h,
+                                     StygianTriadIndexHeader *out_ih) {
+  uint64_t need;
+  if (h->index_size < sizeof(*out_ih) || h->index_offset > map->size ||
+      h->index_size > map->size - h->index_offset ||
+      (h->index_offset % _Alignof(StygianTriadIndexSlot)) != 0u)
+    return false;
+  memcpy(out_ih, map->data + h->index_offset, sizeof(*out_ih));
+  if (memcmp(out_ih->magic, STYGIAN_TRIAD_INDEX_MAGIC, 7) != 0 ||
+      out_ih->slot_count == 0u ||
+      (out_ih->slot_count & (out_ih->slot_count - 1u)) != 0u)
+    return false;
+  need = sizeof(*out_ih) +
+         (uint64_t)out_ih->slot_count * sizeof(StygianTriadIndexSlot) +
+         out_ih->string_bytes;
+  return need <= h->index_size;
+}
+
+// Lookups binary-search the entry table by glyph hash.
+static bool triad_entries_sorted(const StygianTriadEntryFile *entries,
+                                 uint32_t count) {
+  uint32_t i;
+  for (i = 1; i < count; i++) {
+    if (entries[i - 1].glyph_hash > entries[i].glyph_hash)
+      return false;
+  }
+  return true;
+}
+
 bool stygian_triad_runtime_mount(StygianTriadRuntime *rt, const char *path) {
   StygianTriadHeaderFile h;
-  FILE *f = NULL;
-  StygianTriadEntryFile *entries = NULL;
+  StygianTriadIndexHeader ih;
+  StygianMappedFile map;
+  const StygianTriadEntryFile *entries = NULL;
+  StygianTriadEntryFile *owned = NULL;
   StygianTriadGlyphMapEntry *glyph_map = NULL;
-  uint8_t *id_buf = NULL;
+  size_t table_size;
+  uint64_t identity;
+  bool indexed;
   uint32_t i;
 
   if (!rt || !path || !path[0])
     return false;
 
-  f = fopen(path, "rb");
-  if (!f)
-    return false;
-
-  if (fread(&h, sizeof(h), 1, f) != 1) {
-    fclose(f);
+  // Map instead of read: mount only touches the header, entry table and
+  // glyph id bytes; payload pages fault in on first decode.
+  if (!stygian_map_file_readonly(path, &map))
     return false;
-  }
-
-  if (memcmp(h.magic, STYGIAN_TRIAD_MAGIC, 7) != 0 || h.entry_count == 0) {
-    fclose(f);
-    return false;
-  }
-
-  entries = (StygianTriadEntryFile *)triad_alloc(
-      rt, (size_t)h.entry_count * sizeof(StygianTriadEntryFile),
-      _Alignof(StygianTriadEntryFile));
-  if (!entries) {
-    fclose(f);
-    return false;
-  }
 
-  if (fread(entries, sizeof(StygianTriadEntryFile), h.entry_count, f) !=
-      h.entry_count) {
-    triad_free(rt, entries);
-    fclose(f);
+  if (map.size < sizeof(h)) {
+    stygian_unmap_file(&map);
     return false;
   }
-
-  qsort(entries, (size_t)h.entry_count, sizeof(StygianTriadEntryFile),
-        stygian_triad_entry_cmp);
-
-  // Build in-memory glyph id map once to avoid per-lookup file scans.
-  glyph_map = (StygianTriadGlyphMapEntry *)triad_calloc(
-      rt, (size_t)h.entry_count, sizeof(StygianTriadGlyphMapEntry),
-      _Alignof(StygianTriadGlyphMapEntry));
-  if (!glyph_map) {
-    triad_free(rt, entries);
-    fclose(f);
+  memcpy(&h, map.data, sizeof(h));
+  if (memcmp(h.magic, STYGIAN_TRIAD_MAGIC, 7) != 0 || h.entry_count == 0 ||
+      (size_t)h.entry_count >
+          (map.size - sizeof(h)) / sizeof(StygianTriadEntryFile)) {
+    stygian_unmap_file(&map);
     return false;
   }
+  table_size = (size_t)h.entry_count * sizeof(StygianTriadEntryFile);
+  indexed = stygian_triad_index_view(&map, &h, &ih);
+
+  if (indexed) {
+    // Builder packs: the sorted entry table is used in place and identity
+    // comes from the builder's content hash, so mount reads two headers.
+    // The mapping is read-only, so a table that is not sorted is rejected
+    // rather than sorted.
+    entries = (const StygianTriadEntryFile *)(map.data + sizeof(h));
+    if (!triad_entries_sorted(entries, h.entry_count)) {
+      stygian_unmap_file(&map);
+      return false;
+    }
+    identity = stygian_fnv1a64_bytes(1469598103934665603ull, map.data,
+                                     sizeof(h));
+    identity = stygian_fnv1a64_bytes(identity, (const uint8_t *)&ih,
+                                     sizeof(ih));
+  } else {
+    owned = (StygianTriadEntryFile *)triad_alloc(
+        rt, table_size, _Alignof(StygianTriadEntryFile));
+    if (!owned) {
+      stygian_unmap_file(&map);
+      return false;
+    }
+    memcpy(owned, map.data + sizeof(h), table_size);
+    identity = stygian_fnv1a64_bytes(1469598103934665603ull, map.data,
+                                     sizeof(h) + table_size);
 
-  id_buf = (uint8_t *)triad_alloc(rt, 1024, 1);
-  if (!id_buf) {
-    triad_free(rt, glyph_map);
-    triad_free(rt, entries);
-    fclose(f);
-    return false;
-  }
-  size_t id_buf_cap = 1024;
+    if (!triad_entries_sorted(owned, h.entry_count)) {
+      qsort(owned, (size_t)h.entry_count, sizeof(StygianTriadEntryFile),
+            stygian_triad_entry_cmp);
+    }
+    entries = owned;
+
+    // Glyph id map references ids in place; no per-entry allocation or read.
+    glyph_map = (StygianTriadGlyphMapEntry *)triad_calloc(
+        rt, (size_t)h.entry_count, sizeof(StygianTriadGlyphMapEntry),
+        _Alignof(StygianTriadGlyphMapEntry));
+    if (!glyph_map) {
+      triad_free(rt, owned);
+      stygian_unmap_file(&map);
+      return false;
+    }
 
-  for (i = 0; i < h.entry_count; i++) {
-    size_t glen = entries[i].glyph_len;
-    if (glen == 0)
-      continue;
-    if (glen >= id_buf_cap) {
-      size_t new_cap = glen + 1u;
-      uint8_t *nb =
-          (uint8_t *)triad_realloc(rt, id_buf, id_buf_cap, new_cap, 1);
-      if (!nb)
+    for (i = 0; i < h.entry_count; i++) {
+      uint64_t off = entries[i].payload_offset;
+      uint32_t glen = entries[i].glyph_len;
+      if (glen == 0 || off > map.size || glen > map.size - off)
         continue;
-      id_buf = nb;
-      id_buf_cap = new_cap;
+      glyph_map[i].glyph_id = (const char *)map.data + off;
+      glyph_map[i].glyph_len = glen;
+      glyph_map[i].glyph_hash = entries[i].glyph_hash;
     }
-    if (fseek(f, (long)entries[i].payload_offset, SEEK_SET) != 0)
-      continue;
-    if (fread(id_buf, 1, glen, f) != glen)
-      continue;
-    id_buf[glen] = 0;
-    glyph_map[i].glyph_id = (char *)triad_alloc(rt, glen + 1u, 1);
-    if (!glyph_map[i].glyph_id)
-      continue;
-    memcpy(glyph_map[i].glyph_id, id_buf, glen + 1u);
-    glyph_map[i].glyph_hash = entries[i].glyph_hash;
+    qsort(glyph_map, (size_t)h.entry_count, sizeof(StygianTriadGlyphMapEntry),
+          stygian_triad_glyph_map_cmp);
   }
-  triad_free(rt, id_buf);
-  qsort(glyph_map, (size_t)h.entry_count, sizeof(StygianTriadGlyphMapEntry),
-        stygian_triad_glyph_map_cmp);
 
   stygian_triad_runtime_reset(rt);
-  rt->file = f;
+  rt->map = map;
   rt->entries = entries;
+  rt->entries_mapped = indexed;
   rt->glyph_map = glyph_map;
+  if (indexed) {
+    const uint8_t *base = map.data + h.index_offset + sizeof(ih);
+    rt->index_slots = (const StygianTriadIndexSlot *)base;
+    rt->index_mask = ih.slot_count - 1u;
+    rt->index_strings =
+        (const char *)base + (size_t)ih.slot_count * sizeof(*rt->index_slots);
+    rt->index_string_bytes = ih.string_bytes;
+  }
   rt->pack.version = h.version;
   rt->pack.encoding = h.encoding;
   rt->pack.tier = h.tier;
   rt->pack.entry_count = h.entry_count;
   rt->pack.data_offset = h.data_offset;
+  rt->identity = identity;
+  // A dictionary that is out of bounds or unparsable is ignored; only the
+  // zstd entries that need it fail to decode.
+  if (h.zstd_dict_size > 0u) {
+    const uint8_t *dict =
+        stygian_triad_slice(rt, h.zstd_dict_offset, h.zstd_dict_size);
+    if (dict)
+      rt->zstd_dict = ZSTD_createDDict(dict, h.zstd_dict_size);
+  }
   stygian_cpystr(rt->path, sizeof(rt->path), path);
   return true;
 }
 
+StygianTriadDecodeIsa
+stygian_triad_runtime_set_decode_isa(StygianTriadRuntime *rt,
+                                     StygianTriadDecodeIsa isa) {
+  StygianTriadDecodeIsa best = triad_detect_isa();
+  if (!rt)
+    return STYGIAN_TRIAD_ISA_SCALAR;
+  rt->decode_isa = isa > best ? best : isa;
+  return rt->decode_isa;
+}
+
+StygianTriadDecodeIsa
+stygian_triad_runtime_decode_isa(const StygianTriadRuntime *rt) {
+  return rt ? rt->decode_isa : STYGIAN_TRIAD_ISA_SCALAR;
+}
+
 void stygian_triad_runtime_unmount(StygianTriadRuntime *rt) {
   stygian_triad_runtime_reset(rt);
 }
@@ -420,7 +770,12 @@ void stygian_triad_runtime_unmount(StygianTriadRuntime *rt) {
 bool stygian_triad_runtime_is_mounted(const StygianTriadRuntime *rt) {
   if (!rt)
     return false;
-  return rt->file != NULL && rt->entries != NULL && rt->pack.entry_count > 0;
+  return rt->map.data != NULL && rt->entries != NULL &&
+         rt->pack.entry_count > 0;
+}
+
+uint64_t stygian_triad_runtime_identity(const StygianTriadRuntime *rt) {
+  return stygian_triad_runtime_is_mounted(rt) ? rt->identity : 0ull;
 }
 
 bool stygian_triad_runtime_get_pack_info(const StygianTriadRuntime *rt,
@@ -465,6 +820,98 @@ bool stygian_triad_runtime_lookup(const StygianTriadRuntime *rt,
   return true;
 }
 
+bool stygian_triad_runtime_entry_at(const StygianTriadRuntime *rt,
+                                    uint32_t index,
+                                    StygianTriadEntryInfo *out_entry) {
+  const StygianTriadEntryFile *src;
+  if (!rt || !out_entry || !stygian_triad_runtime_is_mounted(rt) ||
+      index >= rt->pack.entry_count)
+    return false;
+  src = &rt->entries[index];
+  out_entry->glyph_hash = src->glyph_hash;
+  out_entry->blob_hash = src->blob_hash;
+  out_entry->payload_offset = src->payload_offset;
+  out_entry->payload_size = src->payload_size;
+  out_entry->raw_blob_size = src->raw_blob_size;
+  out_entry->glyph_len = src->glyph_len;
+  out_entry->codec = src->codec;
+  return true;
+}
+
+uint64_t stygian_triad_canonical_glyph_id(const char *glyph_id, char *out,
+                                          size_t out_size) {
+  const char *s, *e;
+  size_t n = 0, i;
+  bool hex_seq = true;
+  if (!glyph_id || !out || out_size < 8u)
+    return 0u;
+  s = strrchr(glyph_id, '/');
+  if (!s)
+    s = strrchr(glyph_id, '\\');
+  s = s ? s + 1 : glyph_id;
+  e = s + strlen(s);
+  if (s < e && *s == ':')
+    s++;
+  if (e > s && *(e - 1) == ':')
+    e--;
+  if (e - s >= 4 && e[-4] == '.' && tolower((unsigned char)e[-3]) == 's' &&
+      tolower((unsigned char)e[-2]) == 'v' &&
+      tolower((unsigned char)e[-1]) == 'g')
+    e -= 4;
+  if (s >= e)
+    return 0u;
+
+  // "u+1f600" and bare codepoint sequences ("1f44d-1f3fb") share the
+  // "emoji_u..." spelling used by codepoint-named packs.
+  if (e - s > 2 && tolower((unsigned char)s[0]) == 'u' && s[1] == '+') {
+    s += 2;
+  } else {
+    for (i = 0; s + i < e && hex_seq; i++) {
+      unsigned char c = (unsigned char)tolower((unsigned char)s[i]);
+      hex_seq = (c >= '0' && c <= '9') || (c >= 'a' && c <= 'f') ||
+                (i > 0 && (c == '_' || c == '-'));
+    }
+  }
+  if (hex_seq) {
+    memcpy(out, "emoji_u", 7u);
+    n = 7u;
+  }
+  for (; s < e; s++) {
+    unsigned char c = (unsigned char)*s;
+    if (n + 1u >= out_size)
+      return 0u;
+    out[n++] = c == '-' ? '_' : (char)tolower(c);
+  }
+  out[n] = '\0';
+  return stygian_fnv1a64_bytes(1469598103934665603ull, (const uint8_t *)out,
+                               n);
+}
+
+// One hash, one probe sequence over the prebuilt index (load factor <= 1/2).
+static bool stygian_triad_index_find(const StygianTriadRuntime *rt,
+                                     const char *key, uint64_t hash,
+                                     uint32_t *out_index) {
+  size_t key_len = strlen(key);
+  uint32_t slot = (uint32_t)hash & rt->index_mask;
+  uint32_t probes;
+  for (probes = 0; probes <= rt->index_mask; probes++) {
+    const StygianTriadIndexSlot *e = &rt->index_slots[slot];
+    if (e->name_len == 0u)
+      return false;
+    if (e->key_hash == hash && e->name_len == key_len &&
+        e->name_offset <= rt->index_string_bytes &&
+        key_len <= rt->index_string_bytes - e->name_offset &&
+        memcmp(rt->index_strings + e->name_offset, key, key_len) == 0) {
+      if (e->entry_index >= rt->pack.entry_count)
+        return false;
+      *out_index = e->entry_index;
+      return true;
+    }
+    slot = (slot + 1u) & rt->index_mask;
+  }
+  return false;
+}
+
 bool stygian_triad_runtime_lookup_glyph_id(const StygianTriadRuntime *rt,
                                            const char *glyph_id,
                                            StygianTriadEntryInfo *out_entry) {
@@ -483,6 +930,16 @@ bool stygian_triad_runtime_lookup_glyph_id(const StygianTriadRuntime *rt,
   if (!rt || !glyph_id || !out_entry || !stygian_triad_runtime_is_mounted(rt))
     return false;
 
+  if (rt->index_slots) {
+    char key[512];
+    uint32_t index;
+    uint64_t hash = stygian_triad_canonical_glyph_id(glyph_id, key,
+                                                     sizeof(key));
+    return hash != 0u && stygian_triad_index_find(rt, key, hash, &index) &&
+           stygian_triad_runtime_entry_at(rt, index, out_entry);
+  }
+
+  // Packs without an index: try each spelling against the sorted id map.
   base = strrchr(glyph_id, '/');
   if (!base)
     base = strrchr(glyph_id, '\\');
@@ -571,21 +1028,24 @@ bool stygian_triad_runtime_lookup_glyph_id(const StygianTriadRuntime *rt,
   for (ci = 0; ci < ccount; ci++) {
     size_t lo = 0, hi = (size_t)rt->pack.entry_count;
     const char *key = candidates[ci];
+    size_t key_len = strlen(key);
     while (lo < hi) {
       size_t mid = lo + ((hi - lo) / 2);
-      const char *id = rt->glyph_map[mid].glyph_id;
+      const StygianTriadGlyphMapEntry *g = &rt->glyph_map[mid];
       int cmp;
-      if (!id)
+      if (!g->glyph_id)
         cmp = -1;
       else
-        cmp = strcmp(id, key);
+        cmp = stygian_triad_id_cmp(g->glyph_id, g->glyph_len, key, key_len);
       if (cmp < 0)
         lo = mid + 1;
       else
         hi = mid;
     }
     if (lo < (size_t)rt->pack.entry_count && rt->glyph_map[lo].glyph_id &&
-        strcmp(rt->glyph_map[lo].glyph_id, key) == 0) {
+        stygian_triad_id_cmp(rt->glyph_map[lo].glyph_id,
+                             rt->glyph_map[lo].glyph_len, key,
+                             key_len) == 0) {
       return stygian_triad_runtime_lookup(rt, rt->glyph_map[lo].glyph_hash,
                                           out_entry);
     }
@@ -593,124 +1053,202 @@ bool stygian_triad_runtime_lookup_glyph_id(const StygianTriadRuntime *rt,
   return false;
 }
 
+bool stygian_triad_runtime_payload_view(const StygianTriadRuntime *rt,
+                                        uint64_t glyph_hash,
+                                        StygianTriadEntryInfo *out_entry,
+                                        const uint8_t **out_payload) {
+  StygianTriadEntryInfo e;
+  const uint8_t *payload;
+  if (!rt || !out_payload)
+    return false;
+  *out_payload = NULL;
+  if (!stygian_triad_runtime_lookup(rt, glyph_hash, &e))
+    return false;
+  payload = stygian_triad_slice(rt, e.payload_offset + e.glyph_len,
+                                e.payload_size);
+  if (!payload)
+    return false;
+  if (out_entry)
+    *out_entry = e;
+  *out_payload = payload;
+  return true;
+}
+
+// Stored payload -> raw_blob_size bytes for any codec.
+static bool stygian_triad_inflate(const StygianTriadRuntime *rt,
+                                  const StygianTriadEntryInfo *e,
+                                  const uint8_t *in, uint8_t *out) {
+  switch (e->codec) {
+  case STYGIAN_TRIAD_CODEC_RAW:
+  case STYGIAN_TRIAD_CODEC_TRIAD_V34_RAW:
+    if (e->payload_size != e->raw_blob_size)
+      return false;
+    memcpy(out, in, e->raw_blob_size);
+    return true;
+  case STYGIAN_TRIAD_CODEC_LZSS:
+  case STYGIAN_TRIAD_CODEC_TRIAD_V34_LZSS:
+    return stygian_lzss_decompress(in, e->payload_size, out,
+                                   e->raw_blob_size) != 0;
+  case STYGIAN_TRIAD_CODEC_ZSTD:
+  case STYGIAN_TRIAD_CODEC_TRIAD_V34_ZSTD:
+    return stygian_zstd_decompress(rt, in, e->payload_size, out,
+                                   e->raw_blob_size) != 0;
+  default:
+    return false;
+  }
+}
+
+bool stygian_triad_runtime_read_payload(const StygianTriadRuntime *rt,
+                                        uint64_t glyph_hash,
+                                        uint8_t **out_data,
+                                        uint32_t *out_size) {
+  StygianTriadEntryInfo e;
+  const uint8_t *packed = NULL;
+  uint8_t *data;
+  if (!rt || !out_data || !out_size)
+    return false;
+  *out_data = NULL;
+  *out_size = 0;
+  if (!stygian_triad_runtime_payload_view(rt, glyph_hash, &e, &packed) ||
+      e.raw_blob_size == 0 || e.payload_size == 0)
+    return false;
+  data = (uint8_t *)malloc(e.raw_blob_size);
+  if (!data)
+    return false;
+  if (!stygian_triad_inflate(rt, &e, packed, data)) {
+    free(data);
+    return false;
+  }
+  *out_data = data;
+  *out_size = e.raw_blob_size;
+  return true;
+}
+
 bool stygian_triad_runtime_read_svg_blob(const StygianTriadRuntime *rt,
                                          uint64_t glyph_hash,
                                          uint8_t **out_svg_data,
                                          uint32_t *out_svg_size) {
   StygianTriadEntryInfo e;
-  uint8_t *inbuf = NULL;
+  const uint8_t *inbuf = NULL;
   uint8_t *svg = NULL;
-  uint32_t compressed_n;
   uint32_t svg_n;
-  uint32_t raw_blob;
-  if (!rt || !out_svg_data || !out_svg_size || !rt->file)
+  if (!rt || !out_svg_data || !out_svg_size)
     return false;
   *out_svg_data = NULL;
   *out_svg_size = 0;
-  if (!stygian_triad_runtime_lookup(rt, glyph_hash, &e))
+  if (!stygian_triad_runtime_payload_view(rt, glyph_hash, &e, &inbuf))
     return false;
   if (e.raw_blob_size == 0 || e.payload_size == 0)
     return false;
 
-  compressed_n = e.payload_size;
-  raw_blob = e.raw_blob_size;
-  svg_n = raw_blob;
-  inbuf = (uint8_t *)malloc(compressed_n ? compressed_n : 1u);
-  if (!inbuf)
-    return false;
-  if (fseek(rt->file, (long)(e.payload_offset + e.glyph_len), SEEK_SET) != 0 ||
-      fread(inbuf, 1, compressed_n, rt->file) != compressed_n) {
-    free(inbuf);
-    return false;
-  }
-
+  svg_n = e.raw_blob_size;
   svg = (uint8_t *)malloc((size_t)svg_n + 1u);
-  if (!svg) {
-    free(inbuf);
+  if (!svg)
     return false;
-  }
 
-  if (e.codec == STYGIAN_TRIAD_CODEC_RAW) {
-    if (compressed_n != svg_n) {
-      free(inbuf);
-      free(svg);
-      return false;
-    }
-    memcpy(svg, inbuf, svg_n);
-  } else if (e.codec == STYGIAN_TRIAD_CODEC_LZSS) {
-    if (!stygian_lzss_decompress(inbuf, compressed_n, svg, svg_n)) {
-      free(inbuf);
-      free(svg);
-      return false;
-    }
-  } else {
-    free(inbuf);
+  if ((e.codec != STYGIAN_TRIAD_CODEC_RAW &&
+       e.codec != STYGIAN_TRIAD_CODEC_LZSS &&
+       e.codec != STYGIAN_TRIAD_CODEC_ZSTD) ||
+      !stygian_triad_inflate(rt, &e, inbuf, svg)) {
     free(svg);
     return false;
   }
   svg[svg_n] = 0;
-  free(inbuf);
   *out_svg_data = svg;
   *out_svg_size = svg_n;
   return true;
 }
 
+// Output edge for a requested size: the smallest of 256, 128, ... 8 that is
+// still >= target (0 = full resolution).
+static uint32_t triad_decode_level(uint32_t target_px) {
+  uint32_t n = 256u;
+  if (target_px == 0u)
+    return n;
+  while (n > 8u && n / 2u >= target_px)
+    n /= 2u;
+  return n;
+}
+
+// Box-filter the 128 px LL band down to n x n (n divides 128).
+static void triad_ll_to_rgba(const uint8_t *ll_up, uint32_t n, uint8_t *rgba) {
+  uint32_t step = 128u / n;
+  uint32_t area = step * step;
+  uint32_t ox, oy, x, y;
+  for (oy = 0; oy < n; oy++) {
+    for (ox = 0; ox < n; ox++) {
+      const uint8_t *src = ll_up + (size_t)oy * step * 128u + ox * step;
+      uint32_t sum = 0u;
+      uint8_t *out = rgba + ((size_t)oy * n + ox) * 4u;
+      for (y = 0; y < step; y++) {
+        for (x = 0; x < step; x++)
+          sum += src[(size_t)y * 128u + x];
+      }
+      out[0] = out[1] = out[2] = (uint8_t)((sum + area / 2u) / area);
+      out[3] = 255u;
+    }
+  }
+}
+
 bool stygian_triad_runtime_decode_rgba(const StygianTriadRuntime *rt,
                                        uint64_t glyph_hash,
                                        uint8_t **out_rgba_data,
                                        uint32_t *out_width,
                                        uint32_t *out_height) {
+  return stygian_triad_runtime_decode_rgba_sized(
+      rt, glyph_hash, 0u, out_rgba_data, out_width, out_height);
+}
+
+bool stygian_triad_runtime_decode_rgba_sized(const StygianTriadRuntime *rt,
+                                             uint64_t glyph_hash,
+                                             uint32_t target_px,
+                                             uint8_t **out_rgba_data,
+                                             uint32_t *out_width,
+                                             uint32_t *out_height) {
   StygianTriadEntryInfo e;
-  uint8_t *packed = NULL;
+  const uint8_t *packed = NULL;
   uint8_t *raw = NULL;
-  uint8_t *payload = NULL;
+  const uint8_t *payload = NULL;
   uint32_t payload_n;
-  uint32_t payload_storage_n;
   StygianTriadV34PayloadHeader ph;
   const uint8_t *llsrc;
   const uint8_t *valsrc;
   const uint8_t *aux;
   uint8_t *rgba = NULL;
   uint8_t ll_up[128 * 128];
-  uint8_t *idx256 = NULL;
+  uint32_t out_n = triad_decode_level(target_px);
   uint8_t *idx_small = NULL;
+  uint8_t idx_tap[256];
+  float ll_norm[256];
+  float detail[2][256];
+  float ll_line[256];
+  float detail_line[256];
   uint32_t i;
   int x, y;
 
-  if (!rt || !rt->file || !out_rgba_data || !out_width || !out_height)
+  if (!rt || !out_rgba_data || !out_width || !out_height)
     return false;
   *out_rgba_data = NULL;
   *out_width = 0;
   *out_height = 0;
 
-  if (!stygian_triad_runtime_lookup(rt, glyph_hash, &e))
+  if (!stygian_triad_runtime_payload_view(rt, glyph_hash, &e, &packed))
     return false;
   if (e.payload_size == 0 || e.raw_blob_size == 0)
     return false;
   if (e.codec != STYGIAN_TRIAD_CODEC_TRIAD_V34_RAW &&
-      e.codec != STYGIAN_TRIAD_CODEC_TRIAD_V34_LZSS) {
+      e.codec != STYGIAN_TRIAD_CODEC_TRIAD_V34_LZSS &&
+      e.codec != STYGIAN_TRIAD_CODEC_TRIAD_V34_ZSTD) {
     return false;
   }
 
+  // Raw payloads decode straight from the mapping; LZSS/zstd inflate from it.
   payload_n = e.payload_size;
-  payload_storage_n = e.payload_size;
-  packed = (uint8_t *)malloc(payload_n ? payload_n : 1u);
-  if (!packed)
-    return false;
-  if (fseek(rt->file, (long)(e.payload_offset + e.glyph_len), SEEK_SET) != 0 ||
-      fread(packed, 1, payload_n, rt->file) != payload_n) {
-    free(packed);
-    return false;
-  }
-
-  if (e.codec == STYGIAN_TRIAD_CODEC_TRIAD_V34_LZSS) {
+  if (e.codec != STYGIAN_TRIAD_CODEC_TRIAD_V34_RAW) {
     raw = (uint8_t *)malloc(e.raw_blob_size ? e.raw_blob_size : 1u);
-    if (!raw) {
-      free(packed);
+    if (!raw)
       return false;
-    }
-    if (!stygian_lzss_decompress(packed, payload_n, raw, e.raw_blob_size)) {
-      free(packed);
+    if (!stygian_triad_inflate(rt, &e, packed, raw)) {
       free(raw);
       return false;
     }
@@ -718,26 +1256,23 @@ bool stygian_triad_runtime_decode_rgba(const StygianTriadRuntime *rt,
     payload_n = e.raw_blob_size;
   } else {
     payload = packed;
-    payload_n = payload_storage_n;
   }
 
   if (payload_n < sizeof(ph)) {
-    free(packed);
     free(raw);
     return false;
   }
 
   memcpy(&ph, payload, sizeof(ph));
   if (memcmp(ph.magic, "TRV34SP", 7) != 0 || ph.ll_res == 0 ||
-      ph.tier_res == 0 || ph.tier_res > 256 || ph.vals_count > 255) {
-    free(packed);
+      ph.tier_res == 0 || ph.tier_res > 256 || ph.vals_count > 255 ||
+      (size_t)ph.ll_res * (size_t)ph.ll_res > (size_t)ph.ll_size) {
     free(raw);
     return false;
   }
   if ((size_t)sizeof(ph) + (size_t)ph.ll_size + (size_t)ph.vals_count +
           (size_t)ph.aux_size >
       payload_n) {
-    free(packed);
     free(raw);
     return false;
   }
@@ -746,17 +1281,11 @@ bool stygian_triad_runtime_decode_rgba(const StygianTriadRuntime *rt,
   valsrc = llsrc + ph.ll_size;
   aux = valsrc + ph.vals_count;
 
-  stygian_upscale_ll_to_128(llsrc, (int)ph.ll_res, ll_up);
+  stygian_upscale_ll_to_128(rt->decode_isa, llsrc, (int)ph.ll_res, ll_up);
 
   idx_small = (uint8_t *)calloc((size_t)ph.tier_res * (size_t)ph.tier_res, 1u);
-  idx256 = (uint8_t *)calloc(256u * 256u, 1u);
-  rgba = (uint8_t *)malloc(256u * 256u * 4u);
-  if (!idx_small || !idx256 || !rgba) {
-    free(packed);
+  if (!idx_small) {
     free(raw);
-    free(idx_small);
-    free(idx256);
-    free(rgba);
     return false;
   }
 
@@ -777,33 +1306,92 @@ bool stygian_triad_runtime_decode_rgba(const StygianTriadRuntime *rt,
     }
   }
 
-  stygian_upscale_sparse_to_256(idx_small, (int)ph.tier_res, idx256);
+  // Per-value tables replace the per-pixel divides: ll / 255 and the signed
+  // detail term hf * sign * 0.707 for both checkerboard phases.
+  for (i = 0; i < 256u; i++) {
+    float hf = 0.0f;
+    if (i > 0u && i - 1u < ph.vals_count)
+      hf = ((float)valsrc[i - 1u] / 127.5f) - 1.0f;
+    ll_norm[i] = (float)i / 255.0f;
+    detail[0][i] = hf * 1.0f * 0.707f;
+    detail[1][i] = hf * -1.0f * 0.707f;
+  }
+  // Nearest-neighbour taps of the sparse index grid (tier_res -> 256).
+  for (x = 0; x < 256; x++) {
+    float fx = ((float)x + 0.5f) * ((float)ph.tier_res / 256.0f) - 0.5f;
+    int sx = (int)(fx + 0.5f);
+    if (sx < 0)
+      sx = 0;
+    if (sx >= (int)ph.tier_res)
+      sx = (int)ph.tier_res - 1;
+    idx_tap[x] = (uint8_t)sx;
+  }
 
-  for (y = 0; y < 256; y++) {
-    for (x = 0; x < 256; x++) {
-      size_t off = (size_t)y * 256u + (size_t)x;
-      uint8_t ll = ll_up[(size_t)(y / 2) * 128u + (size_t)(x / 2)];
-      uint8_t idx = idx256[off];
-      float hf = 0.0f;
-      float sign = ((x ^ y) & 1) ? -1.0f : 1.0f;
-      float outv;
-      if (idx > 0 && idx - 1u < ph.vals_count) {
-        uint8_t raw_v = valsrc[idx - 1u];
-        hf = ((float)raw_v / 127.5f) - 1.0f;
+  // The detail band is a +/- checkerboard at 256 px, so each 2x2 block of
+  // the full image holds two ll+d and two ll-d texels. For 128 px and below
+  // that pair is folded through the clamp directly into the LL grid (one
+  // index tap per block, no 256 px buffer), then box-filtered to the target.
+  if (out_n < 256u) {
+    for (y = 0; y < 128; y++) {
+      float fy = ((float)(y * 2) + 0.5f) * ((float)ph.tier_res / 256.0f) - 0.5f;
+      int sy = (int)(fy + 0.5f);
+      uint8_t *ll_row = ll_up + (size_t)y * 128u;
+      const uint8_t *idx_row;
+      if (sy < 0)
+        sy = 0;
+      if (sy >= (int)ph.tier_res)
+        sy = (int)ph.tier_res - 1;
+      idx_row = idx_small + (size_t)sy * (size_t)ph.tier_res;
+      for (x = 0; x < 128; x++) {
+        uint8_t v = idx_row[idx_tap[x * 2]];
+        if (v != 0u) {
+          uint32_t a = triad_compose_gray(ll_norm[ll_row[x]] + detail[0][v]);
+          uint32_t b = triad_compose_gray(ll_norm[ll_row[x]] + detail[1][v]);
+          ll_row[x] = (uint8_t)((a + b + 1u) / 2u);
+        }
       }
-      outv =
-          stygian_clamp01(((float)ll / 255.0f) + hf * sign * 0.707f) * 255.0f;
-      rgba[off * 4u + 0u] = (uint8_t)(outv + 0.5f);
-      rgba[off * 4u + 1u] = (uint8_t)(outv + 0.5f);
-      rgba[off * 4u + 2u] = (uint8_t)(outv + 0.5f);
-      rgba[off * 4u + 3u] = 255u;
     }
+    free(raw);
+    free(idx_small);
+    rgba = (uint8_t *)malloc((size_t)out_n * out_n * 4u);
+    if (!rgba)
+      return false;
+    triad_ll_to_rgba(ll_up, out_n, rgba);
+    *out_rgba_data = rgba;
+    *out_width = out_n;
+    *out_height = out_n;
+    return true;
+  }
+
+  rgba = (uint8_t *)malloc(256u * 256u * 4u);
+  if (!rgba) {
+    free(raw);
+    free(idx_small);
+    return false;
+  }
+
+  for (y = 0; y < 256; y++) {
+    float fy = ((float)y + 0.5f) * ((float)ph.tier_res / 256.0f) - 0.5f;
+    int sy = (int)(fy + 0.5f);
+    const uint8_t *idx_row;
+    const uint8_t *ll_row = ll_up + (size_t)(y / 2) * 128u;
+    if (sy < 0)
+      sy = 0;
+    if (sy >= (int)ph.tier_res)
+      sy = (int)ph.tier_res - 1;
+    idx_row = idx_small + (size_t)sy * (size_t)ph.tier_res;
+    if ((y & 1) == 0) {
+      for (x = 0; x < 256; x++)
+        ll_line[x] = ll_norm[ll_row[x / 2]]; // Shared by row pairs
+    }
+    for (x = 0; x < 256; x++)
+      detail_line[x] = detail[(x ^ y) & 1][idx_row[idx_tap[x]]];
+    triad_compose_row(rt->decode_isa, ll_line, detail_line,
+                      rgba + (size_t)y * 256u * 4u, 256);
   }
 
-  free(packed);
   free(raw);
   free(idx_small);
-  free(idx256);
 
   *out_rgba_data = rgba;
   *out_width = 256u;
@@ -813,6 +1401,49 @@ bool stygian_triad_runtime_decode_rgba(const StygianTriadRuntime *rt,
 
 void stygian_triad_runtime_free_blob(void *ptr) { free(ptr); }
 
+void stygian_triad_downsample_rgba(const uint8_t *src, uint32_t w,
+                                   uint32_t h, uint8_t *dst, uint32_t n) {
+  uint32_t dx, dy;
+  if (w == n && h == n) {
+    memcpy(dst, src, (size_t)n * n * 4u); // Already decoded at size
+    return;
+  }
+  for (dy = 0; dy < n; dy++) {
+    uint32_t y0 = dy * h / n;
+    uint32_t y1 = (dy + 1u) * h / n;
+    if (y1 <= y0)
+      y1 = y0 + 1u;
+    for (dx = 0; dx < n; dx++) {
+      uint32_t x0 = dx * w / n;
+      uint32_t x1 = (dx + 1u) * w / n;
+      uint32_t sum_r = 0u, sum_g = 0u, sum_b = 0u, sum_a = 0u, count = 0u;
+      uint8_t *out = dst + ((size_t)dy * n + dx) * 4u;
+      uint32_t x, y;
+      if (x1 <= x0)
+        x1 = x0 + 1u;
+      for (y = y0; y < y1; y++) {
+        const uint8_t *row = src + (size_t)y * w * 4u;
+        for (x = x0; x < x1; x++) {
+          uint32_t a = row[x * 4u + 3u];
+          sum_r += row[x * 4u + 0u] * a;
+          sum_g += row[x * 4u + 1u] * a;
+          sum_b += row[x * 4u + 2u] * a;
+          sum_a += a;
+          count++;
+        }
+      }
+      if (sum_a == 0u) {
+        out[0] = out[1] = out[2] = out[3] = 0u;
+      } else {
+        out[0] = (uint8_t)((sum_r + sum_a / 2u) / sum_a);
+        out[1] = (uint8_t)((sum_g + sum_a / 2u) / sum_a);
+        out[2] = (uint8_t)((sum_b + sum_a / 2u) / sum_a);
+        out[3] = (uint8_t)((sum_a + count / 2u) / count);
+      }
+    }
+  }
+}
+
 uint64_t stygian_triad_runtime_hash_key(const char *glyph_id,
                                         const char *source_tag) {
   uint64_t h = 1469598103934665603ull;
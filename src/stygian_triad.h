@@ -3,10 +3,19 @@
 
 #include "../include/stygian.h"
 #include <stdbool.h>
+#include <stddef.h>
 #include <stdint.h>
 
 typedef struct StygianTriadRuntime StygianTriadRuntime;
 
+// Decode kernel ISA. Output is bit-identical across levels; the runtime picks
+// the best supported level at create (override for benchmarks/tests).
+typedef enum StygianTriadDecodeIsa {
+  STYGIAN_TRIAD_ISA_SCALAR = 0,
+  STYGIAN_TRIAD_ISA_SSE2 = 1,
+  STYGIAN_TRIAD_ISA_AVX2 = 2,
+} StygianTriadDecodeIsa;
+
 StygianTriadRuntime *stygian_triad_runtime_create(void);
 StygianTriadRuntime *
 stygian_triad_runtime_create_ex(StygianAllocator *allocator);
@@ -20,9 +29,24 @@ bool stygian_triad_runtime_get_pack_info(const StygianTriadRuntime *rt,
 bool stygian_triad_runtime_lookup(const StygianTriadRuntime *rt,
                                   uint64_t glyph_hash,
                                   StygianTriadEntryInfo *out_entry);
+// Entry by table index (0 .. entry_count-1), for whole-pack iteration
+bool stygian_triad_runtime_entry_at(const StygianTriadRuntime *rt,
+                                    uint32_t index,
+                                    StygianTriadEntryInfo *out_entry);
 bool stygian_triad_runtime_lookup_glyph_id(const StygianTriadRuntime *rt,
                                            const char *glyph_id,
                                            StygianTriadEntryInfo *out_entry);
+// Zero-copy view of an entry's stored payload inside the mapped pack.
+// Valid until unmount; safe to call from multiple threads.
+bool stygian_triad_runtime_payload_view(const StygianTriadRuntime *rt,
+                                        uint64_t glyph_hash,
+                                        StygianTriadEntryInfo *out_entry,
+                                        const uint8_t **out_payload);
+// Inflated (uncompressed) payload of any codec; free with free_blob.
+bool stygian_triad_runtime_read_payload(const StygianTriadRuntime *rt,
+                                        uint64_t glyph_hash,
+                                        uint8_t **out_data,
+                                        uint32_t *out_size);
 bool stygian_triad_runtime_read_svg_blob(const StygianTriadRuntime *rt,
                                          uint64_t glyph_hash,
                                          uint8_t **out_svg_data,
@@ -32,8 +56,37 @@ bool stygian_triad_runtime_decode_rgba(const StygianTriadRuntime *rt,
                                        uint8_t **out_rgba_data,
                                        uint32_t *out_width,
                                        uint32_t *out_height);
+// Decode for display at about target_px: output is the smallest of 256, 128,
+// 64 ... 8 px that is >= target_px (0 = full 256). Sizes of 128 and below
+// stop reconstruction at the low-pass band, skipping the detail pass.
+bool stygian_triad_runtime_decode_rgba_sized(const StygianTriadRuntime *rt,
+                                             uint64_t glyph_hash,
+                                             uint32_t target_px,
+                                             uint8_t **out_rgba_data,
+                                             uint32_t *out_width,
+                                             uint32_t *out_height);
 void stygian_triad_runtime_free_blob(void *ptr);
+// Request a decode ISA; clamped to what the CPU supports. Returns the level
+// actually in use.
+StygianTriadDecodeIsa
+stygian_triad_runtime_set_decode_isa(StygianTriadRuntime *rt,
+                                     StygianTriadDecodeIsa isa);
+StygianTriadDecodeIsa
+stygian_triad_runtime_decode_isa(const StygianTriadRuntime *rt);
 uint64_t stygian_triad_runtime_hash_key(const char *glyph_id,
                                         const char *source_tag);
+// Canonical spelling of a glyph id, as keyed by prebuilt pack indexes:
+// basename, surrounding ':' and ".svg" stripped, lowercase, '-' -> '_', and
+// "u+XXXX" / bare hex sequences spelled "emoji_uXXXX". Returns its 64-bit
+// key hash, or 0 when empty or out_size is too small.
+uint64_t stygian_triad_canonical_glyph_id(const char *glyph_id, char *out,
+                                          size_t out_size);
+// Content identity of the mounted pack (hash of header + entry table), for
+// validating caches derived from it. 0 when nothing is mounted.
+uint64_t stygian_triad_runtime_identity(const StygianTriadRuntime *rt);
+// Area-average a w x h RGBA image into an n x n one (n <= w, h). Colour is
+// alpha-weighted so fully transparent texels do not darken antialiased edges.
+void stygian_triad_downsample_rgba(const uint8_t *src, uint32_t w, uint32_t h,
+                                   uint8_t *dst, uint32_t n);
 
 #endif // STYGIAN_TRIAD_H
@@ -13,7 +13,7 @@ param(
 $ErrorActionPreference = "Stop"
 
 $root = Split-Path -Parent $PSScriptRoot
-$scenarios = @("idle", "overlay", "sparse", "clip", "scroll", "text")
+$scenarios = @("idle", "overlay", "sparse", "clip", "scroll", "text", "text_large")
 
 $buildProfiles = @{
   "gl" = @{
@@ -35,6 +35,7 @@ $thresholds = @{
       "clip"    = @{ min_render = 18; max_render = 50; max_build = 14; max_upload = 50000  }
       "scroll"  = @{ min_render = 14; max_render = 50; max_build = 24; max_upload = 1500000 }
       "text"    = @{ min_render = 14; max_render = 50; max_build = 24; max_upload = 120000  }
+      "text_large" = @{ min_render = 14; max_render = 50; max_build = 24; max_upload = 1500000 }
     }
     "dgpu" = @{
       "idle"    = @{ max_render = 8;  max_upload = 25000  }
@@ -43,6 +44,7 @@ $thresholds = @{
       "clip"    = @{ min_render = 18; max_render = 60; max_build = 12; max_upload = 50000  }
       "scroll"  = @{ min_render = 14; max_render = 60; max_build = 22; max_upload = 1500000 }
       "text"    = @{ min_render = 14; max_render = 60; max_build = 20; max_upload = 120000  }
+      "text_large" = @{ min_render = 14; max_render = 60; max_build = 22; max_upload = 1500000 }
     }
   }
   "aggressive" = @{
@@ -53,6 +55,7 @@ $thresholds = @{
       "clip"    = @{ min_render = 26; max_render = 33; max_build = 1.2; max_upload = 20000  }
       "scroll"  = @{ min_render = 22; max_render = 33; max_build = 12.0; max_upload = 1400000 }
       "text"    = @{ min_render = 22; max_render = 33; max_build = 2.5; max_upload = 70000  }
+      "text_large" = @{ min_render = 22; max_render = 33; max_build = 12.0; max_upload = 1400000 }
     }
     "dgpu" = @{
       "idle"    = @{ max_render = 3;  max_upload = 20000  }
@@ -61,10 +64,24 @@ $thresholds = @{
       "clip"    = @{ min_render = 26; max_render = 36; max_build = 0.8; max_upload = 20000  }
       "scroll"  = @{ min_render = 22; max_render = 36; max_build = 10.0; max_upload = 1400000 }
       "text"    = @{ min_render = 22; max_render = 36; max_build = 1.8; max_upload = 70000  }
+      "text_large" = @{ min_render = 22; max_render = 36; max_build = 10.0; max_upload = 1400000 }
     }
   }
 }
 
+# CPU-only layout bench, run once per gate. Budgets are for the default -O0
+# build from compile/targets.json; the sub-millisecond 10k-node target of an
+# optimized build is not enforced here.
+$layoutBench = @{
+  BuildScript = "compile\windows\build_layout_flex_bench.bat"
+  ExePath     = "build\layout_flex_bench.exe"
+}
+
+$layoutThresholds = @{
+  "baseline"   = @{ max_total = 4.0; max_edit = 0.25 }
+  "aggressive" = @{ max_total = 2.5; max_edit = 0.15 }
+}
+
 function Invoke-BuildIfNeeded {
   param(
     [string]$Name,
@@ -337,6 +354,59 @@ foreach ($backendName in $backends) {
     $backendName, $backendDevice, $Profile, $goodCount, $warnCount, $badCount)
 }
 
+Invoke-BuildIfNeeded -Name "layout" -ProfileDef $layoutBench -ForceRebuild $Rebuild.IsPresent
+Write-Host "[gate] run layout_flex_bench nodes=10000 profile=$Profile"
+Push-Location $root
+try {
+  $output = & (Join-Path $root $layoutBench.ExePath) --nodes 10000 2>&1
+} finally {
+  Pop-Location
+}
+$layoutRule = $layoutThresholds[$Profile]
+$layoutRows = @{}
+foreach ($line in $output) {
+  if (-not "$line".StartsWith("PERFCASE ")) {
+    continue
+  }
+  $row = @{}
+  foreach ($m in [regex]::Matches("$line", "(\w+)=([^\s]+)")) {
+    $row[$m.Groups[1].Value] = $m.Groups[2].Value
+  }
+  $layoutRows[$row["scenario"]] = $row
+}
+$fails = @()
+$warns = @()
+$full = $layoutRows["flex_layout"]
+$incremental = $layoutRows["flex_layout_incremental"]
+if ($null -eq $full -or $null -eq $incremental) {
+  $fails += "missing-PERFCASE"
+} else {
+  $totalMs = [double]$full["total_ms"]
+  $editMs = [double]$incremental["edit_ms"]
+  if ($totalMs -gt $layoutRule.max_total) {
+    $fails += "total_ms=$([math]::Round($totalMs,3)) > max_total=$($layoutRule.max_total)"
+  } elseif ($totalMs -gt ($layoutRule.max_total * 0.90)) {
+    $warns += "total_ms near limit ($([math]::Round($totalMs,3)))"
+  }
+  if ($editMs -gt $layoutRule.max_edit) {
+    $fails += "edit_ms=$([math]::Round($editMs,4)) > max_edit=$($layoutRule.max_edit)"
+  } elseif ($editMs -gt ($layoutRule.max_edit * 0.90)) {
+    $warns += "edit_ms near limit ($([math]::Round($editMs,4)))"
+  }
+}
+$verdict = "GOOD"
+if ($fails.Count -gt 0) {
+  $verdict = "BAD"
+  $hasBad = $true
+} elseif ($warns.Count -gt 0) {
+  $verdict = "WARN"
+  $hasWarn = $true
+}
+$issues = @($fails + $warns)
+if ($issues.Count -eq 0) { $issues = @("none") }
+Write-Host ("PERF_HEALTH backend=cpu profile={0} scenario=flex_layout verdict={1} issues=""{2}""" -f `
+  $Profile, $verdict, ($issues -join "; "))
+
 if ($hasBad) {
   Write-Host "[gate] FAIL: performance health has BAD scenarios."
   exit 1
@@ -1,5 +1,13 @@
 #include "../include/stygian.h"
 #include "../include/stygian_cmd.h"
+#include "../include/stygian_color.h"
+#include "../layout/stygian_layout.h"
+#include "../src/stygian_glyph_disk_cache.h"
+#include "../src/stygian_range_alloc.h"
+#include "../src/stygian_texture_atlas.h"
+#include "../src/stygian_triad.h"
+#include "../widgets/stygian_log_store.h"
+#include "../widgets/stygian_text_buffer.h"
 #include "../window/stygian_window.h"
 #include <stdint.h>
 #include <stdio.h>
@@ -191,6 +199,503 @@ static void test_frame_intent_eval_only(TestEnv *env) {
   CHECK(!stygian_is_eval_only_frame(env->ctx), "render frame flag clear");
 }
 
+static void test_damage_caret_blink(TestEnv *env) {
+  StygianDamageRect rects[STYGIAN_MAX_DAMAGE_RECTS];
+  uint32_t count;
+  for (int frame = 0; frame < 2; frame++) {
+    float caret = frame == 0 ? 1.0f : 0.1f;
+    stygian_begin_frame(env->ctx, 320, 240);
+    stygian_rect(env->ctx, 0.0f, 0.0f, 320.0f, 240.0f, 0.1f, 0.1f, 0.1f, 1);
+    stygian_rect(env->ctx, 100.0f, 50.0f, 2.0f, 16.0f, caret, caret, caret, 1);
+    stygian_end_frame(env->ctx);
+  }
+  count = stygian_get_last_frame_damage(env->ctx, rects,
+                                        STYGIAN_MAX_DAMAGE_RECTS);
+  CHECK(count == 1u && rects[0].x <= 100.0f && rects[0].w >= 2.0f,
+        "caret blink damages the caret");
+  CHECK(stygian_get_last_frame_damage_fraction(env->ctx) < 0.01f,
+        "caret blink touches under 1% of pixels");
+}
+
+static void test_nested_clip_reject(TestEnv *env) {
+  stygian_begin_frame(env->ctx, 320, 240);
+  stygian_clip_push(env->ctx, 0.0f, 0.0f, 100.0f, 100.0f);
+  stygian_clip_push(env->ctx, 50.0f, 50.0f, 100.0f, 100.0f);
+  stygian_rect(env->ctx, 60.0f, 60.0f, 10.0f, 10.0f, 1, 1, 1, 1);
+  stygian_rect(env->ctx, 120.0f, 120.0f, 10.0f, 10.0f, 1, 1, 1, 1);
+  stygian_clip_pop(env->ctx);
+  stygian_clip_pop(env->ctx);
+  stygian_rect(env->ctx, 200.0f, 200.0f, 10.0f, 10.0f, 1, 1, 1, 1);
+  stygian_end_frame(env->ctx);
+  CHECK(stygian_get_last_frame_clip_rejects(env->ctx) == 1u,
+        "nested clip rejects only the element outside its parent");
+}
+
+static void test_clip_ids_dedup(TestEnv *env) {
+  StygianClipId first, again, last = 0u;
+  int i;
+
+  stygian_begin_frame(env->ctx, 320, 240);
+  first = stygian_clip_push(env->ctx, 10.0f, 20.0f, 30.0f, 40.0f);
+  stygian_clip_pop(env->ctx);
+  again = stygian_clip_push(env->ctx, 10.0f, 20.0f, 30.0f, 40.0f);
+  stygian_clip_pop(env->ctx);
+  CHECK(first != 0u && again == first, "equal clip rects share one id");
+  for (i = 0; i < 1000; i++) {
+    last = stygian_clip_push(env->ctx, (float)i, 0.0f, 4.0f, 4.0f);
+    stygian_clip_pop(env->ctx);
+  }
+  CHECK(last > 0xFFu, "clip ids go past 8 bits");
+  stygian_end_frame(env->ctx);
+  CHECK(stygian_get_last_frame_clip_count(env->ctx) == 1002u,
+        "frame clip count counts distinct clips");
+
+  stygian_begin_frame(env->ctx, 320, 240);
+  again = stygian_clip_push(env->ctx, 10.0f, 20.0f, 30.0f, 40.0f);
+  stygian_clip_pop(env->ctx);
+  stygian_end_frame(env->ctx);
+  CHECK(again == first, "clip ids are stable across frames");
+}
+
+static void test_text_buffer_line_index(void) {
+  StygianTextBuffer *tb = stygian_text_buffer_create(8u);
+  char out[64];
+  CHECK(tb != NULL, "text buffer create");
+  if (!tb)
+    return;
+
+  stygian_text_buffer_set(tb, "ab\ncd\nef", 8u);
+  CHECK(stygian_text_buffer_line_count(tb) == 3u, "text buffer line count");
+  CHECK(stygian_text_buffer_line_start(tb, 2u) == 6u,
+        "text buffer line start lookup");
+
+  // Edit near the top: tail line starts must follow without a rescan.
+  stygian_text_buffer_insert(tb, 1u, "X\nY", 3u);
+  CHECK(stygian_text_buffer_line_count(tb) == 4u,
+        "text buffer insert adds line");
+  CHECK(stygian_text_buffer_line_start(tb, 3u) == 9u,
+        "text buffer tail start shifts on insert");
+  CHECK(stygian_text_buffer_line_of(tb, 6u) == 2u,
+        "text buffer offset to line lookup");
+
+  stygian_text_buffer_erase(tb, 0u, 5u);
+  stygian_text_buffer_copy(tb, 0u, 64u, out, sizeof(out));
+  CHECK(strcmp(out, "\ncd\nef") == 0, "text buffer erase content");
+  CHECK(stygian_text_buffer_line_count(tb) == 3u,
+        "text buffer erase drops lines");
+  CHECK(stygian_text_buffer_line_end(tb, 1u) == 3u,
+        "text buffer line end lookup");
+
+  stygian_text_buffer_destroy(tb);
+}
+
+static void test_log_store_ring(void) {
+  StygianLogStore *ls = stygian_log_store_create(1024u, 4u);
+  char out[STYGIAN_LOG_STORE_MAX_LINE + 1u];
+  CHECK(ls != NULL, "log store create");
+  if (!ls)
+    return;
+
+  stygian_log_store_append(ls, "[INFO] a\nplain\n[WA", 18u);
+  stygian_log_store_append(ls, "RN] b\n", 6u);
+  CHECK(stygian_log_store_line_count(ls) == 3u, "log store line count");
+  stygian_log_store_line_copy(ls, 2u, out, sizeof(out));
+  CHECK(strcmp(out, "[WARN] b") == 0, "log store joins split append");
+  CHECK(stygian_log_store_line_level(ls, 2u) == STYGIAN_LOG_LEVEL_WARN,
+        "log store classifies joined line");
+  CHECK(stygian_log_store_line_level(ls, 1u) == STYGIAN_LOG_LEVEL_PLAIN,
+        "log store plain level");
+
+  // Line ring holds 4: two more lines evict the two oldest.
+  stygian_log_store_append(ls, "[ERROR] c\nd\n", 12u);
+  CHECK(stygian_log_store_line_count(ls) == 4u, "log store bounded lines");
+  CHECK(stygian_log_store_evicted(ls) == 1u, "log store eviction count");
+  stygian_log_store_append(ls, "e\n", 2u);
+  stygian_log_store_line_copy(ls, 0u, out, sizeof(out));
+  CHECK(strcmp(out, "[WARN] b") == 0, "log store evicts oldest first");
+  CHECK(stygian_log_store_line_level(ls, 1u) == STYGIAN_LOG_LEVEL_ERROR,
+        "log store level survives eviction");
+
+  stygian_log_store_destroy(ls);
+}
+
+static void test_glyph_disk_cache(void) {
+  enum { CELL = 4, BYTES = CELL * CELL * 4 };
+  uint8_t a[BYTES], b[BYTES], out[BYTES];
+  StygianGlyphDiskCache *gc;
+  FILE *f;
+  memset(a, 0x11, sizeof(a));
+  memset(b, 0x22, sizeof(b));
+  remove("./stygian_emoji.cache");
+
+  gc = stygian_glyph_disk_cache_open(".", 0xABCDull, CELL, 4096u);
+  CHECK(gc != NULL, "disk cache open");
+  if (!gc)
+    return;
+  CHECK(!stygian_glyph_disk_cache_load(gc, 1u, out), "disk cache cold miss");
+  CHECK(stygian_glyph_disk_cache_store(gc, 1u, a), "disk cache store a");
+  CHECK(stygian_glyph_disk_cache_store(gc, 2u, b), "disk cache store b");
+  stygian_glyph_disk_cache_close(gc);
+
+  // Reopen with the same pack: entries survive the restart.
+  gc = stygian_glyph_disk_cache_open(".", 0xABCDull, CELL, 4096u);
+  CHECK(gc && stygian_glyph_disk_cache_load(gc, 2u, out) &&
+            memcmp(out, b, sizeof(b)) == 0,
+        "disk cache persists across open");
+  stygian_glyph_disk_cache_close(gc);
+
+  // Flip the last pixel byte (cell of key 2): checksum rejects it.
+  f = fopen("./stygian_emoji.cache", "r+b");
+  CHECK(f != NULL, "disk cache file exists");
+  if (f) {
+    fseek(f, -1, SEEK_END);
+    fputc(0x7F, f);
+    fclose(f);
+  }
+  gc = stygian_glyph_disk_cache_open(".", 0xABCDull, CELL, 4096u);
+  CHECK(gc && !stygian_glyph_disk_cache_load(gc, 2u, out),
+        "disk cache rejects corrupted cell");
+  CHECK(gc && stygian_glyph_disk_cache_load(gc, 1u, out) &&
+            memcmp(out, a, sizeof(a)) == 0,
+        "disk cache keeps intact cells");
+  stygian_glyph_disk_cache_close(gc);
+
+  // 4096 bytes hold 50 cells. Key 1 is the oldest store, but its load
+  // stamp reaches disk at close, so a full cache evicts key 2 instead.
+  remove("./stygian_emoji.cache");
+  gc = stygian_glyph_disk_cache_open(".", 0xABCDull, CELL, 4096u);
+  for (uint64_t k = 1u; gc && k <= 50u; k++)
+    stygian_glyph_disk_cache_store(gc, k, k == 2u ? b : a);
+  CHECK(gc && stygian_glyph_disk_cache_load(gc, 1u, out),
+        "disk cache hit on a full cache");
+  stygian_glyph_disk_cache_close(gc);
+  gc = stygian_glyph_disk_cache_open(".", 0xABCDull, CELL, 4096u);
+  CHECK(gc && stygian_glyph_disk_cache_store(gc, 51u, b) &&
+            stygian_glyph_disk_cache_load(gc, 1u, out) &&
+            !stygian_glyph_disk_cache_load(gc, 2u, out) &&
+            stygian_glyph_disk_cache_load(gc, 3u, out) &&
+            stygian_glyph_disk_cache_load(gc, 51u, out) &&
+            memcmp(out, b, sizeof(b)) == 0,
+        "disk cache evicts by persisted recency");
+  stygian_glyph_disk_cache_close(gc);
+
+  // A different pack identity invalidates the whole file.
+  gc = stygian_glyph_disk_cache_open(".", 0x1234ull, CELL, 4096u);
+  CHECK(gc && !stygian_glyph_disk_cache_load(gc, 1u, out),
+        "disk cache resets on pack change");
+  stygian_glyph_disk_cache_close(gc);
+  remove("./stygian_emoji.cache");
+}
+
+static void test_texture_atlas_packer(void) {
+  StygianTextureAtlas *ta = stygian_texture_atlas_create(64u, 1u, 1u);
+  StygianTextureAtlasRect ra, rb, rc;
+  uint32_t a, b, c, d;
+  CHECK(ta != NULL, "atlas packer create");
+  if (!ta)
+    return;
+
+  // 30x30 items take 32x32 padded cells: four fill the page.
+  a = stygian_texture_atlas_alloc(ta, 30u, 30u);
+  b = stygian_texture_atlas_alloc(ta, 30u, 30u);
+  c = stygian_texture_atlas_alloc(ta, 30u, 30u);
+  d = stygian_texture_atlas_alloc(ta, 30u, 30u);
+  CHECK(a && b && c && d && stygian_texture_atlas_rect(ta, a, &ra) &&
+            stygian_texture_atlas_rect(ta, b, &rb) && ra.x == 1u &&
+            ra.y == 1u && ra.w == 30u && rb.x == 33u && rb.y == 1u,
+        "atlas packer places items inside their gutter");
+  CHECK(stygian_texture_atlas_alloc(ta, 30u, 30u) == 0u,
+        "atlas packer reports a full page");
+
+  // Freeing a non-tail item leaves a hole only repack can reuse for a
+  // wide item.
+  stygian_texture_atlas_free(ta, a);
+  stygian_texture_atlas_free(ta, d);
+  CHECK(!stygian_texture_atlas_rect(ta, a, NULL),
+        "atlas packer forgets freed items");
+  CHECK(stygian_texture_atlas_alloc(ta, 62u, 30u) == 0u,
+        "atlas packer cannot span a hole before repack");
+  CHECK(stygian_texture_atlas_repack(ta) &&
+            stygian_texture_atlas_rect(ta, b, &rb) &&
+            stygian_texture_atlas_rect(ta, c, &rc) && rb.y == rc.y,
+        "atlas packer repack moves live items together");
+  a = stygian_texture_atlas_alloc(ta, 62u, 30u);
+  CHECK(a != 0u && stygian_texture_atlas_rect(ta, a, &ra) && ra.w == 62u &&
+            ra.y != rb.y,
+        "atlas packer reuses space reclaimed by repack");
+  stygian_texture_atlas_destroy(ta);
+}
+
+static void test_range_alloc_coalesces(void) {
+  StygianRangeAlloc *ra = stygian_range_alloc_create(1024u);
+  uint64_t a, b, c;
+  CHECK(ra != NULL, "range alloc create");
+  if (!ra)
+    return;
+
+  CHECK(stygian_range_alloc_alloc(ra, 100u, 0u, &a) && a == 0u &&
+            stygian_range_alloc_alloc(ra, 100u, 256u, &b) && b == 256u &&
+            stygian_range_alloc_alloc(ra, 50u, 0u, &c) && c == 100u,
+        "range alloc aligns and fills the skipped pad first");
+  CHECK(stygian_range_alloc_free_bytes(ra) == 774u &&
+            !stygian_range_alloc_alloc(ra, 800u, 0u, NULL),
+        "range alloc refuses more than is free");
+
+  stygian_range_alloc_free(ra, a, 100u);
+  stygian_range_alloc_free(ra, b, 100u);
+  CHECK(stygian_range_alloc_fragments(ra) == 2u,
+        "range alloc keeps separated holes apart");
+  stygian_range_alloc_free(ra, c, 50u);
+  CHECK(stygian_range_alloc_fragments(ra) == 1u &&
+            stygian_range_alloc_free_bytes(ra) == 1024u &&
+            stygian_range_alloc_alloc(ra, 1024u, 0u, &a) && a == 0u,
+        "range alloc merges neighbours back into one span");
+  stygian_range_alloc_destroy(ra);
+}
+
+static void test_flex_layout(void) {
+  StygianArena *arena = stygian_arena_create(64u * 1024u);
+  StygianFlex *flex = stygian_flex_begin_arena(arena);
+  StygianFlexNode row, fixed, grow, capped, wrap, chips[3];
+  float x, y, w, h;
+  int i;
+  CHECK(flex != NULL, "flex begin on an arena");
+  if (!flex) {
+    stygian_arena_destroy(arena);
+    return;
+  }
+
+  // Row of 300: 50 fixed, then two growers sharing 230 where one caps at 60.
+  row = stygian_flex_node(flex, 0u, &(StygianFlexStyle){.gap = 10.0f});
+  fixed = stygian_flex_node(
+      flex, row, &(StygianFlexStyle){.width = 50.0f, .height = 20.0f});
+  grow = stygian_flex_node(flex, row, &(StygianFlexStyle){.grow = 1.0f});
+  capped = stygian_flex_node(flex, row,
+                             &(StygianFlexStyle){.grow = 1.0f, .max_w = 60.0f});
+  stygian_flex_compute(flex, row, 0.0f, 0.0f, 300.0f, 0.0f);
+  CHECK(stygian_flex_rect(flex, fixed, &x, &y, &w, &h) && x == 0.0f &&
+            w == 50.0f,
+        "flex keeps a fixed item at its size");
+  CHECK(stygian_flex_rect(flex, grow, &x, &y, &w, &h) && x == 60.0f &&
+            w == 170.0f,
+        "flex gives a clamped item's share back to the other grower");
+  CHECK(stygian_flex_rect(flex, capped, &x, &y, &w, &h) && x == 240.0f &&
+            w == 60.0f,
+        "flex clamps a grower to max_w");
+  CHECK(stygian_flex_rect(flex, row, &x, &y, &w, &h) && h == 20.0f,
+        "flex fits the cross axis to content");
+
+  // Wrap: three 40-wide items in 100 break after the second.
+  wrap = stygian_flex_node(flex, 0u, &(StygianFlexStyle){.wrap = true});
+  for (i = 0; i < 3; i++)
+    chips[i] = stygian_flex_node(
+        flex, wrap, &(StygianFlexStyle){.width = 40.0f, .height = 10.0f});
+  stygian_flex_compute(flex, wrap, 0.0f, 0.0f, 100.0f, 0.0f);
+  CHECK(stygian_flex_rect(flex, chips[1], &x, &y, &w, &h) && x == 40.0f &&
+            y == 0.0f,
+        "flex keeps items on the line while they fit");
+  CHECK(stygian_flex_rect(flex, chips[2], &x, &y, &w, &h) && x == 0.0f &&
+            y == 10.0f,
+        "flex wraps overflowing items onto a new line");
+  CHECK(!stygian_flex_rect(flex, 0u, &x, &y, &w, &h) &&
+            stygian_flex_node(flex, 999u, NULL) == 0u,
+        "flex rejects invalid nodes");
+  stygian_arena_destroy(arena);
+}
+
+static int g_flex_measures;
+
+static void flex_count_measure(void *user, float max_w, float max_h,
+                               float *out_w, float *out_h) {
+  (void)max_w;
+  (void)max_h;
+  g_flex_measures++;
+  *out_w = *(const float *)user;
+  *out_h = 10.0f;
+}
+
+static void test_flex_incremental(void) {
+  StygianFlex *flex = stygian_flex_create(NULL);
+  StygianFlexNode root, rows[3], labels[3], tail;
+  float widths[3] = {30.0f, 40.0f, 50.0f};
+  float x, y, w, h;
+  int i, before;
+  CHECK(flex != NULL, "flex create retained tree");
+  if (!flex)
+    return;
+
+  root = stygian_flex_node(
+      flex, 0u, &(StygianFlexStyle){.dir = STYGIAN_LAYOUT_COLUMN});
+  for (i = 0; i < 3; i++) {
+    rows[i] = stygian_flex_node(flex, root, &(StygianFlexStyle){.gap = 5.0f});
+    labels[i] = stygian_flex_node(flex, rows[i], NULL);
+    stygian_flex_measure(flex, labels[i], flex_count_measure, &widths[i]);
+  }
+  tail = stygian_flex_node(flex, rows[2], &(StygianFlexStyle){.width = 8.0f});
+  stygian_flex_compute(flex, root, 0.0f, 0.0f, 200.0f, 0.0f);
+  before = g_flex_measures;
+  stygian_flex_compute(flex, root, 0.0f, 0.0f, 200.0f, 0.0f);
+  CHECK(g_flex_measures == before, "flex skips an unchanged tree");
+
+  widths[2] = 70.0f;
+  stygian_flex_invalidate(flex, labels[2]);
+  stygian_flex_compute(flex, root, 0.0f, 0.0f, 200.0f, 0.0f);
+  CHECK(g_flex_measures == before + 1, "flex re-measures only the edit");
+  CHECK(stygian_flex_rect(flex, tail, &x, &y, &w, &h) && x == 75.0f &&
+            y == 20.0f,
+        "flex moves siblings after an edited leaf");
+
+  stygian_flex_set_style(
+      flex, rows[0], &(StygianFlexStyle){.gap = 5.0f, .height = 30.0f});
+  stygian_flex_compute(flex, root, 0.0f, 0.0f, 200.0f, 0.0f);
+  CHECK(stygian_flex_rect(flex, labels[2], &x, &y, &w, &h) && y == 40.0f &&
+            g_flex_measures == before + 1,
+        "flex shifts clean subtrees without re-measuring them");
+
+  stygian_flex_detach(flex, rows[1]);
+  stygian_flex_compute(flex, root, 0.0f, 0.0f, 200.0f, 0.0f);
+  CHECK(stygian_flex_rect(flex, root, &x, &y, &w, &h) && h == 40.0f &&
+            stygian_flex_rect(flex, tail, &x, &y, &w, &h) && y == 30.0f,
+        "flex closes the gap left by a detached subtree");
+  stygian_flex_destroy(flex);
+}
+
+static void test_triad_canonical_glyph_id(void) {
+  char a[64], b[64];
+  uint64_t ha = stygian_triad_canonical_glyph_id("U+1F44D", a, sizeof(a));
+  uint64_t hb =
+      stygian_triad_canonical_glyph_id("art/emoji_u1f44d.SVG", b, sizeof(b));
+  CHECK(ha != 0u && ha == hb && strcmp(a, "emoji_u1f44d") == 0,
+        "canonical id folds u+ and path/extension spellings");
+  stygian_triad_canonical_glyph_id("1f44d-1f3fb", a, sizeof(a));
+  CHECK(strcmp(a, "emoji_u1f44d_1f3fb") == 0,
+        "canonical id spells hex sequences as emoji_u");
+  stygian_triad_canonical_glyph_id(":Party-Popper:", a, sizeof(a));
+  CHECK(strcmp(a, "party_popper") == 0, "canonical id trims shortcode");
+  CHECK(stygian_triad_canonical_glyph_id("::", a, sizeof(a)) == 0u,
+        "canonical id rejects empty");
+  CHECK(stygian_triad_canonical_glyph_id("1f44d", a, 8u) == 0u,
+        "canonical id rejects short buffer");
+}
+
+static void test_color_transform_rgba8(void) {
+  enum { N = 4096 };
+  static uint8_t ref[N * 4], lut[N * 4];
+  StygianColorProfile srgb, p3;
+  int i, worst = 0;
+  stygian_color_profile_init_builtin(&srgb, STYGIAN_COLOR_SPACE_SRGB);
+  stygian_color_profile_init_builtin(&p3, STYGIAN_COLOR_SPACE_DISPLAY_P3);
+  for (i = 0; i < N; i++) {
+    ref[i * 4 + 0] = (uint8_t)i;
+    ref[i * 4 + 1] = (uint8_t)(i * 7);
+    ref[i * 4 + 2] = (uint8_t)(i >> 4);
+    ref[i * 4 + 3] = (uint8_t)(i * 13);
+  }
+  memcpy(lut, ref, sizeof(ref));
+  stygian_color_transform_rgba8_reference(&p3, &srgb, ref, N);
+  stygian_color_transform_rgba8(&p3, &srgb, lut, N);
+  for (i = 0; i < N * 4; i++) {
+    int d = (int)ref[i] - (int)lut[i];
+    if (d < 0)
+      d = -d;
+    if (d > worst)
+      worst = d;
+  }
+  CHECK(worst <= 1, "color table transform within 1 of reference");
+  CHECK(lut[3] == 0u && lut[4 * 5 + 3] == 65u, "color transform keeps alpha");
+}
+
+static void icc_put32(uint8_t *p, uint32_t v) {
+  p[0] = (uint8_t)(v >> 24);
+  p[1] = (uint8_t)(v >> 16);
+  p[2] = (uint8_t)(v >> 8);
+  p[3] = (uint8_t)v;
+}
+
+// Minimal v4 sRGB profile: D50 colorants and a shared para type-3 TRC.
+static void test_icc_trc_profile(void) {
+  static const char *sigs[4] = {"rXYZ", "gXYZ", "bXYZ", "rTRC"};
+  static const double xyz[3][3] = {{0.4361, 0.2225, 0.0139},
+                                   {0.3851, 0.7169, 0.0971},
+                                   {0.1431, 0.0606, 0.7141}};
+  static const double para[5] = {2.4, 1.0 / 1.055, 0.055 / 1.055,
+                                 1.0 / 12.92, 0.04045};
+  uint8_t icc[320] = {0};
+  uint8_t px[256 * 4];
+  StygianColorProfile srgb, loaded;
+  FILE *f;
+  int i, k, worst = 0;
+  uint32_t off = 128u + 4u + 6u * 12u;
+  icc_put32(icc + 16, 0x52474220u); // 'RGB '
+  icc_put32(icc + 36, 0x61637370u); // 'acsp'
+  icc_put32(icc + 128, 6u);
+  for (i = 0; i < 6; i++) {
+    uint8_t *rec = icc + 132 + i * 12;
+    const char *sig = i < 4 ? sigs[i] : (i == 4 ? "gTRC" : "bTRC");
+    memcpy(rec, sig, 4);
+    icc_put32(rec + 4, i < 3 ? off + (uint32_t)i * 20u : off + 60u);
+    icc_put32(rec + 8, i < 3 ? 20u : 32u);
+  }
+  for (i = 0; i < 3; i++) {
+    memcpy(icc + off + i * 20, "XYZ ", 4);
+    for (k = 0; k < 3; k++)
+      icc_put32(icc + off + i * 20 + 8 + k * 4,
+                (uint32_t)(int32_t)(xyz[i][k] * 65536.0 + 0.5));
+  }
+  memcpy(icc + off + 60, "para", 4);
+  icc[off + 69] = 3u;
+  for (k = 0; k < 5; k++)
+    icc_put32(icc + off + 72 + k * 4, (uint32_t)(para[k] * 65536.0 + 0.5));
+  icc_put32(icc, off + 92u);
+
+  f = fopen("./tier1_srgb.icc", "wb");
+  if (f) {
+    fwrite(icc, 1, off + 92u, f);
+    fclose(f);
+  }
+  CHECK(stygian_icc_load_profile("./tier1_srgb.icc", &loaded, NULL) &&
+            loaded.trc[0].type == STYGIAN_COLOR_TRC_PARAMETRIC &&
+            loaded.trc[2].type == STYGIAN_COLOR_TRC_PARAMETRIC,
+        "icc loader reads para TRC tags");
+  remove("./tier1_srgb.icc");
+
+  // An sRGB ICC profile must round-trip the built-in sRGB space.
+  stygian_color_profile_init_builtin(&srgb, STYGIAN_COLOR_SPACE_SRGB);
+  for (i = 0; i < 256; i++) {
+    px[i * 4 + 0] = (uint8_t)i;
+    px[i * 4 + 1] = (uint8_t)(255 - i);
+    px[i * 4 + 2] = (uint8_t)(i * 3);
+    px[i * 4 + 3] = 255u;
+  }
+  stygian_color_transform_rgba8(&srgb, &loaded, px, 256);
+  for (i = 0; i < 256; i++) {
+    int d[3] = {px[i * 4 + 0] - i, px[i * 4 + 1] - (255 - i),
+                px[i * 4 + 2] - (uint8_t)(i * 3)};
+    for (k = 0; k < 3; k++) {
+      if (d[k] < 0)
+        d[k] = -d[k];
+      if (d[k] > worst)
+        worst = d[k];
+    }
+  }
+  CHECK(worst <= 1, "icc sRGB profile matches built-in sRGB");
+
+  {
+    static uint16_t ramp_a[STYGIAN_COLOR_TRC_SAMPLES];
+    static uint16_t ramp_b[STYGIAN_COLOR_TRC_SAMPLES];
+    const StygianColorTrcTable *ta, *tb, *tc;
+    for (i = 0; i < STYGIAN_COLOR_TRC_SAMPLES; i++)
+      ramp_a[i] = ramp_b[i] = (uint16_t)(i * 64);
+    ta = stygian_color_trc_table_intern(ramp_a);
+    tb = stygian_color_trc_table_intern(ramp_b);
+    ramp_b[512] ^= 1u;
+    tc = stygian_color_trc_table_intern(ramp_b);
+    CHECK(ta && ta == tb && tc && tc != ta &&
+              stygian_color_trc_table_samples(tc)[512] == ramp_b[512],
+          "color TRC tables intern by content");
+  }
+}
+
 int main(void) {
   TestEnv env;
   if (!test_env_init(&env)) {
@@ -206,6 +711,19 @@ int main(void) {
   test_cmd_rejects_stale_element(&env);
   test_cmd_accepts_valid_element(&env);
   test_frame_intent_eval_only(&env);
+  test_damage_caret_blink(&env);
+  test_nested_clip_reject(&env);
+  test_clip_ids_dedup(&env);
+  test_text_buffer_line_index();
+  test_log_store_ring();
+  test_glyph_disk_cache();
+  test_texture_atlas_packer();
+  test_range_alloc_coalesces();
+  test_flex_layout();
+  test_flex_incremental();
+  test_triad_canonical_glyph_id();
+  test_color_transform_rgba8();
+  test_icc_trc_profile();
 
   test_env_destroy(&env);
 
@@ -144,7 +144,7 @@ static void test_overlay_invalidation_isolated(TestEnv *env) {
 }
 
 static void test_clip_runtime_behavior(TestEnv *env) {
-  uint8_t clip_id;
+  StygianClipId clip_id;
   StygianElement e;
   int pushes = 0;
   int i;
@@ -164,13 +164,14 @@ static void test_clip_runtime_behavior(TestEnv *env) {
 
   begin_render_frame(env);
   for (i = 0; i < 300; i++) {
-    uint8_t id = stygian_clip_push(env->ctx, (float)i, 0.0f, 2.0f, 2.0f);
+    StygianClipId id =
+        stygian_clip_push(env->ctx, (float)i, 0.0f, 2.0f, 2.0f);
     if (id == 0u)
       break;
     pushes++;
   }
   stygian_end_frame(env->ctx);
-  CHECK(pushes == 255, "clip ids are bounded to 255 user clips");
+  CHECK(pushes == 300, "clip ids are not bounded to 8 bits");
 }
 
 static void test_transient_cleanup_determinism(TestEnv *env) {
@@ -210,8 +210,8 @@ static void test_misuse_sequences(TestEnv *env) {
         break;
       }
       case 8: {
-        uint8_t clip = stygian_clip_push(env->ctx, next_f01() * 120.0f,
-                                         next_f01() * 120.0f, 50.0f, 50.0f);
+        StygianClipId clip = stygian_clip_push(
+            env->ctx, next_f01() * 120.0f, next_f01() * 120.0f, 50.0f, 50.0f);
         StygianElement e = random_element_handle(
             elems, (uint32_t)(sizeof(elems) / sizeof(elems[0])));
         stygian_set_clip(env->ctx, e, clip);
@@ -124,51 +124,14 @@ void stygian_console_log(StygianContext *ctx, StygianFont font,
   // Log content
   float row_h = 16.0f;
   float content_y = state->y + 28.0f;
-
-  if (state->log_buffer && font) {
-    const char *ptr = state->log_buffer;
-    const char *line_start = ptr;
-    float cur_y = content_y - state->scroll_y;
-
-    while (*ptr) {
-      if (*ptr == '\n' || *ptr == 0) {
-        int len = (int)(ptr - line_start);
-        if (len > 0) {
-          char line[256];
-          if (len >= 256)
-            len = 255;
-          memcpy(line, line_start, len);
-          line[len] = 0;
-
-          // Visibility check
-          if (cur_y + row_h > content_y && cur_y < state->y + state->h) {
-            // Color based on prefix (simple log level detection)
-            float r = 0.8f, g = 0.8f, b = 0.8f;
-            if (strstr(line, "[ERROR]")) {
-              r = 0.9f;
-              g = 0.3f;
-              b = 0.3f;
-            } else if (strstr(line, "[WARN]")) {
-              r = 0.9f;
-              g = 0.8f;
-              b = 0.2f;
-            } else if (strstr(line, "[INFO]")) {
-              r = 0.3f;
-              g = 0.8f;
-              b = 0.9f;
-            }
-
-            stygian_text(ctx, font, line, state->x + 8, cur_y, 12.0f, r, g, b,
-                         1.0f);
-          }
-        }
-        cur_y += row_h;
-        line_start = ptr + 1;
-      }
-      if (*ptr == 0)
-        break;
-      ptr++;
-    }
+  float view_h = state->y + state->h - content_y;
+
+  // Virtualized rows: levels were classified on append, nothing is rescanned
+  if (state->log && font) {
+    stygian_log_store_draw_rows(ctx, font, state->log, &state->scroll_y,
+                                &state->seen_evicted, state->auto_scroll,
+                                state->x + 8, content_y, view_h, row_h, 12.0f,
+                                true);
   }
 
   stygian_panel_end(ctx);
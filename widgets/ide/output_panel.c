@@ -39,39 +39,16 @@ void stygian_output_panel(StygianContext *ctx, StygianFont font,
 
   // Content area
   float content_y = state->y + header_h + 4;
+  float view_h = state->y + state->h - content_y;
   float row_h = 18.0f;
 
-  // Simple line rendering
-  if (state->text_buffer && font) {
-    const char *ptr = state->text_buffer;
-    const char *line_start = ptr;
-    float cur_y = content_y - state->scroll_y;
-
-    while (*ptr) {
-      if (*ptr == '\n' || *ptr == 0) {
-        int len = (int)(ptr - line_start);
-        if (len > 0) {
-          char line[256];
-          if (len >= 256)
-            len = 255;
-          memcpy(line, line_start, len);
-          line[len] = 0;
-
-          // Simple visibility check
-          if (cur_y + row_h > content_y && cur_y < state->y + state->h) {
-            // TODO: Parse ANSI color codes here
-            // For now, render plain white/grey
-            stygian_text(ctx, font, line, state->x + 8, cur_y, 14.0f, 0.8f,
-                         0.8f, 0.8f, 1.0f);
-          }
-        }
-        cur_y += row_h;
-        line_start = ptr + 1;
-      }
-      if (*ptr == 0)
-        break;
-      ptr++;
-    }
+  // Virtualized rows: only lines intersecting the view are copied/emitted.
+  // TODO: Parse ANSI color codes here; for now every line is plain grey.
+  if (state->log && font) {
+    stygian_log_store_draw_rows(ctx, font, state->log, &state->scroll_y,
+                                &state->seen_evicted, state->auto_scroll,
+                                state->x + 8, content_y, view_h, row_h, 14.0f,
+                                false);
   }
 
   stygian_panel_end(ctx);
@@ -0,0 +1,271 @@
+// stygian_log_store.c - Bounded ring-buffer log store
+// Backing store for stygian_output_panel and stygian_console_log
+
+#include "stygian_log_store.h"
+#include <stdlib.h>
+#include <string.h>
+
+#define STYGIAN_LOG_STORE_DEFAULT_BYTES (4u * 1024u * 1024u)
+#define STYGIAN_LOG_STORE_DEFAULT_LINES 65536u
+
+typedef struct StygianLogLine {
+  uint64_t start; // Absolute byte position (ring slot = start % capacity)
+  uint32_t len;
+  uint8_t level;
+} StygianLogLine;
+
+// Positions and line ids grow monotonically; ring slots are taken modulo the
+// capacity, so eviction is just advancing first_line.
+struct StygianLogStore {
+  char *bytes;
+  size_t byte_capacity;
+  uint64_t write_pos;
+
+  StygianLogLine *lines;
+  uint32_t max_lines;
+  uint64_t first_line; // Oldest retained line id
+  uint64_t end_line;   // One past the newest line id (includes open tail)
+  bool tail_open;
+
+  uint64_t evicted;
+  uint32_t revision;
+};
+
+static StygianLogLine *ls_line(const StygianLogStore *ls, uint64_t id) {
+  return &ls->lines[id % ls->max_lines];
+}
+
+static void ls_read(const StygianLogStore *ls, uint64_t pos, char *out,
+                    size_t len) {
+  size_t slot = (size_t)(pos % ls->byte_capacity);
+  size_t head = ls->byte_capacity - slot;
+  if (head > len)
+    head = len;
+  memcpy(out, ls->bytes + slot, head);
+  if (head < len)
+    memcpy(out + head, ls->bytes, len - head);
+}
+
+static void ls_write(StygianLogStore *ls, const char *src, size_t len) {
+  size_t slot = (size_t)(ls->write_pos % ls->byte_capacity);
+  size_t head = ls->byte_capacity - slot;
+  if (head > len)
+    head = len;
+  memcpy(ls->bytes + slot, src, head);
+  if (head < len)
+    memcpy(ls->bytes, src + head, len - head);
+  ls->write_pos += len;
+}
+
+static void ls_evict_oldest(StygianLogStore *ls) {
+  ls->first_line++;
+  ls->evicted++;
+}
+
+// Same precedence the console used to apply per frame: error > warn > info.
+static void ls_classify(StygianLogStore *ls, StygianLogLine *line) {
+  char buf[STYGIAN_LOG_STORE_MAX_LINE + 1u];
+  ls_read(ls, line->start, buf, line->len);
+  buf[line->len] = '\0';
+  if (strstr(buf, "[ERROR]"))
+    line->level = STYGIAN_LOG_LEVEL_ERROR;
+  else if (strstr(buf, "[WARN]"))
+    line->level = STYGIAN_LOG_LEVEL_WARN;
+  else if (strstr(buf, "[INFO]"))
+    line->level = STYGIAN_LOG_LEVEL_INFO;
+  else
+    line->level = STYGIAN_LOG_LEVEL_PLAIN;
+}
+
+StygianLogStore *stygian_log_store_create(size_t byte_capacity,
+                                          uint32_t max_lines) {
+  StygianLogStore *ls = (StygianLogStore *)calloc(1, sizeof(StygianLogStore));
+  if (!ls)
+    return NULL;
+  if (byte_capacity == 0u)
+    byte_capacity = STYGIAN_LOG_STORE_DEFAULT_BYTES;
+  // A full-length line must always fit, so the open tail is never evicted.
+  if (byte_capacity < STYGIAN_LOG_STORE_MAX_LINE)
+    byte_capacity = STYGIAN_LOG_STORE_MAX_LINE;
+  if (max_lines == 0u)
+    max_lines = STYGIAN_LOG_STORE_DEFAULT_LINES;
+  ls->bytes = (char *)malloc(byte_capacity);
+  ls->lines = (StygianLogLine *)malloc((size_t)max_lines *
+                                       sizeof(StygianLogLine));
+  if (!ls->bytes || !ls->lines) {
+    free(ls->bytes);
+    free(ls->lines);
+    free(ls);
+    return NULL;
+  }
+  ls->byte_capacity = byte_capacity;
+  ls->max_lines = max_lines;
+  return ls;
+}
+
+void stygian_log_store_destroy(StygianLogStore *ls) {
+  if (!ls)
+    return;
+  free(ls->bytes);
+  free(ls->lines);
+  free(ls);
+}
+
+void stygian_log_store_clear(StygianLogStore *ls) {
+  if (!ls)
+    return;
+  ls->write_pos = 0u;
+  ls->first_line = 0u;
+  ls->end_line = 0u;
+  ls->tail_open = false;
+  ls->evicted = 0u;
+  ls->revision++;
+}
+
+void stygian_log_store_append(StygianLogStore *ls, const char *text,
+                              size_t len) {
+  StygianLogLine *tail = NULL;
+  size_t i = 0u;
+  if (!ls || !text || len == 0u)
+    return;
+
+  while (i < len) {
+    const char *nl = (const char *)memchr(text + i, '\n', len - i);
+    size_t seg = nl ? (size_t)(nl - (text + i)) : len - i;
+    size_t room;
+
+    if (!ls->tail_open) {
+      if (ls->end_line - ls->first_line >= ls->max_lines)
+        ls_evict_oldest(ls);
+      tail = ls_line(ls, ls->end_line++);
+      tail->start = ls->write_pos;
+      tail->len = 0u;
+      tail->level = STYGIAN_LOG_LEVEL_PLAIN;
+      ls->tail_open = true;
+    } else {
+      tail = ls_line(ls, ls->end_line - 1u);
+    }
+
+    room = STYGIAN_LOG_STORE_MAX_LINE - tail->len;
+    if (seg > room)
+      seg = room; // Truncate; the remainder up to '\n' is dropped below
+    if (seg > 0u) {
+      while (ls->write_pos + seg - ls_line(ls, ls->first_line)->start >
+             ls->byte_capacity) {
+        ls_evict_oldest(ls);
+      }
+      ls_write(ls, text + i, seg);
+      tail->len += (uint32_t)seg;
+    }
+
+    if (!nl) {
+      ls_classify(ls, tail);
+      break;
+    }
+    ls_classify(ls, tail);
+    ls->tail_open = false;
+    i = (size_t)(nl - text) + 1u;
+  }
+  ls->revision++;
+}
+
+uint32_t stygian_log_store_line_count(const StygianLogStore *ls) {
+  return ls ? (uint32_t)(ls->end_line - ls->first_line) : 0u;
+}
+
+StygianLogLevel stygian_log_store_line_level(const StygianLogStore *ls,
+                                             uint32_t line) {
+  if (!ls || line >= stygian_log_store_line_count(ls))
+    return STYGIAN_LOG_LEVEL_PLAIN;
+  return (StygianLogLevel)ls_line(ls, ls->first_line + line)->level;
+}
+
+size_t stygian_log_store_line_copy(const StygianLogStore *ls, uint32_t line,
+                                   char *out, size_t out_size) {
+  const StygianLogLine *rec;
+  size_t len;
+  if (!out || out_size == 0u)
+    return 0u;
+  out[0] = '\0';
+  if (!ls || line >= stygian_log_store_line_count(ls))
+    return 0u;
+  rec = ls_line(ls, ls->first_line + line);
+  len = rec->len;
+  if (len > out_size - 1u)
+    len = out_size - 1u;
+  ls_read(ls, rec->start, out, len);
+  out[len] = '\0';
+  return len;
+}
+
+uint64_t stygian_log_store_evicted(const StygianLogStore *ls) {
+  return ls ? ls->evicted : 0u;
+}
+
+uint32_t stygian_log_store_revision(const StygianLogStore *ls) {
+  return ls ? ls->revision : 0u;
+}
+
+// ============================================================================
+// Log View
+// ============================================================================
+
+void stygian_log_store_draw_rows(StygianContext *ctx, StygianFont font,
+                                 const StygianLogStore *ls, float *scroll_y,
+                                 uint64_t *seen_evicted, bool auto_scroll,
+                                 float x, float y, float h, float row_h,
+                                 float size, bool color_levels) {
+  uint32_t count;
+  uint64_t evicted;
+  float max_scroll;
+  if (!ctx || !font || !ls || !scroll_y || !seen_evicted || row_h <= 0.0f)
+    return;
+  count = stygian_log_store_line_count(ls);
+  evicted = stygian_log_store_evicted(ls);
+  max_scroll = (float)count * row_h - h;
+  if (max_scroll < 0.0f)
+    max_scroll = 0.0f;
+
+  // Keep the same lines under the viewport while the head is evicted
+  if (evicted > *seen_evicted)
+    *scroll_y -= (float)(evicted - *seen_evicted) * row_h;
+  *seen_evicted = evicted;
+  if (auto_scroll)
+    *scroll_y = max_scroll;
+  if (*scroll_y > max_scroll)
+    *scroll_y = max_scroll;
+  if (*scroll_y < 0.0f)
+    *scroll_y = 0.0f;
+
+  for (uint32_t i = (uint32_t)(*scroll_y / row_h); i < count; i++) {
+    float cur_y = y + (float)i * row_h - *scroll_y;
+    char line[STYGIAN_LOG_STORE_MAX_LINE + 1u];
+    float r = 0.8f, g = 0.8f, b = 0.8f;
+    if (cur_y >= y + h)
+      break;
+    if (stygian_log_store_line_copy(ls, i, line, sizeof(line)) == 0)
+      continue;
+
+    switch (color_levels ? stygian_log_store_line_level(ls, i)
+                         : STYGIAN_LOG_LEVEL_PLAIN) {
+    case STYGIAN_LOG_LEVEL_ERROR:
+      r = 0.9f;
+      g = 0.3f;
+      b = 0.3f;
+      break;
+    case STYGIAN_LOG_LEVEL_WARN:
+      r = 0.9f;
+      g = 0.8f;
+      b = 0.2f;
+      break;
+    case STYGIAN_LOG_LEVEL_INFO:
+      r = 0.3f;
+      g = 0.8f;
+      b = 0.9f;
+      break;
+    default:
+      break;
+    }
+    stygian_text(ctx, font, line, x, cur_y, size, r, g, b, 1.0f);
+  }
+}
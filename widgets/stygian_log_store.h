@@ -0,0 +1,85 @@
+// stygian_log_store.h - Bounded ring-buffer store for log/output panels
+// Lines are indexed and classified once on append; views read by line index
+#ifndef STYGIAN_LOG_STORE_H
+#define STYGIAN_LOG_STORE_H
+
+#include "../include/stygian.h"
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// ============================================================================
+// Log Store
+// ============================================================================
+//
+// Fixed-size byte ring + fixed-size line ring, allocated once at create.
+// Appending never allocates; when either ring is full the oldest lines are
+// evicted. Each line records its severity at append time, so views never
+// rescan text:
+//   - append: O(bytes appended)
+//   - line lookup by index: O(1)
+// Lines longer than STYGIAN_LOG_STORE_MAX_LINE bytes are truncated.
+
+#define STYGIAN_LOG_STORE_MAX_LINE 512u
+
+typedef enum StygianLogLevel {
+  STYGIAN_LOG_LEVEL_PLAIN = 0,
+  STYGIAN_LOG_LEVEL_INFO = 1,  // "[INFO]"
+  STYGIAN_LOG_LEVEL_WARN = 2,  // "[WARN]"
+  STYGIAN_LOG_LEVEL_ERROR = 3, // "[ERROR]"
+} StygianLogLevel;
+
+typedef struct StygianLogStore StygianLogStore; // Opaque
+
+// Create a store holding at most byte_capacity text bytes and max_lines lines
+// (0 = defaults)
+StygianLogStore *stygian_log_store_create(size_t byte_capacity,
+                                          uint32_t max_lines);
+void stygian_log_store_destroy(StygianLogStore *ls);
+void stygian_log_store_clear(StygianLogStore *ls);
+
+// Append text. '\n' terminates a line; trailing text without '\n' stays open
+// and is continued by the next append.
+void stygian_log_store_append(StygianLogStore *ls, const char *text,
+                              size_t len);
+
+// Retained lines (index 0 = oldest retained line)
+uint32_t stygian_log_store_line_count(const StygianLogStore *ls);
+StygianLogLevel stygian_log_store_line_level(const StygianLogStore *ls,
+                                             uint32_t line);
+// Copy line text into out (always NUL-terminated when out_size > 0).
+// Returns bytes copied, excluding the terminator.
+size_t stygian_log_store_line_copy(const StygianLogStore *ls, uint32_t line,
+                                   char *out, size_t out_size);
+
+// Total lines evicted since create/clear (views use the delta to keep their
+// scroll anchored while the head moves)
+uint64_t stygian_log_store_evicted(const StygianLogStore *ls);
+
+// Incremented on every mutation (use to key caches / scope invalidation)
+uint32_t stygian_log_store_revision(const StygianLogStore *ls);
+
+// ============================================================================
+// Log View
+// ============================================================================
+
+// Draw the rows of ls that intersect [y, y + h), one row_h per line, with
+// text at x. scroll_y / seen_evicted are the view's state: scroll stays
+// anchored to the same lines while the head is evicted, is pinned to the
+// newest line when auto_scroll is set, and is clamped to the content.
+// color_levels tints ERROR/WARN/INFO lines; otherwise every line is grey.
+void stygian_log_store_draw_rows(StygianContext *ctx, StygianFont font,
+                                 const StygianLogStore *ls, float *scroll_y,
+                                 uint64_t *seen_evicted, bool auto_scroll,
+                                 float x, float y, float h, float row_h,
+                                 float size, bool color_levels);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // STYGIAN_LOG_STORE_H
@@ -0,0 +1,337 @@
+// stygian_text_buffer.c - Gap buffer + gapped line index
+// Storage backend for stygian_text_area and other document widgets
+
+#include "stygian_text_buffer.h"
+#include <stdlib.h>
+#include <string.h>
+
+#define STYGIAN_TEXT_BUFFER_DEFAULT_CAPACITY 4096u
+#define STYGIAN_TEXT_BUFFER_DEFAULT_LINES 256u
+
+// Line-start index layout (parallel to the text gap):
+//   lines[0 .. line_gap_start)        absolute byte offsets (start <= edit)
+//   lines[line_gap_end .. line_cap)   distance from document end (start > edit)
+// Edits happen at the line gap, so inserting or erasing text never rewrites
+// entries on either side; only entries that cross the gap are converted.
+struct StygianTextBuffer {
+  char *data;
+  size_t capacity;
+  size_t gap_start;
+  size_t gap_end;
+
+  size_t *lines;
+  uint32_t line_capacity;
+  uint32_t line_gap_start;
+  uint32_t line_gap_end;
+
+  uint32_t revision;
+};
+
+static size_t tb_len(const StygianTextBuffer *tb) {
+  return tb->capacity - (tb->gap_end - tb->gap_start);
+}
+
+static uint32_t tb_line_count(const StygianTextBuffer *tb) {
+  return tb->line_gap_start + (tb->line_capacity - tb->line_gap_end);
+}
+
+static size_t tb_line_get(const StygianTextBuffer *tb, uint32_t line) {
+  if (line < tb->line_gap_start)
+    return tb->lines[line];
+  return tb_len(tb) -
+         tb->lines[line - tb->line_gap_start + tb->line_gap_end];
+}
+
+// Number of line starts <= offset (>= 1, line 0 starts at 0).
+static uint32_t tb_lines_at_or_before(const StygianTextBuffer *tb,
+                                      size_t offset) {
+  uint32_t lo = 1u;
+  uint32_t hi = tb_line_count(tb);
+  while (lo < hi) {
+    uint32_t mid = lo + (hi - lo) / 2u;
+    if (tb_line_get(tb, mid) <= offset)
+      lo = mid + 1u;
+    else
+      hi = mid;
+  }
+  return lo;
+}
+
+static bool tb_reserve_text(StygianTextBuffer *tb, size_t extra) {
+  size_t gap = tb->gap_end - tb->gap_start;
+  size_t new_cap;
+  size_t tail;
+  char *data;
+  if (gap >= extra)
+    return true;
+  new_cap = tb->capacity ? tb->capacity : STYGIAN_TEXT_BUFFER_DEFAULT_CAPACITY;
+  while (new_cap - tb_len(tb) < extra)
+    new_cap *= 2u;
+  data = (char *)realloc(tb->data, new_cap);
+  if (!data)
+    return false;
+  tail = tb->capacity - tb->gap_end;
+  memmove(data + new_cap - tail, data + tb->gap_end, tail);
+  tb->data = data;
+  tb->gap_end = new_cap - tail;
+  tb->capacity = new_cap;
+  return true;
+}
+
+static bool tb_reserve_lines(StygianTextBuffer *tb, uint32_t extra) {
+  uint32_t gap = tb->line_gap_end - tb->line_gap_start;
+  uint32_t new_cap;
+  uint32_t tail;
+  size_t *lines;
+  if (gap >= extra)
+    return true;
+  new_cap = tb->line_capacity ? tb->line_capacity
+                              : STYGIAN_TEXT_BUFFER_DEFAULT_LINES;
+  while (new_cap - tb_line_count(tb) < extra) {
+    if (new_cap > UINT32_MAX / 2u)
+      return false;
+    new_cap *= 2u;
+  }
+  lines = (size_t *)realloc(tb->lines, (size_t)new_cap * sizeof(size_t));
+  if (!lines)
+    return false;
+  tail = tb->line_capacity - tb->line_gap_end;
+  memmove(lines + new_cap - tail, lines + tb->line_gap_end,
+          (size_t)tail * sizeof(size_t));
+  tb->lines = lines;
+  tb->line_gap_end = new_cap - tail;
+  tb->line_capacity = new_cap;
+  return true;
+}
+
+static void tb_move_gap(StygianTextBuffer *tb, size_t offset) {
+  if (offset < tb->gap_start) {
+    size_t n = tb->gap_start - offset;
+    memmove(tb->data + tb->gap_end - n, tb->data + offset, n);
+    tb->gap_start -= n;
+    tb->gap_end -= n;
+  } else if (offset > tb->gap_start) {
+    size_t n = offset - tb->gap_start;
+    memmove(tb->data + tb->gap_start, tb->data + tb->gap_end, n);
+    tb->gap_start += n;
+    tb->gap_end += n;
+  }
+}
+
+// Move the line gap so exactly `before` starts sit on the absolute side.
+// Must run before the text length changes (conversions use current length).
+static void tb_move_line_gap(StygianTextBuffer *tb, uint32_t before) {
+  size_t len = tb_len(tb);
+  while (tb->line_gap_start > before) {
+    tb->line_gap_start--;
+    tb->line_gap_end--;
+    tb->lines[tb->line_gap_end] = len - tb->lines[tb->line_gap_start];
+  }
+  while (tb->line_gap_start < before) {
+    tb->lines[tb->line_gap_start] = len - tb->lines[tb->line_gap_end];
+    tb->line_gap_start++;
+    tb->line_gap_end++;
+  }
+}
+
+StygianTextBuffer *stygian_text_buffer_create(size_t initial_capacity) {
+  StygianTextBuffer *tb =
+      (StygianTextBuffer *)calloc(1, sizeof(StygianTextBuffer));
+  if (!tb)
+    return NULL;
+  if (initial_capacity == 0u)
+    initial_capacity = STYGIAN_TEXT_BUFFER_DEFAULT_CAPACITY;
+  tb->data = (char *)malloc(initial_capacity);
+  tb->lines =
+      (size_t *)malloc(STYGIAN_TEXT_BUFFER_DEFAULT_LINES * sizeof(size_t));
+  if (!tb->data || !tb->lines) {
+    free(tb->data);
+    free(tb->lines);
+    free(tb);
+    return NULL;
+  }
+  tb->capacity = initial_capacity;
+  tb->gap_start = 0u;
+  tb->gap_end = initial_capacity;
+  tb->line_capacity = STYGIAN_TEXT_BUFFER_DEFAULT_LINES;
+  tb->lines[0] = 0u;
+  tb->line_gap_start = 1u;
+  tb->line_gap_end = tb->line_capacity;
+  return tb;
+}
+
+void stygian_text_buffer_destroy(StygianTextBuffer *tb) {
+  if (!tb)
+    return;
+  free(tb->data);
+  free(tb->lines);
+  free(tb);
+}
+
+void stygian_text_buffer_clear(StygianTextBuffer *tb) {
+  if (!tb)
+    return;
+  tb->gap_start = 0u;
+  tb->gap_end = tb->capacity;
+  tb->lines[0] = 0u;
+  tb->line_gap_start = 1u;
+  tb->line_gap_end = tb->line_capacity;
+  tb->revision++;
+}
+
+bool stygian_text_buffer_set(StygianTextBuffer *tb, const char *text,
+                             size_t len) {
+  if (!tb)
+    return false;
+  stygian_text_buffer_clear(tb);
+  if (!text || len == 0u)
+    return true;
+  return stygian_text_buffer_insert(tb, 0u, text, len);
+}
+
+bool stygian_text_buffer_insert(StygianTextBuffer *tb, size_t offset,
+                                const char *text, size_t len) {
+  uint32_t newlines = 0u;
+  size_t i;
+  if (!tb || !text || len == 0u)
+    return tb != NULL;
+  if (offset > tb_len(tb))
+    offset = tb_len(tb);
+
+  for (i = 0u; i < len; i++) {
+    if (text[i] == '\n')
+      newlines++;
+  }
+  if (!tb_reserve_text(tb, len) || !tb_reserve_lines(tb, newlines))
+    return false;
+
+  tb_move_line_gap(tb, tb_lines_at_or_before(tb, offset));
+  tb_move_gap(tb, offset);
+  memcpy(tb->data + tb->gap_start, text, len);
+  tb->gap_start += len;
+
+  // New starts land between the absolute side (<= offset) and the tail side
+  // (> offset + len), so they append to the absolute side in order.
+  for (i = 0u; i < len && newlines > 0u; i++) {
+    if (text[i] == '\n') {
+      tb->lines[tb->line_gap_start++] = offset + i + 1u;
+      newlines--;
+    }
+  }
+  tb->revision++;
+  return true;
+}
+
+void stygian_text_buffer_erase(StygianTextBuffer *tb, size_t offset,
+                               size_t len) {
+  size_t doc_len;
+  size_t end;
+  if (!tb)
+    return;
+  doc_len = tb_len(tb);
+  if (offset >= doc_len || len == 0u)
+    return;
+  if (len > doc_len - offset)
+    len = doc_len - offset;
+  end = offset + len;
+
+  // Starts in (offset, end] follow an erased '\n' and disappear; the rest of
+  // the tail side keeps its distance-from-end encoding unchanged.
+  tb_move_line_gap(tb, tb_lines_at_or_before(tb, offset));
+  while (tb->line_gap_end < tb->line_capacity &&
+         doc_len - tb->lines[tb->line_gap_end] <= end) {
+    tb->line_gap_end++;
+  }
+
+  tb_move_gap(tb, offset);
+  tb->gap_end += len;
+  tb->revision++;
+}
+
+size_t stygian_text_buffer_length(const StygianTextBuffer *tb) {
+  return tb ? tb_len(tb) : 0u;
+}
+
+char stygian_text_buffer_byte(const StygianTextBuffer *tb, size_t offset) {
+  if (!tb || offset >= tb_len(tb))
+    return 0;
+  if (offset < tb->gap_start)
+    return tb->data[offset];
+  return tb->data[offset + (tb->gap_end - tb->gap_start)];
+}
+
+size_t stygian_text_buffer_copy(const StygianTextBuffer *tb, size_t offset,
+                                size_t len, char *out, size_t out_size) {
+  size_t doc_len;
+  size_t copied = 0u;
+  if (!out || out_size == 0u)
+    return 0u;
+  out[0] = '\0';
+  if (!tb)
+    return 0u;
+  doc_len = tb_len(tb);
+  if (offset >= doc_len)
+    return 0u;
+  if (len > doc_len - offset)
+    len = doc_len - offset;
+  if (len > out_size - 1u)
+    len = out_size - 1u;
+
+  if (offset < tb->gap_start) {
+    size_t head = tb->gap_start - offset;
+    if (head > len)
+      head = len;
+    memcpy(out, tb->data + offset, head);
+    copied = head;
+  }
+  if (copied < len) {
+    size_t src = offset + copied + (tb->gap_end - tb->gap_start);
+    memcpy(out + copied, tb->data + src, len - copied);
+    copied = len;
+  }
+  out[copied] = '\0';
+  return copied;
+}
+
+const char *stygian_text_buffer_cstr(StygianTextBuffer *tb) {
+  if (!tb)
+    return "";
+  if (tb->gap_end == tb->gap_start && !tb_reserve_text(tb, 1u))
+    return "";
+  tb_move_gap(tb, tb_len(tb));
+  tb->data[tb->gap_start] = '\0';
+  return tb->data;
+}
+
+uint32_t stygian_text_buffer_line_count(const StygianTextBuffer *tb) {
+  return tb ? tb_line_count(tb) : 1u;
+}
+
+size_t stygian_text_buffer_line_start(const StygianTextBuffer *tb,
+                                      uint32_t line) {
+  if (!tb)
+    return 0u;
+  if (line >= tb_line_count(tb))
+    return tb_len(tb);
+  return tb_line_get(tb, line);
+}
+
+size_t stygian_text_buffer_line_end(const StygianTextBuffer *tb,
+                                    uint32_t line) {
+  if (!tb)
+    return 0u;
+  if (line + 1u >= tb_line_count(tb))
+    return tb_len(tb);
+  return tb_line_get(tb, line + 1u) - 1u;
+}
+
+uint32_t stygian_text_buffer_line_of(const StygianTextBuffer *tb,
+                                     size_t offset) {
+  if (!tb)
+    return 0u;
+  return tb_lines_at_or_before(tb, offset) - 1u;
+}
+
+uint32_t stygian_text_buffer_revision(const StygianTextBuffer *tb) {
+  return tb ? tb->revision : 0u;
+}
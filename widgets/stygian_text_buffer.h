@@ -0,0 +1,80 @@
+// stygian_text_buffer.h - Edit-friendly document storage for text widgets
+// Gap buffer with an incrementally maintained line-start index
+#ifndef STYGIAN_TEXT_BUFFER_H
+#define STYGIAN_TEXT_BUFFER_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// ============================================================================
+// Text Buffer
+// ============================================================================
+//
+// Byte-addressed document store. Text lives in a gap buffer; line starts live
+// in a second gap array that moves with the edit point, so:
+//   - insert/erase at the edit point: O(bytes inserted + newlines touched)
+//   - moving the edit point: O(distance moved)
+//   - offset -> line lookup: O(log lines)
+//   - line -> offset lookup: O(1)
+// Offsets are byte indices into the logical document (gap excluded).
+
+typedef struct StygianTextBuffer StygianTextBuffer; // Opaque
+
+// Create an empty buffer (initial_capacity is a hint, 0 = default)
+StygianTextBuffer *stygian_text_buffer_create(size_t initial_capacity);
+
+// Destroy buffer and release storage
+void stygian_text_buffer_destroy(StygianTextBuffer *tb);
+
+// Replace contents (len == 0 with text == NULL clears)
+bool stygian_text_buffer_set(StygianTextBuffer *tb, const char *text,
+                             size_t len);
+void stygian_text_buffer_clear(StygianTextBuffer *tb);
+
+// Insert len bytes at offset (clamped to length). Returns false on OOM.
+bool stygian_text_buffer_insert(StygianTextBuffer *tb, size_t offset,
+                                const char *text, size_t len);
+
+// Erase len bytes starting at offset (range clamped to length)
+void stygian_text_buffer_erase(StygianTextBuffer *tb, size_t offset,
+                               size_t len);
+
+// Logical length in bytes
+size_t stygian_text_buffer_length(const StygianTextBuffer *tb);
+
+// Byte at offset (0 when out of range)
+char stygian_text_buffer_byte(const StygianTextBuffer *tb, size_t offset);
+
+// Copy [offset, offset+len) into out (always NUL-terminated when
+// out_size > 0). Returns bytes copied, excluding the terminator.
+size_t stygian_text_buffer_copy(const StygianTextBuffer *tb, size_t offset,
+                                size_t len, char *out, size_t out_size);
+
+// Contiguous NUL-terminated view of the whole document. Moves the gap to the
+// end (O(distance)); pointer is valid until the next mutation.
+const char *stygian_text_buffer_cstr(StygianTextBuffer *tb);
+
+// Line index (line 0 always starts at offset 0; count = newlines + 1)
+uint32_t stygian_text_buffer_line_count(const StygianTextBuffer *tb);
+size_t stygian_text_buffer_line_start(const StygianTextBuffer *tb,
+                                      uint32_t line);
+// End of line content, excluding the trailing '\n'
+size_t stygian_text_buffer_line_end(const StygianTextBuffer *tb,
+                                    uint32_t line);
+// Line containing offset (offsets past the end map to the last line)
+uint32_t stygian_text_buffer_line_of(const StygianTextBuffer *tb,
+                                     size_t offset);
+
+// Incremented on every mutation (use to key caches / scope invalidation)
+uint32_t stygian_text_buffer_revision(const StygianTextBuffer *tb);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // STYGIAN_TEXT_BUFFER_H
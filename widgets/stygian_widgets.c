@@ -1112,7 +1112,7 @@ void stygian_perf_widget_set_enabled(StygianPerfWidget *state, bool enabled) {
 
 typedef struct {
   bool active;
-  uint8_t clip_id;
+  StygianClipId clip_id;
 } ModalRuntimeState;
 
 typedef struct {
@@ -1984,186 +1984,867 @@ bool stygian_text_input(StygianContext *ctx, StygianFont font, float x, float y,
 // ============================================================================
 
 // ============================================================================
-// Text Area Logic (Wrapping & Interaction)
+// Text Area Logic (Rows, Wrapping & Interaction)
 // ============================================================================
 
+// Visual rows are hard lines from the buffer's line index, split at the text
+// width unless no_wrap is set. Row breaks come from one forward pass summing
+// glyph advances (ASCII from a per-font LUT). Wrapped row counts and break
+// offsets are cached per line (StygianTextAreaLayout) with row prefix sums,
+// so content height, the caret row and the first visible row are
+// O(log lines); edits made by the widget re-measure only the lines they
+// touch. Either way only rows intersecting the viewport (plus overscan) are
+// loaded or emitted, so frame cost is independent of document length.
+#define STYGIAN_TEXT_AREA_FONT_SIZE 16.0f
+#define STYGIAN_TEXT_AREA_PAD_X 5.0f
+#define STYGIAN_TEXT_AREA_OVERSCAN 2u
+// Lines up to this many bytes load into the row itself; longer lines are
+// copied to the heap so every byte stays reachable.
+#define STYGIAN_TEXT_AREA_ROW_INLINE_BYTES 1024u
+
+// One hard line, loaded for measuring.
 typedef struct {
-  StygianContext *ctx;
-  StygianFont font;
-  const char *text;
-  float max_w;
+  size_t start; // Byte offset of line start in the document
+  size_t len;   // Bytes in text
+  char *text;   // inline_text, or a heap copy of a long line
+  char inline_text[STYGIAN_TEXT_AREA_ROW_INLINE_BYTES + 1u];
+} TextAreaRow;
 
-  // State
-  const char *p; // Current char pointer
-  const char *line_start;
-  float current_w; // Width accumulated for current line
-  float y;         // Current Y offset
-  int line_index;
-  bool done;
-
-  // Cached ASCII glyph advance widths (eliminates per-char font lookups)
-  float advance_lut[128];
-} TextAreaIter;
-
-static void iter_begin(TextAreaIter *it, StygianContext *ctx, StygianFont font,
-                       const char *text, float max_w) {
-  it->ctx = ctx;
-  it->font = font;
-  it->text = text;
-  it->max_w = max_w;
-  it->p = text;
-  it->line_start = text;
-  it->current_w = 0;
-  it->y = 0;
-  it->line_index = 0;
-  it->done = (*text == 0);
-
-  // Pre-compute ASCII advance widths once
+// Cached wrap of one hard line.
+typedef struct {
+  uint32_t rows;   // Visual rows (0 = not measured yet)
+  uint32_t breaks; // Pool index of its (end, next) pairs when rows > 1
+} TextAreaLine;
+
+// Lines are held in chunks so inserting or removing lines moves at most one
+// chunk; Fenwick trees over the chunks give line and row prefix sums.
+#define STYGIAN_TEXT_AREA_CHUNK_LINES 256u
+
+typedef struct {
+  uint32_t count; // Lines held (1..STYGIAN_TEXT_AREA_CHUNK_LINES)
+  uint32_t rows;  // Visual rows of those lines
+  TextAreaLine lines[STYGIAN_TEXT_AREA_CHUNK_LINES];
+} TextAreaChunk;
+
+struct StygianTextAreaLayout {
+  StygianFont font;
+  bool has_lut;
+  float advance_lut[128]; // ASCII advances at the text area font size
+  float max_w;            // Wrap width lines were measured at (0 = none)
+  uint32_t revision;      // Buffer revision the lines describe
+  uint32_t line_count;
+  TextAreaChunk **chunks;
+  uint32_t chunk_count;
+  uint32_t chunk_cap;
+  uint32_t *line_tree; // Fenwick tree over chunk line counts (1-based)
+  uint32_t *row_tree;  // Fenwick tree over chunk row counts (1-based)
+  bool stale;          // Lines in [stale_lo, stale_hi] may need measuring
+  uint32_t stale_lo, stale_hi;
+  uint32_t *pool; // Line-relative (end, next) break pairs
+  size_t pool_len, pool_cap;
+  size_t pool_garbage; // Entries no line refers to anymore
+};
+
+float stygian_text_area_row_height(StygianContext *ctx, StygianFont font) {
+  float h = stygian_font_line_height(ctx, font, STYGIAN_TEXT_AREA_FONT_SIZE);
+  return (h > 1.0f) ? h : 18.0f;
+}
+
+void stygian_text_area_free(StygianTextArea *state) {
+  StygianTextAreaLayout *lay;
+  if (!state || !state->layout)
+    return;
+  lay = state->layout;
+  for (uint32_t c = 0; c < lay->chunk_count; c++)
+    free(lay->chunks[c]);
+  free(lay->chunks);
+  free(lay->line_tree);
+  free(lay->row_tree);
+  free(lay->pool);
+  free(lay);
+  state->layout = NULL;
+}
+
+static void text_area_row_load(const StygianTextBuffer *text, uint32_t line,
+                               TextAreaRow *row) {
+  size_t len;
+  row->start = stygian_text_buffer_line_start(text, line);
+  len = stygian_text_buffer_line_end(text, line) - row->start;
+  row->text = row->inline_text;
+  if (len > STYGIAN_TEXT_AREA_ROW_INLINE_BYTES) {
+    char *heap = (char *)malloc(len + 1u);
+    if (heap)
+      row->text = heap;
+    else
+      len = STYGIAN_TEXT_AREA_ROW_INLINE_BYTES; // Out of memory: clip the tail
+  }
+  row->len =
+      stygian_text_buffer_copy(text, row->start, len, row->text, len + 1u);
+}
+
+static void text_area_row_release(TextAreaRow *row) {
+  if (row->text != row->inline_text)
+    free(row->text);
+  row->text = row->inline_text;
+}
+
+// ASCII advances are measured once per font.
+static void text_area_layout_font(StygianTextAreaLayout *lay,
+                                  StygianContext *ctx, StygianFont font) {
+  if (lay->has_lut && lay->font == font)
+    return;
   for (int c = 0; c < 128; c++) {
     char temp[2] = {(char)c, 0};
-    it->advance_lut[c] =
-        (c >= 32) ? stygian_text_width(ctx, font, temp, 16.0f) : 0.0f;
+    lay->advance_lut[c] =
+        (c >= 32) ? stygian_text_width(ctx, font, temp,
+                                       STYGIAN_TEXT_AREA_FONT_SIZE)
+                  : 0.0f;
+  }
+  lay->font = font;
+  lay->has_lut = true;
+  lay->max_w = 0.0f; // New metrics: re-measure every line
+}
+
+// Advance of the glyph at *i, stepping *i past it. ASCII comes from the LUT;
+// any other UTF-8 sequence is measured as a whole.
+static float text_area_advance(const StygianTextAreaLayout *lay,
+                               StygianContext *ctx, StygianFont font,
+                               const char *s, size_t len, size_t *i) {
+  unsigned char c = (unsigned char)s[*i];
+  char seq[5];
+  size_t n = 1u, k;
+  if (c < 128u) {
+    (*i)++;
+    return lay->advance_lut[c];
+  }
+  if (c >= 0xF0u)
+    n = 4u;
+  else if (c >= 0xE0u)
+    n = 3u;
+  else if (c >= 0xC0u)
+    n = 2u;
+  for (k = 1u; k < n; k++) {
+    if (*i + k >= len || ((unsigned char)s[*i + k] & 0xC0u) != 0x80u)
+      break;
   }
+  memcpy(seq, s + *i, k);
+  seq[k] = '\0';
+  *i += k;
+  return stygian_text_width(ctx, font, seq, STYGIAN_TEXT_AREA_FONT_SIZE);
 }
 
-// Advances to next line (hard or soft break)
-// Returns true if there is a line to process
-static bool iter_next_line(TextAreaIter *it, const char **out_start,
-                           const char **out_end) {
-  if (it->done)
-    return false;
-
-  it->line_start = it->p;
-  it->current_w = 0;
-
-  const char *scan = it->p;
-  const char *last_space = NULL;
+// Width of bytes [a, b) of a loaded row.
+static float text_area_row_width(const StygianTextAreaLayout *lay,
+                                 StygianContext *ctx, StygianFont font,
+                                 const TextAreaRow *row, size_t a, size_t b) {
+  float w = 0.0f;
+  if (b > row->len)
+    b = row->len;
+  while (a < b)
+    w += text_area_advance(lay, ctx, font, row->text, row->len, &a);
+  return w;
+}
 
-  while (*scan) {
-    if (*scan == '\n') {
-      *out_start = it->line_start;
-      *out_end = scan;
-      it->p = scan + 1; // Skip newline
-      it->y += 18.0f;
-      return true;
+// First byte past the glyphs of [a, b) that start within max_w.
+static size_t text_area_row_fit(const StygianTextAreaLayout *lay,
+                                StygianContext *ctx, StygianFont font,
+                                const TextAreaRow *row, size_t a, size_t b,
+                                float max_w) {
+  float w = 0.0f;
+  while (a < b && w <= max_w)
+    w += text_area_advance(lay, ctx, font, row->text, row->len, &a);
+  return (a < b) ? a : b;
+}
+
+// End of the visual row starting at byte a: the rest of the line when it
+// fits in max_w (or max_w <= 0), else the last space that fits (skipped),
+// else as many glyphs as fit (at least one). *next is where the following
+// row starts.
+static size_t text_area_row_break(const StygianTextAreaLayout *lay,
+                                  StygianContext *ctx, StygianFont font,
+                                  const TextAreaRow *row, size_t a,
+                                  float max_w, size_t *next) {
+  size_t i = a, space = a;
+  float w = 0.0f;
+  *next = row->len;
+  if (max_w <= 0.0f)
+    return row->len;
+  while (i < row->len) {
+    size_t at = i;
+    float adv = text_area_advance(lay, ctx, font, row->text, row->len, &i);
+    if (at > a && w + adv > max_w) {
+      if (row->text[at] == ' ')
+        space = at;
+      *next = (space > a) ? space + 1u : at;
+      return (space > a) ? space : at;
     }
+    w += adv;
+    if (row->text[at] == ' ')
+      space = at;
+  }
+  return row->len;
+}
+
+// Byte nearest to local_x within the visual row [a, b): the first glyph
+// whose midpoint lies right of it.
+static size_t text_area_row_hit(const StygianTextAreaLayout *lay,
+                                StygianContext *ctx, StygianFont font,
+                                const TextAreaRow *row, size_t a, size_t b,
+                                float local_x) {
+  float w = 0.0f;
+  while (a < b) {
+    size_t at = a;
+    float adv = text_area_advance(lay, ctx, font, row->text, row->len, &a);
+    if (local_x < w + 0.5f * adv)
+      return at;
+    w += adv;
+  }
+  return b;
+}
 
-    // Fast path uses ASCII LUT; non-ASCII falls back to font measurement.
-    unsigned char uc = (unsigned char)*scan;
-    float cw = (uc < 128) ? it->advance_lut[uc]
-                          : stygian_text_width(it->ctx, it->font,
-                                               (char[]){*scan, 0}, 16.0f);
+// ============================================================================
+// Text Area Wrap Cache
+// ============================================================================
 
-    if (it->current_w + cw > it->max_w) {
-      // Soft wrap needed
-      if (last_space) {
-        // Break at space
-        *out_start = it->line_start;
-        *out_end = last_space;
-        it->p = last_space + 1; // Skip space
-      } else {
-        // Forced break at char
-        *out_start = it->line_start;
-        *out_end = scan;
-        it->p = scan; // Start next line here
-      }
-      it->y += 18.0f;
-      return true;
+static void text_area_tree_add(uint32_t *tree, uint32_t n, uint32_t i,
+                               uint32_t delta) {
+  for (i++; i <= n; i += i & (0u - i))
+    tree[i] += delta; // Wraps for negative deltas
+}
+
+// Sum of the first i entries.
+static uint32_t text_area_tree_sum(const uint32_t *tree, uint32_t i) {
+  uint32_t sum = 0u;
+  for (; i > 0u; i -= i & (0u - i))
+    sum += tree[i];
+  return sum;
+}
+
+// Largest i whose first i entries sum to at most *value; *value keeps the
+// remainder.
+static uint32_t text_area_tree_find(const uint32_t *tree, uint32_t n,
+                                    uint32_t *value) {
+  uint32_t pos = 0u, step = 1u;
+  while (step <= n / 2u)
+    step *= 2u;
+  for (; step > 0u; step /= 2u) {
+    if (pos + step <= n && tree[pos + step] <= *value) {
+      pos += step;
+      *value -= tree[pos];
     }
+  }
+  return pos;
+}
 
-    it->current_w += cw;
-    if (*scan == ' ') {
-      last_space = scan;
+// Rebuilds both trees after chunks were added or removed.
+static void text_area_layout_index(StygianTextAreaLayout *lay) {
+  uint32_t n = lay->chunk_count;
+  for (uint32_t i = 1u; i <= n; i++) {
+    lay->line_tree[i] = lay->chunks[i - 1u]->count;
+    lay->row_tree[i] = lay->chunks[i - 1u]->rows;
+  }
+  for (uint32_t i = 1u; i <= n; i++) {
+    uint32_t parent = i + (i & (0u - i));
+    if (parent <= n) {
+      lay->line_tree[parent] += lay->line_tree[i];
+      lay->row_tree[parent] += lay->row_tree[i];
     }
-    scan++;
   }
+}
 
-  // End of string
-  *out_start = it->line_start;
-  *out_end = scan;
-  it->p = scan;    // Point to null
-  it->done = true; // Mark as last pass
-  it->y += 18.0f;
+// Chunk holding line (line_count maps past the end of the last chunk).
+static TextAreaChunk *text_area_layout_locate(const StygianTextAreaLayout *lay,
+                                              uint32_t line, uint32_t *chunk,
+                                              uint32_t *k) {
+  uint32_t c = text_area_tree_find(lay->line_tree, lay->chunk_count, &line);
+  if (c >= lay->chunk_count) {
+    c = lay->chunk_count - 1u;
+    line = lay->chunks[c]->count;
+  }
+  *chunk = c;
+  *k = line;
+  return lay->chunks[c];
+}
+
+static const TextAreaLine *
+text_area_layout_line(const StygianTextAreaLayout *lay, uint32_t line) {
+  uint32_t c, k;
+  return &text_area_layout_locate(lay, line, &c, &k)->lines[k];
+}
+
+// Visual rows above line (all rows when line == line_count).
+static uint32_t text_area_layout_first_row(const StygianTextAreaLayout *lay,
+                                           uint32_t line) {
+  const TextAreaChunk *ch;
+  uint32_t c, k, rows;
+  if (lay->max_w <= 0.0f)
+    return line;
+  ch = text_area_layout_locate(lay, line, &c, &k);
+  rows = text_area_tree_sum(lay->row_tree, c);
+  for (uint32_t j = 0; j < k; j++)
+    rows += ch->lines[j].rows;
+  return rows;
+}
+
+static uint32_t text_area_layout_total_rows(const StygianTextAreaLayout *lay,
+                                            const StygianTextBuffer *text) {
+  if (lay->max_w <= 0.0f)
+    return stygian_text_buffer_line_count(text);
+  return text_area_tree_sum(lay->row_tree, lay->chunk_count);
+}
+
+static uint32_t text_area_layout_rows(const StygianTextAreaLayout *lay,
+                                      uint32_t line) {
+  return (lay->max_w > 0.0f) ? text_area_layout_line(lay, line)->rows : 1u;
+}
+
+// Line holding visual row `row` (< total rows); *sub is the row within it.
+static uint32_t text_area_layout_line_at(const StygianTextAreaLayout *lay,
+                                         uint32_t row, uint32_t *sub) {
+  const TextAreaChunk *ch;
+  uint32_t c, k = 0u;
+  if (lay->max_w <= 0.0f) {
+    *sub = 0u;
+    return row;
+  }
+  c = text_area_tree_find(lay->row_tree, lay->chunk_count, &row);
+  if (c >= lay->chunk_count) { // Past the last row: clamp to it
+    c = lay->chunk_count - 1u;
+    row = lay->chunks[c]->rows;
+  }
+  ch = lay->chunks[c];
+  while (k + 1u < ch->count && row >= ch->lines[k].rows)
+    row -= ch->lines[k++].rows;
+  *sub = (row < ch->lines[k].rows) ? row : ch->lines[k].rows - 1u;
+  return text_area_tree_sum(lay->line_tree, c) + k;
+}
+
+// Bytes [*a, *b) of visual row sub of a line line_len bytes long.
+static void text_area_layout_segment(const StygianTextAreaLayout *lay,
+                                     uint32_t line, uint32_t sub,
+                                     size_t line_len, size_t *a, size_t *b) {
+  const TextAreaLine *ln;
+  const uint32_t *pairs;
+  if (lay->max_w <= 0.0f) {
+    *a = 0u;
+    *b = line_len;
+    return;
+  }
+  ln = text_area_layout_line(lay, line);
+  pairs = lay->pool + ln->breaks;
+  *a = (sub > 0u) ? pairs[2u * (sub - 1u) + 1u] : 0u;
+  *b = (sub + 1u < ln->rows) ? pairs[2u * sub] : line_len;
+}
+
+// Visual row of the caret; on a wrap boundary, the row it ends.
+static uint32_t text_area_caret_row(const StygianTextAreaLayout *lay,
+                                    const StygianTextBuffer *text,
+                                    size_t cursor) {
+  uint32_t line = stygian_text_buffer_line_of(text, cursor);
+  uint32_t row = text_area_layout_first_row(lay, line);
+  size_t column = cursor - stygian_text_buffer_line_start(text, line);
+  const TextAreaLine *ln;
+  uint32_t lo = 0u, hi;
+  if (lay->max_w <= 0.0f)
+    return row;
+  // Row ends are ascending: bisect for the first one at or past column.
+  ln = text_area_layout_line(lay, line);
+  hi = ln->rows - 1u;
+  while (lo < hi) {
+    uint32_t mid = lo + (hi - lo) / 2u;
+    if (lay->pool[ln->breaks + 2u * mid] < column)
+      lo = mid + 1u;
+    else
+      hi = mid;
+  }
+  return row + lo;
+}
+
+static bool text_area_layout_reserve(StygianTextAreaLayout *lay,
+                                     uint32_t count) {
+  uint32_t cap = lay->chunk_cap ? lay->chunk_cap : 16u;
+  TextAreaChunk **chunks;
+  uint32_t *tree;
+  if (count <= lay->chunk_cap)
+    return true;
+  while (cap < count)
+    cap *= 2u;
+  chunks = (TextAreaChunk **)realloc(lay->chunks, cap * sizeof(*chunks));
+  if (!chunks)
+    return false;
+  lay->chunks = chunks;
+  tree = (uint32_t *)realloc(lay->line_tree, (cap + 1u) * sizeof(*tree));
+  if (!tree)
+    return false;
+  lay->line_tree = tree;
+  tree = (uint32_t *)realloc(lay->row_tree, (cap + 1u) * sizeof(*tree));
+  if (!tree)
+    return false;
+  lay->row_tree = tree;
+  lay->chunk_cap = cap;
   return true;
 }
 
-// Helper to measure a single line (with consistent "fat space" logic)
-// Uses advance LUT when available, falls back to stygian_text_width.
-static float measure_line_lut(const float *lut, StygianContext *ctx,
-                              StygianFont font, const char *start,
-                              const char *end) {
-  float w = 0;
-  const char *p = start;
-  while (p < end) {
-    unsigned char uc = (unsigned char)*p;
-    float cw = (lut && uc < 128)
-                   ? lut[uc]
-                   : stygian_text_width(ctx, font, (char[]){*p, 0}, 16.0f);
-    if (*p == ' ' && cw < 1.0f)
-      cw = 4.0f; // Minimal width for spaces
-    w += cw;
-    p++;
-  }
-  return w;
+// count unmeasured lines in full chunks, every one stale.
+static bool text_area_layout_reset(StygianTextAreaLayout *lay,
+                                   uint32_t count) {
+  uint32_t need = (count + STYGIAN_TEXT_AREA_CHUNK_LINES - 1u) /
+                  STYGIAN_TEXT_AREA_CHUNK_LINES;
+  if (!text_area_layout_reserve(lay, need))
+    return false;
+  while (lay->chunk_count > need)
+    free(lay->chunks[--lay->chunk_count]);
+  while (lay->chunk_count < need) {
+    TextAreaChunk *ch = (TextAreaChunk *)malloc(sizeof(*ch));
+    if (!ch)
+      return false;
+    lay->chunks[lay->chunk_count++] = ch;
+  }
+  for (uint32_t c = 0; c < need; c++) {
+    TextAreaChunk *ch = lay->chunks[c];
+    uint32_t left = count - c * STYGIAN_TEXT_AREA_CHUNK_LINES;
+    ch->count = (left < STYGIAN_TEXT_AREA_CHUNK_LINES)
+                    ? left
+                    : STYGIAN_TEXT_AREA_CHUNK_LINES;
+    ch->rows = 0u;
+    memset(ch->lines, 0, ch->count * sizeof(*ch->lines));
+  }
+  text_area_layout_index(lay);
+  lay->line_count = count;
+  lay->pool_len = lay->pool_garbage = 0u;
+  lay->stale = true;
+  lay->stale_lo = 0u;
+  lay->stale_hi = count - 1u;
+  return true;
 }
 
-static int text_xy_to_index(StygianContext *ctx, StygianFont font,
-                            const char *text, float param_x, float param_y,
-                            float scroll_y, float max_w) {
-  if (!text || !*text)
-    return 0;
+// Lines [k, count) of chunk c move to a new chunk after it.
+static bool text_area_layout_split(StygianTextAreaLayout *lay, uint32_t c,
+                                   uint32_t k) {
+  TextAreaChunk *ch = lay->chunks[c];
+  TextAreaChunk *tail;
+  if (!text_area_layout_reserve(lay, lay->chunk_count + 1u))
+    return false;
+  tail = (TextAreaChunk *)malloc(sizeof(*tail));
+  if (!tail)
+    return false;
+  tail->count = ch->count - k;
+  tail->rows = 0u;
+  memcpy(tail->lines, ch->lines + k, tail->count * sizeof(*tail->lines));
+  for (uint32_t j = 0; j < tail->count; j++)
+    tail->rows += tail->lines[j].rows;
+  ch->count = k;
+  ch->rows -= tail->rows;
+  memmove(lay->chunks + c + 2u, lay->chunks + c + 1u,
+          (lay->chunk_count - c - 1u) * sizeof(*lay->chunks));
+  lay->chunks[c + 1u] = tail;
+  lay->chunk_count++;
+  text_area_layout_index(lay);
+  return true;
+}
 
-  TextAreaIter it;
-  iter_begin(&it, ctx, font, text, max_w);
+// Appends chunk c + 1 to chunk c and drops it.
+static void text_area_layout_merge(StygianTextAreaLayout *lay, uint32_t c) {
+  TextAreaChunk *ch = lay->chunks[c];
+  TextAreaChunk *next = lay->chunks[c + 1u];
+  memcpy(ch->lines + ch->count, next->lines,
+         next->count * sizeof(*next->lines));
+  ch->count += next->count;
+  ch->rows += next->rows;
+  free(next);
+  memmove(lay->chunks + c + 1u, lay->chunks + c + 2u,
+          (lay->chunk_count - c - 2u) * sizeof(*lay->chunks));
+  lay->chunk_count--;
+  text_area_layout_index(lay);
+}
+
+// Marks m lines from line unmeasured, dropping their rows and breaks.
+static void text_area_layout_clear(StygianTextAreaLayout *lay, uint32_t line,
+                                   uint32_t m) {
+  while (m > 0u) {
+    uint32_t c, k, take, rows = 0u;
+    TextAreaChunk *ch = text_area_layout_locate(lay, line, &c, &k);
+    take = (m < ch->count - k) ? m : ch->count - k;
+    for (uint32_t j = k; j < k + take; j++) {
+      TextAreaLine *ln = &ch->lines[j];
+      if (ln->rows > 1u)
+        lay->pool_garbage += 2u * (size_t)(ln->rows - 1u);
+      rows += ln->rows;
+      ln->rows = ln->breaks = 0u;
+    }
+    ch->rows -= rows;
+    text_area_tree_add(lay->row_tree, lay->chunk_count, c, 0u - rows);
+    line += take;
+    m -= take;
+  }
+}
+
+static void text_area_layout_remove(StygianTextAreaLayout *lay, uint32_t line,
+                                    uint32_t m) {
+  text_area_layout_clear(lay, line, m);
+  while (m > 0u) {
+    uint32_t c, k, take;
+    TextAreaChunk *ch = text_area_layout_locate(lay, line, &c, &k);
+    take = (m < ch->count - k) ? m : ch->count - k;
+    memmove(ch->lines + k, ch->lines + k + take,
+            (ch->count - k - take) * sizeof(*ch->lines));
+    ch->count -= take;
+    text_area_tree_add(lay->line_tree, lay->chunk_count, c, 0u - take);
+    lay->line_count -= take;
+    m -= take;
+    // Keep chunks from thinning out (an emptied one always merges).
+    if (c + 1u < lay->chunk_count &&
+        ch->count + lay->chunks[c + 1u]->count <=
+            STYGIAN_TEXT_AREA_CHUNK_LINES)
+      text_area_layout_merge(lay, c);
+    else if (c > 0u && lay->chunks[c - 1u]->count + ch->count <=
+                           STYGIAN_TEXT_AREA_CHUNK_LINES)
+      text_area_layout_merge(lay, c - 1u);
+  }
+}
+
+static bool text_area_layout_insert(StygianTextAreaLayout *lay, uint32_t line,
+                                    uint32_t m) {
+  while (m > 0u) {
+    uint32_t c, k, take;
+    TextAreaChunk *ch = text_area_layout_locate(lay, line, &c, &k);
+    if (ch->count == STYGIAN_TEXT_AREA_CHUNK_LINES) {
+      if (!text_area_layout_split(lay, c, ch->count / 2u))
+        return false;
+      continue;
+    }
+    take = STYGIAN_TEXT_AREA_CHUNK_LINES - ch->count;
+    take = (m < take) ? m : take;
+    memmove(ch->lines + k + take, ch->lines + k,
+            (ch->count - k) * sizeof(*ch->lines));
+    memset(ch->lines + k, 0, take * sizeof(*ch->lines));
+    ch->count += take;
+    text_area_tree_add(lay->line_tree, lay->chunk_count, c, take);
+    lay->line_count += take;
+    line += take;
+    m -= take;
+  }
+  return true;
+}
 
-  const char *start, *end;
-  float target_y = param_y + scroll_y;
+static bool text_area_layout_push(StygianTextAreaLayout *lay, size_t end,
+                                  size_t next) {
+  if (lay->pool_len + 2u > lay->pool_cap) {
+    size_t cap = lay->pool_cap ? lay->pool_cap * 2u : 256u;
+    uint32_t *pool = (uint32_t *)realloc(lay->pool, cap * sizeof(*pool));
+    if (!pool)
+      return false;
+    lay->pool = pool;
+    lay->pool_cap = cap;
+  }
+  lay->pool[lay->pool_len++] = (uint32_t)end;
+  lay->pool[lay->pool_len++] = (uint32_t)next;
+  return true;
+}
 
-  // Iterate lines to find Y match
-  while (iter_next_line(&it, &start, &end)) {
-    // Check Y bounds of this line
-    float line_top = it.y - 18.0f; // iter_next_line advances Y
-    float line_bottom = it.y;
-
-    if (target_y >= line_top && target_y < line_bottom) {
-      // Found the line. Scan X.
-      // Linear scan within line
-      const char *scan = start;
-      float lx = 0;
-      while (scan < end) {
-        float cw = measure_line_lut(NULL, ctx, font, scan, scan + 1);
-        float mid_x = lx + cw * 0.5f;
-        if (param_x < mid_x)
-          return (int)(scan - text);
-        lx += cw;
-        scan++;
+// Drops pool entries of re-measured lines once they outweigh the live ones
+// and the line walk it takes.
+static void text_area_layout_compact(StygianTextAreaLayout *lay) {
+  size_t live = lay->pool_len - lay->pool_garbage;
+  size_t len = 0u;
+  uint32_t *pool;
+  if (lay->pool_garbage <= live ||
+      lay->pool_garbage <= lay->line_count / 4u + 1024u)
+    return;
+  pool = (uint32_t *)malloc((live ? live : 1u) * sizeof(*pool));
+  if (!pool)
+    return; // Keep the old pool; it is still valid
+  for (uint32_t c = 0; c < lay->chunk_count; c++) {
+    TextAreaChunk *ch = lay->chunks[c];
+    for (uint32_t k = 0; k < ch->count; k++) {
+      TextAreaLine *ln = &ch->lines[k];
+      size_t n;
+      if (ln->rows <= 1u)
+        continue;
+      n = 2u * (size_t)(ln->rows - 1u);
+      memcpy(pool + len, lay->pool + ln->breaks, n * sizeof(*pool));
+      ln->breaks = (uint32_t)len;
+      len += n;
+    }
+  }
+  free(lay->pool);
+  lay->pool = pool;
+  lay->pool_len = len;
+  lay->pool_cap = live ? live : 1u;
+  lay->pool_garbage = 0u;
+}
+
+// Row count and breaks of one line, in one pass over its glyphs.
+static bool text_area_layout_measure(StygianTextAreaLayout *lay,
+                                     StygianContext *ctx, StygianFont font,
+                                     const StygianTextBuffer *text,
+                                     uint32_t line, TextAreaLine *ln) {
+  TextAreaRow row;
+  size_t a = 0u, end, next;
+  bool ok = true;
+  text_area_row_load(text, line, &row);
+  ln->rows = 1u;
+  ln->breaks = (uint32_t)lay->pool_len;
+  for (;;) {
+    end = text_area_row_break(lay, ctx, font, &row, a, lay->max_w, &next);
+    if (next >= row.len)
+      break;
+    if (!text_area_layout_push(lay, end, next)) {
+      ok = false;
+      break;
+    }
+    ln->rows++;
+    a = next;
+  }
+  text_area_row_release(&row);
+  return ok;
+}
+
+// Brings the cache up to date for max_w. Lines are re-measured only when
+// stale; a new width, font, line count or a revision the widget did not
+// make itself invalidates them all. Returns false (rows fall back to one per
+// line) when unwrapped or out of memory.
+static bool text_area_layout_sync(StygianTextAreaLayout *lay,
+                                  StygianContext *ctx, StygianFont font,
+                                  const StygianTextBuffer *text,
+                                  float max_w) {
+  uint32_t count = stygian_text_buffer_line_count(text);
+  uint32_t revision = stygian_text_buffer_revision(text);
+  text_area_layout_font(lay, ctx, font);
+  if (max_w <= 0.0f) {
+    lay->max_w = 0.0f;
+    return false;
+  }
+  if (lay->max_w != max_w || lay->revision != revision ||
+      lay->line_count != count) {
+    if (!text_area_layout_reset(lay, count)) {
+      lay->max_w = 0.0f;
+      return false;
+    }
+    lay->max_w = max_w;
+    lay->revision = revision;
+  }
+  if (lay->stale) {
+    uint32_t line = lay->stale_lo;
+    text_area_layout_compact(lay);
+    while (line <= lay->stale_hi && line < count) {
+      uint32_t c, k;
+      TextAreaChunk *ch = text_area_layout_locate(lay, line, &c, &k);
+      uint32_t rows = 0u;
+      for (; k < ch->count && line <= lay->stale_hi; k++, line++) {
+        if (ch->lines[k].rows)
+          continue;
+        if (!text_area_layout_measure(lay, ctx, font, text, line,
+                                      &ch->lines[k])) {
+          lay->max_w = 0.0f;
+          return false;
+        }
+        rows += ch->lines[k].rows;
       }
-      return (int)(end - text); // Clicked past end of line
+      ch->rows += rows;
+      text_area_tree_add(lay->row_tree, lay->chunk_count, c, rows);
     }
+    lay->stale = false;
   }
-  return (int)strlen(text); // Below all text
+  return true;
 }
 
-// Helper to insert character at index
-static void buffer_insert(char *buf, int size, int idx, char c) {
-  int len = strlen(buf);
-  if (len + 1 >= size)
+// Lines [first, first + old_n) became new_n unmeasured lines.
+static void text_area_layout_splice(StygianTextAreaLayout *lay,
+                                    const StygianTextBuffer *text,
+                                    uint32_t first, uint32_t old_n,
+                                    uint32_t new_n) {
+  uint32_t old_end = first + old_n;
+  uint32_t new_last = first + new_n - 1u;
+  uint32_t keep = (old_n < new_n) ? old_n : new_n;
+  uint32_t lo = first, hi = new_last;
+  text_area_layout_clear(lay, first, keep);
+  if (old_n > new_n) {
+    text_area_layout_remove(lay, first + keep, old_n - new_n);
+  } else if (new_n > old_n &&
+             !text_area_layout_insert(lay, first + keep, new_n - old_n)) {
+    lay->max_w = 0.0f; // Rebuild from scratch on the next sync
     return;
-  memmove(buf + idx + 1, buf + idx, len - idx + 1);
-  buf[idx] = c;
+  }
+  if (lay->stale) { // Shift the pending range past the edit and merge
+    lo = (lay->stale_lo >= old_end) ? lay->stale_lo - old_n + new_n
+                                    : lay->stale_lo;
+    hi = (lay->stale_hi >= old_end) ? lay->stale_hi - old_n + new_n
+                                    : lay->stale_hi;
+    lo = (lo < first) ? lo : first;
+    hi = (hi > new_last) ? hi : new_last;
+  }
+  lay->stale = true;
+  lay->stale_lo = lo;
+  lay->stale_hi = hi;
+  lay->revision = stygian_text_buffer_revision(text);
+}
+
+// Buffer edits made by the widget: the cache learns which lines changed, so
+// only those are re-measured.
+static bool text_area_layout_tracks(const StygianTextAreaLayout *lay,
+                                    const StygianTextBuffer *text) {
+  return lay->max_w > 0.0f &&
+         lay->revision == stygian_text_buffer_revision(text);
+}
+
+static void text_area_erase(StygianTextAreaLayout *lay,
+                            StygianTextBuffer *text, size_t offset,
+                            size_t len) {
+  bool tracked = text_area_layout_tracks(lay, text);
+  uint32_t first = stygian_text_buffer_line_of(text, offset);
+  uint32_t last = stygian_text_buffer_line_of(text, offset + len);
+  stygian_text_buffer_erase(text, offset, len);
+  if (tracked)
+    text_area_layout_splice(lay, text, first, last - first + 1u, 1u);
+}
+
+static bool text_area_insert(StygianTextAreaLayout *lay,
+                             StygianTextBuffer *text, size_t offset,
+                             const char *bytes, size_t len) {
+  bool tracked = text_area_layout_tracks(lay, text);
+  uint32_t first = stygian_text_buffer_line_of(text, offset);
+  if (!stygian_text_buffer_insert(text, offset, bytes, len))
+    return false;
+  if (tracked) {
+    uint32_t last = stygian_text_buffer_line_of(text, offset + len);
+    text_area_layout_splice(lay, text, first, 1u, last - first + 1u);
+  }
+  return true;
 }
 
-// Helper to delete character before index
-static void buffer_delete(char *buf, int idx) {
-  if (idx <= 0)
-    return;
-  int len = strlen(buf);
-  memmove(buf + idx - 1, buf + idx, len - idx + 1);
+// ============================================================================
+// Text Area Rows
+// ============================================================================
+
+// Visual row walker: loads one hard line at a time and steps through its
+// cached rows, starting at row sub of first_line.
+typedef struct {
+  const StygianTextAreaLayout *lay;
+  const StygianTextBuffer *text;
+  uint32_t line;
+  uint32_t line_count;
+  uint32_t sub;  // Row within line
+  uint32_t rows; // Rows of line
+  bool loaded;
+  TextAreaRow row;
+  size_t seg_start, seg_end; // Current visual row within row
+} TextAreaRows;
+
+static void text_area_rows_begin(TextAreaRows *it,
+                                 const StygianTextAreaLayout *lay,
+                                 const StygianTextBuffer *text,
+                                 uint32_t first_line, uint32_t sub) {
+  it->lay = lay;
+  it->text = text;
+  it->line = first_line;
+  it->line_count = stygian_text_buffer_line_count(text);
+  it->sub = sub;
+  it->rows = 0u;
+  it->loaded = false;
+  it->row.text = it->row.inline_text;
+  it->seg_start = it->seg_end = 0;
+}
+
+static bool text_area_rows_next(TextAreaRows *it) {
+  if (it->loaded && it->sub + 1u < it->rows) {
+    it->sub++;
+  } else {
+    if (it->loaded) {
+      text_area_row_release(&it->row);
+      it->loaded = false;
+      it->line++;
+      it->sub = 0u;
+    }
+    if (it->line >= it->line_count)
+      return false;
+    text_area_row_load(it->text, it->line, &it->row);
+    it->loaded = true;
+    it->rows = text_area_layout_rows(it->lay, it->line);
+    if (it->sub >= it->rows)
+      it->sub = it->rows - 1u;
+  }
+  text_area_layout_segment(it->lay, it->line, it->sub, it->row.len,
+                           &it->seg_start, &it->seg_end);
+  return true;
+}
+
+static void text_area_rows_end(TextAreaRows *it) {
+  if (it->loaded)
+    text_area_row_release(&it->row);
+  it->loaded = false;
+}
+
+// Width rows wrap at (0 = no wrap): the area minus padding and scrollbar.
+static float text_area_wrap_width(const StygianTextArea *state) {
+  float max_w;
+  if (state->no_wrap)
+    return 0.0f;
+  max_w = state->w - (state->total_height > state->h ? 14.0f : 10.0f);
+  return (max_w < 20.0f) ? 20.0f : max_w;
+}
+
+static int text_xy_to_index(StygianContext *ctx, StygianFont font,
+                            const StygianTextAreaLayout *lay,
+                            const StygianTextBuffer *text, float param_x,
+                            float param_y, float scroll_y, float row_h) {
+  float target_y = param_y + scroll_y;
+  size_t doc_len = stygian_text_buffer_length(text);
+  uint32_t total_rows = text_area_layout_total_rows(lay, text);
+  uint32_t line, sub;
+  size_t column;
+  TextAreaRows it;
+
+  if (doc_len == 0)
+    return 0;
+  if (target_y < 0.0f)
+    target_y = 0.0f;
+  if (target_y / row_h >= (float)total_rows)
+    return (int)doc_len; // Below all text
+  line = text_area_layout_line_at(lay, (uint32_t)(target_y / row_h), &sub);
+
+  text_area_rows_begin(&it, lay, text, line, sub);
+  if (!text_area_rows_next(&it))
+    return (int)doc_len;
+  column = text_area_row_hit(lay, ctx, font, &it.row, it.seg_start,
+                             it.seg_end, param_x - STYGIAN_TEXT_AREA_PAD_X);
+  column += it.row.start;
+  text_area_rows_end(&it);
+  return (int)column;
+}
+
+// Hard-line caret move (UP/DOWN). Keeps the byte column, clamped to the
+// target line; resolved through the buffer's line index, not a rescan.
+static int text_area_line_jump(const StygianTextBuffer *text, int cursor,
+                               int delta) {
+  uint32_t line = stygian_text_buffer_line_of(text, (size_t)cursor);
+  uint32_t line_count = stygian_text_buffer_line_count(text);
+  size_t column = (size_t)cursor - stygian_text_buffer_line_start(text, line);
+  size_t target_start, target_end;
+  if (delta < 0) {
+    if (line == 0)
+      return 0;
+    line--;
+  } else {
+    if (line + 1 >= line_count)
+      return (int)stygian_text_buffer_length(text);
+    line++;
+  }
+  target_start = stygian_text_buffer_line_start(text, line);
+  target_end = stygian_text_buffer_line_end(text, line);
+  if (column > target_end - target_start)
+    column = target_end - target_start;
+  return (int)(target_start + column);
 }
 
 bool stygian_text_area(StygianContext *ctx, StygianFont font,
                        StygianTextArea *state) {
+  if (!state || !state->text)
+    return false;
+  StygianTextBuffer *text = state->text;
   uint32_t id = widget_id(state->x, state->y, "textarea");
+  float row_h = stygian_text_area_row_height(ctx, font);
+  float wrap_w = text_area_wrap_width(state);
   StygianWidgetRegionFlags region_flags =
       STYGIAN_WIDGET_REGION_POINTER_LEFT_MUTATES;
   if (state->total_height > state->h) {
@@ -2177,6 +2858,24 @@ bool stygian_text_area(StygianContext *ctx, StygianFont font,
   widget_register_focusable(id);
   widget_nav_prepare();
 
+  // Caller may have edited the document directly; keep indices in range.
+  {
+    int doc_len = (int)stygian_text_buffer_length(text);
+    if (state->cursor_idx > doc_len)
+      state->cursor_idx = doc_len;
+    if (state->selection_start > doc_len)
+      state->selection_start = doc_len;
+    if (state->selection_end > doc_len)
+      state->selection_end = doc_len;
+  }
+  if (!state->layout) {
+    state->layout = (StygianTextAreaLayout *)calloc(1, sizeof(*state->layout));
+    if (!state->layout)
+      return false;
+  }
+  StygianTextAreaLayout *lay = state->layout;
+  text_area_layout_sync(lay, ctx, font, text, wrap_w);
+
   // Input Handling
   if (hovered && widget_mouse_pressed()) {
     g_widget_state.focus_id = id;
@@ -2184,9 +2883,8 @@ bool stygian_text_area(StygianContext *ctx, StygianFont font,
     state->focused = true;
     float local_x = g_widget_state.mouse_x - state->x;
     float local_y = g_widget_state.mouse_y - state->y;
-    // Pass state->w - 10 (padding) as max wrap width
-    int idx = text_xy_to_index(ctx, font, state->buffer, local_x, local_y,
-                               state->scroll_y, state->w - 10.0f);
+    int idx = text_xy_to_index(ctx, font, lay, text, local_x, local_y,
+                               state->scroll_y, row_h);
     state->cursor_idx = idx;
 
     // Shift-Click extends selection
@@ -2208,8 +2906,8 @@ bool stygian_text_area(StygianContext *ctx, StygianFont font,
   if (g_widget_state.active_id == id && g_widget_state.mouse_down) {
     float local_x = g_widget_state.mouse_x - state->x;
     float local_y = g_widget_state.mouse_y - state->y;
-    int idx = text_xy_to_index(ctx, font, state->buffer, local_x, local_y,
-                               state->scroll_y, state->w - 10.0f);
+    int idx = text_xy_to_index(ctx, font, lay, text, local_x, local_y,
+                               state->scroll_y, row_h);
     state->cursor_idx = idx;
     // Update end while keeping start as anchor
     state->selection_end = idx;
@@ -2235,6 +2933,7 @@ bool stygian_text_area(StygianContext *ctx, StygianFont font,
   bool has_selection = (sel_min != sel_max);
 
   bool changed = false;
+  bool caret_moved = false;
   if (state->focused) {
     // Process Buffer Keys
     for (int i = 0; i < g_widget_state.key_count; i++) {
@@ -2246,28 +2945,26 @@ bool stygian_text_area(StygianContext *ctx, StygianFont font,
       if (key == STYGIAN_KEY_BACKSPACE) {
         if (has_selection) {
           // Delete range
-          int buf_len = strlen(state->buffer);
-          memmove(state->buffer + sel_min, state->buffer + sel_max,
-                  buf_len - sel_max + 1);
+          text_area_erase(lay, text, (size_t)sel_min,
+                          (size_t)(sel_max - sel_min));
           state->cursor_idx = sel_min;
           state->selection_start = state->selection_end = sel_min;
           changed = true;
         } else if (state->cursor_idx > 0) {
-          buffer_delete(state->buffer, state->cursor_idx);
+          text_area_erase(lay, text, (size_t)state->cursor_idx - 1, 1);
           state->cursor_idx--;
           state->selection_start = state->selection_end = state->cursor_idx;
           changed = true;
         }
       } else if (key == STYGIAN_KEY_ENTER) {
         if (has_selection) {
-          int buf_len = strlen(state->buffer);
-          memmove(state->buffer + sel_min, state->buffer + sel_max,
-                  buf_len - sel_max + 1);
+          text_area_erase(lay, text, (size_t)sel_min,
+                          (size_t)(sel_max - sel_min));
           state->cursor_idx = sel_min;
         }
-        buffer_insert(state->buffer, state->buffer_size, state->cursor_idx,
-                      '\n');
-        state->cursor_idx++;
+        if (text_area_insert(lay, text, (size_t)state->cursor_idx, "\n", 1)) {
+          state->cursor_idx++;
+        }
         state->selection_start = state->selection_end = state->cursor_idx;
         changed = true;
       } else if (key == STYGIAN_KEY_LEFT) {
@@ -2277,17 +2974,23 @@ bool stygian_text_area(StygianContext *ctx, StygianFont font,
           state->selection_end = state->cursor_idx;
         else
           state->selection_start = state->selection_end = state->cursor_idx;
+        caret_moved = true;
       } else if (key == STYGIAN_KEY_RIGHT) {
-        if (state->buffer[state->cursor_idx] != 0)
+        if ((size_t)state->cursor_idx < stygian_text_buffer_length(text))
           state->cursor_idx++;
         if (shift)
           state->selection_end = state->cursor_idx;
         else
           state->selection_start = state->selection_end = state->cursor_idx;
-      } else if (key == STYGIAN_KEY_UP) {
-        // TODO: Line jump logic
-      } else if (key == STYGIAN_KEY_DOWN) {
-        // TODO: Line jump logic
+        caret_moved = true;
+      } else if (key == STYGIAN_KEY_UP || key == STYGIAN_KEY_DOWN) {
+        state->cursor_idx = text_area_line_jump(
+            text, state->cursor_idx, key == STYGIAN_KEY_UP ? -1 : 1);
+        if (shift)
+          state->selection_end = state->cursor_idx;
+        else
+          state->selection_start = state->selection_end = state->cursor_idx;
+        caret_moved = true;
       } else if (key == STYGIAN_KEY_C &&
                  (g_widget_state.key_events[i].mods & STYGIAN_MOD_CTRL)) {
         // Universal Copy
@@ -2295,30 +2998,27 @@ bool stygian_text_area(StygianContext *ctx, StygianFont font,
           int len = sel_max - sel_min;
           if (len > 0 && len < 8192) {
             char temp[8192];
-            memcpy(temp, state->buffer + sel_min, len);
-            temp[len] = 0;
+            stygian_text_buffer_copy(text, (size_t)sel_min, (size_t)len, temp,
+                                     sizeof(temp));
             stygian_clipboard_push(ctx, temp, NULL);
           }
         } else {
-          stygian_clipboard_push(ctx, state->buffer, NULL);
+          stygian_clipboard_push(ctx, stygian_text_buffer_cstr(text), NULL);
         }
       } else if (key == STYGIAN_KEY_V &&
                  (g_widget_state.key_events[i].mods & STYGIAN_MOD_CTRL)) {
         // Universal Paste
         if (has_selection) {
-          int buf_len = strlen(state->buffer);
-          memmove(state->buffer + sel_min, state->buffer + sel_max,
-                  buf_len - sel_max + 1);
+          text_area_erase(lay, text, (size_t)sel_min,
+                          (size_t)(sel_max - sel_min));
           state->cursor_idx = sel_min;
         }
         char *clip = stygian_clipboard_pop(ctx);
         if (clip) {
-          const char *p = clip;
-          while (*p) {
-            buffer_insert(state->buffer, state->buffer_size, state->cursor_idx,
-                          *p);
-            state->cursor_idx++;
-            p++;
+          size_t clip_len = strlen(clip);
+          if (text_area_insert(lay, text, (size_t)state->cursor_idx, clip,
+                               clip_len)) {
+            state->cursor_idx += (int)clip_len;
           }
           // Clipboard pop returns CRT-owned memory; free with matching runtime.
           free(clip);
@@ -2333,33 +3033,50 @@ bool stygian_text_area(StygianContext *ctx, StygianFont font,
       char c = (char)g_widget_state.char_events[i];
       if (c >= 32 && c <= 126) { // Printable ASCII for now
         if (has_selection) {
-          int buf_len = strlen(state->buffer);
-          memmove(state->buffer + sel_min, state->buffer + sel_max,
-                  buf_len - sel_max + 1);
+          text_area_erase(lay, text, (size_t)sel_min,
+                          (size_t)(sel_max - sel_min));
           state->cursor_idx = sel_min;
           // state->selection_start = state->selection_end = sel_min; //
           // handled at end
           has_selection = false;
           sel_min = sel_max = state->cursor_idx;
         }
-        buffer_insert(state->buffer, state->buffer_size, state->cursor_idx, c);
-        state->cursor_idx++;
+        if (text_area_insert(lay, text, (size_t)state->cursor_idx, &c, 1)) {
+          state->cursor_idx++;
+        }
         state->selection_start = state->selection_end = state->cursor_idx;
         changed = true;
       }
     }
   }
+
+  // Re-measure the lines edited above; height and caret row then come from
+  // the row index.
+  text_area_layout_sync(lay, ctx, font, text, wrap_w);
+  uint32_t total_rows = text_area_layout_total_rows(lay, text);
+  float caret_top =
+      (float)text_area_caret_row(lay, text, (size_t)state->cursor_idx) * row_h;
+  state->total_height = (float)total_rows * row_h;
+
+  // Keep the caret row in view after keyboard edits/navigation.
+  if (changed || caret_moved) {
+    if (caret_top < state->scroll_y)
+      state->scroll_y = caret_top;
+    else if (caret_top + row_h > state->scroll_y + state->h)
+      state->scroll_y = caret_top + row_h - state->h;
+  }
+
   // Scroll Handling
   if (hovered &&
       (g_widget_state.scroll_dy != 0 || g_widget_state.scroll_dx != 0)) {
     state->scroll_y -= g_widget_state.scroll_dy * 20.0f;
   }
   // Clamp scroll
-  if (state->scroll_y < 0.0f)
-    state->scroll_y = 0;
   if (state->total_height > state->h &&
       state->scroll_y > state->total_height - state->h)
     state->scroll_y = state->total_height - state->h;
+  if (state->scroll_y < 0.0f)
+    state->scroll_y = 0;
 
   // Render Background
   float bg_col[4] = {0.1f, 0.1f, 0.12f, 1.0f};
@@ -2374,77 +3091,84 @@ bool stygian_text_area(StygianContext *ctx, StygianFont font,
   // Clip Content
   stygian_clip_push(ctx, state->x, state->y, state->w, state->h);
 
-  // Render Text Line by Line (Wrapped)
-  float x_off = state->x + 5.0f;
-  bool show_scrollbar = state->total_height > state->h;
-  float max_w = state->w - (show_scrollbar ? 14.0f : 10.0f);
-  if (max_w < 20.0f)
-    max_w = 20.0f;
-
-  TextAreaIter it;
-  iter_begin(&it, ctx, font, state->buffer, max_w);
-  const char *start, *end;
-
-  while (iter_next_line(&it, &start, &end)) {
-    // Draw visible lines
-    float line_top = it.y - 18.0f;
-    float abs_top = state->y + line_top - state->scroll_y;
-
-    if (abs_top + 18.0f > state->y && abs_top < state->y + state->h) {
-      float lx = x_off;
-
-      // Draw Selection Rect (Block)
-      if (has_selection) {
-        int idx_start = (int)(start - state->buffer);
-        int idx_end = (int)(end - state->buffer);
-
-        int intersect_min = (sel_min > idx_start) ? sel_min : idx_start;
-        int intersect_max = (sel_max < idx_end) ? sel_max : idx_end;
-
-        if (intersect_min < intersect_max) {
-          // Valid intersection on this line
-          float pre_width = measure_line_lut(NULL, ctx, font, start,
-                                             state->buffer + intersect_min);
-          float sel_width =
-              measure_line_lut(NULL, ctx, font, state->buffer + intersect_min,
-                               state->buffer + intersect_max);
-
-          stygian_rect(ctx, lx + pre_width, abs_top, sel_width, 18.0f, 0.2f,
-                       0.4f, 0.8f, 0.5f);
-        }
-      }
+  // Visible rows (+ overscan), starting from the row index lookup of the
+  // scroll offset.
+  float x_off = state->x + STYGIAN_TEXT_AREA_PAD_X;
+  float overscan_h = (float)STYGIAN_TEXT_AREA_OVERSCAN * row_h;
+  float view_w = state->w - STYGIAN_TEXT_AREA_PAD_X;
+  uint32_t first_row = (uint32_t)(state->scroll_y / row_h);
+  uint32_t first_line = 0u, first_sub = 0u;
+  first_row = (first_row > STYGIAN_TEXT_AREA_OVERSCAN)
+                  ? first_row - STYGIAN_TEXT_AREA_OVERSCAN
+                  : 0u;
+  if (first_row >= total_rows)
+    first_row = total_rows - 1u;
+  first_line = text_area_layout_line_at(lay, first_row, &first_sub);
+  float top = (float)first_row * row_h;
+
+  TextAreaRows rows;
+  text_area_rows_begin(&rows, lay, text, first_line, first_sub);
+  while (text_area_rows_next(&rows)) {
+    TextAreaRow *row = &rows.row;
+    size_t seg_start = rows.seg_start, seg_end = rows.seg_end;
+    float abs_top = state->y + top - state->scroll_y;
+    int idx_start = (int)(row->start + seg_start);
+    int idx_end = (int)(row->start + seg_end);
+    top += row_h;
+    if (abs_top >= state->y + state->h + overscan_h)
+      break;
+    if (abs_top + row_h < state->y - overscan_h)
+      continue;
 
-      const char *lp = start;
-      while (lp < end) {
-        char temp[2] = {*lp, 0};
-        // Re-measure for consistent placement
-        float cw = stygian_text_width(ctx, font, temp, 16.0f);
-        if (*lp == ' ' && cw < 1.0f)
-          cw = 4.0f;
-
-        stygian_text(ctx, font, temp, lx, abs_top, 16.0f, 0.9f, 0.9f, 0.9f,
-                     1.0f);
-        lx += cw;
-        lp++;
+    // Draw Selection Rect (Block)
+    if (has_selection) {
+      int intersect_min = (sel_min > idx_start) ? sel_min : idx_start;
+      int intersect_max = (sel_max < idx_end) ? sel_max : idx_end;
+
+      if (intersect_min < intersect_max) {
+        // Valid intersection on this row
+        float pre_width =
+            text_area_row_width(lay, ctx, font, row, seg_start,
+                                (size_t)intersect_min - row->start);
+        float sel_width =
+            text_area_row_width(lay, ctx, font, row,
+                                (size_t)intersect_min - row->start,
+                                (size_t)intersect_max - row->start);
+
+        stygian_rect(ctx, x_off + pre_width, abs_top, sel_width, row_h, 0.2f,
+                     0.4f, 0.8f, 0.5f);
       }
+    }
 
-      // Cursor
-      if (state->focused) {
-        int idx_start = (int)(start - state->buffer);
-        int idx_end = (int)(end - state->buffer);
-        if (state->cursor_idx >= idx_start && state->cursor_idx <= idx_end) {
-          float cx =
-              x_off + measure_line_lut(NULL, ctx, font, start,
-                                       state->buffer + state->cursor_idx);
-          stygian_rect(ctx, cx, abs_top, 2.0f, 16.0f, 1.0f, 1.0f, 1.0f, 1.0f);
-        }
+    // One text run per row (batched glyph allocation inside stygian_text).
+    // An unwrapped long line only emits the bytes that reach the view.
+    if (seg_end > seg_start) {
+      size_t draw_end = seg_end;
+      char saved;
+      if (seg_end - seg_start > STYGIAN_TEXT_AREA_ROW_INLINE_BYTES) {
+        draw_end =
+            text_area_row_fit(lay, ctx, font, row, seg_start, seg_end, view_w);
       }
+      saved = row->text[draw_end];
+      row->text[draw_end] = '\0';
+      stygian_text(ctx, font, row->text + seg_start, x_off, abs_top,
+                   STYGIAN_TEXT_AREA_FONT_SIZE, 0.9f, 0.9f, 0.9f, 1.0f);
+      row->text[draw_end] = saved;
+    }
+
+    // Cursor
+    if (state->focused && state->cursor_idx >= idx_start &&
+        state->cursor_idx <= idx_end) {
+      float cx = x_off + text_area_row_width(
+                             lay, ctx, font, row, seg_start,
+                             (size_t)state->cursor_idx - row->start);
+      stygian_rect(ctx, cx, abs_top, 2.0f, STYGIAN_TEXT_AREA_FONT_SIZE, 1.0f,
+                   1.0f, 1.0f, 1.0f);
     }
   }
+  text_area_rows_end(&rows);
 
   stygian_clip_pop(ctx);
-  // Auto-scroll logic could be added here
-  state->total_height = it.y;
 
   stygian_scrollbar_v(ctx, state->x + state->w - 8.0f, state->y + 2.0f, 6.0f,
                       state->h - 4.0f, state->total_height, &state->scroll_y);
@@ -2583,7 +3307,7 @@ bool stygian_scrollbar_v(StygianContext *ctx, float x, float y, float w,
 
 static struct {
   float x, y, w, h;
-  uint8_t clip_id;
+  StygianClipId clip_id;
   bool active;
 } g_panel_state = {0};
 
@@ -5,6 +5,8 @@
 
 #include "../include/stygian.h"
 #include "../window/stygian_input.h"
+#include "stygian_log_store.h"
+#include "stygian_text_buffer.h"
 
 #ifdef __cplusplus
 extern "C" {
@@ -81,20 +83,35 @@ bool stygian_text_input(StygianContext *ctx, StygianFont font, float x, float y,
                         float w, float h, char *buffer, int buffer_size);
 
 // Multiline Text Area with Scrolling & Selection
+// Document storage is a caller-owned StygianTextBuffer (gap buffer + line
+// index), so edits and caret/line lookups do not scale with document size.
+// Lines soft-wrap at the area's width; per-line row counts and breaks are
+// cached (keyed by buffer revision and wrap width) so only visible rows and
+// edited lines are touched each frame. With no_wrap, rows are hard lines
+// clipped at the right edge. Either way frame cost does not grow with the
+// document; a caller-side edit costs one re-measure of the whole document.
+typedef struct StygianTextAreaLayout StygianTextAreaLayout; // Opaque
+
 typedef struct StygianTextArea {
   float x, y, w, h;
-  char *buffer;
-  int buffer_size;
-  int cursor_idx;      // Byte index
-  int selection_start; // Byte index (-1 if no selection)
-  int selection_end;   // Byte index (-1 if no selection)
+  StygianTextBuffer *text; // Required: document storage (caller-owned)
+  int cursor_idx;          // Byte index
+  int selection_start;     // Byte index (-1 if no selection)
+  int selection_end;       // Byte index (-1 if no selection)
   float scroll_y;
   float total_height; // Computed
   bool focused;
+  bool no_wrap; // One row per hard line (virtualized)
+  // Internal wrap cache (zero-init; released by stygian_text_area_free)
+  StygianTextAreaLayout *layout;
 } StygianTextArea;
 
 bool stygian_text_area(StygianContext *ctx, StygianFont font,
                        StygianTextArea *state);
+// Release the internal wrap cache (the text buffer stays caller-owned).
+void stygian_text_area_free(StygianTextArea *state);
+// Height of one text area row (line height, 18px without font metrics).
+float stygian_text_area_row_height(StygianContext *ctx, StygianFont font);
 
 // Vertical scrollbar for custom panels/areas.
 // content_height: total scrollable content height in pixels.
@@ -317,11 +334,10 @@ bool stygian_breadcrumb(StygianContext *ctx, StygianFont font,
 typedef struct StygianOutputPanel {
   float x, y, w, h;
   const char *title;
-  // Circular buffer or pointer to log data
-  // For demo, standard C string
-  const char *text_buffer;
+  StygianLogStore *log; // Required: line store (caller-owned)
   float scroll_y;
-  bool auto_scroll;
+  bool auto_scroll;      // Pin view to the newest line
+  uint64_t seen_evicted; // Internal: keeps scroll anchored across eviction
 } StygianOutputPanel;
 
 void stygian_output_panel(StygianContext *ctx, StygianFont font,
@@ -516,9 +532,10 @@ bool stygian_asset_browser(StygianContext *ctx, StygianFont font,
 
 typedef struct StygianConsoleLog {
   float x, y, w, h;
-  const char *log_buffer; // Newline-separated log entries
+  StygianLogStore *log; // Required: line store (caller-owned)
   float scroll_y;
-  bool auto_scroll;
+  bool auto_scroll;      // Pin view to the newest line
+  uint64_t seen_evicted; // Internal: keeps scroll anchored across eviction
 } StygianConsoleLog;
 
 void stygian_console_log(StygianContext *ctx, StygianFont font,